@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Measures HDF5 write bandwidth of a distributed vector as a function of the number of ranks
+
+#include "cxxopts/cxxopts.hpp"
+#include "fmt/printf.h"
+#include "godzilla/Init.h"
+#include "godzilla/Exception.h"
+#include "godzilla/HDF5File.h"
+#include "godzilla/Vector.h"
+#include "mpicpp-lite/mpicpp-lite.h"
+#include <chrono>
+
+using namespace godzilla;
+
+/// Write a vector with `n_global` values `n_reps` times from all ranks of `comm`
+///
+/// @return Average time of one write in seconds
+double
+benchmark_write(mpi::Communicator comm, Int n_global, int n_reps, const hdf5::FileOptions & opts)
+{
+    auto v = Vector::create_mpi(comm, PETSC_DECIDE, n_global);
+    v.set(1.);
+
+    fs::path file_name = fmt::format("hdf5-write-{}.h5", comm.size());
+    double total = 0.;
+    for (int i = 0; i < n_reps; ++i) {
+        comm.barrier();
+        auto start = std::chrono::steady_clock::now();
+        {
+            HDF5File f(comm, file_name, FileAccess::CREATE, opts);
+            auto g = f.create_group(hdf5::ROOT_GROUP);
+            g.write_global_vector("vec", v);
+        }
+        comm.barrier();
+        auto end = std::chrono::steady_clock::now();
+        total += std::chrono::duration<double>(end - start).count();
+    }
+    if (comm.rank() == 0)
+        fs::remove(file_name);
+    return total / n_reps;
+}
+
+hdf5::Compression
+parse_compression(const std::string & name)
+{
+    if (name == "none")
+        return hdf5::Compression::NONE;
+    else if (name == "deflate")
+        return hdf5::Compression::DEFLATE;
+    else if (name == "szip")
+        return hdf5::Compression::SZIP;
+    else
+        throw Exception(fmt::format("Unknown compression '{}'", name));
+}
+
+int
+main(int argc, char * argv[])
+{
+    Init init(argc, argv);
+    mpi::Communicator world(MPI_COMM_WORLD);
+    try {
+        cxxopts::Options opts("hdf5-write-benchmark");
+        opts.add_option("", "h", "help", "Show this help page", cxxopts::value<bool>(), "");
+        opts.add_option("",
+                        "n",
+                        "size",
+                        "Number of values in the written vector",
+                        cxxopts::value<Int>()->default_value("16777216"),
+                        "");
+        opts.add_option("",
+                        "r",
+                        "reps",
+                        "Number of writes per rank count",
+                        cxxopts::value<int>()->default_value("5"),
+                        "");
+        opts.add_option("",
+                        "",
+                        "chunk-size",
+                        "Number of values per chunk, 0 for contiguous storage",
+                        cxxopts::value<Int>()->default_value("0"),
+                        "");
+        opts.add_option("",
+                        "",
+                        "compression",
+                        "Compression: none, deflate or szip",
+                        cxxopts::value<std::string>()->default_value("none"),
+                        "");
+        opts.add_option("",
+                        "",
+                        "cb-nodes",
+                        "Number of MPI-IO aggregators, 0 for the MPI-IO default",
+                        cxxopts::value<int>()->default_value("0"),
+                        "");
+        auto result = opts.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}", opts.help());
+            return 0;
+        }
+
+        auto n_global = result["size"].as<Int>();
+        auto n_reps = result["reps"].as<int>();
+        hdf5::FileOptions file_opts;
+        file_opts.datasets.chunk_size = result["chunk-size"].as<Int>();
+        file_opts.datasets.compression = parse_compression(result["compression"].as<std::string>());
+        auto cb_nodes = result["cb-nodes"].as<int>();
+        if (cb_nodes > 0)
+            file_opts.mpi_hints.emplace_back("cb_nodes", std::to_string(cb_nodes));
+
+        std::vector<int> rank_counts;
+        for (int n = 1; n < world.size(); n *= 2)
+            rank_counts.push_back(n);
+        rank_counts.push_back(world.size());
+
+        auto mbytes = n_global * sizeof(Real) / (1024. * 1024.);
+        if (world.rank() == 0)
+            fmt::print("{:>8} {:>16} {:>20}\n", "ranks", "time/write [ms]", "bandwidth [MiB/s]");
+        for (auto n_ranks : rank_counts) {
+            MPI_Comm sub;
+            MPI_Comm_split(world, world.rank() < n_ranks ? 0 : MPI_UNDEFINED, 0, &sub);
+            if (sub != MPI_COMM_NULL) {
+                auto time = benchmark_write(mpi::Communicator(sub), n_global, n_reps, file_opts);
+                if (world.rank() == 0)
+                    fmt::print("{:>8} {:>16.3f} {:>20.1f}\n", n_ranks, time * 1000., mbytes / time);
+                MPI_Comm_free(&sub);
+            }
+            world.barrier();
+        }
+        return 0;
+    }
+    catch (Exception & e) {
+        fmt::println("{}", e.what());
+        return -1;
+    }
+}
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Measures time per ExodusII output step as a function of mesh size
+
+#include "cxxopts/cxxopts.hpp"
+#include "fmt/printf.h"
+#include "godzilla/Init.h"
+#include "godzilla/App.h"
+#include "godzilla/Exception.h"
+#include "godzilla/MeshFactory.h"
+#include "godzilla/RectangleMesh.h"
+#include "godzilla/FENonlinearProblem.h"
+#include "godzilla/ExodusIIOutput.h"
+#include "mpicpp-lite/mpicpp-lite.h"
+#include <chrono>
+
+using namespace godzilla;
+
+/// Problem with a scalar and a vector field and no weak form, used only for output
+class OutputProblem : public FENonlinearProblem {
+public:
+    explicit OutputProblem(const Parameters & pars) : FENonlinearProblem(pars) {}
+
+protected:
+    void
+    set_up_fields() override
+    {
+        add_field("u", 1, Order(1));
+        add_field("vel", 3, Order(1));
+        add_field("p", 1, Order(0));
+    }
+
+    void
+    set_up_weak_form() override
+    {
+    }
+};
+
+/// Run `n_steps` output steps on an `n x n` mesh
+///
+/// @return Number of nodes and average time per output step in seconds
+std::pair<Int, double>
+benchmark_output(mpi::Communicator comm, Int n, int n_steps)
+{
+    App app(comm, "io-output");
+
+    auto mesh_pars = app.make_parameters<RectangleMesh>();
+    mesh_pars.set<Int>("nx", n);
+    mesh_pars.set<Int>("ny", n);
+    auto mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+
+    auto prob_pars = app.make_parameters<OutputProblem>();
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+    auto prob = app.make_problem<OutputProblem>(prob_pars);
+
+    auto file_name = fmt::format("io-output-{}", n);
+    auto out_pars = app.make_parameters<ExodusIIOutput>();
+    out_pars.set<fs::path>("file", file_name);
+    out_pars.set<ExecuteOnFlags>("on", ExecuteOn::NONE);
+    auto out = prob->add_output<ExodusIIOutput>(out_pars);
+
+    prob->create();
+    prob->get_solution_vector().set(1.);
+    prob->compute_solution_vector_local();
+
+    // first step stores the mesh, keep it out of the measurement
+    out->output_step();
+
+    comm.barrier();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_steps; ++i)
+        out->output_step();
+    comm.barrier();
+    auto end = std::chrono::steady_clock::now();
+
+    auto n_nodes = prob->get_mesh()->get_num_vertices();
+    fs::remove(out->get_file_name());
+    return { n_nodes, std::chrono::duration<double>(end - start).count() / n_steps };
+}
+
+int
+main(int argc, char * argv[])
+{
+    Init init(argc, argv);
+    mpi::Communicator comm(MPI_COMM_WORLD);
+    try {
+        cxxopts::Options opts("io-output-benchmark");
+        opts.add_option("", "h", "help", "Show this help page", cxxopts::value<bool>(), "");
+        opts.add_option("",
+                        "s",
+                        "steps",
+                        "Number of output steps per mesh size",
+                        cxxopts::value<int>()->default_value("10"),
+                        "");
+        opts.add_option("",
+                        "n",
+                        "max-size",
+                        "Largest number of cells in each direction",
+                        cxxopts::value<Int>()->default_value("1024"),
+                        "");
+        auto result = opts.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}", opts.help());
+            return 0;
+        }
+
+        auto n_steps = result["steps"].as<int>();
+        auto max_size = result["max-size"].as<Int>();
+        if (comm.rank() == 0)
+            fmt::print("{:>12} {:>16}\n", "nodes", "time/step [ms]");
+        for (Int n = 32; n <= max_size; n *= 2) {
+            auto [n_nodes, time] = benchmark_output(comm, n, n_steps);
+            if (comm.rank() == 0)
+                fmt::print("{:>12} {:>16.3f}\n", n_nodes, time * 1000.);
+        }
+        return 0;
+    }
+    catch (Exception & e) {
+        fmt::println("{}", e.what());
+        return -1;
+    }
+}
@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Measures time of a residual evaluation with the original, RCM and Hilbert ordering of the mesh
+
+#include "cxxopts/cxxopts.hpp"
+#include "fmt/printf.h"
+#include "godzilla/Init.h"
+#include "godzilla/App.h"
+#include "godzilla/Exception.h"
+#include "godzilla/MeshFactory.h"
+#include "godzilla/RectangleMesh.h"
+#include "godzilla/FileMesh.h"
+#include "godzilla/FENonlinearProblem.h"
+#include "godzilla/ResidualFunc.h"
+#include "mpicpp-lite/mpicpp-lite.h"
+#include <chrono>
+#include <optional>
+
+using namespace godzilla;
+
+/// Poisson problem `-Δu = 2`
+class PoissonProblem : public FENonlinearProblem {
+public:
+    explicit PoissonProblem(const Parameters & pars) : FENonlinearProblem(pars) {}
+
+protected:
+    void set_up_fields() override;
+    void set_up_weak_form() override;
+};
+
+class F0 : public ResidualFunc {
+public:
+    explicit F0(Ref<PoissonProblem> prob) : ResidualFunc(prob) {}
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        f[0] = -2.0;
+    }
+};
+
+class F1 : public ResidualFunc {
+public:
+    explicit F1(Ref<PoissonProblem> prob) :
+        ResidualFunc(prob),
+        dim(get_spatial_dimension()),
+        u_x(get_field_gradient("u"))
+    {
+    }
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            f[d] = this->u_x(d);
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldGradient & u_x;
+};
+
+void
+PoissonProblem::set_up_fields()
+{
+    add_field("u", 1, Order(1));
+}
+
+void
+PoissonProblem::set_up_weak_form()
+{
+    add_residual_block(0, new F0(ref(*this)), new F1(ref(*this)));
+}
+
+/// Evaluate the residual `n_reps` times
+///
+/// @param ordering Mesh ordering, no reordering if not set
+/// @return Number of cells and average time per residual evaluation in seconds
+std::pair<Int, double>
+benchmark_residual(mpi::Communicator comm,
+                   const std::string & file_name,
+                   Int n,
+                   std::optional<UnstructuredMesh::Ordering> ordering,
+                   int n_reps)
+{
+    App app(comm, "mesh-reorder");
+
+    Qtr<UnstructuredMesh> mesh;
+    if (file_name.empty()) {
+        auto mesh_pars = app.make_parameters<RectangleMesh>();
+        mesh_pars.set<Int>("nx", n);
+        mesh_pars.set<Int>("ny", n);
+        mesh_pars.set<bool>("simplex", true);
+        mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+    }
+    else {
+        auto mesh_pars = app.make_parameters<FileMesh>();
+        mesh_pars.set<fs::path>("file", file_name);
+        mesh = MeshFactory::create<FileMesh>(mesh_pars);
+    }
+    if (ordering)
+        mesh->reorder(*ordering);
+
+    auto prob_pars = app.make_parameters<PoissonProblem>();
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+    auto prob = app.make_problem<PoissonProblem>(prob_pars);
+    prob->create();
+
+    auto & x = prob->get_solution_vector();
+    x.set(1.);
+    auto r = x.duplicate();
+
+    // first evaluation allocates the assembly data, keep it out of the measurement
+    PETSC_CHECK(SNESComputeFunction(prob->get_snes(), x, r));
+
+    comm.barrier();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n_reps; ++i)
+        PETSC_CHECK(SNESComputeFunction(prob->get_snes(), x, r));
+    comm.barrier();
+    auto end = std::chrono::steady_clock::now();
+
+    auto n_cells = prob->get_mesh()->get_num_cells();
+    return { n_cells, std::chrono::duration<double>(end - start).count() / n_reps };
+}
+
+int
+main(int argc, char * argv[])
+{
+    Init init(argc, argv);
+    mpi::Communicator comm(MPI_COMM_WORLD);
+    try {
+        cxxopts::Options opts("mesh-reorder-benchmark");
+        opts.add_option("", "h", "help", "Show this help page", cxxopts::value<bool>(), "");
+        opts.add_option("",
+                        "f",
+                        "file",
+                        "Mesh file (a generated square mesh is used if not given)",
+                        cxxopts::value<std::string>()->default_value(""),
+                        "");
+        opts.add_option("",
+                        "n",
+                        "size",
+                        "Number of cells in each direction of the generated mesh",
+                        cxxopts::value<Int>()->default_value("512"),
+                        "");
+        opts.add_option("",
+                        "r",
+                        "reps",
+                        "Number of residual evaluations",
+                        cxxopts::value<int>()->default_value("20"),
+                        "");
+        auto result = opts.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}", opts.help());
+            return 0;
+        }
+
+        auto file_name = result["file"].as<std::string>();
+        auto n = result["size"].as<Int>();
+        auto n_reps = result["reps"].as<int>();
+
+        std::vector<std::pair<const char *, std::optional<UnstructuredMesh::Ordering>>> orderings =
+            { { "original", std::nullopt },
+              { "rcm", UnstructuredMesh::Ordering::RCM },
+              { "hilbert", UnstructuredMesh::Ordering::HILBERT } };
+        if (comm.rank() == 0)
+            fmt::print("{:>10} {:>12} {:>20}\n", "ordering", "cells", "time/residual [ms]");
+        for (auto & [name, ordering] : orderings) {
+            auto [n_cells, time] = benchmark_residual(comm, file_name, n, ordering, n_reps);
+            if (comm.rank() == 0)
+                fmt::print("{:>10} {:>12} {:>20.3f}\n", name, n_cells, time * 1000.);
+        }
+        return 0;
+    }
+    catch (Exception & e) {
+        fmt::println("{}", e.what());
+        return -1;
+    }
+}
@@ -8,7 +8,10 @@ using namespace godzilla;
 
 class Residual0 : public ResidualFunc {
 public:
-    Residual0(Ref<FEProblemInterface> fepi) : ResidualFunc(fepi), ffn(get_field_value("forcing_fn"))
+    Residual0(Ref<FEProblemInterface> fepi) :
+        ResidualFunc(fepi),
+        ffn(get_field_value("forcing_fn")),
+        ffn_b(get_batch_field("forcing_fn"))
     {
     }
 
@@ -19,8 +22,24 @@ public:
         f[0] = -this->ffn(0);
     }
 
+    bool
+    is_batched() const override
+    {
+        return true;
+    }
+
+    void
+    evaluate_batch(const QuadratureBatch & batch, Scalar f[]) const override
+    {
+        CALL_STACK_MSG();
+        const Scalar * ffn = batch.value(this->ffn_b);
+        for (Int p = 0; p < batch.n; ++p)
+            f[p] = -ffn[p];
+    }
+
 protected:
     const FieldValue & ffn;
+    const BatchField & ffn_b;
 };
 
 class Residual1 : public ResidualFunc {
@@ -28,7 +47,8 @@ public:
     Residual1(Ref<FEProblemInterface> fepi) :
         ResidualFunc(fepi),
         dim(get_spatial_dimension()),
-        u_x(get_field_gradient("u"))
+        u_x(get_field_gradient("u")),
+        u_b(get_batch_field("u"))
     {
     }
 
@@ -40,9 +60,28 @@ public:
             f[d] = this->u_x(d);
     }
 
+    bool
+    is_batched() const override
+    {
+        return true;
+    }
+
+    void
+    evaluate_batch(const QuadratureBatch & batch, Scalar f[]) const override
+    {
+        CALL_STACK_MSG();
+        for (Int d = 0; d < batch.dim; ++d) {
+            const Scalar * u_x = batch.gradient(this->u_b, 0, d);
+            Scalar * f1 = &f[d * batch.n];
+            for (Int p = 0; p < batch.n; ++p)
+                f1[p] = u_x[p];
+        }
+    }
+
 protected:
     const Dimension & dim;
     const FieldGradient & u_x;
+    const BatchField & u_b;
 };
 
 class Jacobian3 : public JacobianFunc {
@@ -57,6 +96,23 @@ public:
             g[d * this->dim + d] = 1.0;
     }
 
+    bool
+    is_batched() const override
+    {
+        return true;
+    }
+
+    void
+    evaluate_batch(const QuadratureBatch & batch, Scalar g[]) const override
+    {
+        CALL_STACK_MSG();
+        for (Int d = 0; d < batch.dim; ++d) {
+            Scalar * g3 = &g[(d * batch.dim + d) * batch.n];
+            for (Int p = 0; p < batch.n; ++p)
+                g3[p] = 1.0;
+        }
+    }
+
 protected:
     const Dimension & dim;
 };
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace godzilla {
+
+/// Bounded queue of output tasks executed in order by a background I/O thread
+///
+/// Tasks must not call into PETSc or touch the problem - they only write data that was
+/// snapshotted on the calling thread.
+class AsyncOutputQueue {
+public:
+    /// Create a queue
+    ///
+    /// @param max_depth Maximum number of tasks that are queued or being executed. `push` blocks
+    ///        when the queue is full.
+    explicit AsyncOutputQueue(Int max_depth = 2);
+    ~AsyncOutputQueue();
+
+    AsyncOutputQueue(const AsyncOutputQueue &) = delete;
+    AsyncOutputQueue & operator=(const AsyncOutputQueue &) = delete;
+
+    /// Get the maximum queue depth
+    ///
+    /// @return Maximum number of tasks queued or being executed
+    Int get_max_depth() const;
+
+    /// Add a task to the queue
+    ///
+    /// If a previously queued task threw, the exception is re-thrown here.
+    ///
+    /// @param task Task to execute on the I/O thread
+    void push(std::function<void()> task);
+
+    /// Wait until all queued tasks are finished
+    ///
+    /// If a queued task threw, the exception is re-thrown here.
+    void flush();
+
+private:
+    void worker();
+    void rethrow_error();
+
+    /// Maximum number of tasks queued or being executed
+    Int max_depth;
+    /// I/O thread
+    std::thread thread;
+    /// Guards all the members below
+    std::mutex mutex;
+    /// Signals the I/O thread that a task is available (or that it should exit)
+    std::condition_variable work_cv;
+    /// Signals the calling thread that a task finished
+    std::condition_variable done_cv;
+    /// Queued tasks, the front one is being executed
+    std::deque<std::function<void()>> tasks;
+    /// Tells the I/O thread to exit
+    bool quit;
+    /// First exception thrown by a task
+    std::exception_ptr error;
+};
+
+} // namespace godzilla
@@ -4,12 +4,18 @@
 #pragma once
 
 #include "godzilla/FileOutput.h"
+#include "fmt/format.h"
 #include <fstream>
 
 namespace godzilla {
 
+class Postprocessor;
+
 /// Output to a CSV file
 ///
+/// Every step is one row with time and values of all postprocessors (one column per component).
+/// Rows are formatted into a memory buffer and written to the file in blocks of `flush_interval`
+/// rows and when the file is closed.
 class CSVOutput : public FileOutput {
 public:
     explicit CSVOutput(const Parameters & pars);
@@ -31,6 +37,8 @@ protected:
     void open_file();
     void write_header();
     void write_values(Real time);
+    /// Write buffered rows into the file
+    void flush_rows();
     void close_file();
 
 private:
@@ -45,6 +53,21 @@ private:
     /// Names of postprocessors to store
     std::vector<String> pps_names;
 
+    /// Postprocessors to store, resolved in `create`
+    std::vector<Postprocessor *> pps;
+
+    /// Number of columns of each postprocessor
+    std::vector<std::size_t> pps_n_cols;
+
+    /// Number of rows to buffer before writing them into the file
+    Int flush_interval;
+
+    /// Formatted rows not yet written into the file
+    fmt::memory_buffer buffer;
+
+    /// Number of rows in `buffer`
+    Int n_buffered_rows;
+
 public:
     static Parameters parameters();
 };
@@ -27,7 +27,9 @@ enum class FileAccess {
     /// Open the file for writing
     WRITE,
     /// Create a new file
-    CREATE
+    CREATE,
+    /// Create a new file held only in memory
+    CREATE_IN_MEMORY
 };
 
 /// Coordinate system type
@@ -7,7 +7,11 @@
 #include "godzilla/DiscreteProblemInterface.h"
 #include "godzilla/Types.h"
 #include "godzilla/Qtr.h"
+#include "godzilla/ParallelExodusIIFile.h"
+#include "godzilla/IO.h"
 #include "exodusIIcpp/exodusIIcpp.h"
+#include <memory>
+#include <mutex>
 
 namespace godzilla {
 
@@ -26,6 +30,13 @@ class DGProblemInterface;
 ///     file: 'out'
 /// ```
 ///
+/// By default, each rank writes its own file (`out.<rank>.exo`). With `single_file: true`, all
+/// ranks write collectively into one file (`out.exo`).
+///
+/// With asynchronous output enabled on the problem, every step after the first one is
+/// snapshotted and written by the background I/O thread. The first step (which stores the mesh),
+/// single-file output and DG problems are always written synchronously.
+///
 /// This output works only with finite element problems
 class ExodusIIOutput : public FileOutput {
 public:
@@ -35,6 +46,7 @@ public:
     void create() override;
     void output_mesh();
     void output_step() override;
+    std::function<void()> create_output_task() override;
 
 protected:
     void open_file();
@@ -45,18 +57,29 @@ protected:
 
 private:
     String get_file_ext() const override;
+    fs::path create_file_name() const override;
     void output_step(const DiscreteProblemInterface & dpi);
     void output_step(const DGProblemInterface & dpi);
+    void output_step_single_file();
+    void get_all_variable_names(std::vector<std::string> & nodal_var_names,
+                                std::vector<std::string> & elem_var_names) const;
+    std::vector<double> get_global_values() const;
+    std::string get_created_by() const;
+    std::shared_ptr<io::StepData> get_free_step_data();
 
     Ref<DiscreteProblemInterface> dpi;
     /// Unstructured mesh
     Ref<UnstructuredMesh> mesh;
     /// `true` is appending into the ExodusII file
     bool append;
+    /// `true` if all ranks write into a single file
+    bool single_file;
     /// Variable names to be stored
     std::vector<String> variable_names;
     /// ExodusII file
     Qtr<exodusIIcpp::File> exo;
+    /// ExodusII file shared by all ranks (used when `single_file` is `true`)
+    Qtr<ParallelExodusIIFile> pexo;
     /// Step number
     int step_num;
     /// Flag indicating if we need to store mesh during `output_step`
@@ -75,6 +98,17 @@ private:
     std::vector<std::pair<FieldID, int>> elem_var_fids;
     /// List of elemental auxiliary variable field IDs
     std::vector<std::pair<FieldID, int>> elem_aux_var_fids;
+    /// Buffer for gathering variable values, reused between output steps
+    std::vector<double> values;
+    /// Snapshots for asynchronous output that are not being written
+    struct StepDataPool {
+        /// Guards `free`, tasks return their snapshot here once it is written
+        std::mutex mutex;
+        /// Snapshots that can be reused
+        std::vector<std::shared_ptr<io::StepData>> free;
+    };
+    /// Shared with the output tasks, so a snapshot can be returned after this object is gone
+    std::shared_ptr<StepDataPool> step_data_pool;
 
 public:
     static Parameters parameters();
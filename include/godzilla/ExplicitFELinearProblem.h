@@ -48,6 +48,12 @@ protected:
 private:
     SNESolver create_sne_solver() override;
     void compute_rhs_local(Real time, const Vector & x, Vector & F) override;
+    bool can_split_rhs_local() const override;
+    void compute_rhs_local_cells(Real time,
+                                 const Vector & x,
+                                 const IndexSet & cells,
+                                 Vector & F) override;
+    void compute_rhs_local_bnd(Real time, const Vector & x, Vector & F) override;
     void compute_rhs_function_fem(Real time, const Vector & loc_x, Vector & loc_g);
 
 public:
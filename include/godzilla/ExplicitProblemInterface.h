@@ -5,10 +5,13 @@
 
 #include "godzilla/Matrix.h"
 #include "godzilla/Vector.h"
+#include "godzilla/IndexSet.h"
 #include "godzilla/Parameters.h"
 #include "godzilla/NonlinearProblem.h"
 #include "godzilla/TransientProblemInterface.h"
 #include "godzilla/String.h"
+#include <array>
+#include <vector>
 
 namespace godzilla {
 
@@ -39,6 +42,32 @@ protected:
     /// @param F Local output vector
     virtual void compute_rhs_local(Real time, const Vector & x, Vector & F);
 
+    /// Check if the local residual can be formed cell set by cell set via
+    /// `compute_rhs_local_cells` and `compute_rhs_local_bnd`
+    ///
+    /// This is required for overlapping the residual evaluation with communication (see
+    /// `overlap_communication` parameter).
+    ///
+    /// @return `true` if supported, `false` otherwise
+    virtual bool can_split_rhs_local() const;
+
+    /// Add contributions of `cells` into the local residual 'F'
+    ///
+    /// @param time The time
+    /// @param x Local solution
+    /// @param cells Cells to integrate over
+    /// @param F Local output vector
+    virtual void
+    compute_rhs_local_cells(Real time, const Vector & x, const IndexSet & cells, Vector & F);
+
+    /// Add contributions not tied to cells (like natural boundary conditions) into the local
+    /// residual 'F'
+    ///
+    /// @param time The time
+    /// @param x Local solution
+    /// @param F Local output vector
+    virtual void compute_rhs_local_bnd(Real time, const Vector & x, Vector & F);
+
     /// Insert the essential boundary values into the local vector
     ///
     /// @param time The time
@@ -54,6 +83,35 @@ private:
     /// @param F Global output vector
     void compute_rhs_function(Real time, const Vector & x, Vector & F);
 
+    /// Form the global residual 'F' while the ghost exchange is in flight
+    ///
+    /// Cells that do not touch ghost points are integrated during the global-to-local and
+    /// local-to-global exchanges, the remaining cells in between.
+    ///
+    /// @param time The time
+    /// @param x Global solution
+    /// @param loc_x Local solution with essential boundary values inserted
+    /// @param F Global output vector
+    void compute_rhs_function_overlapped(Real time, const Vector & x, Vector & loc_x, Vector & F);
+
+    /// Split local cells into the ones that touch ghost points and the ones that do not
+    ///
+    /// The sets are rebuilt only when the DM or its local section changed since the last call.
+    void build_overlap_sets(const Vector & F);
+
+    /// Overlap residual evaluation with communication
+    bool overlap_comm;
+    /// Cells not touching ghost points. First set is integrated during the global-to-local
+    /// exchange, the second one during the local-to-global exchange.
+    std::array<IndexSet, 2> interior_cells;
+    /// Cells touching ghost points
+    IndexSet boundary_cells;
+    /// Local vector indices of owned unconstrained dofs
+    std::vector<Int> owned_local_idx;
+    /// Positions of `owned_local_idx` in the local part of a global vector
+    std::vector<Int> owned_global_idx;
+    /// IDs of the DM and its local section the overlap sets were built for
+    PetscObjectId overlap_dm_id, overlap_section_id;
     /// Nonlinear problem
     Ref<NonlinearProblem> nl_problem;
     /// Mass matrix
@@ -51,8 +51,9 @@ connectivity(const UnstructuredMesh & mesh)
     CALL_STACK_MSG();
     auto n_cells = mesh.get_num_cells();
     Array1D<DenseVector<Int, N_ELEM_NODES>> connect(mesh.get_comm(), n_cells);
+    const auto & mesh_conn = mesh.get_cell_connectivity();
     for (auto elem_id : mesh.get_cell_range()) {
-        auto cell_conn = mesh.get_connectivity(elem_id);
+        auto cell_conn = mesh_conn[elem_id];
         for (Int i = 0; i < N_ELEM_NODES; ++i)
             connect[elem_id](i) = cell_conn[i];
     }
@@ -73,8 +74,9 @@ common_elements_by_node(const UnstructuredMesh & mesh)
     auto n_all_cells = mesh.get_num_all_cells();
     auto n_nodes = mesh.get_num_vertices();
     Array1D<std::vector<Int>> nelcom(mesh.get_comm(), n_nodes);
+    const auto & mesh_conn = mesh.get_cell_connectivity();
     for (auto & cell : mesh.get_cell_range()) {
-        const auto & node_ids = mesh.get_connectivity(cell);
+        auto node_ids = mesh_conn[cell];
         for (Int j = 0; j < N_ELEM_NODES; ++j)
             nelcom[node_ids[j] - n_all_cells].push_back(cell);
     }
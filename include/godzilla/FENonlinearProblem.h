@@ -7,12 +7,16 @@
 #include "godzilla/Delegate.h"
 #include "godzilla/NonlinearProblem.h"
 #include "godzilla/FEProblemInterface.h"
+#include "godzilla/IndexSet.h"
+#include "godzilla/ShellMatrix.h"
+#include "godzilla/PerfLog.h"
+#include <map>
+#include <memory>
 
 namespace godzilla {
 
 class ResidualFunc;
 class JacobianFunc;
-class IndexSet;
 
 /// Non-linear problem that arises from a finite element discretization using the PetscFE system
 class FENonlinearProblem : public NonlinearProblem, public FEProblemInterface {
@@ -23,6 +27,28 @@ public:
     Real get_time() const override;
     void compute_solution_vector_local() override;
 
+    /// Get cells of a weak form region
+    ///
+    /// Cells are computed on the first request and cached, so that the assembly does not query
+    /// labels or intersect index sets on every evaluation. They are recomputed when the mesh DM or
+    /// the region label changes.
+    ///
+    /// @param region Weak form region (`part` is ignored)
+    /// @return Sorted cells of the region, null index set if there are none on this process
+    const IndexSet & get_region_cells(const WeakForm::Region & region);
+
+    /// Get facets of a boundary
+    ///
+    /// @param label Label marking the boundary
+    /// @param value Label value
+    /// @return Sorted facets with `value` in `label`, null index set if there are none on this
+    ///         process
+    const IndexSet & get_boundary_facets(const Label & label, Int value);
+
+    /// Drop cached region cells and boundary facets. Changes of the mesh DM and of labels are
+    /// detected automatically, this is needed only when the mesh is modified in place.
+    void invalidate_region_cache();
+
 protected:
     void init() override;
     void set_up_callbacks() override;
@@ -74,6 +100,15 @@ protected:
                                    const Vector & loc_x_t,
                                    Real t,
                                    Vector & loc_f);
+    /// Same as `compute_residual_internal` but without the boundary (natural BC) contributions
+    void compute_cell_residual_internal(DM dm,
+                                        const WeakForm::Region & region,
+                                        const IndexSet & cells,
+                                        Real time,
+                                        const Vector & loc_x,
+                                        const Vector & loc_x_t,
+                                        Real t,
+                                        Vector & loc_f);
     void compute_bnd_residual_internal(DM dm, Vec loc_x, Vec loc_x_t, Real t, Vec loc_f);
     void compute_bnd_residual_single_internal(DM dm,
                                               Real t,
@@ -81,8 +116,7 @@ protected:
                                               Vec loc_x,
                                               Vec loc_x_t,
                                               Vec loc_f,
-                                              DMField coord_field,
-                                              const IndexSet & facets);
+                                              DMField coord_field);
 
     void compute_jacobian_internal(DM dm,
                                    const WeakForm::Region & region,
@@ -111,10 +145,182 @@ protected:
                                               Real x_t_shift,
                                               Mat J,
                                               Mat Jp,
-                                              DMField coord_field,
-                                              const IndexSet & facets);
+                                              DMField coord_field);
+
+    /// Is the Jacobian assembled with `MatSetValuesCOO`?
+    bool uses_coo_assembly() const;
+
+    /// Check if COO assembly writes every value of the Jacobian, so the matrix does not have to be
+    /// zeroed before assembly
+    ///
+    /// @param J Jacobian matrix
+    /// @param Jp Preconditioner matrix
+    /// @return `true` if the values of `Jp` are overwritten by COO assembly
+    bool coo_overwrites(const Matrix & J, const Matrix & Jp) const;
+
+    /// Insert the COO values of all Jacobian regions with a single `MatSetValuesCOO`, add the
+    /// boundary terms and assemble `Jp`
+    void assemble_coo_jacobian(DM dm,
+                               const Vector & X,
+                               const Vector & X_t,
+                               Real t,
+                               Real x_t_shift,
+                               Matrix & J,
+                               Matrix & Jp);
+
+    /// Is the Jacobian applied matrix-free from coefficients stored at quadrature points?
+    bool uses_matrix_free() const;
+
+    /// Get the matrix-free Jacobian operator
+    ShellMatrix & get_matrix_free_jacobian();
+
+    /// Evaluate and store Jacobian coefficients g0-g3 at quadrature points of a region. The
+    /// matrix-free Jacobian then applies them until the next evaluation.
+    void compute_matrix_free_jacobian(DM dm,
+                                      const WeakForm::Region & region,
+                                      const IndexSet & cell_is,
+                                      Real t,
+                                      Real x_t_shift,
+                                      const Vector & X,
+                                      const Vector & X_t);
 
 private:
+    /// Positions of element matrix entries in the value array of a sequential AIJ matrix
+    struct InsertionMap {
+        /// Matrix the positions were computed for
+        Mat mat;
+        /// Nonzero state of `mat` when the positions were computed
+        PetscObjectState nnz_state;
+        /// Position of each element matrix entry, -1 for entries that are not inserted
+        std::vector<Int> pos;
+
+        InsertionMap() : mat(nullptr), nnz_state(-1) {}
+    };
+
+    /// Points cached for a region, with the DM and label they were computed from
+    struct CachedPoints {
+        /// Cached points
+        IndexSet points;
+        /// ID of the mesh DM
+        PetscObjectId dm_id;
+        /// ID and state of the label, zero for regions without a label
+        PetscObjectId label_id;
+        PetscObjectState label_state;
+
+        CachedPoints() : dm_id(0), label_id(0), label_state(0) {}
+    };
+
+    /// Cells of a region grouped by color, so that no two cells of the same color share a DoF
+    struct JacobianColoring {
+        /// Number of cells in the region the coloring was built for
+        Int n_cells;
+        /// IDs of the cell index set, the DM and its local section the coloring was built for. A
+        /// change in any of them (new mesh, partition or DoF layout) invalidates the coloring.
+        PetscObjectId cells_id, dm_id, section_id;
+        /// Cells sorted by color
+        IndexSet cells;
+        /// Offsets into `cells` where each color starts (size = number of colors + 1)
+        std::vector<Int> color_offsets;
+        /// Insertion positions for the Jacobian and the preconditioner matrix
+        InsertionMap jac, prec;
+        /// Perf log events `FENonlinearProblem::JacobianColor<i>` timing the assembly of each color
+        std::vector<perf_log::EventID> color_events;
+
+        JacobianColoring() : n_cells(-1), cells_id(0), dm_id(0), section_id(0) {}
+    };
+
+    /// Jacobian assembly through (row, col) pairs computed once for all cells
+    struct COOAssembly {
+        /// Element matrices of a region in the COO value array
+        struct Block {
+            /// Offset of the first entry
+            Int offset;
+            /// Number of cells
+            Int n_cells;
+        };
+
+        /// Matrix the COO pattern was set on
+        Mat mat;
+        /// Blocks of the Jacobian regions
+        std::map<WeakForm::Region, Block> regions;
+        /// Values of all COO entries
+        std::vector<Scalar> values;
+
+        COOAssembly() : mat(nullptr) {}
+    };
+
+    /// Jacobian applied element by element from coefficients stored at quadrature points
+    struct MatrixFreeJacobian {
+        /// Stored coefficients of a region
+        struct Block {
+            /// Cells of the region
+            IndexSet cells;
+            /// Number of cells
+            Int n_cells;
+            /// g0-g3 at quadrature points for each pair of fields (`field_i * n_fields +
+            /// field_j`), empty if the pair has no Jacobian terms
+            std::vector<std::vector<Scalar>> g;
+            /// Cell geometry of each field the coefficients were computed with. Ownership is
+            /// shared with the geometry cache, so the geometry outlives eviction of its entry.
+            std::vector<std::shared_ptr<PetscFEGeom>> geom;
+        };
+
+        /// Shell matrix with the action and the diagonal of the Jacobian
+        ShellMatrix mat;
+        /// Blocks of the Jacobian regions
+        std::map<WeakForm::Region, Block> regions;
+        /// Local work vectors
+        Vector loc_x, loc_y;
+        /// Element work arrays
+        std::vector<Scalar> x_elem, y_elem;
+    };
+
+    /// Get the state of the mesh DM and `label` that cached points are computed from
+    ///
+    /// @param label Label of the region, can be null
+    /// @return Cache entry with empty points and the current IDs and state
+    CachedPoints get_cache_state(const Label & label) const;
+
+    /// Compute COO entries of all element matrices and set them as the pattern of `mat`
+    void set_up_coo_assembly(Matrix & mat);
+
+    /// Create the shell matrix of the matrix-free Jacobian
+    void set_up_matrix_free_jacobian();
+
+    /// Compute `y = J x` with the matrix-free Jacobian
+    void mult_matrix_free_jacobian(Matrix & A, Vector & x, Vector & y);
+
+    /// Compute the diagonal of the matrix-free Jacobian (used by `PCJACOBI`)
+    void get_matrix_free_jacobian_diagonal(Matrix & A, Vector & diag);
+
+    /// Check if element matrices can be inserted without DoF permutations or constraints
+    bool has_plain_closures(DM dm, PetscDS ds) const;
+
+    /// Get coloring of the cells in `cell_is`
+    JacobianColoring &
+    get_jacobian_coloring(DM dm, const WeakForm::Region & region, const IndexSet & cell_is);
+
+    /// Can element matrices be written directly into the value array of `mat`?
+    bool can_insert_directly(DM dm, PetscDS ds, Mat mat) const;
+
+    /// Update insertion positions in `map` for matrix `mat`
+    ///
+    /// @return `true` if every element matrix entry was found in the nonzero pattern of `mat`
+    bool update_insertion_map(DM dm,
+                              const JacobianColoring & coloring,
+                              Int tot_dim,
+                              Mat mat,
+                              InsertionMap & map);
+
+    /// Add element matrices of cells `[cs, ce)` (positions in `coloring.cells`) into `mat`
+    /// concurrently
+    void insert_directly(const InsertionMap & map,
+                         Int tot_dim,
+                         Int cs,
+                         Int ce,
+                         const Scalar elem_mat[],
+                         Mat mat);
+
     void compute_residual_local(const Vector & x, Vector & f);
     void compute_jacobian_local(const Vector & x, Matrix & J, Matrix & Jp);
     void compute_boundary_local(Vector & x);
@@ -127,6 +333,20 @@ private:
     Delegate<void(const Vector &, Vector &)> compute_residual_delegate;
     /// Delegate for compute_jacobian
     Delegate<void(const Vector & x, Matrix & J, Matrix & Jp)> compute_jacobian_delegate;
+    /// Cell colorings used by the threaded Jacobian assembly
+    std::map<WeakForm::Region, JacobianColoring> jac_colorings;
+    /// Assemble the Jacobian with `MatSetValuesCOO`
+    bool coo_assembly;
+    /// COO entries of the Jacobian
+    COOAssembly coo;
+    /// Apply the Jacobian without assembling it
+    bool matrix_free;
+    /// Matrix-free Jacobian
+    MatrixFreeJacobian mf;
+    /// Cached cells of weak form regions
+    std::map<WeakForm::Region, CachedPoints> region_cells;
+    /// Cached boundary facets, keyed by (label, value)
+    std::map<WeakForm::Region, CachedPoints> bnd_facets;
 
 public:
     static Parameters parameters();
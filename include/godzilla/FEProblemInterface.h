@@ -9,10 +9,17 @@
 #include "godzilla/FieldValue.h"
 #include "godzilla/Types.h"
 #include "godzilla/WeakForm.h"
+#include "godzilla/IndexSet.h"
 #include "godzilla/Qtr.h"
+#include "godzilla/ThreadPool.h"
+#include "godzilla/QuadratureBatch.h"
+#include "godzilla/TensorProductBasis.h"
 #include "petscfe.h"
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <map>
+#include <memory>
 
 namespace godzilla {
 
@@ -100,6 +107,15 @@ public:
 
     const FieldValue & get_field_dot(String field_name) const;
 
+    /// Get location of field components in `QuadratureBatch` arrays
+    ///
+    /// The location is filled in when the problem is created, so the returned reference must be
+    /// stored, not copied, by functionals constructed before that.
+    ///
+    /// @param field_name The name of the field
+    /// @return Location of field components
+    const BatchField & get_batch_field(String field_name) const;
+
     const Real & get_time_shift() const;
 
     const Real & get_assembly_time() const;
@@ -108,6 +124,32 @@ public:
 
     const Point & get_xyz() const;
 
+    /// Set the number of threads used for integrating residuals and Jacobians
+    ///
+    /// Must be called before `create()`. With more than one thread, cells are split into chunks
+    /// that are integrated concurrently, each thread working in its own scratch space.
+    ///
+    /// @param n_threads Number of assembly threads
+    void set_num_assembly_threads(Int n_threads);
+
+    /// Get the number of threads used for integrating residuals and Jacobians
+    ///
+    /// @return Number of assembly threads
+    Int get_num_assembly_threads() const;
+
+    /// Enable or disable sum-factorized kernels on quadrilaterals and hexahedra
+    ///
+    /// Must be called before `create()`. When disabled, all cells are integrated with the dense
+    /// tabulation.
+    ///
+    /// @param use `true` to use sum factorization where the elements allow it
+    void set_sum_factorization(bool use);
+
+    /// Are sum-factorized kernels enabled?
+    ///
+    /// @return `true` if sum factorization is used where the elements allow it
+    bool uses_sum_factorization() const;
+
     /// Add residual statement for a field variable
     ///
     /// @param fid Field ID
@@ -230,6 +272,38 @@ public:
                             Real u_tshift,
                             Scalar elem_mat[]);
 
+    /// Integrate residual, splitting cells into chunks integrated by the assembly threads
+    ///
+    /// Each chunk writes into its own part of `elem_vec`, so the result does not depend on the
+    /// number of threads.
+    void integrate_residual_chunked(PetscDS ds,
+                                    const WeakForm::Key & key,
+                                    Int n_elems,
+                                    PetscFEGeom * cell_geom,
+                                    const Scalar coefficients[],
+                                    const Scalar coefficients_t[],
+                                    PetscDS ds_aux,
+                                    const Scalar coefficients_aux[],
+                                    Real t,
+                                    Scalar elem_vec[]);
+
+    /// Integrate Jacobian, splitting cells into chunks integrated by the assembly threads
+    ///
+    /// Each chunk writes into its own part of `elem_mat`, so the result does not depend on the
+    /// number of threads.
+    void integrate_jacobian_chunked(PetscDS ds,
+                                    PetscFEJacobianType jtype,
+                                    const WeakForm::Key & key,
+                                    Int n_elems,
+                                    PetscFEGeom * cell_geom,
+                                    const Scalar coefficients[],
+                                    const Scalar coefficients_t[],
+                                    PetscDS ds_aux,
+                                    const Scalar coefficients_aux[],
+                                    Real t,
+                                    Real u_tshift,
+                                    Scalar elem_mat[]);
+
     // Integrate Jacobian over a boundary
     void integrate_bnd_jacobian(PetscDS ds,
                                 const WeakForm::Key & key,
@@ -243,6 +317,50 @@ public:
                                 Real u_tshift,
                                 Scalar elem_mat[]);
 
+    /// Get number of values per element stored by `evaluate_jacobian_qp`
+    ///
+    /// @param ds Discrete system
+    /// @param key Weak form key (region and pair of fields)
+    /// @param dim_embed Embedding dimension of the cell geometry
+    Int get_jacobian_qp_size(PetscDS ds, const WeakForm::Key & key, Int dim_embed) const;
+
+    /// Evaluate Jacobian coefficients g0-g3 at quadrature points
+    ///
+    /// Values are multiplied by the quadrature weight. Each element gets `get_jacobian_qp_size`
+    /// entries, split evenly among its quadrature points, and each point stores g0, g1, g2 and g3
+    /// one after another.
+    void evaluate_jacobian_qp(PetscDS ds,
+                              PetscFEJacobianType jtype,
+                              const WeakForm::Key & key,
+                              Int n_elems,
+                              PetscFEGeom * cell_geom,
+                              const Scalar coefficients[],
+                              const Scalar coefficients_t[],
+                              PetscDS ds_aux,
+                              const Scalar coefficients_aux[],
+                              Real t,
+                              Real u_tshift,
+                              Scalar qp_data[]);
+
+    /// Add the action of a Jacobian block on element vectors `x` into `y`, using coefficients
+    /// stored by `evaluate_jacobian_qp`
+    void apply_jacobian_qp(PetscDS ds,
+                           const WeakForm::Key & key,
+                           Int n_elems,
+                           PetscFEGeom * cell_geom,
+                           const Scalar qp_data[],
+                           const Scalar x[],
+                           Scalar y[]);
+
+    /// Add the diagonal of element matrices of a Jacobian block into `diag`, using coefficients
+    /// stored by `evaluate_jacobian_qp`. Blocks coupling two different fields have no diagonal.
+    void add_jacobian_qp_diagonal(PetscDS ds,
+                                  const WeakForm::Key & key,
+                                  Int n_elems,
+                                  PetscFEGeom * cell_geom,
+                                  const Scalar qp_data[],
+                                  Scalar diag[]);
+
 protected:
     const std::map<FieldID, FieldInfo> & get_fields() const;
     Expected<PetscFE, ErrorCode> get_fe(FieldID fid) const;
@@ -261,6 +379,55 @@ protected:
     void set_up_assembly_data();
     void set_up_assembly_data_aux();
 
+    /// Allocate scratch space for assembly threads and bind field values to it
+    void set_up_assembly_threads();
+
+    /// Get the number of chunks to split `n_elems` cells into when integrating `key`
+    ///
+    /// @param fnls Value functionals evaluated together with the weak form functionals
+    /// @param n_elems Number of cells
+    /// @return Number of chunks (1 means serial integration on the calling thread)
+    Int get_num_assembly_chunks(const std::vector<const ValueFunctional *> & fnls,
+                                Int n_elems) const;
+
+    /// Get the pool of assembly threads
+    ///
+    /// @return Pool of assembly threads
+    ThreadPool & get_assembly_thread_pool();
+
+    /// Get geometry of `cells` evaluated at the quadrature points of `fe`
+    ///
+    /// Geometry is cached per region, quadrature and cell index set (by its ID and state) and
+    /// reused until the mesh or its coordinates change. Cells with affine geometry share one
+    /// geometry for all fields. The least recently used entry is dropped when the cache is full.
+    /// The returned geometry is owned by the cache and must not be restored or destroyed.
+    ///
+    /// @param dm DM the cells belong to
+    /// @param region Region the cells belong to
+    /// @param cells Cells
+    /// @param fe Finite element of the integrated field
+    /// @return Geometry of the cells
+    PetscFEGeom *
+    get_cell_geometry(DM dm, const WeakForm::Region & region, const IndexSet & cells, PetscFE fe);
+
+    /// Get geometry of `cells` like `get_cell_geometry`, sharing its ownership with the caller
+    ///
+    /// The geometry stays valid after its cache entry is evicted, so it can be kept between
+    /// evaluations.
+    ///
+    /// @param dm DM the cells belong to
+    /// @param region Region the cells belong to
+    /// @param cells Cells
+    /// @param fe Finite element of the integrated field
+    /// @return Geometry of the cells
+    std::shared_ptr<PetscFEGeom> get_shared_cell_geometry(DM dm,
+                                                          const WeakForm::Region & region,
+                                                          const IndexSet & cells,
+                                                          PetscFE fe);
+
+    /// Drop all cached cell geometry
+    void clear_geometry_cache();
+
     /// Set up field variables
     virtual void set_up_fields() = 0;
 
@@ -277,6 +444,36 @@ protected:
 
     void sort_jacobian_functionals(const std::map<String, const ValueFunctional *> & suppliers);
 
+    /// Residual functions and functionals of a (region, field) block
+    struct ResidualBlock {
+        /// f0 functions
+        std::vector<ResidualFunc *> f0;
+        /// f1 functions
+        std::vector<ResidualFunc *> f1;
+        /// Functionals that must be evaluated before `f0` and `f1` (in order of evaluation)
+        std::vector<const ValueFunctional *> fnls;
+    };
+
+    /// Jacobian functions and functionals of a (region, test field, base field) block
+    struct JacobianBlock {
+        /// g0-g3 functions indexed by `PetscFEJacobianType`
+        std::array<std::array<std::vector<JacobianFunc *>, 4>, 3> g;
+        /// Functionals that must be evaluated before `g` (in order of evaluation)
+        std::vector<const ValueFunctional *> fnls;
+    };
+
+    /// Get the residual block for a weak form key
+    ///
+    /// @param key Weak form key (region and field)
+    /// @return Residual block, empty if nothing is defined for `key`
+    const ResidualBlock & get_residual_block(const WeakForm::Key & key) const;
+
+    /// Get the Jacobian block for a weak form key
+    ///
+    /// @param key Weak form key (region and pair of fields)
+    /// @return Jacobian block, empty if nothing is defined for `key`
+    const JacobianBlock & get_jacobian_block(const WeakForm::Key & key) const;
+
     void update_element_vec(PetscFE fe,
                             PetscTabulation tab,
                             Int r,
@@ -309,6 +506,31 @@ protected:
                             Int offset_j,
                             Scalar elem_mat[]);
 
+    /// Integrate residual with batched functionals
+    void integrate_residual_batched(PetscDS ds,
+                                    const WeakForm::Key & key,
+                                    const std::vector<ResidualFunc *> & f0_fns,
+                                    const std::vector<ResidualFunc *> & f1_fns,
+                                    Int n_elems,
+                                    PetscFEGeom * cell_geom,
+                                    const Scalar coefficients[],
+                                    const Scalar coefficients_t[],
+                                    PetscDS ds_aux,
+                                    const Scalar coefficients_aux[],
+                                    Scalar elem_vec[]);
+
+    /// Integrate Jacobian with batched functionals
+    void integrate_jacobian_batched(PetscDS ds,
+                                    const WeakForm::Key & key,
+                                    const std::vector<JacobianFunc *> * g_fns[4],
+                                    Int n_elems,
+                                    PetscFEGeom * cell_geom,
+                                    const Scalar coefficients[],
+                                    const Scalar coefficients_t[],
+                                    PetscDS ds_aux,
+                                    const Scalar coefficients_aux[],
+                                    Scalar elem_mat[]);
+
     void evaluate_field_jets(PetscDS ds,
                              Int nf,
                              Int r,
@@ -347,6 +569,8 @@ private:
         FieldGradient derivs;
         /// Time derivative (used during assembling)
         FieldValue dots;
+        /// Location of field components in batched assembly arrays
+        BatchField batch;
 
         FieldInfo(String name, FieldID id, Int nc, Order k, Dimension dim, const Label & block) :
             name(name),
@@ -357,7 +581,8 @@ private:
             k(k),
             values(nc),
             derivs(dim, nc),
-            dots(nc)
+            dots(nc),
+            batch()
         {
         }
 
@@ -383,20 +608,10 @@ private:
     struct AssemblyData {
         /// Spatial dimension
         Dimension dim;
-        /// Values of primary variables
-        Scalar * u;
-        /// Time derivative of primary variable values
-        Scalar * u_t;
-        /// Gradient of primary values
-        Scalar * u_x;
         /// Spatial coordinates
         Point xyz;
         /// Outward normals when doing surface integration
         Normal normals;
-        /// Values of auxiliary fields
-        Scalar * a;
-        /// Gradients of auxiliary fields
-        Scalar * a_x;
         /// Time at which are our forms evaluated (NOTE: this is not the simulation time)
         Real time;
         /// the multiplier a for dF/dU_t
@@ -406,12 +621,268 @@ private:
     };
     Qtr<AssemblyData> asmbl;
 
-    /// Functionals that must be evaluated before the weak form residual functionals
-    /// associated with the WeakForm::Key are evaluated
-    std::map<WeakForm::Key, std::vector<const ValueFunctional *>> sorted_res_functionals;
-    /// Functionals that must be evaluated before the weak form Jacobian functionals
-    /// associated with the WeakForm::Key are evaluated
-    std::map<WeakForm::Key, std::vector<const ValueFunctional *>> sorted_jac_functionals;
+    /// Scratch arrays used by one assembly thread
+    struct AssemblyWorkspace {
+        /// Values of primary variables
+        Scalar * u;
+        /// Time derivative of primary variable values
+        Scalar * u_t;
+        /// Gradient of primary values
+        Scalar * u_x;
+        /// Values of auxiliary fields
+        Scalar * a;
+        /// Gradients of auxiliary fields
+        Scalar * a_x;
+        /// Residual integrands
+        Scalar * f0;
+        Scalar * f1;
+        /// Jacobian integrands
+        Scalar * g0;
+        Scalar * g1;
+        Scalar * g2;
+        Scalar * g3;
+        /// Basis and test functions (and their derivatives) in real space
+        Scalar * basis_real;
+        Scalar * basis_der_real;
+        Scalar * test_real;
+        Scalar * test_der_real;
+        /// Storage for the arrays above. The main thread works directly on the PetscDS arrays, so
+        /// this is used only by worker threads
+        std::vector<Scalar> storage;
+        /// Storage for spatial coordinates
+        std::vector<Real> coord;
+
+        /// Structure-of-arrays storage for batched evaluation
+        struct Batch {
+            /// Quadrature weights (including the Jacobian determinant)
+            std::vector<Real> w;
+            /// Physical coordinates
+            std::vector<Real> xyz;
+            /// Field values, time derivatives and gradients
+            std::vector<Scalar> u, u_t, u_x;
+            /// Auxiliary field values and gradients
+            std::vector<Scalar> a, a_x;
+            /// Integrand values (f0, f1 or g0 - g3)
+            std::vector<Scalar> v[4];
+        } batch;
+
+        /// Storage for sum-factorized evaluation
+        struct Tensor {
+            /// Field values, time derivatives and gradients at all quadrature points of a cell
+            std::vector<Scalar> u, u_t, u_x;
+            /// Auxiliary field values and gradients at all quadrature points of a cell
+            std::vector<Scalar> a, a_x;
+            /// Values and reference gradients of one field
+            std::vector<Scalar> val, grad;
+            /// Residual integrands mapped onto the reference cell
+            std::vector<Scalar> f1;
+            /// Scratch space of `TensorProductBasis`
+            std::vector<Scalar> work;
+            /// Jacobian integrands at all quadrature points of a cell (g0 - g3 of each point one
+            /// after another)
+            std::vector<Scalar> g;
+            /// Values and reference gradients of one trial function
+            std::vector<Real> phi, dphi;
+            /// Inverse Jacobians of the cell map at all quadrature points of a cell
+            std::vector<Real> inv_j;
+            /// Integrands of one trial function and the element matrix column they give
+            std::vector<Scalar> f0, col;
+        } tensor;
+
+        AssemblyWorkspace();
+    };
+
+    /// Split `n_elems` cells into `n_chunks` contiguous chunks and call `fn` on each of them from
+    /// the assembly threads
+    ///
+    /// @param n_chunks Number of chunks
+    /// @param n_elems Number of cells
+    /// @param cell_geom Geometry of the cells
+    /// @param fn Function called with the first cell of the chunk, number of cells in the chunk and
+    ///        the geometry of the chunk
+    void for_each_chunk(Int n_chunks,
+                        Int n_elems,
+                        PetscFEGeom * cell_geom,
+                        const std::function<void(Int, Int, PetscFEGeom *)> & fn);
+
+    /// Evaluate fields at the quadrature points of cells `[e_start, e_start + n_blk)` into
+    /// `ws.batch`
+    ///
+    /// @return Batch pointing into `ws.batch`
+    QuadratureBatch fill_batch(AssemblyWorkspace & ws,
+                               PetscDS ds,
+                               PetscDS ds_aux,
+                               PetscFEGeom * cell_geom,
+                               PetscQuadrature quad,
+                               Int e_start,
+                               Int n_blk,
+                               const Scalar coefficients[],
+                               const Scalar coefficients_t[],
+                               const Scalar coefficients_aux[]);
+
+    /// Evaluate fields straight from the tabulation into structure-of-arrays storage
+    ///
+    /// Values are added into `u[c * n + p]`, gradients into `u_x[(c * dim + d) * n + p]`, where
+    /// `p = (e - e_start) * n_q + q`. Fields must not use a Piola transform.
+    ///
+    /// @param nf Number of fields
+    /// @param tab Tabulations of the fields
+    /// @param cell_geom Geometry of the cells
+    /// @param e_start First cell
+    /// @param n_blk Number of cells
+    /// @param tot_dim Number of coefficients per cell
+    /// @param coefficients Field coefficients
+    /// @param coefficients_t Time derivatives of field coefficients (can be `nullptr`)
+    /// @param n Stride between components (number of points in the batch)
+    /// @param u Values
+    /// @param u_x Gradients
+    /// @param u_t Time derivatives (can be `nullptr`)
+    void evaluate_field_jets_batch(Int nf,
+                                   PetscTabulation tab[],
+                                   PetscFEGeom * cell_geom,
+                                   Int e_start,
+                                   Int n_blk,
+                                   Int tot_dim,
+                                   const Scalar coefficients[],
+                                   const Scalar coefficients_t[],
+                                   Int n,
+                                   Scalar u[],
+                                   Scalar u_x[],
+                                   Scalar u_t[]);
+
+    /// Get scratch arrays for the calling thread
+    ///
+    /// @param ds Discrete system being integrated
+    AssemblyWorkspace & get_workspace(PetscDS ds);
+
+    /// Build sum-factorized bases of the fields in a discrete system
+    ///
+    /// @param ds Discrete system
+    /// @return Bases indexed by field number, empty if some field does not factorize
+    std::vector<TensorProductBasis> create_tensor_bases(PetscDS ds) const;
+
+    /// Check if cells can be integrated with sum-factorized kernels
+    ///
+    /// @param ds Discrete system being integrated
+    /// @param ds_aux Discrete system of auxiliary fields (can be `nullptr`)
+    /// @param cell_geom Geometry of the cells
+    bool use_tensor_kernels(PetscDS ds, PetscDS ds_aux, PetscFEGeom * cell_geom) const;
+
+    /// Evaluate fields at all quadrature points of a cell with sum factorization
+    ///
+    /// @param ws Scratch arrays of the calling thread
+    /// @param bases Sum-factorized bases of the fields
+    /// @param cell_geom Geometry of the cells
+    /// @param e Cell index
+    /// @param coefficients Field coefficients of the cell
+    /// @param coefficients_t Time derivatives of field coefficients of the cell (can be `nullptr`)
+    /// @param u Values, `u[q * n_comp + c]`
+    /// @param u_x Gradients, `u_x[(q * n_comp + c) * dim + d]`
+    /// @param u_t Time derivatives, `u_t[q * n_comp + c]`
+    void evaluate_field_jets_tensor(AssemblyWorkspace & ws,
+                                    const std::vector<TensorProductBasis> & bases,
+                                    PetscFEGeom * cell_geom,
+                                    Int e,
+                                    const Scalar coefficients[],
+                                    const Scalar coefficients_t[],
+                                    std::vector<Scalar> & u,
+                                    std::vector<Scalar> & u_x,
+                                    std::vector<Scalar> & u_t);
+
+    /// Copy field values at quadrature point `q` evaluated by `evaluate_field_jets_tensor` into
+    /// the arrays used by residual and Jacobian functions
+    void load_field_jets_tensor(AssemblyWorkspace & ws, Int q, bool has_u_t, bool has_aux);
+
+    /// Sum-factorized counterpart of `update_element_vec`
+    ///
+    /// @param ws Scratch arrays of the calling thread
+    /// @param basis Sum-factorized basis of the test field
+    /// @param cell_geom Geometry of the cells
+    /// @param e Cell index
+    /// @param f0 Integrands multiplying test functions, `f0[q * n_comp + c]`
+    /// @param f1 Integrands multiplying test function gradients, `f1[(q * n_comp + c) * dim + d]`
+    /// @param elem_vec Element vector of the test field
+    void update_element_vec_tensor(AssemblyWorkspace & ws,
+                                   const TensorProductBasis & basis,
+                                   PetscFEGeom * cell_geom,
+                                   Int e,
+                                   const Scalar f0[],
+                                   const Scalar f1[],
+                                   Scalar elem_vec[]);
+
+    /// Sum-factorized counterpart of `update_element_mat`, adding the element matrix of a cell
+    /// column by column
+    ///
+    /// @param ws Scratch arrays of the calling thread
+    /// @param basis_i Sum-factorized basis of the test field
+    /// @param basis_j Sum-factorized basis of the trial field
+    /// @param cell_geom Geometry of the cells
+    /// @param e Cell index
+    /// @param g Integrands g0 - g3 at all quadrature points, multiplied by quadrature weights
+    /// @param tot_dim Number of rows (and columns) of the element matrix
+    /// @param offset_i Offset of the test field in the element matrix
+    /// @param offset_j Offset of the trial field in the element matrix
+    /// @param elem_mat Element matrix of the cell
+    void update_element_mat_tensor(AssemblyWorkspace & ws,
+                                   const TensorProductBasis & basis_i,
+                                   const TensorProductBasis & basis_j,
+                                   PetscFEGeom * cell_geom,
+                                   Int e,
+                                   const Scalar g[],
+                                   Int tot_dim,
+                                   Int offset_i,
+                                   Int offset_j,
+                                   Scalar elem_mat[]);
+
+    /// Scratch space indexed by thread slot (slot 0 is the main thread)
+    std::vector<AssemblyWorkspace> work;
+    /// Threads used for assembling
+    ThreadPool thread_pool;
+    /// Requested number of assembly threads
+    Int n_assembly_threads;
+
+    /// Cell geometry computed by `get_cell_geometry`
+    struct CachedGeometry {
+        /// Region the geometry belongs to
+        WeakForm::Region region;
+        /// Quadrature of the field, `nullptr` if the geometry is shared by all fields
+        PetscQuadrature fe_quad;
+        /// Cells the geometry was computed for (a reference is kept, so their ID is not reused)
+        IndexSet cells;
+        /// ID and state of `cells`
+        PetscObjectId cells_id;
+        PetscObjectState cells_state;
+        /// Value of `geom_cache_clock` when the entry was last used
+        std::uint64_t last_use;
+        /// Geometry of the cells. It is destroyed together with the quadrature it was evaluated
+        /// at when the last owner releases it.
+        std::shared_ptr<PetscFEGeom> geom;
+    };
+
+    /// Cached cell geometry
+    std::vector<CachedGeometry> geom_cache;
+    /// Coordinate field the cached geometry was computed from
+    DMField geom_cache_coord_field;
+    /// State of the local coordinate vector when the cached geometry was computed
+    PetscObjectState geom_cache_coord_state;
+    /// Counts cache lookups, used to find the least recently used entry
+    std::uint64_t geom_cache_clock;
+
+    /// Use sum-factorized kernels where the elements allow it
+    bool sum_factorization;
+    /// Sum-factorized bases of fields, empty if the fields do not factorize
+    std::vector<TensorProductBasis> tensor_bases;
+    /// Sum-factorized bases of auxiliary fields, empty if the fields do not factorize
+    std::vector<TensorProductBasis> tensor_bases_aux;
+
+    /// Regions with residual forms
+    std::vector<WeakForm::Region> res_regions;
+    /// Residual dispatch table: [region * n_fields + field] -> block
+    std::vector<ResidualBlock> res_blocks;
+    /// Regions with Jacobian forms
+    std::vector<WeakForm::Region> jac_regions;
+    /// Jacobian dispatch table: [(region * n_fields + field_i) * n_fields + field_j] -> block
+    std::vector<JacobianBlock> jac_blocks;
 };
 
 } // namespace godzilla
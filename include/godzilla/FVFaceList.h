@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include "godzilla/Range.h"
+#include "godzilla/Span.h"
+#include "petscdm.h"
+#include <vector>
+
+namespace godzilla {
+
+/// Flat list of faces used by the finite volume residual evaluation
+///
+/// Faces between two regular cells come first, faces with a ghost cell (i.e. on the domain
+/// boundary) come last. The ghost cell is always on the right side. Faces are split into blocks
+/// that never mix the two kinds, so loops over a block need no branches. Face geometry of a block
+/// is stored in structure-of-arrays layout, i.e. the `d`-th coordinate of the `i`-th face in a
+/// block with `n` faces is at `d * n + i`.
+class FVFaceList {
+public:
+    FVFaceList();
+
+    /// Build the face list
+    ///
+    /// @param dm DMPlex with ghost cells and a local section with a single field
+    /// @param block_size Maximum number of faces in a block
+    void create(DM dm, Int block_size);
+
+    /// Check if the list was built
+    bool is_created() const;
+
+    /// Check if the list was built for `dm` and its current local section
+    ///
+    /// A new mesh, partitioning or DoF layout requires rebuilding the list.
+    ///
+    /// @param dm DMPlex to check against
+    bool is_up_to_date(DM dm) const;
+
+    /// Get the number of faces
+    Int get_num_faces() const;
+
+    /// Get the number of faces between two regular cells
+    Int get_num_interior_faces() const;
+
+    /// Get the number of blocks
+    Int get_num_blocks() const;
+
+    /// Get faces of a block
+    ///
+    /// @param blk Block index
+    /// @return Range of face indices
+    Range get_block(Int blk) const;
+
+    /// Check if a block contains faces with a ghost cell
+    ///
+    /// @param blk Block index
+    bool is_boundary_block(Int blk) const;
+
+    /// Get face centroids of a block
+    ///
+    /// @param blk Block index
+    const Real * get_centroids(Int blk) const;
+
+    /// Get area-scaled face normals (pointing from left to right) of a block
+    ///
+    /// @param blk Block index
+    const Real * get_normals(Int blk) const;
+
+    /// Get face areas
+    Span<const Real> get_areas() const;
+
+    /// Get DMPlex points of the faces
+    Span<const Int> get_faces() const;
+
+    /// Get left cells (local point numbers)
+    Span<const Int> get_left_cells() const;
+
+    /// Get right cells (local point numbers)
+    Span<const Int> get_right_cells() const;
+
+    /// Get offsets of left cells into a local vector
+    Span<const Int> get_left_offsets() const;
+
+    /// Get offsets of right cells into a local vector
+    Span<const Int> get_right_offsets() const;
+
+    /// Get inverse volumes of left cells
+    Span<const Real> get_left_inv_volumes() const;
+
+    /// Get inverse volumes of right cells
+    Span<const Real> get_right_inv_volumes() const;
+
+private:
+    /// Spatial dimension
+    Int dim;
+    /// IDs of the DM and its local section the list was built for
+    PetscObjectId dm_id, section_id;
+    /// Number of faces between two regular cells
+    Int n_interior;
+    /// First face of each block, the last entry is the total number of faces
+    std::vector<Int> block_start;
+    /// DMPlex points of the faces
+    std::vector<Int> faces;
+    /// Face centroids (block layout)
+    std::vector<Real> centroid;
+    /// Area-scaled face normals (block layout)
+    std::vector<Real> normal;
+    /// Face areas
+    std::vector<Real> area;
+    /// Left cells
+    std::vector<Int> cell_l;
+    /// Right cells
+    std::vector<Int> cell_r;
+    /// Offsets of left cells into a local vector
+    std::vector<Int> offset_l;
+    /// Offsets of right cells into a local vector
+    std::vector<Int> offset_r;
+    /// Inverse volumes of left cells
+    std::vector<Real> inv_vol_l;
+    /// Inverse volumes of right cells
+    std::vector<Real> inv_vol_r;
+};
+
+} // namespace godzilla
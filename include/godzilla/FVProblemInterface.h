@@ -5,6 +5,8 @@
 
 #include "godzilla/Delegate.h"
 #include "godzilla/DiscreteProblemInterface.h"
+#include "godzilla/FVFaceList.h"
+#include "godzilla/FVReconstruction.h"
 #include "godzilla/NaturalRiemannBC.h"
 #include "godzilla/Qtr.h"
 
@@ -20,9 +22,20 @@ public:
     using ComputeFluxDelegate =
         Delegate<void(const Real[], const Real[], const Scalar[], const Scalar[], Scalar[])>;
 
+    /// Riemann solver evaluating fluxes on a block of faces
+    ///
+    /// Arguments are the number of faces `n`, face centroids, area-scaled face normals, states on
+    /// the left and right side of the faces and the output fluxes. All arrays use
+    /// structure-of-arrays layout, i.e. the `d`-th coordinate of face `i` is `x[d * n + i]` and
+    /// the `c`-th component of its left state is `u_l[c * n + i]`.
+    using ComputeFluxBatchDelegate = Delegate<
+        void(Int n, const Real[], const Real[], const Scalar[], const Scalar[], Scalar[])>;
+
     FVProblemInterface(Problem & problem, const Parameters & pars);
     ~FVProblemInterface() override;
 
+    static Parameters parameters();
+
     Int get_num_fields() const override;
     std::vector<String> get_field_names() const override;
     Expected<String, ErrorCode> get_field_name(FieldID fid) const override;
@@ -80,6 +93,11 @@ public:
     Ref<OBJECT> add_boundary_condition(Parameters & pars,
                                        std::source_location loc = std::source_location::current());
 
+    /// Check if a batched Riemann solver was set
+    ///
+    /// @return `true` if `set_batched_riemann_solver` was called, `false` otherwise
+    bool has_batched_riemann_solver() const;
+
 protected:
     void init() override;
     void create() override;
@@ -109,7 +127,42 @@ protected:
         PETSC_CHECK(PetscDSSetContext(ds, field.value(), &this->compute_flux_methods[field]));
     }
 
+    /// Set Riemann solver that evaluates fluxes on blocks of faces
+    ///
+    /// The solver computes fluxes of all components. When set, the face loop is done by
+    /// `compute_flux_residual_local` instead of PETSc.
+    ///
+    /// @tparam T C++ class type
+    /// @param instance Instance of class T
+    /// @param method Member function in class T
+    template <class T>
+    void
+    set_batched_riemann_solver(Ref<T> instance,
+                               void (T::*method)(Int,
+                                                 const Real[],
+                                                 const Real[],
+                                                 const Scalar[],
+                                                 const Scalar[],
+                                                 Scalar[]))
+    {
+        this->compute_flux_batch_method.bind(instance, method);
+    }
+
+    /// Form the local residual from face fluxes using the batched Riemann solver
+    ///
+    /// Face geometry, neighbor cells and their offsets are taken from a face list that is built
+    /// on the first call, so the face loop does not touch DMPlex topology. With least-squares
+    /// reconstruction, face states are reconstructed from (limited) cell gradients.
+    ///
+    /// @param time The time
+    /// @param loc_x Local solution
+    /// @param loc_f Local output vector
+    void compute_flux_residual_local(Real time, const Vector & loc_x, Vector & loc_f);
+
 private:
+    /// Number of faces passed to the batched Riemann solver at once
+    static constexpr Int FACE_BLOCK_SIZE = 256;
+
     /// Field information
     struct FieldInfo {
         /// The name of the field
@@ -161,6 +214,23 @@ private:
 
     std::map<FieldID, ComputeFluxDelegate> compute_flux_methods;
 
+    ComputeFluxBatchDelegate compute_flux_batch_method;
+
+    /// Faces used by `compute_flux_residual_local`, built on first use
+    FVFaceList face_list;
+
+    /// Use least-squares reconstruction of face states
+    bool lsq_reconstruction;
+
+    /// Slope limiter used with reconstruction
+    FVReconstruction::Limiter limiter;
+
+    /// Constant `K` of the Venkatakrishnan limiter
+    Real venkat_k;
+
+    /// Reconstruction operator, built on first use
+    FVReconstruction reconstruction;
+
     std::vector<Qtr<NaturalRiemannBC>> riemann_bcs;
 
     static const String empty_name;
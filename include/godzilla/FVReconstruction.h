@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include "godzilla/FVFaceList.h"
+#include "petscdm.h"
+#include "petscsf.h"
+#include <vector>
+
+namespace godzilla {
+
+/// Second-order (MUSCL-type) reconstruction of cell states to faces for finite volume problems
+///
+/// Cell gradients are computed by least squares from the face neighbors. The least-squares
+/// operator is assembled once and stored as CSR weights, so computing gradients is a sparse
+/// matrix-vector product per component. Gradients are then optionally limited and the face
+/// states are `u_c + grad u_c . (x_f - x_c)`. Ghost cells keep zero gradients.
+class FVReconstruction {
+public:
+    /// Slope limiter
+    enum class Limiter {
+        /// No limiting
+        NONE,
+        /// Barth-Jespersen
+        BARTH_JESPERSEN,
+        /// Venkatakrishnan
+        VENKATAKRISHNAN
+    };
+
+    FVReconstruction();
+    ~FVReconstruction();
+
+    FVReconstruction(const FVReconstruction &) = delete;
+    FVReconstruction & operator=(const FVReconstruction &) = delete;
+
+    /// Build the least-squares operator
+    ///
+    /// @param dm DMPlex with ghost cells and a local section with a single field
+    /// @param faces Face list built from `dm`, used only for the reconstruction on its faces
+    /// @param n_comps Number of components
+    /// @param limiter Slope limiter
+    /// @param venkat_k Constant `K` of the Venkatakrishnan limiter
+    void
+    create(DM dm, const FVFaceList & faces, Int n_comps, Limiter limiter, Real venkat_k = 5.);
+
+    /// Check if the operator was built
+    bool is_created() const;
+
+    /// Compute (and limit) cell gradients
+    ///
+    /// @param x Local solution array
+    void compute_gradients(const Scalar x[]);
+
+    /// Get gradient of a cell
+    ///
+    /// @param cell Cell (local point number)
+    /// @return Gradient with `grad[c * dim + d]` being the `d`-th derivative of component `c`
+    const Scalar * get_gradient(Int cell) const;
+
+    /// Reconstruct states on the left and right side of faces in a block
+    ///
+    /// @param faces Face list
+    /// @param blk Block index
+    /// @param x Local solution array
+    /// @param u_l Left states in structure-of-arrays layout
+    /// @param u_r Right states in structure-of-arrays layout
+    void reconstruct(const FVFaceList & faces,
+                     Int blk,
+                     const Scalar x[],
+                     Scalar u_l[],
+                     Scalar u_r[]) const;
+
+private:
+    void limit(const Scalar x[]);
+
+    /// Spatial dimension
+    Int dim;
+    /// Number of components
+    Int nc;
+    /// First cell
+    Int c_start;
+    /// Number of cells, including ghost cells
+    Int n_cells;
+    /// Slope limiter
+    Limiter limiter;
+    /// Offsets of cells into a local vector
+    std::vector<Int> cell_offset;
+    /// CSR row pointers of the least-squares operator (rows of ghost cells are empty)
+    std::vector<Int> row_ptr;
+    /// Neighbor cells
+    std::vector<Int> nbr;
+    /// Least-squares weights, `dim` values per neighbor
+    std::vector<Real> weight;
+    /// Cell index on the left side of each local face (including faces owned by other ranks)
+    std::vector<Int> face_cell_l;
+    /// Cell index on the right side of each local face, -1 for ghost cells
+    std::vector<Int> face_cell_r;
+    /// Face centroid minus left cell centroid, `dim` values per local face
+    std::vector<Real> face_dx_l;
+    /// Face centroid minus right cell centroid, `dim` values per local face
+    std::vector<Real> face_dx_r;
+    /// Face centroid minus left cell centroid, `dim` values per face of the face list
+    std::vector<Real> dx_l;
+    /// Face centroid minus right cell centroid, `dim` values per face of the face list
+    std::vector<Real> dx_r;
+    /// Venkatakrishnan's epsilon squared of each cell
+    std::vector<Real> eps2;
+    /// Cell gradients, `nc * dim` values per cell
+    std::vector<Scalar> grad;
+    /// Limiter value of each cell and component
+    std::vector<Real> phi;
+    /// Minimum/maximum of neighbor values of each cell and component
+    std::vector<Scalar> u_min, u_max;
+    /// Star forest over `grad` (offsets relative to the first cell), used to update gradients of
+    /// overlap cells
+    PetscSF cell_sf;
+};
+
+} // namespace godzilla
@@ -5,42 +5,59 @@
 
 #include "godzilla/Types.h"
 #include "godzilla/Assert.h"
+#include "godzilla/ThreadPool.h"
+#include <utility>
+#include <vector>
 
 namespace godzilla {
 
 /// C++ wrapper around a C-array with late binding. Behaves like an array object.
 ///
+/// Each thread slot (see `get_thread_slot`) has its own binding, so the same object can be read
+/// concurrently by several assembly threads, each one seeing its own data.
+///
 /// @tparam T Type of array elements
 template <typename T>
 class LateBindArray {
 public:
-    LateBindArray(Int size) : size(size), data(nullptr) {}
+    LateBindArray(Int size) : size(size), data(1, nullptr) {}
 
+    /// Bind the array for the calling thread
     void
     set(T * new_data)
     {
-        this->data = new_data;
+        this->data[get_thread_slot()] = new_data;
+    }
+
+    /// Bind the array for thread slot `slot`
+    void
+    set(Int slot, T * new_data)
+    {
+        if (std::cmp_greater_equal(slot, this->data.size()))
+            this->data.resize(slot + 1, nullptr);
+        this->data[slot] = new_data;
     }
 
     T *
     get() const
     {
-        return this->data;
+        return this->data[get_thread_slot()];
     }
 
     T
     operator()(unsigned int idx) const
     {
-        GODZILLA_ASSERT_TRUE(this->data != nullptr, "Array is not bound to data");
+        auto * d = get();
+        GODZILLA_ASSERT_TRUE(d != nullptr, "Array is not bound to data");
         GODZILLA_ASSERT_TRUE(idx < this->size, "Index out of bounds");
-        return this->data[idx];
+        return d[idx];
     }
 
 private:
     /// Number of elements stored in `data`
     Int size;
-    /// The elements of the array
-    T * data;
+    /// The elements of the array (one binding per thread slot)
+    std::vector<T *> data;
 };
 
 /// Used for field values during assembling
@@ -44,10 +44,15 @@ protected:
 private:
     void detect_file_format();
     Qtr<UnstructuredMesh> create_from_exodus();
+    /// Create mesh from an ExodusII file with every rank reading a contiguous slice of cells and
+    /// vertices
+    Qtr<UnstructuredMesh> create_from_exodus_parallel();
     Qtr<UnstructuredMesh> create_from_gmsh();
 
     /// File name with the mesh
     fs::path file_name;
+    /// Read the mesh in parallel
+    bool parallel_read;
 
 public:
     static Parameters parameters();
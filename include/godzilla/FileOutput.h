@@ -7,6 +7,7 @@
 #include "godzilla/String.h"
 #include "godzilla/Output.h"
 #include <filesystem>
+#include <functional>
 
 namespace fs = std::filesystem;
 
@@ -35,6 +36,23 @@ public:
     /// @param stepi Step number
     void set_sequence_file_base(unsigned int stepi);
 
+    /// Snapshot the data of the current step and create a task that writes it into the file
+    ///
+    /// The task runs on a background I/O thread, so it must not call into PETSc or access the
+    /// problem. Outputs that cannot write asynchronously return an empty task and are written
+    /// with `output_step` instead, which is also the default.
+    ///
+    /// @return Task writing the snapshotted step
+    virtual std::function<void()> create_output_task();
+
+    /// Can `create_output_task` run while the I/O thread is writing?
+    ///
+    /// Outputs that snapshot their step through ExodusII or HDF5 must return `false`. These
+    /// libraries are not thread-safe, so pending writes are finished first.
+    ///
+    /// @return `true` if the snapshot does not call into ExodusII or HDF5 (default)
+    virtual bool is_snapshot_thread_safe() const;
+
 protected:
     fs::path get_file_base() const;
 
@@ -69,6 +69,12 @@ protected:
     /// @return Reference to a class that contains the field time derivative values
     const FieldValue & get_field_dot(String field_name) const;
 
+    /// Get location of field components in `QuadratureBatch` arrays
+    ///
+    /// @param field_name The name of the field
+    /// @return Reference to the location of the field components
+    const BatchField & get_batch_field(String field_name) const;
+
     /// Get time at which the function is evaluated
     ///
     /// @return Time at which is the function evaluated
@@ -160,6 +160,38 @@ get_datatype<String>()
     return dtype;
 }
 
+/// Compression filter
+enum class Compression {
+    /// No compression
+    NONE,
+    /// Deflate (zlib)
+    DEFLATE,
+    /// SZIP
+    SZIP
+};
+
+/// Options used when creating large (distributed) datasets
+struct DatasetOptions {
+    /// Number of values per chunk, 0 for contiguous storage
+    hsize_t chunk_size = 0;
+    /// Compression filter, applied only to chunked datasets and only if the filter is available
+    Compression compression = Compression::NONE;
+    /// Compression level of the deflate filter (1-9)
+    unsigned int deflate_level = 4;
+};
+
+/// Options used when opening or creating a file
+struct FileOptions {
+    /// MPI-IO hints, for example `{ "romio_cb_write", "enable" }` or `{ "cb_nodes", "8" }`
+    std::vector<std::pair<std::string, std::string>> mpi_hints;
+    /// Alignment of objects in the file in bytes, 0 for no alignment
+    hsize_t alignment = 0;
+    /// Only objects of at least this size (in bytes) are aligned
+    hsize_t alignment_threshold = 1;
+    /// Options for large datasets
+    DatasetOptions datasets;
+};
+
 } // namespace hdf5
 
 /// Class for interaction with HDF5 files
@@ -168,7 +200,9 @@ class HDF5File {
     class Attribute;
 
     class Group {
-        Group(hid_t id) : id(id) {}
+        Group(hid_t id, const hdf5::DatasetOptions & dset_opts = {}) : id(id), dset_opts(dset_opts)
+        {
+        }
 
     public:
         ~Group();
@@ -227,23 +261,26 @@ class HDF5File {
         }
 
     public:
+        /// Options for large datasets created in this group
+        hdf5::DatasetOptions dset_opts;
+
         static Group
-        open(hid_t parent_id, String name)
+        open(hid_t parent_id, String name, const hdf5::DatasetOptions & dset_opts = {})
         {
             auto id = H5Gopen2(parent_id, name.c_str(), H5P_DEFAULT);
             if (id < 0)
                 throw Exception(fmt::format("Failed to open group '{}'", name));
-            return Group(id);
+            return Group(id, dset_opts);
         }
 
         static Group
-        create(hid_t parent_id, String name)
+        create(hid_t parent_id, String name, const hdf5::DatasetOptions & dset_opts = {})
         {
             if (name == "/") {
-                return Group::open(parent_id, name);
+                return Group::open(parent_id, name, dset_opts);
             }
             else if (H5Lexists(parent_id, name.c_str(), H5P_DEFAULT) > 0) {
-                return Group::open(parent_id, name);
+                return Group::open(parent_id, name, dset_opts);
             }
             else {
                 auto lcpl_id = H5Pcreate(H5P_LINK_CREATE);
@@ -254,7 +291,7 @@ class HDF5File {
                 if (id < 0)
                     throw Exception(fmt::format("Failed to create group '{}'", name));
                 H5Pclose(lcpl_id);
-                return Group(id);
+                return Group(id, dset_opts);
             }
         }
     };
@@ -406,6 +443,28 @@ class HDF5File {
             return Dataset(id);
         }
 
+        /// Create a 1D dataset with chunking and compression given by `opts`
+        template <typename T>
+        static Dataset
+        create(hid_t parent_id,
+               String name,
+               const Dataspace & dspace,
+               const hdf5::DatasetOptions & opts)
+        {
+            auto dcpl = create_property_list(dspace, opts);
+            auto id = H5Dcreate2(parent_id,
+                                 name.c_str(),
+                                 hdf5::get_datatype<T>(),
+                                 dspace.id,
+                                 H5P_DEFAULT,
+                                 dcpl,
+                                 H5P_DEFAULT);
+            H5Pclose(dcpl);
+            if (id == H5I_INVALID_HID)
+                throw Exception(fmt::format("Failed to create dataset '{}'", name));
+            return Dataset(id);
+        }
+
         static Dataset
         open(hid_t parent_id, String name)
         {
@@ -414,6 +473,10 @@ class HDF5File {
                 throw Exception(fmt::format("Unable to open dataset '{}'", name));
             return Dataset(id);
         }
+
+    private:
+        static hid_t create_property_list(const Dataspace & dspace,
+                                          const hdf5::DatasetOptions & opts);
     };
 
     class Attribute {
@@ -471,13 +534,23 @@ class HDF5File {
 
 public:
     HDF5File(mpi::Communicator comm, fs::path file_name, FileAccess faccess);
+    HDF5File(mpi::Communicator comm,
+             fs::path file_name,
+             FileAccess faccess,
+             const hdf5::FileOptions & opts);
     HDF5File(fs::path file_name, FileAccess faccess);
+    HDF5File(fs::path file_name, FileAccess faccess, const hdf5::FileOptions & opts);
     ~HDF5File();
 
     fs::path get_file_name() const;
 
     fs::path get_file_path() const;
 
+    /// Get the image of the file, i.e. the bytes the file would have on disk
+    ///
+    /// @return File image
+    std::vector<char> get_file_image() const;
+
     bool has_attribute(String name) const;
 
     bool has_dataset(String name) const;
@@ -507,6 +580,8 @@ public:
 private:
     hid_t id;
     fs::path file_name;
+    /// Options for large datasets
+    hdf5::DatasetOptions dset_opts;
 };
 
 // Group
@@ -537,13 +612,13 @@ HDF5File::Group::has_dataset(String name) const
 inline HDF5File::Group
 HDF5File::Group::create_group(String name)
 {
-    return Group::create(this->id, name);
+    return Group::create(this->id, name, this->dset_opts);
 }
 
 inline HDF5File::Group
 HDF5File::Group::open_group(String name)
 {
-    return Group::open(this->id, name);
+    return Group::open(this->id, name, this->dset_opts);
 }
 
 template <typename T>
@@ -942,13 +1017,13 @@ HDF5File::Attribute::write(const String & data)
 inline HDF5File::Group
 HDF5File::create_group(String name) const
 {
-    return Group::create(this->id, name);
+    return Group::create(this->id, name, this->dset_opts);
 }
 
 inline HDF5File::Group
 HDF5File::open_group(String name) const
 {
-    return Group::open(this->id, name);
+    return Group::open(this->id, name, this->dset_opts);
 }
 
 inline bool
@@ -18,6 +18,7 @@ class DiscreteProblemInterface;
 class FEProblemInterface;
 class FVProblemInterface;
 class DGProblemInterface;
+class ParallelExodusIIFile;
 
 namespace io {
 
@@ -65,6 +66,10 @@ std::vector<String> get_var_names(DiscreteProblemInterface & dpi, FieldID fid);
 std::vector<String> get_aux_var_names(DiscreteProblemInterface & dpi, FieldID fid);
 
 // Solution writing
+//
+// Each component of a field is gathered into a contiguous buffer and written with a single call
+// per variable (and per element block). Overloads taking `buffer` let the caller keep the scratch
+// space between output steps.
 
 /// Write field values at one time step.
 ///
@@ -81,6 +86,23 @@ void write_field_values(exodusIIcpp::File & f,
                         FieldID field_id,
                         int exo_var_id);
 
+/// Write field values at one time step.
+///
+/// @param f ExodusII file to write to
+/// @param fepi Problem interface with solution
+/// @param step_num Time step number
+/// @param time Current time value
+/// @param fid Field ID
+/// @param exo_var_id ExodusII variable ID to write into
+/// @param buffer Scratch space for gathering the values
+void write_field_values(exodusIIcpp::File & f,
+                        const DiscreteProblemInterface & dpi,
+                        int step_num,
+                        Real time,
+                        FieldID field_id,
+                        int exo_var_id,
+                        std::vector<double> & buffer);
+
 void write_field_values(exodusIIcpp::File & f,
                         const DGProblemInterface & dgpi,
                         int step_num,
@@ -88,6 +110,14 @@ void write_field_values(exodusIIcpp::File & f,
                         FieldID field_id,
                         int exo_var_id);
 
+void write_field_values(exodusIIcpp::File & f,
+                        const DGProblemInterface & dgpi,
+                        int step_num,
+                        Real time,
+                        FieldID field_id,
+                        int exo_var_id,
+                        std::vector<double> & buffer);
+
 /// Write field values at one time step.
 ///
 /// @param f ExodusII file to write to
@@ -103,6 +133,23 @@ void write_aux_field_values(exodusIIcpp::File & f,
                             FieldID field_id,
                             int exo_var_id);
 
+/// Write field values at one time step.
+///
+/// @param f ExodusII file to write to
+/// @param dpi Problem interface with solution
+/// @param step_num Time step number
+/// @param time Current time value
+/// @param fid Auxiliary field ID
+/// @param exo_var_id ExodusII variable ID to write into
+/// @param buffer Scratch space for gathering the values
+void write_aux_field_values(exodusIIcpp::File & f,
+                            const DiscreteProblemInterface & dpi,
+                            int step_num,
+                            Real time,
+                            FieldID field_id,
+                            int exo_var_id,
+                            std::vector<double> & buffer);
+
 void write_aux_field_values(exodusIIcpp::File & f,
                             const DGProblemInterface & dgpi,
                             int step_num,
@@ -110,6 +157,14 @@ void write_aux_field_values(exodusIIcpp::File & f,
                             FieldID field_id,
                             int exo_var_id);
 
+void write_aux_field_values(exodusIIcpp::File & f,
+                            const DGProblemInterface & dgpi,
+                            int step_num,
+                            Real time,
+                            FieldID field_id,
+                            int exo_var_id,
+                            std::vector<double> & buffer);
+
 void write_elemental_field_values(exodusIIcpp::File & f,
                                   DiscreteProblemInterface & dpi,
                                   int step_num,
@@ -117,6 +172,14 @@ void write_elemental_field_values(exodusIIcpp::File & f,
                                   FieldID fid,
                                   int exo_var_id);
 
+void write_elemental_field_values(exodusIIcpp::File & f,
+                                  DiscreteProblemInterface & dpi,
+                                  int step_num,
+                                  Real time,
+                                  FieldID fid,
+                                  int exo_var_id,
+                                  std::vector<double> & buffer);
+
 void write_aux_elemental_field_values(exodusIIcpp::File & f,
                                       DiscreteProblemInterface & dpi,
                                       int step_num,
@@ -124,6 +187,150 @@ void write_aux_elemental_field_values(exodusIIcpp::File & f,
                                       FieldID fid,
                                       int exo_var_id);
 
+void write_aux_elemental_field_values(exodusIIcpp::File & f,
+                                      DiscreteProblemInterface & dpi,
+                                      int step_num,
+                                      Real time,
+                                      FieldID fid,
+                                      int exo_var_id,
+                                      std::vector<double> & buffer);
+
+// Solution snapshots
+
+/// Values of one output step, recorded so they can be written into a file later (for example by
+/// a background I/O thread)
+///
+/// Storage is kept between steps, so a snapshot can be reused without reallocating.
+class StepData {
+public:
+    /// Clear the recorded values and start a new step
+    ///
+    /// @param step_num Time step number
+    /// @param time Time
+    void start(int step_num, Real time);
+
+    /// Record values of a nodal variable
+    void write_nodal_var(int step_num, int var_idx, const std::vector<double> & values);
+
+    /// Record values of an elemental variable in a block
+    void
+    write_elem_var(int step_num, int var_idx, int blk_id, const std::vector<double> & values);
+
+    /// Record values of the global variables
+    void write_global_vars(const std::vector<double> & values);
+
+    /// Write the recorded values into a file
+    ///
+    /// @param f ExodusII file to write into
+    void write(exodusIIcpp::File & f) const;
+
+private:
+    struct Var {
+        int var_idx;
+        int blk_id;
+        std::vector<double> values;
+    };
+
+    Var & next_var(std::vector<Var> & vars, Int & n);
+
+    /// Time step number
+    int step_num = 0;
+    /// Time
+    Real time = 0.;
+    /// Nodal variables, only the first `n_nodal_vars` are valid
+    std::vector<Var> nodal_vars;
+    Int n_nodal_vars = 0;
+    /// Elemental variables, only the first `n_elem_vars` are valid
+    std::vector<Var> elem_vars;
+    Int n_elem_vars = 0;
+    /// Global variables
+    std::vector<double> global_vars;
+};
+
+/// Record field values at one time step.
+void write_field_values(StepData & f,
+                        const DiscreteProblemInterface & dpi,
+                        int step_num,
+                        Real time,
+                        FieldID fid,
+                        int exo_var_id,
+                        std::vector<double> & buffer);
+
+/// Record auxiliary field values at one time step.
+void write_aux_field_values(StepData & f,
+                            const DiscreteProblemInterface & dpi,
+                            int step_num,
+                            Real time,
+                            FieldID fid,
+                            int exo_var_id,
+                            std::vector<double> & buffer);
+
+/// Record elemental field values at one time step.
+void write_elemental_field_values(StepData & f,
+                                  DiscreteProblemInterface & dpi,
+                                  int step_num,
+                                  Real time,
+                                  FieldID fid,
+                                  int exo_var_id,
+                                  std::vector<double> & buffer);
+
+/// Record elemental auxiliary field values at one time step.
+void write_aux_elemental_field_values(StepData & f,
+                                      DiscreteProblemInterface & dpi,
+                                      int step_num,
+                                      Real time,
+                                      FieldID fid,
+                                      int exo_var_id,
+                                      std::vector<double> & buffer);
+
+// Solution writing into a single file shared by all ranks
+//
+// Each rank writes the values at the vertices and cells it owns.
+
+/// Write field values at one time step into a shared file.
+///
+/// @param f Shared ExodusII file to write to
+/// @param dpi Problem interface with solution
+/// @param step_num Time step number
+/// @param fid Field ID
+/// @param exo_var_id ExodusII variable ID to write into
+/// @param buffer Scratch space for gathering the values
+void write_field_values(ParallelExodusIIFile & f,
+                        const DiscreteProblemInterface & dpi,
+                        int step_num,
+                        FieldID fid,
+                        int exo_var_id,
+                        std::vector<double> & buffer);
+
+/// Write auxiliary field values at one time step into a shared file.
+///
+/// @param f Shared ExodusII file to write to
+/// @param dpi Problem interface with solution
+/// @param step_num Time step number
+/// @param fid Auxiliary field ID
+/// @param exo_var_id ExodusII variable ID to write into
+/// @param buffer Scratch space for gathering the values
+void write_aux_field_values(ParallelExodusIIFile & f,
+                            const DiscreteProblemInterface & dpi,
+                            int step_num,
+                            FieldID fid,
+                            int exo_var_id,
+                            std::vector<double> & buffer);
+
+void write_elemental_field_values(ParallelExodusIIFile & f,
+                                  const DiscreteProblemInterface & dpi,
+                                  int step_num,
+                                  FieldID fid,
+                                  int exo_var_id,
+                                  std::vector<double> & buffer);
+
+void write_aux_elemental_field_values(ParallelExodusIIFile & f,
+                                      const DiscreteProblemInterface & dpi,
+                                      int step_num,
+                                      FieldID fid,
+                                      int exo_var_id,
+                                      std::vector<double> & buffer);
+
 /// Map PolytopeType -> ExodusII element type string ("TRI3", "HEX8", ...).
 const char * get_elem_type(PolytopeType elem_type);
 
@@ -5,6 +5,7 @@
 
 #include "godzilla/Functional.h"
 #include "godzilla/FieldValue.h"
+#include "godzilla/QuadratureBatch.h"
 #include "godzilla/String.h"
 
 namespace godzilla {
@@ -20,6 +21,20 @@ public:
     /// @param val Array to store the values into
     virtual void evaluate(Scalar val[]) const = 0;
 
+    /// Does this functional implement `evaluate_batch`?
+    ///
+    /// @return `true` if batched evaluation is implemented, `false` otherwise
+    virtual bool is_batched() const;
+
+    /// Evaluate this functional at a batch of quadrature points
+    ///
+    /// Entry `k` of the value at point `p` is stored into `val[k * batch.n + p]`. Batched
+    /// functionals read field data from `batch`, not from `FieldValue`s.
+    ///
+    /// @param batch Field data at the quadrature points
+    /// @param val Array to store the values into
+    virtual void evaluate_batch(const QuadratureBatch & batch, Scalar val[]) const;
+
 protected:
     /// Get the multiplier a for dF/dU_t
     ///
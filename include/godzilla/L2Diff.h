@@ -16,6 +16,8 @@ public:
 
     void create() override;
     void compute() override;
+    bool compute_local(ReductionBatch & batch) override;
+    void finish_compute(const ReductionBatch & batch) override;
 
     std::vector<Real> get_value() override;
 
@@ -29,6 +31,8 @@ public:
 private:
     /// Computed L_2 error
     Real l2_diff;
+    /// Handle of the squared L_2 error in a reduction batch
+    std::size_t l2_diff_sq_handle;
 
 public:
     static Parameters parameters();
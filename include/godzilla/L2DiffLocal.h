@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include "godzilla/Vector.h"
+#include "petscdm.h"
+#include <vector>
+
+namespace godzilla {
+
+/// Compute squared L_2 differences between functions and an FE solution over cells of this rank
+///
+/// This is the local part of `DMComputeL2FieldDiff`. Nothing is reduced across ranks, so the
+/// results can be reduced together with other values (see `ReductionBatch`). Overlap cells owned
+/// by other ranks are skipped, so every cell is counted exactly once in the sum over ranks. Fields
+/// must use finite elements without basis transformations.
+///
+/// @param dm DM with the FE discretization
+/// @param time Time at which the functions are evaluated
+/// @param funcs Functions, one per field (`nullptr` skips the field)
+/// @param ctxs Contexts passed into `funcs`
+/// @param loc_x Local solution vector with boundary values inserted
+/// @return Squared L_2 difference for each entry in `funcs`
+std::vector<Real> compute_l2_field_diff_squared_local(DM dm,
+                                                      Real time,
+                                                      const std::vector<PetscFunc *> & funcs,
+                                                      const std::vector<void *> & ctxs,
+                                                      const Vector & loc_x);
+
+} // namespace godzilla
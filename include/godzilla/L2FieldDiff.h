@@ -18,6 +18,8 @@ public:
 
     void create() override;
     void compute() override;
+    bool compute_local(ReductionBatch & batch) override;
+    void finish_compute(const ReductionBatch & batch) override;
     std::vector<Real> get_value() override;
 
 protected:
@@ -31,12 +33,17 @@ protected:
 private:
     virtual void set_up_callbacks() = 0;
 
+    /// Build the function and context arrays passed to PETSc
+    void get_functions(std::vector<PetscFunc *> & funcs, std::vector<void *> & contexts);
+
     /// FE problem
     Optional<Ref<const FEProblemInterface>> fepi;
     /// Number of fields
     Int n_fields;
     /// Computed L_2 errors
     std::vector<Real> l2_diff;
+    /// Handles of the squared L_2 errors in a reduction batch
+    std::vector<std::size_t> l2_diff_sq_handles;
     /// Delegates: [field id] -> function
     std::map<Int, FunctionDelegate> delegates;
 
@@ -19,6 +19,9 @@ public:
 private:
     String get_file_ext() const override;
 
+    /// Write the file with collective MPI-IO
+    bool collective_io;
+
 public:
     static Parameters parameters();
 };
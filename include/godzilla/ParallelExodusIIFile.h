@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include "godzilla/String.h"
+#include "godzilla/Enums.h"
+#include "mpicpp-lite/mpicpp-lite.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace mpi = mpicpp_lite;
+namespace fs = std::filesystem;
+
+namespace godzilla {
+
+class UnstructuredMesh;
+
+/// ExodusII file written collectively by all ranks of a communicator
+///
+/// Every rank writes only the nodes and elements it owns, at positions given by a global
+/// numbering: owned vertices follow the global vertex numbering of the mesh and owned cells of each
+/// element block are numbered contiguously rank by rank. On more than one rank, this requires an
+/// ExodusII library built with parallel I/O support.
+class ParallelExodusIIFile {
+public:
+    /// Element block with the cells owned by this rank
+    struct Block {
+        /// Block ID
+        int id;
+        /// Owned cells of this block (local point numbers)
+        std::vector<Int> cells;
+        /// Position of the first owned cell within the block
+        Int start;
+    };
+
+    /// Create a file
+    ///
+    /// @param comm Communicator of all ranks writing the file
+    /// @param file_name File name
+    ParallelExodusIIFile(mpi::Communicator comm, const fs::path & file_name);
+    ~ParallelExodusIIFile();
+
+    ParallelExodusIIFile(const ParallelExodusIIFile &) = delete;
+    ParallelExodusIIFile & operator=(const ParallelExodusIIFile &) = delete;
+
+    /// Write mesh (coordinates, element blocks, node sets and side sets)
+    ///
+    /// This also builds the global numbering used by the other write methods.
+    ///
+    /// @param mesh Mesh to write
+    void write_mesh(const UnstructuredMesh & mesh);
+
+    /// Write information records
+    ///
+    /// @param info Information records
+    void write_info(const std::vector<std::string> & info);
+
+    /// Write names of nodal, elemental and global variables
+    void write_var_names(const std::vector<std::string> & nodal_var_names,
+                         const std::vector<std::string> & elem_var_names,
+                         const std::vector<std::string> & global_var_names);
+
+    /// Write time value of a time step
+    ///
+    /// @param step_num Time step number (1-based)
+    /// @param time Time
+    void write_time(int step_num, Real time);
+
+    /// Write values of a nodal variable at owned vertices
+    ///
+    /// @param step_num Time step number
+    /// @param var_idx Variable index (1-based)
+    /// @param values Values in the order given by `get_owned_vertices()`
+    void write_nodal_var(int step_num, int var_idx, const std::vector<double> & values);
+
+    /// Write values of an elemental variable at owned cells of a block
+    ///
+    /// @param step_num Time step number
+    /// @param var_idx Variable index (1-based)
+    /// @param blk Element block
+    /// @param values Values in the order given by `blk.cells`
+    void write_elem_var(int step_num,
+                        int var_idx,
+                        const Block & blk,
+                        const std::vector<double> & values);
+
+    /// Write values of all global variables
+    ///
+    /// @param step_num Time step number
+    /// @param values Values (must be the same on all ranks)
+    void write_global_vars(int step_num, const std::vector<double> & values);
+
+    /// Flush buffered data to disk
+    void update();
+
+    /// Close the file
+    void close();
+
+    /// Get vertices owned by this rank (local point numbers)
+    const std::vector<Int> & get_owned_vertices() const;
+
+    /// Get element blocks
+    const std::vector<Block> & get_blocks() const;
+
+private:
+    void build_numbering(const UnstructuredMesh & mesh);
+    void write_init(const UnstructuredMesh & mesh);
+    void write_coords(const UnstructuredMesh & mesh);
+    void write_elements(const UnstructuredMesh & mesh);
+    void write_node_sets(const UnstructuredMesh & mesh);
+    void write_face_sets(const UnstructuredMesh & mesh);
+
+    /// Compute offset of this rank and the global sum of `n` over all ranks
+    std::pair<Int, Int> exscan(Int n) const;
+
+    /// Communicator
+    mpi::Communicator comm;
+    /// ExodusII file ID
+    int exoid;
+    /// Owned vertices
+    std::vector<Int> owned_vertices;
+    /// Global index of the first owned vertex
+    Int vertex_start;
+    /// Total number of vertices
+    Int n_global_vertices;
+    /// Total number of cells in each block
+    std::vector<Int> n_global_block_cells;
+    /// Cell type of each block
+    std::vector<PolytopeType> block_cell_types;
+    /// Element blocks
+    std::vector<Block> blocks;
+    /// Global (1-based) ExodusII vertex number of each local vertex
+    std::vector<Int> exo_vertex_ids;
+    /// Global (1-based) ExodusII element number of each local cell, 0 for cells not owned
+    std::vector<Int> exo_elem_ids;
+};
+
+} // namespace godzilla
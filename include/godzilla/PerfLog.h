@@ -57,6 +57,38 @@ StageID get_stage_id(String name);
 /// Adds floating point operations to the global counter.
 void log_flops(LogDouble n);
 
+/// Events instrumenting the hot paths of godzilla itself
+///
+/// They are registered by `init()`, so they exist on every rank and show up in the performance
+/// log even if they never fired. Event IDs are resolved once, so using them costs only a
+/// `PetscLogEventBegin/End` pair, which does nothing when logging is disabled.
+namespace event {
+
+/// Residual assembly (per weak form region)
+extern EventID compute_residual;
+/// Jacobian assembly (per weak form region)
+extern EventID compute_jacobian;
+/// Residual assembly on boundaries
+extern EventID compute_bnd_residual;
+/// Jacobian assembly on boundaries
+extern EventID compute_bnd_jacobian;
+/// Integration of a residual block over cells
+extern EventID integrate_residual;
+/// Integration of a Jacobian block over cells
+extern EventID integrate_jacobian;
+/// Lookup of cell geometry found in the cache
+extern EventID geometry_cache_hit;
+/// Lookup of cell geometry not found in the cache (geometry is computed)
+extern EventID geometry_cache_miss;
+/// Global-to-local vector scatter
+extern EventID global_to_local;
+/// Computation of postprocessors
+extern EventID compute_postprocessors;
+/// Writing of output files
+extern EventID output;
+
+} // namespace event
+
 /// Performance logging stage
 ///
 class Stage {
@@ -192,6 +224,11 @@ public:
     /// @param name Name of the event
     explicit ScopedEvent(const char * name);
     explicit ScopedEvent(String name);
+
+    /// Construct a scoped performance logging event from event ID
+    ///
+    /// @param id ID of a previously registered event
+    explicit ScopedEvent(EventID id);
     virtual ~ScopedEvent();
 };
 
@@ -11,6 +11,7 @@
 namespace godzilla {
 
 class Problem;
+class ReductionBatch;
 
 struct PostprocessorTag {};
 
@@ -31,6 +32,23 @@ public:
     ///
     virtual void compute() = 0;
 
+    /// Compute the local part of the postprocessor value and queue its reductions into `batch`
+    ///
+    /// Used instead of `compute` when postprocessor reductions are batched. The default
+    /// implementation does not support batching and returns `false`, in which case `compute` is
+    /// called instead.
+    ///
+    /// @param batch Batch to queue reductions into
+    /// @return `true` if reductions were queued, `false` otherwise
+    virtual bool compute_local(ReductionBatch & batch);
+
+    /// Finish computation of the postprocessor value from the reduced values
+    ///
+    /// Called after `batch` was reduced, only if `compute_local` returned `true`.
+    ///
+    /// @param batch Reduced batch
+    virtual void finish_compute(const ReductionBatch & batch);
+
     /// Get the computed value
     ///
     /// @return The value computed by the postprocessor
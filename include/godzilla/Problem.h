@@ -20,6 +20,8 @@
 #include "godzilla/FileOutput.h"
 #include "godzilla/Postprocessor.h"
 #include "godzilla/Ref.h"
+#include "godzilla/Qtr.h"
+#include "godzilla/AsyncOutputQueue.h"
 #include <initializer_list>
 
 namespace godzilla {
@@ -102,6 +104,9 @@ public:
     const std::vector<String> & get_postprocessor_names() const;
 
     /// Compute all postprocessors
+    ///
+    /// With `batch_postprocessor_reductions` enabled, postprocessors that support it compute their
+    /// local values first and all their reductions are done with a single collective call.
     void compute_postprocessors();
 
     /// Compute all postprocessors with specified execute on flag
@@ -109,9 +114,20 @@ public:
 
     /// Output
     ///
+    /// With `async_output` enabled, file outputs that support it are written by a background I/O
+    /// thread. Pending writes are flushed on `ExecuteOn::FINAL`.
+    ///
     /// @param mask Bit mask for an output event, see `Output` for valid options.
     void output(ExecuteOn flag);
 
+    /// Wait until all pending asynchronous output is written
+    void flush_output();
+
+    /// Check if file outputs can be written asynchronously
+    ///
+    /// @return `true` if `async_output` is enabled, `false` otherwise
+    bool is_output_async() const;
+
     /// Gets the type of vector created with `create_local_vector` and `create_global_vector`
     ///
     /// @return The vector type
@@ -280,6 +296,39 @@ public:
     /// @param l Local vector
     void global_to_local(const Vector & g, InsertMode mode, Vector & l) const;
 
+    /// Start updating global vector from local vector, finish with `local_to_global_end`
+    ///
+    /// Work that does not touch `l` or `g` can be done between the two calls.
+    ///
+    /// @param l Local vector
+    /// @param mode Insert mode
+    /// @param g Global vector
+    void local_to_global_begin(const Vector & l, InsertMode mode, Vector & g) const;
+
+    /// Finish updating global vector from local vector started by `local_to_global_begin`
+    ///
+    /// @param l Local vector
+    /// @param mode Insert mode
+    /// @param g Global vector
+    void local_to_global_end(const Vector & l, InsertMode mode, Vector & g) const;
+
+    /// Start updating local vector from global vector, finish with `global_to_local_end`
+    ///
+    /// Owned entries of `l` are already updated when this returns, only ghost entries are
+    /// in flight. Work that reads the owned entries can be done between the two calls.
+    ///
+    /// @param g Global vector
+    /// @param mode Insert mode
+    /// @param l Local vector
+    void global_to_local_begin(const Vector & g, InsertMode mode, Vector & l) const;
+
+    /// Finish updating local vector from global vector started by `global_to_local_begin`
+    ///
+    /// @param g Global vector
+    /// @param mode Insert mode
+    /// @param l Local vector
+    void global_to_local_end(const Vector & g, InsertMode mode, Vector & l) const;
+
     /// When `create_matrix` is called, the matrix structure will be created but the array for
     /// numerical values will not be allocated.
     ///
@@ -302,6 +351,11 @@ protected:
     /// Set solution vector
     void set_solution_vector(const Vector & x);
 
+    /// Write a step into a file output, asynchronously if enabled and supported by the output
+    ///
+    /// @param out File output to write into
+    void write_output(FileOutput & out);
+
     virtual ExecuteOnFlags
     default_execute_on(OutputTag) const
     {
@@ -333,6 +387,11 @@ private:
 
     virtual void output_with(FileOutput & out);
 
+    /// Compute postprocessors
+    ///
+    /// @param pps Postprocessors to compute
+    void compute_postprocessors(const std::vector<Postprocessor *> & pps);
+
     /// Mesh
     Optional<Ref<Mesh>> mesh;
 
@@ -355,9 +414,16 @@ private:
     /// List of postprocessor names
     std::vector<String> pps_names;
 
+    /// Batch reductions of postprocessors
+    bool batch_pps;
+
     /// Output monitor
     Delegate<void(String)> output_monitor_delegate;
 
+    /// Queue for asynchronous output (declared after `outputs`, so pending writes finish before
+    /// the outputs are destroyed)
+    Qtr<AsyncOutputQueue> output_queue;
+
 public:
     static Parameters parameters();
 };
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+
+namespace godzilla {
+
+/// Location of the components of a field inside `QuadratureBatch` arrays
+struct BatchField {
+    /// `true` if this is an auxiliary field
+    bool aux;
+    /// Index of the first component of the field
+    Int offset;
+
+    BatchField() : aux(false), offset(-1) {}
+    BatchField(bool aux, Int offset) : aux(aux), offset(offset) {}
+};
+
+/// Field data at a block of quadrature points in structure-of-arrays layout
+///
+/// Entry `k` of a per-point quantity (field component, gradient entry, coordinate) at point `p` is
+/// stored at `[k * n + p]`, so kernels can loop over points with unit stride. Batched functionals
+/// write their results with the same layout.
+struct QuadratureBatch {
+    /// Number of points in the batch
+    Int n;
+    /// Spatial dimension
+    Int dim;
+    /// Time at which the forms are evaluated
+    Real time;
+    /// The multiplier a for dF/dU_t
+    Real u_t_shift;
+    /// Physical coordinates `[dim][n]`
+    const Real * xyz;
+    /// Values of primary fields `[n_comps][n]`
+    const Scalar * u;
+    /// Time derivatives of primary fields `[n_comps][n]`
+    const Scalar * u_t;
+    /// Gradients of primary fields `[n_comps][dim][n]`
+    const Scalar * u_x;
+    /// Values of auxiliary fields `[n_aux_comps][n]`
+    const Scalar * a;
+    /// Gradients of auxiliary fields `[n_aux_comps][dim][n]`
+    const Scalar * a_x;
+
+    /// Get physical coordinate `d` at all points
+    const Real *
+    coord(Int d) const
+    {
+        return this->xyz + d * this->n;
+    }
+
+    /// Get component `c` of a field at all points
+    const Scalar *
+    value(const BatchField & fld, Int c = 0) const
+    {
+        return (fld.aux ? this->a : this->u) + (fld.offset + c) * this->n;
+    }
+
+    /// Get time derivative of component `c` of a field at all points
+    const Scalar *
+    dot(const BatchField & fld, Int c = 0) const
+    {
+        return this->u_t + (fld.offset + c) * this->n;
+    }
+
+    /// Get derivative in direction `d` of component `c` of a field at all points
+    const Scalar *
+    gradient(const BatchField & fld, Int c, Int d) const
+    {
+        return (fld.aux ? this->a_x : this->u_x) + ((fld.offset + c) * this->dim + d) * this->n;
+    }
+};
+
+} // namespace godzilla
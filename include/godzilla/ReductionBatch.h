@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include "mpicpp-lite/mpicpp-lite.h"
+#include <cstddef>
+#include <vector>
+
+namespace mpi = mpicpp_lite;
+
+namespace godzilla {
+
+/// Collects scalar reductions and performs all of them together
+///
+/// Instead of one collective call per value, all queued sums are reduced with a single
+/// `MPI_Allreduce` and all minima and maxima with another one.
+///
+/// ```
+/// ReductionBatch batch(comm);
+/// auto h_time = batch.add_max(time);
+/// auto h_calls = batch.add_sum(n_calls);
+/// batch.reduce();
+/// auto max_time = batch.get(h_time);
+/// ```
+class ReductionBatch {
+public:
+    /// Handle of a queued value
+    using Handle = std::size_t;
+
+    /// Create a batch
+    ///
+    /// @param comm Communicator the reductions are performed over
+    explicit ReductionBatch(mpi::Communicator comm);
+
+    /// Queue a value to be summed over all ranks
+    ///
+    /// @param val Local value
+    /// @return Handle to retrieve the reduced value with
+    Handle add_sum(double val);
+
+    /// Queue a value whose minimum over all ranks is needed
+    ///
+    /// @param val Local value
+    /// @return Handle to retrieve the reduced value with
+    Handle add_min(double val);
+
+    /// Queue a value whose maximum over all ranks is needed
+    ///
+    /// @param val Local value
+    /// @return Handle to retrieve the reduced value with
+    Handle add_max(double val);
+
+    /// Get the number of queued values
+    ///
+    /// @return Number of queued values
+    std::size_t size() const;
+
+    /// Reduce all queued values
+    ///
+    /// This is collective. All ranks must queue the same sequence of reductions.
+    void reduce();
+
+    /// Get a reduced value
+    ///
+    /// @param h Handle returned when the value was queued
+    /// @return Reduced value (valid after `reduce` was called)
+    double get(Handle h) const;
+
+    /// Remove all queued values
+    void clear();
+
+private:
+    enum Operation { SUM, MIN_MAX };
+
+    /// Communicator
+    mpi::Communicator comm;
+    /// Values summed over ranks
+    std::vector<double> sums;
+    /// Minima and negated maxima, so both can be reduced with `MPI_MIN`
+    std::vector<double> min_max;
+    /// [handle] -> (operation, index into `sums` or `min_max`, sign)
+    struct Entry {
+        Operation op;
+        std::size_t idx;
+        double sign;
+    };
+    std::vector<Entry> entries;
+};
+
+} // namespace godzilla
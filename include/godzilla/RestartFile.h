@@ -6,6 +6,7 @@
 #include "godzilla/Enums.h"
 #include "godzilla/Exception.h"
 #include "godzilla/HDF5File.h"
+#include "petscdm.h"
 
 namespace godzilla {
 
@@ -16,12 +17,31 @@ class RestartFile {
 public:
     RestartFile(mpi::Communicator comm, fs::path file_name, FileAccess faccess);
 
+    /// Restart file shared by all ranks of a communicator
+    ///
+    /// @param comm Communicator
+    /// @param file_name Name of the file
+    /// @param faccess Access mode
+    /// @param opts Tuning of the file (MPI-IO hints, alignment, chunking and compression)
+    RestartFile(mpi::Communicator comm,
+                fs::path file_name,
+                FileAccess faccess,
+                const hdf5::FileOptions & opts);
+
     /// Restart file
     ///
     /// @param file_name Name of the file
     /// @param faccess Access mode
     RestartFile(fs::path file_name, FileAccess faccess);
 
+    /// Restart file
+    ///
+    /// @param file_name Name of the file
+    /// @param faccess Access mode
+    /// @param opts Tuning of the file (alignment, chunking and compression), MPI-IO hints are not
+    ///        used
+    RestartFile(fs::path file_name, FileAccess faccess, const hdf5::FileOptions & opts);
+
     /// Write data to the file
     ///
     /// @param path Path to the data
@@ -38,6 +58,19 @@ public:
     /// Write global vector
     void write_global_vector(String app_name, String path, String name, const Vector & data);
 
+    /// Write global vector in the natural ordering of the mesh
+    ///
+    /// The natural ordering is the ordering of the mesh before it was distributed. It does not
+    /// depend on the number of ranks or the partitioning, so the vector can be read back on a
+    /// different number of ranks. Each rank writes only the part it owns.
+    ///
+    /// @param dm DM the vector belongs to
+    void write_natural_vector(String path, String name, DM dm, const Vector & data);
+
+    /// Write global vector in the natural ordering of the mesh
+    void
+    write_natural_vector(String app_name, String path, String name, DM dm, const Vector & data);
+
     /// Read data from the file
     ///
     /// @param path Path to the data
@@ -54,6 +87,18 @@ public:
     /// Read global vector
     void read_global_vector(String app_name, String path, String name, Vector & data) const;
 
+    /// Read global vector stored in the natural ordering of the mesh
+    ///
+    /// Each rank reads only a contiguous chunk of the stored vector, which is then redistributed
+    /// into the partitioning of `dm`.
+    ///
+    /// @param dm DM the vector belongs to
+    void read_natural_vector(String path, String name, DM dm, Vector & data) const;
+
+    /// Read global vector stored in the natural ordering of the mesh
+    void
+    read_natural_vector(String app_name, String path, String name, DM dm, Vector & data) const;
+
     /// Get the name of the file
     ///
     /// @return The name of the file
@@ -64,6 +109,13 @@ public:
     /// @return The path of the file
     [[nodiscard]] fs::path file_path() const;
 
+    /// Get the image of the file, i.e. the bytes the file would have on disk
+    ///
+    /// Useful with `FileAccess::CREATE_IN_MEMORY` to store the file later.
+    ///
+    /// @return File image
+    std::vector<char> get_file_image() const;
+
 protected:
     /// Get the full "path" to the data inside HDF5 file
     ///
@@ -5,15 +5,38 @@
 
 #include "RestartInterface.h"
 #include "godzilla/FileOutput.h"
+#include "godzilla/HDF5File.h"
+#include <vector>
 
 namespace godzilla {
 
+/// Output of restart checkpoints
+///
+/// A checkpoint is written into a temporary file first, which then replaces the previous one by
+/// an atomic rename, so an interrupted write never destroys the last complete checkpoint. The
+/// `num_checkpoints` most recent checkpoints are kept: `<file>.restart.h5` is the newest one,
+/// older ones are `<file>-1.restart.h5`, `<file>-2.restart.h5`, etc.
+///
+/// With asynchronous output enabled on the problem, the restart data are snapshotted into memory
+/// and written to disk by the background I/O thread. This is supported on a single process only.
+///
+/// Large datasets can be chunked and compressed, and the parallel file can be tuned with MPI-IO
+/// hints (see the `chunk_size`, `compression`, `alignment`, `cb_nodes` and
+/// `collective_buffering` parameters).
 class RestartOutput : public FileOutput {
 public:
     explicit RestartOutput(const Parameters & pars);
 
     void create() override;
     void output_step() override;
+    std::function<void()> create_output_task() override;
+    bool is_snapshot_thread_safe() const override;
+
+    /// Get the file name of a checkpoint
+    ///
+    /// @param idx Checkpoint index, 0 is the newest one
+    /// @return File name of the checkpoint
+    fs::path get_checkpoint_file_name(Int idx) const;
 
 private:
     String get_file_ext() const override;
@@ -23,6 +46,14 @@ private:
     Optional<Ref<RestartInterface>> ri;
     /// The file base of the output file
     fs::path file_base;
+    /// Number of checkpoints to keep
+    Int n_checkpoints;
+    /// File names of the checkpoints, newest first
+    std::vector<fs::path> checkpoint_file_names;
+    /// Temporary file the checkpoints are written into
+    fs::path temp_file_name;
+    /// Tuning of the restart file
+    hdf5::FileOptions file_opts;
 
 public:
     static Parameters parameters();
@@ -54,12 +54,36 @@ public:
         }
     }
 
+    /// Set a matrix operation that fills a vector
+    ///
+    /// @param op The matrix operation (`MATOP_GET_DIAGONAL`)
+    /// @param instance The instance of the class
+    /// @param method The method of the class
+    template <class T>
+    void
+    set_operation(MatOperation op, Ref<T> instance, void (T::*method)(Matrix &, Vector &))
+    {
+        if (op == MATOP_GET_DIAGONAL) {
+            this->get_diagonal_delegate.bind(instance, method);
+            PETSC_CHECK(
+                MatShellSetOperation(*this,
+                                     MATOP_GET_DIAGONAL,
+                                     (void (*)()) ShellMatrix::invoke_get_diagonal_op_delegate));
+        }
+        else {
+            throw Exception(fmt::format("Unsupported operation: {}", static_cast<int>(op)));
+        }
+    }
+
 private:
     /// The delegate for the matrix-vector multiplication operation
     Delegate<void(Matrix & A, Vector & x_vec, Vector & y_vec)> mult_delegate;
+    /// The delegate for extracting the diagonal
+    Delegate<void(Matrix & A, Vector & diag)> get_diagonal_delegate;
 
 public:
     static PetscErrorCode invoke_matmult_op_delegate(Mat matrix, Vec vector, Vec action);
+    static PetscErrorCode invoke_get_diagonal_op_delegate(Mat matrix, Vec diagonal);
 };
 
 } // namespace godzilla
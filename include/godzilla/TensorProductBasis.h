@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include "petscfe.h"
+#include <vector>
+
+namespace godzilla {
+
+/// Sum-factorized evaluation of a tensor-product Lagrange basis on quadrilaterals and hexahedra
+///
+/// Basis functions and quadrature points of such elements are products of 1D ones. Values and
+/// gradients at all quadrature points (and integrals against all test functions) are then computed
+/// one dimension at a time, which costs O(p^(d+1)) per element instead of O(p^(2d)) with the dense
+/// tabulation.
+///
+/// Gradients are in reference coordinates, i.e. they still need to be mapped into the physical
+/// space with the inverse of the cell Jacobian.
+class TensorProductBasis {
+public:
+    TensorProductBasis();
+
+    /// Factorize the basis of a finite element
+    ///
+    /// The factorization is checked against the tabulation of `fe` at its quadrature points.
+    ///
+    /// @param fe Finite element
+    /// @return `true` if `fe` factorizes, `false` otherwise (this object is then not valid)
+    bool create(PetscFE fe);
+
+    /// Check if the factorization is valid
+    bool is_valid() const;
+
+    /// Get spatial dimension
+    Int get_dimension() const;
+
+    /// Get number of basis functions of the element
+    Int get_num_basis() const;
+
+    /// Get number of components
+    Int get_num_components() const;
+
+    /// Get number of quadrature points of the element
+    Int get_num_qpoints() const;
+
+    /// Get size of the scratch space needed by `interpolate` and `integrate`
+    Int get_work_size() const;
+
+    /// Get the component of a basis function
+    ///
+    /// @param b Basis function
+    /// @return The only component in which `b` is nonzero
+    Int get_component(Int b) const;
+
+    /// Evaluate one basis function at all quadrature points
+    ///
+    /// @param b Basis function
+    /// @param val Values of component `get_component(b)`, `val[q]`
+    /// @param grad_ref Reference gradients of component `get_component(b)`, `grad_ref[q * dim + d]`
+    void tabulate(Int b, Real val[], Real grad_ref[]) const;
+
+    /// Evaluate a function at all quadrature points
+    ///
+    /// @param coefs Coefficients of the basis functions
+    /// @param u Values, `u[q * n_comp + c]`
+    /// @param u_ref Reference gradients, `u_ref[(q * n_comp + c) * dim + d]` (can be `nullptr`)
+    /// @param work Scratch space with at least `get_work_size()` entries
+    void interpolate(const Scalar coefs[], Scalar u[], Scalar u_ref[], Scalar work[]) const;
+
+    /// Integrate against all test functions
+    ///
+    /// Computes `elem_vec[b] += sum_q (phi_b(q) f0(q) + grad phi_b(q) . f1_ref(q))`.
+    ///
+    /// @param f0 Values multiplying test functions, `f0[q * n_comp + c]` (can be `nullptr`)
+    /// @param f1_ref Values multiplying reference gradients of test functions,
+    ///        `f1_ref[(q * n_comp + c) * dim + d]` (can be `nullptr`)
+    /// @param elem_vec Element vector to add into
+    /// @param work Scratch space with at least `get_work_size()` entries
+    void
+    integrate(const Scalar f0[], const Scalar f1_ref[], Scalar elem_vec[], Scalar work[]) const;
+
+private:
+    /// Apply a 1D operator along one axis of a tensor
+    ///
+    /// @param M 1D operator stored as `M[q * n_b1 + b]`
+    /// @param transpose Apply `M^T` (points to basis) instead of `M` (basis to points)
+    /// @param axis Axis to contract
+    /// @param shape Shape of the tensor, updated to the shape of `out`
+    /// @param in Input tensor (axis 0 is the fastest)
+    /// @param out Output tensor
+    void contract(const std::vector<Real> & M,
+                  bool transpose,
+                  Int axis,
+                  Int shape[],
+                  const Scalar in[],
+                  Scalar out[]) const;
+
+    /// Spatial dimension
+    Int dim;
+    /// Number of components
+    Int n_comp;
+    /// Number of 1D basis functions
+    Int n_b1;
+    /// Number of 1D quadrature points
+    Int n_q1;
+    /// 1D basis functions at 1D quadrature points, `B[q * n_b1 + b]`
+    std::vector<Real> B;
+    /// Derivatives of 1D basis functions at 1D quadrature points, `D[q * n_b1 + b]`
+    std::vector<Real> D;
+    /// Lexicographic index of the node of each basis function
+    std::vector<Int> node;
+    /// Component of each basis function
+    std::vector<Int> comp;
+    /// Lexicographic index of each quadrature point
+    std::vector<Int> qpoint;
+};
+
+} // namespace godzilla
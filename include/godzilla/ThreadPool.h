@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "godzilla/Types.h"
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace godzilla {
+
+/// Get the slot of the calling thread
+///
+/// The main thread (and any thread not owned by a `ThreadPool`) has slot 0. Worker threads of a
+/// `ThreadPool` have slots 1 through N, where N is the number of workers in the pool.
+///
+/// @return Slot of the calling thread
+Int get_thread_slot();
+
+/// Fixed-size pool of worker threads for fork-join style loops
+///
+/// Workers are created once and parked between `parallel_for` calls, so dispatching work does not
+/// pay for thread creation.
+class ThreadPool {
+public:
+    /// Create a pool
+    ///
+    /// @param n_threads Number of worker threads. With zero workers, `parallel_for` runs on the
+    ///        calling thread.
+    explicit ThreadPool(Int n_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    /// Get the number of worker threads
+    ///
+    /// @return Number of worker threads
+    Int get_num_threads() const;
+
+    /// Change the number of worker threads
+    ///
+    /// @param n_threads New number of worker threads
+    void resize(Int n_threads);
+
+    /// Call `fn(i)` for every `i` in `[0, n)` and wait until all calls finish
+    ///
+    /// Items are handed out to the workers dynamically. If any call throws, the first exception is
+    /// re-thrown on the calling thread after all workers are done.
+    ///
+    /// @param n Number of work items
+    /// @param fn Function to call for each work item
+    void parallel_for(Int n, const std::function<void(Int)> & fn);
+
+private:
+    void start(Int n_threads);
+    void stop();
+    /// Worker loop
+    ///
+    /// @param slot Slot of the worker thread
+    /// @param seen Generation of the last job dispatched before the worker was started
+    void worker(Int slot, std::uint64_t seen);
+
+    /// Worker threads
+    std::vector<std::thread> threads;
+    /// Guards all the members below
+    std::mutex mutex;
+    /// Signals workers that a new job is available (or that they should exit)
+    std::condition_variable work_cv;
+    /// Signals the dispatching thread that all workers finished the job
+    std::condition_variable done_cv;
+    /// Current job
+    const std::function<void(Int)> * job;
+    /// Number of items in the current job
+    Int n_items;
+    /// Next item to hand out
+    Int next_item;
+    /// Number of workers still working on the current job
+    Int n_active;
+    /// Incremented with every dispatched job
+    std::uint64_t generation;
+    /// Tells the workers to exit
+    bool quit;
+    /// First exception thrown by the current job
+    std::exception_ptr error;
+};
+
+} // namespace godzilla
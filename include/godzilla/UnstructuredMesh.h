@@ -24,6 +24,63 @@ class Partitioner;
 ///
 class UnstructuredMesh : public Mesh {
 public:
+    /// Cell-vertex connectivity of all (interior) cells in compressed sparse row format
+    struct CellConnectivity {
+        /// Cells in this connectivity
+        Range cells;
+        /// Offsets into `vertices`, one per cell plus one
+        std::vector<Int> offsets;
+        /// Vertices of the cells (mesh points)
+        std::vector<Int> vertices;
+
+        /// Get vertices of a cell
+        ///
+        /// @param cell Cell (must be in `cells`)
+        /// @return Vertices of the cell
+        Span<const Int>
+        operator[](Int cell) const
+        {
+            auto i = cell - this->cells.first();
+            return { this->vertices.data() + this->offsets[i],
+                     this->offsets[i + 1] - this->offsets[i] };
+        }
+    };
+
+    /// Read-only view of local vertex coordinates
+    ///
+    /// Holds the array of the local coordinate vector for as long as the view exists.
+    class VertexCoordinates {
+    public:
+        explicit VertexCoordinates(const UnstructuredMesh & mesh);
+
+        /// Get coordinates of a vertex
+        ///
+        /// @param vertex Vertex (mesh point)
+        /// @return Pointer to `dim` coordinates of the vertex
+        const Real *
+        operator[](Int vertex) const
+        {
+            return this->array.data() + (vertex - this->v_start) * this->dim;
+        }
+
+        /// Get the coordinate dimension
+        Int
+        get_dim() const
+        {
+            return this->dim;
+        }
+
+    private:
+        /// Local coordinate vector
+        Vector coords;
+        /// Borrowed array of `coords`
+        VectorBorrowedArrayRead array;
+        /// Coordinate dimension
+        Int dim;
+        /// First vertex
+        Int v_start;
+    };
+
     explicit UnstructuredMesh(mpi::Communicator comm);
     explicit UnstructuredMesh(DM dm);
 
@@ -126,6 +183,19 @@ public:
     /// @return Point connectivity
     std::vector<Int> get_connectivity(Int point) const;
 
+    /// Get connectivity of all interior cells
+    ///
+    /// The connectivity is built in one pass on the first call and cached for the `DM` (its ID and
+    /// object state) it was built from.
+    ///
+    /// @return Cell-vertex connectivity
+    const CellConnectivity & get_cell_connectivity() const;
+
+    /// Get a view of local vertex coordinates
+    ///
+    /// @return Read-only view of local vertex coordinates
+    VertexCoordinates get_vertex_coordinates() const;
+
     /// Return the points on the out-edges for this point
     ///
     /// @param point Point with must lie in the chart
@@ -320,6 +390,32 @@ public:
     /// @return `true` if the mesh is distributed, `false` otherwise
     bool is_distributed() const;
 
+    /// Find out whether the ordering of the mesh before distribution is known
+    ///
+    /// @return `true` if the mesh is not distributed or it was distributed by `distribute`, `false`
+    ///         if it was created already distributed (e.g. read in parallel)
+    bool has_natural_ordering() const;
+
+    /// Ordering of mesh points used by `reorder`
+    enum class Ordering {
+        /// Reverse Cuthill-McKee ordering of the cell dual graph
+        RCM,
+        /// Cells ordered along a Hilbert curve through their centroids
+        HILBERT
+    };
+
+    /// Renumber local mesh points to improve memory locality during assembly
+    ///
+    /// Cells are renumbered by `ordering`, and faces, edges and vertices in the order they appear
+    /// in the closures of the renumbered cells. Labels, coordinates and the point star forest
+    /// follow the new numbering. Call this after `distribute` and before ghost cells are
+    /// constructed or any problem is set up on this mesh, so sections created later (and with them
+    /// the DOF numbering) follow the new numbering. Reordering a mesh that already has fields or a
+    /// local section is an error.
+    ///
+    /// @param ordering Ordering to use
+    void reorder(Ordering ordering);
+
     /// Construct ghost cells which connect to every boundary face
     ///
     void construct_ghost_cells();
@@ -413,6 +509,12 @@ private:
     /// Vertex set IDs
     std::map<String, Int> vertex_set_ids;
 
+    /// Cached cell connectivity
+    mutable CellConnectivity connectivity;
+    /// ID and state of the DM `connectivity` was built for
+    mutable PetscObjectId connectivity_dm_id = 0;
+    mutable PetscObjectState connectivity_dm_state = 0;
+
 public:
     static int get_num_cell_nodes(PolytopeType cell_type);
 
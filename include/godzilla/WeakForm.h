@@ -39,6 +39,13 @@ public:
             else
                 return this->label < other.label;
         }
+
+        bool
+        operator==(const Region & other) const
+        {
+            return this->label == other.label && this->value == other.value &&
+                   this->part == other.part;
+        }
     };
 
     struct JacobianFieldID {
@@ -228,6 +235,11 @@ public:
     /// @return `true` if weak form for Jacobian preconditioner statement is set, otherwise `false`
     bool has_jacobian_preconditioner() const;
 
+    /// Query if boundary Jacobian statement is set
+    ///
+    /// @return `true` if weak form for boundary Jacobian statement is set, otherwise `false`
+    bool has_bnd_jacobian() const;
+
 private:
     /// All residual forms
     std::array<std::map<Key, std::vector<ResidualFunc *>>, PETSC_NUM_WF> res_forms;
@@ -10,9 +10,11 @@
 #include "godzilla/Utils.h"
 #include "godzilla/Logger.h"
 #include "godzilla/Assert.h"
+#include "godzilla/ReductionBatch.h"
 #include "yaml-cpp/yaml.h"
 #include "fmt/chrono.h"
 #include <source_location>
+#include <sstream>
 
 namespace YAML {
 
@@ -59,6 +61,61 @@ check_app_name(String name, std::source_location loc)
     return name;
 }
 
+/// Build a list of performance logging events that is the same on all ranks
+///
+/// Events can be registered on some ranks only (e.g. by code executed on a subset of ranks), so
+/// the local lists can differ in length and order. Statistics of all events are reduced in a
+/// single batch, so every rank has to contribute the same events in the same order.
+///
+/// @param comm Communicator
+/// @return Event IDs in the order agreed on by all ranks
+std::vector<perf_log::EventID>
+agree_on_perf_log_events(mpi::Communicator comm)
+{
+    auto & ids = perf_log::registered_event_ids();
+    std::string names;
+    for (auto & id : ids)
+        names += fmt::format("{}\n", perf_log::Event(id).name());
+
+    ReductionBatch batch(comm);
+    auto n = static_cast<double>(ids.size());
+    // drop bits that do not fit into the mantissa of a double
+    auto digest = static_cast<double>(std::hash<std::string> {}(names) >> 11);
+    auto n_min = batch.add_min(n);
+    auto n_max = batch.add_max(n);
+    auto digest_min = batch.add_min(digest);
+    auto digest_max = batch.add_max(digest);
+    batch.reduce();
+    if (batch.get(n_min) == batch.get(n_max) && batch.get(digest_min) == batch.get(digest_max))
+        return ids;
+
+    // gather the event names of all ranks in one go
+    int n_chars = static_cast<int>(names.size());
+    std::vector<int> counts(comm.size());
+    MPI_Allgather(&n_chars, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+    std::vector<int> displs(comm.size(), 0);
+    for (int r = 1; r < comm.size(); ++r)
+        displs[r] = displs[r - 1] + counts[r - 1];
+    std::string all_names(displs.back() + counts.back(), '\0');
+    MPI_Allgatherv(names.data(),
+                   n_chars,
+                   MPI_CHAR,
+                   all_names.data(),
+                   counts.data(),
+                   displs.data(),
+                   MPI_CHAR,
+                   comm);
+
+    // union in the order of ranks, so it is the same everywhere; register the missing events
+    std::vector<perf_log::EventID> agreed_ids;
+    std::unordered_set<std::string> seen;
+    std::istringstream iss(all_names);
+    for (std::string name; std::getline(iss, name);)
+        if (seen.insert(name).second)
+            agreed_ids.push_back(perf_log::Event(name).get_id());
+    return agreed_ids;
+}
+
 } // namespace
 
 Registry registry;
@@ -235,11 +292,18 @@ App::write_perf_log(const fs::path & file_name, std::chrono::duration<double> ru
     CALL_STACK_MSG();
     auto comm = get_comm();
 
-    auto build_stat_node = [&](double val) {
-        double min, max, tot;
-        comm.all_reduce(val, min, mpi::op::min<double>());
-        comm.all_reduce(val, max, mpi::op::max<double>());
-        comm.all_reduce(val, tot, mpi::op::sum<double>());
+    // all statistics are reduced together, see below
+    ReductionBatch batch(comm);
+    struct Stat {
+        ReductionBatch::Handle min, max, sum;
+    };
+    auto add_stat = [&](double val) {
+        return Stat { batch.add_min(val), batch.add_max(val), batch.add_sum(val) };
+    };
+    auto build_stat_node = [&](const Stat & stat) {
+        auto min = batch.get(stat.min);
+        auto max = batch.get(stat.max);
+        auto tot = batch.get(stat.sum);
         auto ratio = utils::ratio(max, min);
         YAML::Node ynode;
         ynode["max"] = max;
@@ -248,6 +312,26 @@ App::write_perf_log(const fs::path & file_name, std::chrono::duration<double> ru
         return ynode;
     };
 
+    struct EventStats {
+        perf_log::Event evt;
+        Stat calls, time, flops;
+        ReductionBatch::Handle n_msgs, msg_len, n_reducts;
+    };
+    auto run_time_stat = add_stat(run_time.count());
+    std::vector<EventStats> event_stats;
+    for (auto & id : agree_on_perf_log_events(comm)) {
+        perf_log::Event evt(id);
+        auto nfo = evt.info();
+        event_stats.push_back({ evt,
+                                add_stat(nfo.num_calls()),
+                                add_stat(nfo.time()),
+                                add_stat(nfo.flops()),
+                                batch.add_sum(nfo.num_messages()),
+                                batch.add_sum(nfo.messages_length()),
+                                batch.add_sum(nfo.num_reductions()) });
+    }
+    batch.reduce();
+
     YAML::Node yperflog;
     // info section
     {
@@ -280,7 +364,7 @@ App::write_perf_log(const fs::path & file_name, std::chrono::duration<double> ru
         YAML::Node yglobal;
 
         YAML::Node ytime;
-        yglobal["time"] = build_stat_node(run_time.count());
+        yglobal["time"] = build_stat_node(run_time_stat);
 
         yperflog["global"] = yglobal;
     }
@@ -288,22 +372,16 @@ App::write_perf_log(const fs::path & file_name, std::chrono::duration<double> ru
     {
         YAML::Node yevents(YAML::NodeType::Sequence);
 
-        auto & event_ids = perf_log::registered_event_ids();
-        for (auto & id : event_ids) {
-            perf_log::Event evt(id);
-            auto nfo = evt.info();
+        for (auto & es : event_stats) {
             YAML::Node yevent;
-            yevent["name"] = evt.name();
-            yevent["calls"] = build_stat_node(nfo.num_calls());
-            yevent["time"] = build_stat_node(nfo.time());
-            yevent["flops"] = build_stat_node(nfo.flops());
-
-            perf_log::LogDouble n_msgs;
-            comm.all_reduce(nfo.num_messages(), n_msgs, mpi::op::sum<perf_log::LogDouble>());
-            perf_log::LogDouble msg_len;
-            comm.all_reduce(nfo.messages_length(), msg_len, mpi::op::sum<perf_log::LogDouble>());
-            perf_log::LogDouble n_reducts;
-            comm.all_reduce(nfo.num_reductions(), n_reducts, mpi::op::sum<perf_log::LogDouble>());
+            yevent["name"] = es.evt.name();
+            yevent["calls"] = build_stat_node(es.calls);
+            yevent["time"] = build_stat_node(es.time);
+            yevent["flops"] = build_stat_node(es.flops);
+
+            auto n_msgs = batch.get(es.n_msgs);
+            auto msg_len = batch.get(es.msg_len);
+            auto n_reducts = batch.get(es.n_reducts);
 
             // see `PetscLogHandlerView_Default_Info` in PETSc
             n_msgs *= 0.5;
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/AsyncOutputQueue.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Assert.h"
+
+namespace godzilla {
+
+AsyncOutputQueue::AsyncOutputQueue(Int max_depth) : max_depth(max_depth), quit(false)
+{
+    CALL_STACK_MSG();
+    expect_true(max_depth > 0, "Queue depth must be positive");
+    this->thread = std::thread(&AsyncOutputQueue::worker, this);
+}
+
+AsyncOutputQueue::~AsyncOutputQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->quit = true;
+    }
+    this->work_cv.notify_one();
+    this->thread.join();
+}
+
+Int
+AsyncOutputQueue::get_max_depth() const
+{
+    CALL_STACK_MSG();
+    return this->max_depth;
+}
+
+void
+AsyncOutputQueue::push(std::function<void()> task)
+{
+    CALL_STACK_MSG();
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->done_cv.wait(lock,
+                           [this] { return (Int) this->tasks.size() < this->max_depth; });
+        rethrow_error();
+        this->tasks.push_back(std::move(task));
+    }
+    this->work_cv.notify_one();
+}
+
+void
+AsyncOutputQueue::flush()
+{
+    CALL_STACK_MSG();
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->done_cv.wait(lock, [this] { return this->tasks.empty(); });
+    rethrow_error();
+}
+
+void
+AsyncOutputQueue::rethrow_error()
+{
+    if (this->error) {
+        auto err = this->error;
+        this->error = nullptr;
+        std::rethrow_exception(err);
+    }
+}
+
+void
+AsyncOutputQueue::worker()
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        // pending tasks are finished before exiting
+        this->work_cv.wait(lock, [this] { return this->quit || !this->tasks.empty(); });
+        if (this->tasks.empty())
+            return;
+        auto & task = this->tasks.front();
+        lock.unlock();
+        try {
+            task();
+        }
+        catch (...) {
+            lock.lock();
+            if (!this->error)
+                this->error = std::current_exception();
+            lock.unlock();
+        }
+        lock.lock();
+        // task is destroyed here, so the data it holds is released before anyone is notified
+        this->tasks.pop_front();
+        this->done_cv.notify_all();
+    }
+}
+
+} // namespace godzilla
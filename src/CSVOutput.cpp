@@ -8,6 +8,7 @@
 #include "fmt/printf.h"
 #include <cstring>
 #include <cerrno>
+#include <iterator>
 
 namespace godzilla {
 
@@ -15,10 +16,22 @@ Parameters
 CSVOutput::parameters()
 {
     auto params = FileOutput::parameters();
+    params.add_param<Int>("flush_interval",
+                          100,
+                          "Number of rows to buffer before writing them into the file");
     return params;
 }
 
-CSVOutput::CSVOutput(const Parameters & pars) : FileOutput(pars), f(nullptr), has_header(false) {}
+CSVOutput::CSVOutput(const Parameters & pars) :
+    FileOutput(pars),
+    f(nullptr),
+    has_header(false),
+    flush_interval(pars.get<Int>("flush_interval")),
+    n_buffered_rows(0)
+{
+    CALL_STACK_MSG();
+    expect_true(this->flush_interval > 0, "The 'flush_interval' parameter must be positive.");
+}
 
 CSVOutput::~CSVOutput()
 {
@@ -33,6 +46,11 @@ CSVOutput::create()
     FileOutput::create();
 
     this->pps_names = get_problem()->get_postprocessor_names();
+    this->pps.clear();
+    for (auto & name : this->pps_names) {
+        auto pp = get_problem()->get_postprocessor(name).value();
+        this->pps.push_back(&pp.get());
+    }
 
     if (!this->pps_names.empty())
         open_file();
@@ -57,6 +75,8 @@ CSVOutput::output_step()
         this->has_header = true;
     }
     write_values(get_problem()->get_time());
+    if (this->n_buffered_rows >= this->flush_interval)
+        flush_rows();
 }
 
 void
@@ -73,24 +93,57 @@ void
 CSVOutput::write_header()
 {
     CALL_STACK_MSG();
-    fmt::print(this->f, "time");
-    for (auto & name : this->pps_names)
-        fmt::print(this->f, ",{}", name);
-    fmt::print(this->f, "\n");
+    // vector-valued postprocessors get one column per component
+    auto out = std::back_inserter(this->buffer);
+    fmt::format_to(out, "time");
+    this->pps_n_cols.resize(this->pps.size());
+    for (std::size_t i = 0; i < this->pps.size(); ++i) {
+        auto n = this->pps[i]->get_value().size();
+        this->pps_n_cols[i] = n;
+        if (n == 1)
+            fmt::format_to(out, ",{}", this->pps_names[i]);
+        else
+            for (std::size_t j = 0; j < n; ++j)
+                fmt::format_to(out, ",{}_{}", this->pps_names[i], j);
+    }
+    fmt::format_to(out, "\n");
 }
 
 void
 CSVOutput::write_values(Real time)
 {
     CALL_STACK_MSG();
-    fmt::print(this->f, "{:g}", time);
-    for (auto & name : this->pps_names) {
-        auto pps = get_problem()->get_postprocessor(name).value();
-        auto vals = pps->get_value();
-        // FIXME: store all components
-        fmt::print(this->f, ",{:g}", vals[0]);
+    auto out = std::back_inserter(this->buffer);
+    fmt::format_to(out, "{:g}", time);
+    for (std::size_t i = 0; i < this->pps.size(); ++i) {
+        auto vals = this->pps[i]->get_value();
+        if (vals.size() != this->pps_n_cols[i])
+            error("Postprocessor '{}' changed its number of values from {} to {}.",
+                  this->pps_names[i],
+                  this->pps_n_cols[i],
+                  vals.size());
+        for (auto & v : vals)
+            fmt::format_to(out, ",{:g}", v);
+    }
+    fmt::format_to(out, "\n");
+    ++this->n_buffered_rows;
+}
+
+void
+CSVOutput::flush_rows()
+{
+    CALL_STACK_MSG();
+    if (this->f != nullptr && this->buffer.size() > 0) {
+        auto n = fwrite(this->buffer.data(), 1, this->buffer.size(), this->f);
+        if (n != this->buffer.size() || fflush(this->f) != 0)
+            error("Failed to write into '{}' ({} of {} bytes written): {}.",
+                  get_file_name().string(),
+                  n,
+                  this->buffer.size(),
+                  strerror(errno));
     }
-    fmt::print(this->f, "\n");
+    this->buffer.clear();
+    this->n_buffered_rows = 0;
 }
 
 void
@@ -98,6 +151,7 @@ CSVOutput::close_file()
 {
     CALL_STACK_MSG();
     if (this->f != nullptr) {
+        flush_rows();
         fclose(this->f);
         this->f = nullptr;
     }
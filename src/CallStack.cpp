@@ -10,8 +10,8 @@
 namespace godzilla {
 namespace internal {
 
-// global instance of the call stack object
-static CallStack call_stack;
+// call stack object, one per thread so that worker threads do not trample each other's frames
+static thread_local CallStack call_stack;
 
 } // namespace internal
 
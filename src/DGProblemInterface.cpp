@@ -493,6 +493,7 @@ DGProblemInterface::set_up_section_constraint_indicies(Section & section)
     auto depth_label = unstr_mesh->get_depth_label();
     auto dim = unstr_mesh->get_dimension();
     auto all_facets = depth_label.get_stratum(dim - 1);
+    const auto & cell_conn = unstr_mesh->get_cell_connectivity();
 
     for (auto & bnd : get_essential_bcs()) {
         auto components = bnd->get_components();
@@ -513,13 +514,13 @@ DGProblemInterface::set_up_section_constraint_indicies(Section & section)
                         support.size() == 1,
                         "Internal facet cannot be included in a boundary face set");
                     auto fconn = unstr_mesh->get_connectivity(facet);
-                    auto econn = unstr_mesh->get_connectivity(support[0]);
+                    auto econn = cell_conn[support[0]];
 
                     auto cell_id = support[0];
                     auto n_nodes_per_elem = (Int) econn.size();
                     std::vector<Int> indices;
                     for (std::size_t j = 0; j < fconn.size(); ++j) {
-                        auto local_node_idx = utils::index_of(econn, fconn[j]);
+                        auto local_node_idx = utils::index_of<Int>(econn, fconn[j]);
                         for (Int k = 0; k < components.size(); ++k) {
                             auto c = components[k];
                             indices.push_back((c * n_nodes_per_elem) + local_node_idx);
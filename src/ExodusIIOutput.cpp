@@ -22,6 +22,9 @@ ExodusIIOutput::parameters()
 {
     auto params = FileOutput::parameters();
     params.add_param<bool>("append", false, "Append into an existing exodusII file");
+    params.add_param<bool>("single_file",
+                           false,
+                           "Write a single file from all ranks instead of a file per rank");
     params.add_param<std::vector<String>>(
         "variables",
         std::vector<String> {},
@@ -34,9 +37,11 @@ ExodusIIOutput::ExodusIIOutput(const Parameters & pars) :
     dpi(dynamic_ref_cast<DiscreteProblemInterface>(pars.get<Ref<Problem>>("_problem"))),
     mesh(dpi->get_mesh()),
     append(pars.get<bool>("append")),
+    single_file(pars.get<bool>("single_file")),
     variable_names(pars.get<std::vector<String>>("variables"), {}),
     step_num(1),
-    mesh_stored(false)
+    mesh_stored(false),
+    step_data_pool(std::make_shared<StepDataPool>())
 {
     CALL_STACK_MSG();
 }
@@ -46,6 +51,8 @@ ExodusIIOutput::~ExodusIIOutput()
     CALL_STACK_MSG();
     if (this->exo)
         this->exo->close();
+    if (this->pexo)
+        this->pexo->close();
 }
 
 String
@@ -55,12 +62,29 @@ ExodusIIOutput::get_file_ext() const
     return { "exo" };
 }
 
+fs::path
+ExodusIIOutput::create_file_name() const
+{
+    CALL_STACK_MSG();
+    if (this->single_file)
+        return fmt::format("{}.{}", get_file_base(), get_file_ext());
+    else
+        return FileOutput::create_file_name();
+}
+
 void
 ExodusIIOutput::create()
 {
     CALL_STACK_MSG();
     FileOutput::create();
 
+    if (this->single_file) {
+        if (this->append)
+            error("Parameter 'append' is not supported together with 'single_file'.");
+        if (try_dynamic_ref_cast<const DGProblemInterface>(get_problem()).has_value())
+            error("Parameter 'single_file' is not supported for DG problems.");
+    }
+
     auto flds = this->dpi->get_field_names();
     auto aux_flds = this->dpi->get_aux_field_names();
     auto & pps = get_problem()->get_postprocessor_names();
@@ -136,7 +160,9 @@ void
 ExodusIIOutput::output_step()
 {
     CALL_STACK_MSG();
-    if (auto dgpi = try_dynamic_ref_cast<const DGProblemInterface>(get_problem());
+    if (this->single_file)
+        output_step_single_file();
+    else if (auto dgpi = try_dynamic_ref_cast<const DGProblemInterface>(get_problem());
         dgpi.has_value()) {
         output_step(*dgpi.value());
     }
@@ -145,6 +171,77 @@ ExodusIIOutput::output_step()
     }
 }
 
+std::function<void()>
+ExodusIIOutput::create_output_task()
+{
+    CALL_STACK_MSG();
+    if (this->single_file || this->exo == nullptr || !this->mesh_stored)
+        return {};
+    if (try_dynamic_ref_cast<const DGProblemInterface>(get_problem()).has_value())
+        return {};
+
+    auto data = get_free_step_data();
+    Real time = get_problem()->get_time();
+    data->start(this->step_num, time);
+    for (auto [fid, exo_var_id] : this->nodal_var_fids)
+        io::write_field_values(*data,
+                               *this->dpi,
+                               this->step_num,
+                               time,
+                               fid,
+                               exo_var_id,
+                               this->values);
+    for (auto [fid, exo_var_id] : this->nodal_aux_var_fids)
+        io::write_aux_field_values(*data,
+                                   *this->dpi,
+                                   this->step_num,
+                                   time,
+                                   fid,
+                                   exo_var_id,
+                                   this->values);
+    for (auto [fid, exo_var_id] : this->elem_var_fids)
+        io::write_elemental_field_values(*data,
+                                         *this->dpi,
+                                         this->step_num,
+                                         time,
+                                         fid,
+                                         exo_var_id,
+                                         this->values);
+    for (auto [fid, exo_var_id] : this->elem_aux_var_fids)
+        io::write_aux_elemental_field_values(*data,
+                                             *this->dpi,
+                                             this->step_num,
+                                             time,
+                                             fid,
+                                             exo_var_id,
+                                             this->values);
+    data->write_global_vars(get_global_values());
+
+    ++this->step_num;
+
+    auto exo = this->exo.get();
+    return [exo, data, pool = this->step_data_pool]() {
+        data->write(*exo);
+        exo->update();
+        // the mutex orders this task's reads of `data` before the next snapshot overwrites it
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->free.push_back(data);
+    };
+}
+
+std::shared_ptr<io::StepData>
+ExodusIIOutput::get_free_step_data()
+{
+    CALL_STACK_MSG();
+    std::lock_guard<std::mutex> lock(this->step_data_pool->mutex);
+    auto & free = this->step_data_pool->free;
+    if (free.empty())
+        return std::make_shared<io::StepData>();
+    auto data = std::move(free.back());
+    free.pop_back();
+    return data;
+}
+
 void
 ExodusIIOutput::output_step(const DiscreteProblemInterface & iface)
 {
@@ -163,10 +260,22 @@ ExodusIIOutput::output_step(const DiscreteProblemInterface & iface)
     this->exo->write_time(this->step_num, time);
 
     for (auto [fid, exo_var_id] : this->nodal_var_fids) {
-        io::write_field_values(*this->exo, iface, this->step_num, time, fid, exo_var_id);
+        io::write_field_values(*this->exo,
+                               iface,
+                               this->step_num,
+                               time,
+                               fid,
+                               exo_var_id,
+                               this->values);
     }
     for (auto [fid, exo_var_id] : this->nodal_aux_var_fids) {
-        io::write_aux_field_values(*this->exo, iface, this->step_num, time, fid, exo_var_id);
+        io::write_aux_field_values(*this->exo,
+                                   iface,
+                                   this->step_num,
+                                   time,
+                                   fid,
+                                   exo_var_id,
+                                   this->values);
     }
 
     write_elem_variables();
@@ -195,10 +304,22 @@ ExodusIIOutput::output_step(const DGProblemInterface & dgpi)
     this->exo->write_time(this->step_num, time);
 
     for (auto [fid, exo_var_id] : this->nodal_var_fids) {
-        io::write_field_values(*this->exo, dgpi, this->step_num, time, fid, exo_var_id);
+        io::write_field_values(*this->exo,
+                               dgpi,
+                               this->step_num,
+                               time,
+                               fid,
+                               exo_var_id,
+                               this->values);
     }
     for (auto [fid, exo_var_id] : this->nodal_aux_var_fids) {
-        io::write_aux_field_values(*this->exo, dgpi, this->step_num, time, fid, exo_var_id);
+        io::write_aux_field_values(*this->exo,
+                                   dgpi,
+                                   this->step_num,
+                                   time,
+                                   fid,
+                                   exo_var_id,
+                                   this->values);
     }
 
     write_elem_variables();
@@ -209,6 +330,61 @@ ExodusIIOutput::output_step(const DGProblemInterface & dgpi)
     ++this->step_num;
 }
 
+void
+ExodusIIOutput::output_step_single_file()
+{
+    CALL_STACK_MSG();
+    if (this->pexo == nullptr)
+        this->pexo = Qtr<ParallelExodusIIFile>::alloc(get_comm(), get_file_name());
+
+    if (!this->mesh_stored) {
+        this->mesh_stored = true;
+        this->pexo->write_info({ get_created_by() });
+        this->pexo->write_mesh(*this->mesh);
+        std::vector<std::string> nodal_var_names;
+        std::vector<std::string> elem_var_names;
+        get_all_variable_names(nodal_var_names, elem_var_names);
+        this->pexo->write_var_names(nodal_var_names, elem_var_names, this->global_var_names);
+    }
+
+    Real time = get_problem()->get_time();
+    this->pexo->write_time(this->step_num, time);
+
+    for (auto [fid, exo_var_id] : this->nodal_var_fids)
+        io::write_field_values(*this->pexo,
+                               *this->dpi,
+                               this->step_num,
+                               fid,
+                               exo_var_id,
+                               this->values);
+    for (auto [fid, exo_var_id] : this->nodal_aux_var_fids)
+        io::write_aux_field_values(*this->pexo,
+                                   *this->dpi,
+                                   this->step_num,
+                                   fid,
+                                   exo_var_id,
+                                   this->values);
+    for (auto [fid, exo_var_id] : this->elem_var_fids)
+        io::write_elemental_field_values(*this->pexo,
+                                         *this->dpi,
+                                         this->step_num,
+                                         fid,
+                                         exo_var_id,
+                                         this->values);
+    for (auto [fid, exo_var_id] : this->elem_aux_var_fids)
+        io::write_aux_elemental_field_values(*this->pexo,
+                                             *this->dpi,
+                                             this->step_num,
+                                             fid,
+                                             exo_var_id,
+                                             this->values);
+    this->pexo->write_global_vars(this->step_num, get_global_values());
+
+    this->pexo->update();
+
+    ++this->step_num;
+}
+
 void
 ExodusIIOutput::open_file()
 {
@@ -238,9 +414,19 @@ void
 ExodusIIOutput::write_all_variable_names()
 {
     CALL_STACK_MSG();
-
     std::vector<std::string> nodal_var_names;
     std::vector<std::string> elem_var_names;
+    get_all_variable_names(nodal_var_names, elem_var_names);
+    this->exo->write_nodal_var_names(nodal_var_names);
+    this->exo->write_elem_var_names(elem_var_names);
+    this->exo->write_global_var_names(this->global_var_names);
+}
+
+void
+ExodusIIOutput::get_all_variable_names(std::vector<std::string> & nodal_var_names,
+                                       std::vector<std::string> & elem_var_names) const
+{
+    CALL_STACK_MSG();
     for (auto & name : this->field_var_names) {
         auto fid = this->dpi->get_field_id(name).value();
         auto order = this->dpi->get_field_order(fid).value();
@@ -265,9 +451,6 @@ ExodusIIOutput::write_all_variable_names()
             nodal_var_names.insert(nodal_var_names.end(), names.begin(), names.end());
         }
     }
-    this->exo->write_nodal_var_names(nodal_var_names);
-    this->exo->write_elem_var_names(elem_var_names);
-    this->exo->write_global_var_names(this->global_var_names);
 }
 
 void
@@ -284,7 +467,8 @@ ExodusIIOutput::write_elem_variables()
                                          this->step_num,
                                          time,
                                          fid,
-                                         exo_var_id);
+                                         exo_var_id,
+                                         this->values);
     }
     for (auto [fid, exo_var_id] : this->elem_aux_var_fids) {
         io::write_aux_elemental_field_values(*this->exo,
@@ -292,7 +476,8 @@ ExodusIIOutput::write_elem_variables()
                                              this->step_num,
                                              time,
                                              fid,
-                                             exo_var_id);
+                                             exo_var_id,
+                                             this->values);
     }
 }
 
@@ -311,18 +496,36 @@ ExodusIIOutput::write_global_variables()
     }
 }
 
-void
-ExodusIIOutput::write_info()
+std::vector<double>
+ExodusIIOutput::get_global_values() const
+{
+    CALL_STACK_MSG();
+    std::vector<double> vals;
+    vals.reserve(this->global_var_names.size());
+    for (auto & name : this->global_var_names) {
+        auto pp = get_problem()->get_postprocessor(name).value();
+        // FIXME: store all components
+        vals.push_back(pp->get_value()[0]);
+    }
+    return vals;
+}
+
+std::string
+ExodusIIOutput::get_created_by() const
 {
     CALL_STACK_MSG();
     auto app = get_app();
     std::time_t now = std::time(nullptr);
     String datetime = fmt::format("{:%d %b %Y, %H:%M:%S}", *std::localtime(&now));
-    String created_by =
-        fmt::format("Created by {} {}, on {}", app->get_name(), app->get_version(), datetime);
+    return fmt::format("Created by {} {}, on {}", app->get_name(), app->get_version(), datetime);
+}
 
+void
+ExodusIIOutput::write_info()
+{
+    CALL_STACK_MSG();
     std::vector<std::string> info;
-    info.push_back(created_by);
+    info.push_back(get_created_by());
     this->exo->write_info(info);
 }
 
@@ -142,7 +142,7 @@ ExplicitDGLinearProblem::output_with(FileOutput & out)
 {
     CALL_STACK_MSG();
     compute_solution_vector_local();
-    out.output_step();
+    write_output(out);
 }
 
 } // namespace godzilla
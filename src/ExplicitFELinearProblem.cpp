@@ -154,6 +154,52 @@ ExplicitFELinearProblem::compute_rhs_local(Real time, const Vector & x, Vector &
     compute_rhs_function_fem(time, x, F);
 }
 
+bool
+ExplicitFELinearProblem::can_split_rhs_local() const
+{
+    return true;
+}
+
+void
+ExplicitFELinearProblem::compute_rhs_local_cells(Real time,
+                                                 const Vector & x,
+                                                 const IndexSet & cells,
+                                                 Vector & F)
+{
+    CALL_STACK_MSG();
+    for (auto region : get_weak_form().get_residual_regions()) {
+        IndexSet region_cells;
+        region.value = 0;
+        region.part = 100;
+        if (region.label.is_null()) {
+            region_cells = cells;
+        }
+        else {
+            region.value = 1;
+            region_cells = IndexSet::intersect_caching(cells, get_region_cells(region));
+        }
+        if (region_cells.get_size() > 0)
+            compute_cell_residual_internal(get_dm(),
+                                           region,
+                                           region_cells,
+                                           time,
+                                           x,
+                                           nullptr,
+                                           time,
+                                           F);
+    }
+}
+
+void
+ExplicitFELinearProblem::compute_rhs_local_bnd(Real time, const Vector & x, Vector & F)
+{
+    CALL_STACK_MSG();
+    // `compute_rhs_function_fem` adds the boundary terms once per residual region, match it
+    auto n_regions = get_weak_form().get_residual_regions().size();
+    for (std::size_t i = 0; i < n_regions; ++i)
+        compute_bnd_residual_internal(get_dm(), x, nullptr, time, F);
+}
+
 void
 ExplicitFELinearProblem::post_step()
 {
@@ -196,20 +242,10 @@ ExplicitFELinearProblem::compute_rhs_function_fem(Real time, const Vector & loc_
 {
     // this is based on DMPlexTSComputeRHSFunctionFEM()
     CALL_STACK_MSG();
-    auto all_cells = get_mesh()->get_all_cells();
-
     for (auto region : get_weak_form().get_residual_regions()) {
-        IndexSet cells;
-        region.value = 0;
+        region.value = region.label.is_null() ? 0 : 1;
         region.part = 100;
-        if (region.label.is_null()) {
-            cells = all_cells;
-        }
-        else {
-            region.value = 1;
-            auto points = region.label.get_stratum(region.value);
-            cells = IndexSet::intersect_caching(all_cells, points);
-        }
+        auto & cells = get_region_cells(region);
         compute_residual_internal(get_dm(), region, cells, time, loc_x, nullptr, time, loc_g);
     }
 }
@@ -11,6 +11,7 @@ Parameters
 ExplicitFVLinearProblem::parameters()
 {
     auto params = NonlinearProblem::parameters();
+    params += FVProblemInterface::parameters();
     params += ExplicitProblemInterface::parameters();
     return params;
 }
@@ -131,7 +132,10 @@ void
 ExplicitFVLinearProblem::compute_rhs_local(Real time, const Vector & x, Vector & F)
 {
     CALL_STACK_MSG();
-    PETSC_CHECK(DMPlexTSComputeRHSFunctionFVM(get_dm(), time, x, F, this));
+    if (has_batched_riemann_solver())
+        compute_flux_residual_local(time, x, F);
+    else
+        PETSC_CHECK(DMPlexTSComputeRHSFunctionFVM(get_dm(), time, x, F, this));
 }
 
 void
@@ -149,7 +153,7 @@ ExplicitFVLinearProblem::output_with(FileOutput & out)
 {
     CALL_STACK_MSG();
     compute_solution_vector_local();
-    out.output_step();
+    write_output(out);
 }
 
 } // namespace godzilla
@@ -10,13 +10,20 @@ Parameters
 ExplicitProblemInterface::parameters()
 {
     auto params = TransientProblemInterface::parameters();
+    params.add_param<bool>(
+        "overlap_communication",
+        false,
+        "Overlap residual evaluation with the ghost exchange (only if the problem supports it)");
     return params;
 }
 
 ExplicitProblemInterface::ExplicitProblemInterface(NonlinearProblem & problem,
                                                    const Parameters & pars) :
     TransientProblemInterface(problem, pars),
-    nl_problem(problem)
+    nl_problem(problem),
+    overlap_comm(pars.get<bool>("overlap_communication")),
+    overlap_dm_id(0),
+    overlap_section_id(0)
 {
 }
 
@@ -97,14 +104,19 @@ ExplicitProblemInterface::compute_rhs_function(Real time, const Vector & x, Vect
 {
     CALL_STACK_MSG();
     auto loc_x = this->nl_problem->get_local_vector();
-    auto loc_F = this->nl_problem->get_local_vector();
     loc_x.zero();
     compute_boundary_local(time, loc_x);
-    this->nl_problem->global_to_local(x, INSERT_VALUES, loc_x);
-    loc_F.zero();
-    compute_rhs_local(time, loc_x, loc_F);
-    F.zero();
-    this->nl_problem->local_to_global(loc_F, ADD_VALUES, F);
+    if (this->overlap_comm && can_split_rhs_local())
+        compute_rhs_function_overlapped(time, x, loc_x, F);
+    else {
+        auto loc_F = this->nl_problem->get_local_vector();
+        this->nl_problem->global_to_local(x, INSERT_VALUES, loc_x);
+        loc_F.zero();
+        compute_rhs_local(time, loc_x, loc_F);
+        F.zero();
+        this->nl_problem->local_to_global(loc_F, ADD_VALUES, F);
+        this->nl_problem->restore_local_vector(loc_F);
+    }
     if ((Vec) this->M_lumped_inv == nullptr) {
         auto ksp = this->nl_problem->get_ksp();
         ksp.solve(F);
@@ -112,7 +124,123 @@ ExplicitProblemInterface::compute_rhs_function(Real time, const Vector & x, Vect
     else
         pointwise_mult(F, this->M_lumped_inv, F);
     this->nl_problem->restore_local_vector(loc_x);
+}
+
+void
+ExplicitProblemInterface::compute_rhs_function_overlapped(Real time,
+                                                          const Vector & x,
+                                                          Vector & loc_x,
+                                                          Vector & F)
+{
+    CALL_STACK_MSG();
+    build_overlap_sets(F);
+
+    auto loc_F = this->nl_problem->get_local_vector();
+    auto loc_F_int = this->nl_problem->get_local_vector();
+
+    // interior cells read only owned values, so copy them into `loc_x` ourselves instead of relying
+    // on the scatter to do its local part in `begin`
+    {
+        auto lx = loc_x.borrow_array();
+        auto gx = x.borrow_array_read();
+        for (std::size_t i = 0; i < this->owned_local_idx.size(); ++i)
+            lx[this->owned_local_idx[i]] = gx[this->owned_global_idx[i]];
+    }
+    this->nl_problem->global_to_local_begin(x, INSERT_VALUES, loc_x);
+    loc_F.zero();
+    compute_rhs_local_cells(time, loc_x, this->interior_cells[0], loc_F);
+    this->nl_problem->global_to_local_end(x, INSERT_VALUES, loc_x);
+
+    compute_rhs_local_cells(time, loc_x, this->boundary_cells, loc_F);
+    compute_rhs_local_bnd(time, loc_x, loc_F);
+
+    F.zero();
+    this->nl_problem->local_to_global_begin(loc_F, ADD_VALUES, F);
+    // `loc_F` is being sent, so the rest of interior cells goes into a separate vector. These
+    // only touch owned dofs, so they are added into `F` without any communication.
+    loc_F_int.zero();
+    compute_rhs_local_cells(time, loc_x, this->interior_cells[1], loc_F_int);
+    this->nl_problem->local_to_global_end(loc_F, ADD_VALUES, F);
+    {
+        auto f = F.borrow_array();
+        auto f_int = loc_F_int.borrow_array_read();
+        for (std::size_t i = 0; i < this->owned_local_idx.size(); ++i)
+            f[this->owned_global_idx[i]] += f_int[this->owned_local_idx[i]];
+    }
+
     this->nl_problem->restore_local_vector(loc_F);
+    this->nl_problem->restore_local_vector(loc_F_int);
+}
+
+void
+ExplicitProblemInterface::build_overlap_sets(const Vector & F)
+{
+    CALL_STACK_MSG();
+    auto dm = this->nl_problem->get_dm();
+    // a new mesh, partitioning or DoF layout invalidates the sets
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscObjectId dm_id, section_id;
+    PETSC_CHECK(PetscObjectGetId((PetscObject) dm, &dm_id));
+    PETSC_CHECK(PetscObjectGetId((PetscObject) section, &section_id));
+    if (this->overlap_dm_id == dm_id && this->overlap_section_id == section_id)
+        return;
+
+    Int p_start, p_end;
+    PETSC_CHECK(DMPlexGetChart(dm, &p_start, &p_end));
+    std::vector<bool> ghost(p_end - p_start, false);
+    PetscSF sf;
+    PETSC_CHECK(DMGetPointSF(dm, &sf));
+    Int n_roots, n_leaves;
+    const Int * leaves;
+    PETSC_CHECK(PetscSFGetGraph(sf, &n_roots, &n_leaves, &leaves, nullptr));
+    for (Int i = 0; i < n_leaves; ++i)
+        ghost[(leaves ? leaves[i] : i) - p_start] = true;
+
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+    std::vector<Int> interior, boundary;
+    for (Int c = c_start; c < c_end; ++c) {
+        Int n_closure;
+        Int * closure = nullptr;
+        PETSC_CHECK(DMPlexGetTransitiveClosure(dm, c, PETSC_TRUE, &n_closure, &closure));
+        bool touches_ghost = false;
+        for (Int i = 0; i < n_closure && !touches_ghost; ++i)
+            touches_ghost = ghost[closure[2 * i] - p_start];
+        PETSC_CHECK(DMPlexRestoreTransitiveClosure(dm, c, PETSC_TRUE, &n_closure, &closure));
+        if (touches_ghost)
+            boundary.push_back(c);
+        else
+            interior.push_back(c);
+    }
+    auto half = interior.size() / 2;
+    this->interior_cells[0] =
+        IndexSet::create_general(PETSC_COMM_SELF, Span<const Int>(interior.data(), half));
+    this->interior_cells[1] = IndexSet::create_general(
+        PETSC_COMM_SELF,
+        Span<const Int>(interior.data() + half, interior.size() - half));
+    this->boundary_cells = IndexSet::create_general(PETSC_COMM_SELF, boundary);
+
+    // constrained dofs map to negative indices and ghost dofs outside of the ownership range
+    ISLocalToGlobalMapping ltog;
+    PETSC_CHECK(DMGetLocalToGlobalMapping(dm, &ltog));
+    Int n;
+    PETSC_CHECK(ISLocalToGlobalMappingGetSize(ltog, &n));
+    const Int * idx;
+    PETSC_CHECK(ISLocalToGlobalMappingGetIndices(ltog, &idx));
+    auto rng = F.get_ownership_range();
+    this->owned_local_idx.clear();
+    this->owned_global_idx.clear();
+    for (Int i = 0; i < n; ++i) {
+        if (idx[i] >= rng.first() && idx[i] < rng.last()) {
+            this->owned_local_idx.push_back(i);
+            this->owned_global_idx.push_back(idx[i] - rng.first());
+        }
+    }
+    PETSC_CHECK(ISLocalToGlobalMappingRestoreIndices(ltog, &idx));
+
+    this->overlap_dm_id = dm_id;
+    this->overlap_section_id = section_id;
 }
 
 void
@@ -122,6 +250,27 @@ ExplicitProblemInterface::compute_rhs_local(Real /* time */,
 {
 }
 
+bool
+ExplicitProblemInterface::can_split_rhs_local() const
+{
+    return false;
+}
+
+void
+ExplicitProblemInterface::compute_rhs_local_cells(Real /* time */,
+                                                  const Vector & /* x */,
+                                                  const IndexSet & /* cells */,
+                                                  Vector & /* F */)
+{
+}
+
+void
+ExplicitProblemInterface::compute_rhs_local_bnd(Real /* time */,
+                                                const Vector & /* x */,
+                                                Vector & /* F */)
+{
+}
+
 void
 ExplicitProblemInterface::compute_boundary_local(Real time, Vector & x)
 {
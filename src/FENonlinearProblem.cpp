@@ -6,10 +6,14 @@
 #include "godzilla/UnstructuredMesh.h"
 #include "godzilla/IndexSet.h"
 #include "godzilla/WeakForm.h"
+#include "godzilla/Optional.h"
+#include "godzilla/PerfLog.h"
+#include "godzilla/Assert.h"
 #include "petscdm.h"
 #include "petscds.h"
 #include "petsc/private/dmimpl.h"
 #include "petsc/private/dmpleximpl.h"
+#include <algorithm>
 
 namespace godzilla {
 namespace internal {
@@ -175,15 +179,35 @@ Parameters
 FENonlinearProblem::parameters()
 {
     auto params = NonlinearProblem::parameters();
+    params.add_param<Int>("num_assembly_threads",
+                          1,
+                          "Number of threads used for assembling the residual and the Jacobian");
+    params.add_param<bool>(
+        "coo_assembly",
+        false,
+        "Assemble the Jacobian from (row, col) pairs computed once instead of per-cell closures");
+    params.add_param<bool>("matrix_free",
+                           false,
+                           "Apply the Jacobian element by element from coefficients stored at "
+                           "quadrature points instead of assembling it");
+    params.add_param<bool>("sum_factorization",
+                           true,
+                           "Use sum-factorized kernels on quadrilateral and hexahedral meshes");
     return params;
 }
 
 FENonlinearProblem::FENonlinearProblem(const Parameters & pars) :
     NonlinearProblem(pars),
     FEProblemInterface(*this, pars),
-    state(INITIAL)
+    state(INITIAL),
+    coo_assembly(pars.get<bool>("coo_assembly")),
+    matrix_free(pars.get<bool>("matrix_free"))
 {
     CALL_STACK_MSG();
+    set_num_assembly_threads(pars.get<Int>("num_assembly_threads"));
+    set_sum_factorization(pars.get<bool>("sum_factorization"));
+    expect_true(!(this->coo_assembly && this->matrix_free),
+                "Parameters 'coo_assembly' and 'matrix_free' cannot be used together.");
 }
 
 void
@@ -209,6 +233,11 @@ FENonlinearProblem::set_up_callbacks()
     set_boundary_local(ref(*this), &FENonlinearProblem::compute_boundary_local);
     set_function_local(ref(*this), &FENonlinearProblem::compute_residual_local);
     set_jacobian_local(ref(*this), &FENonlinearProblem::compute_jacobian_local);
+    // the solver must assemble into the matrix the COO pattern was set on
+    if (this->coo_assembly)
+        PETSC_CHECK(SNESSetJacobian(get_snes(), get_jacobian(), get_jacobian(), nullptr, nullptr));
+    else if (this->matrix_free)
+        PETSC_CHECK(SNESSetJacobian(get_snes(), this->mf.mat, this->mf.mat, nullptr, nullptr));
 }
 
 void
@@ -225,6 +254,10 @@ FENonlinearProblem::allocate_objects()
     CALL_STACK_MSG();
     NonlinearProblem::allocate_objects();
     FEProblemInterface::allocate_objects();
+    if (this->coo_assembly)
+        set_up_coo_assembly(get_jacobian());
+    if (this->matrix_free)
+        set_up_matrix_free_jacobian();
 }
 
 void
@@ -245,17 +278,8 @@ FENonlinearProblem::compute_residual_local(const Vector & x, Vector & f)
 {
     CALL_STACK_MSG();
     // this is based on DMSNESComputeResidual()
-    auto all_cells = get_mesh()->get_all_cells();
-
     for (auto & region : get_weak_form().get_residual_regions()) {
-        IndexSet cells;
-        if (region.label.is_null()) {
-            cells = all_cells;
-        }
-        else {
-            auto points = region.label.get_stratum(region.value);
-            cells = IndexSet::intersect_caching(all_cells, points);
-        }
+        auto & cells = get_region_cells(region);
         compute_residual_internal(get_dm(), region, cells, PETSC_MIN_REAL, x, Vector(), 0.0, f);
     }
 }
@@ -271,14 +295,27 @@ FENonlinearProblem::compute_residual_internal(DM dm,
                                               Vector & loc_f)
 {
     CALL_STACK_MSG();
+    compute_cell_residual_internal(dm, region, cell_is, time, loc_x, loc_x_t, t, loc_f);
+    compute_bnd_residual_internal(dm, loc_x, loc_x_t, t, loc_f);
+}
+
+void
+FENonlinearProblem::compute_cell_residual_internal(DM dm,
+                                                   const WeakForm::Region & region,
+                                                   const IndexSet & cell_is,
+                                                   Real time,
+                                                   const Vector & loc_x,
+                                                   const Vector & loc_x_t,
+                                                   Real t,
+                                                   Vector & loc_f)
+{
+    CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::compute_residual);
     DM dm_aux = nullptr;
     PetscDS ds_aux = nullptr;
     PetscBool is_implicit = (loc_x_t || time == PETSC_MIN_REAL) ? PETSC_TRUE : PETSC_FALSE;
     Scalar *u = nullptr, *u_t, *a;
     IndexSet chunk_is;
-    Int tot_dim_aux;
-    PetscQuadrature affine_quad = nullptr, *quads = nullptr;
-    PetscFEGeom *affine_geom = nullptr, **geoms = nullptr;
 
     /// TODO The places where we have to use isFE are probably the member functions for the
     /// PetscDisc class
@@ -313,59 +350,8 @@ FENonlinearProblem::compute_residual_internal(DM dm,
 #else
         PETSC_CHECK(DMGetCellDS(dm_aux, subcell, &ds_aux));
 #endif
-        PETSC_CHECK(PetscDSGetTotalDimension(ds_aux, &tot_dim_aux));
-    }
-    /* 2: Get geometric data */
-    for (Int f = 0; f < n_fields; ++f) {
-        PetscBool fimp;
-        PETSC_CHECK(PetscDSGetImplicit(ds, f, &fimp));
-        if (is_implicit != fimp)
-            continue;
-    }
-    DMField coord_field = nullptr;
-    PETSC_CHECK(DMGetCoordinateField(dm, &coord_field));
-    Int max_degree = PETSC_MAX_INT;
-    PETSC_CHECK(DMFieldGetDegree(coord_field, cell_is, nullptr, &max_degree));
-    if (max_degree <= 1) {
-        PETSC_CHECK(DMFieldCreateDefaultQuadrature(coord_field, cell_is, &affine_quad));
-        if (affine_quad) {
-#if PETSC_VERSION_GE(3, 23, 0)
-            PETSC_CHECK(DMSNESGetFEGeom(coord_field,
-                                        cell_is,
-                                        affine_quad,
-                                        PETSC_FEGEOM_BASIC,
-                                        &affine_geom));
-#else
-            PETSC_CHECK(
-                DMSNESGetFEGeom(coord_field, cell_is, affine_quad, PETSC_FALSE, &affine_geom));
-#endif
-        }
-    }
-    else {
-        PETSC_CHECK(PetscCalloc2(n_fields, &quads, n_fields, &geoms));
-        for (Int f = 0; f < n_fields; ++f) {
-            PetscBool fimp;
-            PETSC_CHECK(PetscDSGetImplicit(ds, f, &fimp));
-            if (is_implicit != fimp)
-                continue;
-            PetscObject obj;
-            PETSC_CHECK(PetscDSGetDiscretization(ds, f, &obj));
-            PetscClassId id;
-            PETSC_CHECK(PetscObjectGetClassId(obj, &id));
-            if (id == PETSCFE_CLASSID) {
-                PetscFE fe = (PetscFE) obj;
-                PETSC_CHECK(PetscFEGetQuadrature(fe, &quads[f]));
-                PETSC_CHECK(PetscObjectReference((PetscObject) quads[f]));
-#if PETSC_VERSION_GE(3, 23, 0)
-                PETSC_CHECK(
-                    DMSNESGetFEGeom(coord_field, cell_is, quads[f], PETSC_FEGEOM_BASIC, &geoms[f]));
-#else
-                PETSC_CHECK(
-                    DMSNESGetFEGeom(coord_field, cell_is, quads[f], PETSC_FALSE, &geoms[f]));
-#endif
-            }
-        }
     }
+    /* 2: Geometric data is taken from the geometry cache, see get_cell_geometry() */
     /* Loop over chunks */
     chunk_is.create(PETSC_COMM_SELF);
     Int n_cells = c_end - c_start;
@@ -397,40 +383,21 @@ FENonlinearProblem::compute_residual_internal(DM dm,
             if (id == PETSCFE_CLASSID) {
                 WeakForm::Key key(region, f, 0);
 
-                PetscFE fe = (PetscFE) obj;
-                PetscFEGeom * geom = affine_geom ? affine_geom : geoms[f];
-                PetscQuadrature quad = affine_quad ? affine_quad : quads[f];
-
-                Int n_batches, n_blocks;
-                PETSC_CHECK(PetscFEGetTileSizes(fe, nullptr, &n_blocks, nullptr, &n_batches));
-                Int n_qpts;
-                PETSC_CHECK(
-                    PetscQuadratureGetData(quad, nullptr, nullptr, &n_qpts, nullptr, nullptr));
-                Int n_basis;
-                PETSC_CHECK(PetscFEGetDimension(fe, &n_basis));
-                Int block_size = n_basis;
-                Int batch_size = n_blocks * block_size;
-                PETSC_CHECK(PetscFESetTileSizes(fe, block_size, n_blocks, batch_size, n_batches));
-                Int n_chunks_field = n_chunk_cells / (n_batches * batch_size);
-                Int n_elems = n_chunks_field * n_batches * batch_size;
-                Int n_remdr = n_chunk_cells % (n_batches * batch_size);
-                Int offset = n_chunk_cells - n_remdr;
+                auto geom = get_cell_geometry(dm, region, cell_is, (PetscFE) obj);
                 /* Integrate FE residual to get elemVec (need fields at quadrature points) */
                 PetscFEGeom * chunk_geom = nullptr;
-                PETSC_CHECK(PetscFEGeomGetChunk(geom, 0, offset, &chunk_geom));
-                integrate_residual(ds, key, n_elems, chunk_geom, u, u_t, ds_aux, a, t, elem_vec);
-                PETSC_CHECK(PetscFEGeomGetChunk(geom, offset, n_chunk_cells, &chunk_geom));
-                integrate_residual(ds,
-                                   key,
-                                   n_remdr,
-                                   chunk_geom,
-                                   &u[offset * tot_dim],
-                                   u_t ? &u_t[offset * tot_dim] : nullptr,
-                                   ds_aux,
-                                   &a[offset * tot_dim_aux],
-                                   t,
-                                   &elem_vec[offset * tot_dim]);
-                PETSC_CHECK(PetscFEGeomRestoreChunk(geom, offset, n_chunk_cells, &chunk_geom));
+                PETSC_CHECK(PetscFEGeomGetChunk(geom, 0, n_chunk_cells, &chunk_geom));
+                integrate_residual_chunked(ds,
+                                           key,
+                                           n_chunk_cells,
+                                           chunk_geom,
+                                           u,
+                                           u_t,
+                                           ds_aux,
+                                           a,
+                                           t,
+                                           elem_vec);
+                PETSC_CHECK(PetscFEGeomRestoreChunk(geom, 0, n_chunk_cells, &chunk_geom));
             }
             else
                 throw Exception(fmt::format("Unknown discretization type for field {}", f));
@@ -460,22 +427,6 @@ FENonlinearProblem::compute_residual_internal(DM dm,
     }
     cell_is.restore_point_range(c_start, c_end, cells);
 
-    compute_bnd_residual_internal(dm, loc_x, loc_x_t, t, loc_f);
-
-    if (max_degree <= 1) {
-        PETSC_CHECK(
-            DMSNESRestoreFEGeom(coord_field, cell_is, affine_quad, PETSC_FALSE, &affine_geom));
-        PETSC_CHECK(PetscQuadratureDestroy(&affine_quad));
-    }
-    else {
-        for (Int f = 0; f < n_fields; ++f) {
-            PETSC_CHECK(
-                DMSNESRestoreFEGeom(coord_field, cell_is, quads[f], PETSC_FALSE, &geoms[f]));
-            PETSC_CHECK(PetscQuadratureDestroy(&quads[f]));
-        }
-        PETSC_CHECK(PetscFree2(quads, geoms));
-    }
-
     /* FEM */
     /* 1: Get sizes from dm and dmAux */
     /* 2: Get geometric data */
@@ -500,12 +451,10 @@ void
 FENonlinearProblem::compute_bnd_residual_internal(DM dm, Vec loc_x, Vec loc_x_t, Real t, Vec loc_f)
 {
     CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::compute_bnd_residual);
 
     PetscDS prob;
     PETSC_CHECK(DMGetDS(dm, &prob));
-    auto depth_label = get_mesh()->get_depth_label();
-    auto dim = get_dimension();
-    auto facets = depth_label.get_stratum(dim - 1);
     Int n_bnd;
     PETSC_CHECK(PetscDSGetNumBoundary(prob, &n_bnd));
     for (Int bd = 0; bd < n_bnd; ++bd) {
@@ -546,8 +495,7 @@ FENonlinearProblem::compute_bnd_residual_internal(DM dm, Vec loc_x, Vec loc_x_t,
                                                  loc_x,
                                                  loc_x_t,
                                                  loc_f,
-                                                 coord_field,
-                                                 facets);
+                                                 coord_field);
         }
     }
 }
@@ -559,8 +507,7 @@ FENonlinearProblem::compute_bnd_residual_single_internal(DM dm,
                                                          Vec loc_x,
                                                          Vec loc_x_t,
                                                          Vec loc_f,
-                                                         DMField coord_field,
-                                                         const IndexSet & facets)
+                                                         DMField coord_field)
 {
     CALL_STACK_MSG();
     DM plex = nullptr, plex_aux = nullptr;
@@ -586,15 +533,10 @@ FENonlinearProblem::compute_bnd_residual_single_internal(DM dm,
         PETSC_CHECK(DMGetLocalSection(plex_aux, &section_aux));
     }
 
-    auto points = key.label.get_stratum(key.value);
+    auto points = get_boundary_facets(key.label, key.value);
     if (points) {
         PetscQuadrature q_geom = nullptr;
 
-        /* TODO: Special cases of ISIntersect where it is quick to check a priori if one is a
-         * superset of the other */
-        IndexSet isect = IndexSet::intersect_caching(facets, points);
-        points = isect;
-
         Int n_faces = points.get_local_size();
         auto point_idxs = points.borrow_indices();
 
@@ -710,26 +652,488 @@ FENonlinearProblem::compute_jacobian_local(const Vector & x, Matrix & J, Matrix
 {
     CALL_STACK_MSG();
     // based on DMPlexSNESComputeJacobianFEM and DMSNESComputeJacobianAction
-    auto all_cells = get_mesh()->get_all_cells();
-
     auto & wf = get_weak_form();
+    if (this->matrix_free) {
+        for (auto & region : wf.get_jacobian_regions())
+            compute_matrix_free_jacobian(get_dm(),
+                                         region,
+                                         get_region_cells(region),
+                                         0.0,
+                                         0.0,
+                                         x,
+                                         Vector());
+        // bump the state of the shell matrix, so the preconditioner is rebuilt from the new
+        // coefficients
+        J.assemble();
+        return;
+    }
+
     auto has_jac = wf.has_jacobian();
     auto has_precond = wf.has_jacobian_preconditioner();
     if (has_jac && has_precond)
         J.zero();
-    Jp.zero();
+    auto coo = coo_overwrites(J, Jp);
+    if (!coo)
+        Jp.zero();
 
     for (auto & region : wf.get_jacobian_regions()) {
-        IndexSet cells;
-        if (region.label.is_null()) {
-            cells = all_cells;
+        auto & cells = get_region_cells(region);
+        compute_jacobian_internal(get_dm(), region, cells, 0.0, 0.0, x, Vector(), J, Jp);
+    }
+    if (coo)
+        assemble_coo_jacobian(get_dm(), x, Vector(), 0.0, 0.0, J, Jp);
+}
+
+const IndexSet &
+FENonlinearProblem::get_region_cells(const WeakForm::Region & region)
+{
+    CALL_STACK_MSG();
+    // cells do not depend on the part, so all parts of a region share one entry
+    WeakForm::Region key(region.label, region.label.is_null() ? 0 : region.value, 0);
+    auto state = get_cache_state(region.label);
+    auto & entry = this->region_cells[key];
+    if (entry.dm_id == state.dm_id && entry.label_id == state.label_id &&
+        entry.label_state == state.label_state)
+        return entry.points;
+
+    auto all_cells = get_mesh()->get_all_cells();
+    if (region.label.is_null())
+        state.points = all_cells;
+    else {
+        auto points = region.label.get_stratum(region.value);
+        if (points)
+            state.points = IndexSet::intersect(all_cells, points);
+    }
+    entry = state;
+    return entry.points;
+}
+
+const IndexSet &
+FENonlinearProblem::get_boundary_facets(const Label & label, Int value)
+{
+    CALL_STACK_MSG();
+    WeakForm::Region key(label, value, 0);
+    auto state = get_cache_state(label);
+    auto & entry = this->bnd_facets[key];
+    if (entry.dm_id == state.dm_id && entry.label_id == state.label_id &&
+        entry.label_state == state.label_state)
+        return entry.points;
+
+    auto points = label.get_stratum(value);
+    if (points) {
+        auto depth_label = get_mesh()->get_depth_label();
+        auto all_facets = depth_label.get_stratum(get_dimension() - 1);
+        state.points = IndexSet::intersect(all_facets, points);
+    }
+    entry = state;
+    return entry.points;
+}
+
+FENonlinearProblem::CachedPoints
+FENonlinearProblem::get_cache_state(const Label & label) const
+{
+    CALL_STACK_MSG();
+    CachedPoints state;
+    PETSC_CHECK(PetscObjectGetId((PetscObject) get_mesh()->get_dm(), &state.dm_id));
+    if (!label.is_null()) {
+        state.label_id = label.get_id();
+        PETSC_CHECK(PetscObjectStateGet((PetscObject) (DMLabel) label, &state.label_state));
+    }
+    return state;
+}
+
+void
+FENonlinearProblem::invalidate_region_cache()
+{
+    CALL_STACK_MSG();
+    this->region_cells.clear();
+    this->bnd_facets.clear();
+}
+
+bool
+FENonlinearProblem::uses_coo_assembly() const
+{
+    CALL_STACK_MSG();
+    return this->coo_assembly;
+}
+
+bool
+FENonlinearProblem::coo_overwrites(const Matrix & J, const Matrix & Jp) const
+{
+    CALL_STACK_MSG();
+    // the Jacobian and the preconditioner assembled into different matrices do not use COO
+    auto & wf = get_weak_form();
+    if (wf.has_jacobian() && wf.has_jacobian_preconditioner() && J != Jp)
+        return false;
+    return this->coo.mat != nullptr && this->coo.mat == (Mat) Jp;
+}
+
+void
+FENonlinearProblem::assemble_coo_jacobian(DM dm,
+                                          const Vector & X,
+                                          const Vector & X_t,
+                                          Real t,
+                                          Real x_t_shift,
+                                          Matrix & J,
+                                          Matrix & Jp)
+{
+    CALL_STACK_MSG();
+    // every entry of the matrix pattern is overwritten, so `Jp` does not have to be zeroed. The
+    // insert must come before the boundary terms that are added on top of it
+    PETSC_CHECK(MatSetValuesCOO(Jp, this->coo.values.data(), INSERT_VALUES));
+    compute_bnd_jacobian_internal(dm, X, X_t, t, x_t_shift, J, Jp);
+    Jp.assemble();
+}
+
+bool
+FENonlinearProblem::uses_matrix_free() const
+{
+    CALL_STACK_MSG();
+    return this->matrix_free;
+}
+
+ShellMatrix &
+FENonlinearProblem::get_matrix_free_jacobian()
+{
+    CALL_STACK_MSG();
+    return this->mf.mat;
+}
+
+void
+FENonlinearProblem::set_up_matrix_free_jacobian()
+{
+    CALL_STACK_MSG();
+    PetscBool transform;
+    PETSC_CHECK(DMHasBasisTransform(get_dm(), &transform));
+    auto & wf = get_weak_form();
+    if (transform || wf.has_bnd_jacobian() || wf.has_jacobian_preconditioner())
+        throw Exception("Matrix-free Jacobian does not support basis transformations, boundary "
+                        "Jacobian terms or a separate preconditioner Jacobian.");
+
+    auto & x = get_solution_vector();
+    this->mf.mat.create(get_comm(),
+                        x.get_local_size(),
+                        x.get_local_size(),
+                        x.get_size(),
+                        x.get_size());
+    this->mf.mat.set_operation(MATOP_MULT,
+                               ref(*this),
+                               &FENonlinearProblem::mult_matrix_free_jacobian);
+    this->mf.mat.set_operation(MATOP_GET_DIAGONAL,
+                               ref(*this),
+                               &FENonlinearProblem::get_matrix_free_jacobian_diagonal);
+    this->mf.loc_x = create_local_vector();
+    this->mf.loc_y = create_local_vector();
+    // factorization based preconditioners need the matrix entries, the diagonal is available
+    PETSC_CHECK(PCSetType(get_ksp().get_pc(), PCJACOBI));
+}
+
+void
+FENonlinearProblem::compute_matrix_free_jacobian(DM dm,
+                                                 const WeakForm::Region & region,
+                                                 const IndexSet & cell_is,
+                                                 Real t,
+                                                 Real x_t_shift,
+                                                 const Vector & X,
+                                                 const Vector & X_t)
+{
+    CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::compute_jacobian);
+    Int n_fields = get_num_fields();
+    auto & blk = this->mf.regions[region];
+    blk.cells = cell_is;
+    blk.n_cells = cell_is ? cell_is.get_local_size() : 0;
+    blk.g.resize(n_fields * n_fields);
+    blk.geom.assign(n_fields, nullptr);
+    if (blk.n_cells == 0)
+        return;
+
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscDS prob;
+    PETSC_CHECK(DMGetDS(dm, &prob));
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(prob, &tot_dim));
+
+    Vec A;
+    PETSC_CHECK(DMGetAuxiliaryVec(dm, region.label, region.value, 0, &A));
+    DM dm_aux = nullptr;
+    DMEnclosureType enc_aux;
+    PetscDS prob_aux = nullptr;
+    PetscSection section_aux;
+    DM plex = nullptr;
+    Int tot_dim_aux = 0;
+    if (A) {
+        PETSC_CHECK(VecGetDM(A, &dm_aux));
+        PETSC_CHECK(DMGetEnclosureRelation(dm_aux, dm, &enc_aux));
+        PETSC_CHECK(DMConvert(dm_aux, DMPLEX, &plex));
+        PETSC_CHECK(DMGetLocalSection(plex, &section_aux));
+        PETSC_CHECK(DMGetDS(dm_aux, &prob_aux));
+        PETSC_CHECK(PetscDSGetTotalDimension(prob_aux, &tot_dim_aux));
+    }
+
+    Int n_cells = blk.n_cells;
+    std::vector<Scalar> u(n_cells * tot_dim);
+    std::vector<Scalar> u_t(X_t ? n_cells * tot_dim : 0);
+    std::vector<Scalar> a(n_cells * tot_dim_aux);
+    Int c_start, c_end;
+    const Int * cells;
+    cell_is.get_point_range(c_start, c_end, cells);
+    for (Int c = c_start; c < c_end; ++c) {
+        const Int cell = cells ? cells[c] : c;
+        const Int cind = c - c_start;
+
+        Scalar * x = nullptr;
+        PETSC_CHECK(DMPlexVecGetClosure(dm, section, X, cell, nullptr, &x));
+        std::copy(x, x + tot_dim, &u[cind * tot_dim]);
+        PETSC_CHECK(DMPlexVecRestoreClosure(dm, section, X, cell, nullptr, &x));
+        if (X_t) {
+            PETSC_CHECK(DMPlexVecGetClosure(dm, section, X_t, cell, nullptr, &x));
+            std::copy(x, x + tot_dim, &u_t[cind * tot_dim]);
+            PETSC_CHECK(DMPlexVecRestoreClosure(dm, section, X_t, cell, nullptr, &x));
         }
-        else {
-            auto points = region.label.get_stratum(region.value);
-            cells = IndexSet::intersect_caching(all_cells, points);
+        if (dm_aux) {
+            Int subcell;
+            PETSC_CHECK(DMGetEnclosurePoint(dm_aux, dm, enc_aux, cell, &subcell));
+            PETSC_CHECK(DMPlexVecGetClosure(plex, section_aux, A, subcell, nullptr, &x));
+            std::copy(x, x + tot_dim_aux, &a[cind * tot_dim_aux]);
+            PETSC_CHECK(DMPlexVecRestoreClosure(plex, section_aux, A, subcell, nullptr, &x));
         }
-        compute_jacobian_internal(get_dm(), region, cells, 0.0, 0.0, x, Vector(), J, Jp);
     }
+    cell_is.restore_point_range(c_start, c_end, cells);
+
+    for (Int field_i = 0; field_i < n_fields; ++field_i) {
+        PetscFE fe;
+        PETSC_CHECK(PetscDSGetDiscretization(prob, field_i, (PetscObject *) &fe));
+        blk.geom[field_i] = get_shared_cell_geometry(dm, region, cell_is, fe);
+        auto geom = blk.geom[field_i].get();
+        for (Int field_j = 0; field_j < n_fields; ++field_j) {
+            WeakForm::Key key(region, field_i, field_j);
+            auto & g = blk.g[field_i * n_fields + field_j];
+            g.clear();
+            bool has_terms = false;
+            for (auto & fns : get_jacobian_block(key).g[PETSCFE_JACOBIAN])
+                has_terms = has_terms || !fns.empty();
+            if (!has_terms)
+                continue;
+            g.assign(n_cells * get_jacobian_qp_size(prob, key, geom->dimEmbed), 0.);
+            evaluate_jacobian_qp(prob,
+                                 PETSCFE_JACOBIAN,
+                                 key,
+                                 n_cells,
+                                 geom,
+                                 u.data(),
+                                 X_t ? u_t.data() : nullptr,
+                                 prob_aux,
+                                 dm_aux ? a.data() : nullptr,
+                                 t,
+                                 x_t_shift,
+                                 g.data());
+        }
+    }
+    PETSC_CHECK(DMDestroy(&plex));
+}
+
+void
+FENonlinearProblem::mult_matrix_free_jacobian(Matrix &, Vector & x, Vector & y)
+{
+    CALL_STACK_MSG();
+    auto dm = get_dm();
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscDS prob;
+    PETSC_CHECK(DMGetDS(dm, &prob));
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(prob, &tot_dim));
+    Int n_fields = get_num_fields();
+
+    // constrained DoFs are not in the global vector, so they stay zero
+    auto & loc_x = this->mf.loc_x;
+    auto & loc_y = this->mf.loc_y;
+    loc_x.zero();
+    global_to_local(x, INSERT_VALUES, loc_x);
+    loc_y.zero();
+    for (auto & [region, blk] : this->mf.regions) {
+        if (blk.n_cells == 0)
+            continue;
+        auto & x_elem = this->mf.x_elem;
+        auto & y_elem = this->mf.y_elem;
+        x_elem.resize(blk.n_cells * tot_dim);
+        y_elem.assign(blk.n_cells * tot_dim, 0.);
+
+        Int c_start, c_end;
+        const Int * cells;
+        blk.cells.get_point_range(c_start, c_end, cells);
+        for (Int c = c_start; c < c_end; ++c) {
+            const Int cell = cells ? cells[c] : c;
+            Scalar * vals = nullptr;
+            PETSC_CHECK(DMPlexVecGetClosure(dm, section, loc_x, cell, nullptr, &vals));
+            std::copy(vals, vals + tot_dim, &x_elem[(c - c_start) * tot_dim]);
+            PETSC_CHECK(DMPlexVecRestoreClosure(dm, section, loc_x, cell, nullptr, &vals));
+        }
+
+        for (Int field_i = 0; field_i < n_fields; ++field_i) {
+            auto geom = blk.geom[field_i].get();
+            for (Int field_j = 0; field_j < n_fields; ++field_j) {
+                auto & g = blk.g[field_i * n_fields + field_j];
+                if (!g.empty())
+                    apply_jacobian_qp(prob,
+                                      WeakForm::Key(region, field_i, field_j),
+                                      blk.n_cells,
+                                      geom,
+                                      g.data(),
+                                      x_elem.data(),
+                                      y_elem.data());
+            }
+        }
+
+        for (Int c = c_start; c < c_end; ++c) {
+            const Int cell = cells ? cells[c] : c;
+            PETSC_CHECK(DMPlexVecSetClosure(dm,
+                                            section,
+                                            loc_y,
+                                            cell,
+                                            &y_elem[(c - c_start) * tot_dim],
+                                            ADD_VALUES));
+        }
+        blk.cells.restore_point_range(c_start, c_end, cells);
+    }
+    y.zero();
+    local_to_global(loc_y, ADD_VALUES, y);
+}
+
+void
+FENonlinearProblem::get_matrix_free_jacobian_diagonal(Matrix &, Vector & diag)
+{
+    CALL_STACK_MSG();
+    auto dm = get_dm();
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscDS prob;
+    PETSC_CHECK(DMGetDS(dm, &prob));
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(prob, &tot_dim));
+    Int n_fields = get_num_fields();
+
+    auto & loc_diag = this->mf.loc_y;
+    loc_diag.zero();
+    for (auto & [region, blk] : this->mf.regions) {
+        if (blk.n_cells == 0)
+            continue;
+        auto & d_elem = this->mf.y_elem;
+        d_elem.assign(blk.n_cells * tot_dim, 0.);
+        for (Int field = 0; field < n_fields; ++field) {
+            auto & g = blk.g[field * n_fields + field];
+            if (g.empty())
+                continue;
+            add_jacobian_qp_diagonal(prob,
+                                     WeakForm::Key(region, field, field),
+                                     blk.n_cells,
+                                     blk.geom[field].get(),
+                                     g.data(),
+                                     d_elem.data());
+        }
+
+        Int c_start, c_end;
+        const Int * cells;
+        blk.cells.get_point_range(c_start, c_end, cells);
+        for (Int c = c_start; c < c_end; ++c) {
+            const Int cell = cells ? cells[c] : c;
+            PETSC_CHECK(DMPlexVecSetClosure(dm,
+                                            section,
+                                            loc_diag,
+                                            cell,
+                                            &d_elem[(c - c_start) * tot_dim],
+                                            ADD_VALUES));
+        }
+        blk.cells.restore_point_range(c_start, c_end, cells);
+    }
+    diag.zero();
+    local_to_global(loc_diag, ADD_VALUES, diag);
+}
+
+void
+FENonlinearProblem::set_up_coo_assembly(Matrix & mat)
+{
+    CALL_STACK_MSG();
+    auto dm = get_dm();
+    PetscDS ds;
+    PETSC_CHECK(DMGetDS(dm, &ds));
+    PetscBool is_aij;
+    PETSC_CHECK(PetscObjectTypeCompareAny((PetscObject) (Mat) mat,
+                                          &is_aij,
+                                          MATSEQAIJ,
+                                          MATMPIAIJ,
+                                          ""));
+    PetscBool transform;
+    PETSC_CHECK(DMHasBasisTransform(dm, &transform));
+    if (!is_aij || transform || !has_plain_closures(dm, ds))
+        throw Exception("COO assembly requires an AIJ matrix and elements without DoF "
+                        "permutations, anchors or basis transformations.");
+
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscSection global_section;
+    PETSC_CHECK(DMGetGlobalSection(dm, &global_section));
+
+    // element matrices are laid out region by region, in the order the cells are assembled
+    this->coo = COOAssembly();
+    this->coo.mat = mat;
+    std::vector<Int> rows, cols;
+    for (auto & region : get_weak_form().get_jacobian_regions()) {
+        auto & cell_is = get_region_cells(region);
+        Int n_cells = cell_is.get_local_size();
+        auto threaded = get_num_assembly_threads() > 1 && n_cells > 0;
+        const IndexSet & asmbl_is =
+            threaded ? get_jacobian_coloring(dm, region, cell_is).cells : cell_is;
+        this->coo.regions[region] = { (Int) rows.size(), n_cells };
+        rows.reserve(rows.size() + n_cells * tot_dim * tot_dim);
+        cols.reserve(cols.size() + n_cells * tot_dim * tot_dim);
+
+        Int c_start, c_end;
+        const Int * cells;
+        asmbl_is.get_point_range(c_start, c_end, cells);
+        for (Int c = c_start; c < c_end; ++c) {
+            const Int cell = cells ? cells[c] : c;
+            Int n_idx;
+            Int * idx = nullptr;
+            PETSC_CHECK(DMPlexGetClosureIndices(dm,
+                                                section,
+                                                global_section,
+                                                cell,
+                                                PETSC_TRUE,
+                                                &n_idx,
+                                                &idx,
+                                                nullptr,
+                                                nullptr));
+            if (n_idx != tot_dim)
+                throw InternalError(fmt::format("Cell {} has {} closure indices, expected {}.",
+                                                cell,
+                                                n_idx,
+                                                tot_dim));
+            // negative (constrained) indices are ignored by PETSc
+            for (Int i = 0; i < n_idx; ++i) {
+                for (Int j = 0; j < n_idx; ++j) {
+                    rows.push_back(idx[i]);
+                    cols.push_back(idx[j]);
+                }
+            }
+            PETSC_CHECK(DMPlexRestoreClosureIndices(dm,
+                                                    section,
+                                                    global_section,
+                                                    cell,
+                                                    PETSC_TRUE,
+                                                    &n_idx,
+                                                    &idx,
+                                                    nullptr,
+                                                    nullptr));
+        }
+        asmbl_is.restore_point_range(c_start, c_end, cells);
+    }
+    this->coo.values.assign(rows.size(), 0.);
+    PETSC_CHECK(MatSetPreallocationCOO(mat, rows.size(), rows.data(), cols.data()));
 }
 
 void
@@ -744,10 +1148,17 @@ FENonlinearProblem::compute_jacobian_internal(DM dm,
                                               Matrix & Jp)
 {
     CALL_STACK_MSG();
-    Int n_cells = cell_is.get_local_size();
+    perf_log::ScopedEvent event(perf_log::event::compute_jacobian);
+    // With multiple assembly threads, cells are ordered by color and each color is integrated and
+    // inserted into the matrix concurrently
+    auto threaded = get_num_assembly_threads() > 1 && cell_is.get_local_size() > 0;
+    JacobianColoring * coloring = threaded ? &get_jacobian_coloring(dm, region, cell_is) : nullptr;
+    const IndexSet & asmbl_is = coloring ? coloring->cells : cell_is;
+
+    Int n_cells = asmbl_is.get_local_size();
     Int c_start, c_end;
     const Int * cells;
-    cell_is.get_point_range(c_start, c_end, cells);
+    asmbl_is.get_point_range(c_start, c_end, cells);
     PetscBool transform;
     PETSC_CHECK(DMHasBasisTransform(dm, &transform));
     DM tdm;
@@ -775,6 +1186,16 @@ FENonlinearProblem::compute_jacobian_internal(DM dm,
     if (has_jac && J == Jp)
         has_prec = PETSC_FALSE;
 
+    // With COO assembly, element matrices are only copied into the COO value array. The caller
+    // inserts the values of all regions with a single call in assemble_coo_jacobian()
+    COOAssembly::Block * coo_block = nullptr;
+    if (coo_overwrites(J, Jp)) {
+        auto it = this->coo.regions.find(region);
+        if (it == this->coo.regions.end() || it->second.n_cells != n_cells)
+            throw InternalError("COO pattern does not match the cells of the Jacobian region.");
+        coo_block = &it->second;
+    }
+
     Vec A;
     PETSC_CHECK(DMGetAuxiliaryVec(dm, region.label, region.value, 0, &A));
     DM dm_aux = nullptr;
@@ -782,7 +1203,7 @@ FENonlinearProblem::compute_jacobian_internal(DM dm,
     PetscDS prob_aux = nullptr;
     PetscSection section_aux;
     DM plex;
-    Int tot_dim_aux;
+    Int tot_dim_aux = 0;
     if (A) {
         PETSC_CHECK(VecGetDM(A, &dm_aux));
         PETSC_CHECK(DMGetEnclosureRelation(dm_aux, dm, &enc_aux));
@@ -806,8 +1227,6 @@ FENonlinearProblem::compute_jacobian_internal(DM dm,
     if (dm_aux)
         PETSC_CHECK(PetscMalloc1(n_cells * tot_dim_aux, &a));
 
-    DMField coord_field;
-    PETSC_CHECK(DMGetCoordinateField(dm, &coord_field));
     for (Int c = c_start; c < c_end; ++c) {
         const Int cell = cells ? cells[c] : c;
         const Int cind = c - c_start;
@@ -837,154 +1256,134 @@ FENonlinearProblem::compute_jacobian_internal(DM dm,
         PETSC_CHECK(PetscArrayzero(elem_mat, n_cells * tot_dim * tot_dim));
     if (has_prec)
         PETSC_CHECK(PetscArrayzero(elem_mat_P, n_cells * tot_dim * tot_dim));
+
+    std::vector<PetscFEGeom *> cgeoms(n_fields, nullptr);
     for (Int field_i = 0; field_i < n_fields; ++field_i) {
         PetscFE fe;
         PETSC_CHECK(PetscDSGetDiscretization(prob, field_i, (PetscObject *) &fe));
-        PetscClassId id;
-        PETSC_CHECK(PetscObjectGetClassId((PetscObject) fe, &id));
-        Int n_basis;
-        PETSC_CHECK(PetscFEGetDimension(fe, &n_basis));
-        Int n_batches, n_blocks;
-        PETSC_CHECK(PetscFEGetTileSizes(fe, nullptr, &n_blocks, nullptr, &n_batches));
-        Int max_degree;
-        PETSC_CHECK(DMFieldGetDegree(coord_field, cell_is, nullptr, &max_degree));
-        PetscQuadrature q_geom = nullptr;
-        if (max_degree <= 1) {
-            PETSC_CHECK(DMFieldCreateDefaultQuadrature(coord_field, cell_is, &q_geom));
-        }
-        if (!q_geom) {
-            PETSC_CHECK(PetscFEGetQuadrature(fe, &q_geom));
-            PETSC_CHECK(PetscObjectReference((PetscObject) q_geom));
-        }
-        Int n_qpts;
-        PETSC_CHECK(PetscQuadratureGetData(q_geom, nullptr, nullptr, &n_qpts, nullptr, nullptr));
-        PetscFEGeom * cgeom_fem;
-#if PETSC_VERSION_GE(3, 23, 0)
-        PETSC_CHECK(DMSNESGetFEGeom(coord_field, cell_is, q_geom, PETSC_FEGEOM_BASIC, &cgeom_fem));
-#else
-        PETSC_CHECK(DMSNESGetFEGeom(coord_field, cell_is, q_geom, PETSC_FALSE, &cgeom_fem));
-#endif
-        Int block_size = n_basis;
-        Int batch_size = n_blocks * block_size;
-        PETSC_CHECK(PetscFESetTileSizes(fe, block_size, n_blocks, batch_size, n_batches));
-        Int num_chunks = n_cells / (n_batches * batch_size);
-        Int n_elems = num_chunks * n_batches * batch_size;
-        Int n_remdr = n_cells % (n_batches * batch_size);
-        Int offset = n_cells - n_remdr;
-        PetscFEGeom * chunk_geom = nullptr;
-        PETSC_CHECK(PetscFEGeomGetChunk(cgeom_fem, 0, offset, &chunk_geom));
-        PetscFEGeom * rem_geom = nullptr;
-        PETSC_CHECK(PetscFEGeomGetChunk(cgeom_fem, offset, n_cells, &rem_geom));
-        for (Int field_j = 0; field_j < n_fields; ++field_j) {
-            WeakForm::Key key(region, field_i, field_j);
-            if (has_jac) {
-                integrate_jacobian(prob,
-                                   PETSCFE_JACOBIAN,
-                                   key,
-                                   n_elems,
-                                   chunk_geom,
-                                   u,
-                                   u_t,
-                                   prob_aux,
-                                   a,
-                                   t,
-                                   x_t_shift,
-                                   elem_mat);
-                integrate_jacobian(prob,
-                                   PETSCFE_JACOBIAN,
-                                   key,
-                                   n_remdr,
-                                   rem_geom,
-                                   &u[offset * tot_dim],
-                                   u_t ? &u_t[offset * tot_dim] : nullptr,
-                                   prob_aux,
-                                   &a[offset * tot_dim_aux],
-                                   t,
-                                   x_t_shift,
-                                   &elem_mat[offset * tot_dim * tot_dim]);
-            }
-            if (has_prec) {
-                integrate_jacobian(prob,
-                                   PETSCFE_JACOBIAN_PRE,
-                                   key,
-                                   n_elems,
-                                   chunk_geom,
-                                   u,
-                                   u_t,
-                                   prob_aux,
-                                   a,
-                                   t,
-                                   x_t_shift,
-                                   elem_mat_P);
-                integrate_jacobian(prob,
-                                   PETSCFE_JACOBIAN_PRE,
-                                   key,
-                                   n_remdr,
-                                   rem_geom,
-                                   &u[offset * tot_dim],
-                                   u_t ? &u_t[offset * tot_dim] : nullptr,
-                                   prob_aux,
-                                   &a[offset * tot_dim_aux],
-                                   t,
-                                   x_t_shift,
-                                   &elem_mat_P[offset * tot_dim * tot_dim]);
+        cgeoms[field_i] = get_cell_geometry(dm, region, asmbl_is, fe);
+    }
+
+    // Matrices that element matrices are written into directly by the assembly threads
+    Mat direct_jac = nullptr, direct_prec = nullptr;
+    if (coloring && !transform && !coo_block) {
+        Mat mat_jac = has_prec ? (Mat) J : (Mat) Jp;
+        if (has_jac && can_insert_directly(dm, prob, mat_jac) &&
+            update_insertion_map(dm, *coloring, tot_dim, mat_jac, coloring->jac))
+            direct_jac = mat_jac;
+        if (has_prec && can_insert_directly(dm, prob, Jp) &&
+            update_insertion_map(dm, *coloring, tot_dim, Jp, coloring->prec))
+            direct_prec = Jp;
+    }
+
+    Int n_colors = coloring ? (Int) coloring->color_offsets.size() - 1 : 1;
+    for (Int color = 0; color < n_colors; ++color) {
+        Int cs = coloring ? coloring->color_offsets[color] : 0;
+        Int ce = coloring ? coloring->color_offsets[color + 1] : n_cells;
+        Optional<perf_log::ScopedEvent> color_event;
+        if (coloring)
+            color_event.emplace(coloring->color_events[color]);
+
+        for (Int field_i = 0; field_i < n_fields; ++field_i) {
+            PetscFEGeom * chunk_geom = nullptr;
+            PETSC_CHECK(PetscFEGeomGetChunk(cgeoms[field_i], cs, ce, &chunk_geom));
+            for (Int field_j = 0; field_j < n_fields; ++field_j) {
+                WeakForm::Key key(region, field_i, field_j);
+                if (has_jac)
+                    integrate_jacobian_chunked(prob,
+                                               PETSCFE_JACOBIAN,
+                                               key,
+                                               ce - cs,
+                                               chunk_geom,
+                                               &u[cs * tot_dim],
+                                               u_t ? &u_t[cs * tot_dim] : nullptr,
+                                               prob_aux,
+                                               a ? &a[cs * tot_dim_aux] : nullptr,
+                                               t,
+                                               x_t_shift,
+                                               &elem_mat[cs * tot_dim * tot_dim]);
+                if (has_prec)
+                    integrate_jacobian_chunked(prob,
+                                               PETSCFE_JACOBIAN_PRE,
+                                               key,
+                                               ce - cs,
+                                               chunk_geom,
+                                               &u[cs * tot_dim],
+                                               u_t ? &u_t[cs * tot_dim] : nullptr,
+                                               prob_aux,
+                                               a ? &a[cs * tot_dim_aux] : nullptr,
+                                               t,
+                                               x_t_shift,
+                                               &elem_mat_P[cs * tot_dim * tot_dim]);
             }
+            PETSC_CHECK(PetscFEGeomRestoreChunk(cgeoms[field_i], cs, ce, &chunk_geom));
         }
-        PETSC_CHECK(PetscFEGeomRestoreChunk(cgeom_fem, offset, n_cells, &rem_geom));
-        PETSC_CHECK(PetscFEGeomRestoreChunk(cgeom_fem, 0, offset, &chunk_geom));
-        PETSC_CHECK(DMSNESRestoreFEGeom(coord_field, cell_is, q_geom, PETSC_FALSE, &cgeom_fem));
-        PETSC_CHECK(PetscQuadratureDestroy(&q_geom));
-    }
-    // Add contribution from X_t
-    // Insert values into matrix
-    for (Int c = c_start; c < c_end; ++c) {
-        const Int cell = cells ? cells[c] : c;
-        const Int cind = c - c_start;
 
-        // Transform to global basis before insertion in Jacobian
-        if (transform)
-            PETSC_CHECK(internal::DMPlexBasisTransformPointTensor_Internal(
-                dm,
-                tdm,
-                tv,
-                cell,
-                PETSC_TRUE,
-                tot_dim,
-                &elem_mat[cind * tot_dim * tot_dim]));
-        if (has_prec) {
-            if (has_jac)
-                PETSC_CHECK(DMPlexMatSetClosure(dm,
-                                                section,
-                                                global_section,
-                                                J,
-                                                cell,
-                                                &elem_mat[cind * tot_dim * tot_dim],
-                                                ADD_VALUES));
-            PETSC_CHECK(DMPlexMatSetClosure(dm,
-                                            section,
-                                            global_section,
-                                            Jp,
-                                            cell,
-                                            &elem_mat_P[cind * tot_dim * tot_dim],
-                                            ADD_VALUES));
+        // Insert values into matrix
+        if (coo_block) {
+            const Scalar * src = has_jac ? elem_mat : elem_mat_P;
+            Int n_vals = tot_dim * tot_dim;
+            std::copy(src + cs * n_vals,
+                      src + ce * n_vals,
+                      this->coo.values.data() + coo_block->offset + cs * n_vals);
+            continue;
         }
-        else {
-            if (has_jac)
-                PETSC_CHECK(DMPlexMatSetClosure(dm,
-                                                section,
-                                                global_section,
-                                                Jp,
-                                                cell,
-                                                &elem_mat[cind * tot_dim * tot_dim],
-                                                ADD_VALUES));
+        if (direct_jac)
+            insert_directly(coloring->jac, tot_dim, cs, ce, elem_mat, direct_jac);
+        if (direct_prec)
+            insert_directly(coloring->prec, tot_dim, cs, ce, elem_mat_P, direct_prec);
+        for (Int c = c_start + cs; c < c_start + ce; ++c) {
+            const Int cell = cells ? cells[c] : c;
+            const Int cind = c - c_start;
+
+            // Transform to global basis before insertion in Jacobian
+            if (transform)
+                PETSC_CHECK(internal::DMPlexBasisTransformPointTensor_Internal(
+                    dm,
+                    tdm,
+                    tv,
+                    cell,
+                    PETSC_TRUE,
+                    tot_dim,
+                    &elem_mat[cind * tot_dim * tot_dim]));
+            if (has_prec) {
+                if (has_jac && !direct_jac)
+                    PETSC_CHECK(DMPlexMatSetClosure(dm,
+                                                    section,
+                                                    global_section,
+                                                    J,
+                                                    cell,
+                                                    &elem_mat[cind * tot_dim * tot_dim],
+                                                    ADD_VALUES));
+                if (!direct_prec)
+                    PETSC_CHECK(DMPlexMatSetClosure(dm,
+                                                    section,
+                                                    global_section,
+                                                    Jp,
+                                                    cell,
+                                                    &elem_mat_P[cind * tot_dim * tot_dim],
+                                                    ADD_VALUES));
+            }
+            else {
+                if (has_jac && !direct_jac)
+                    PETSC_CHECK(DMPlexMatSetClosure(dm,
+                                                    section,
+                                                    global_section,
+                                                    Jp,
+                                                    cell,
+                                                    &elem_mat[cind * tot_dim * tot_dim],
+                                                    ADD_VALUES));
+            }
         }
     }
-    cell_is.restore_point_range(c_start, c_end, cells);
+    asmbl_is.restore_point_range(c_start, c_end, cells);
     PETSC_CHECK(PetscFree4(u, u_t, elem_mat, elem_mat_P));
     if (dm_aux) {
         PETSC_CHECK(PetscFree(a));
         PETSC_CHECK(DMDestroy(&plex));
     }
+    if (coo_block)
+        return;
     // Compute boundary integrals
     compute_bnd_jacobian_internal(dm, X, X_t, t, x_t_shift, J, Jp);
     // Assemble matrix
@@ -1000,6 +1399,249 @@ FENonlinearProblem::compute_jacobian_internal(DM dm,
     Jp.assemble();
 }
 
+FENonlinearProblem::JacobianColoring &
+FENonlinearProblem::get_jacobian_coloring(DM dm,
+                                          const WeakForm::Region & region,
+                                          const IndexSet & cell_is)
+{
+    CALL_STACK_MSG();
+    auto & coloring = this->jac_colorings[region];
+    Int n_cells = cell_is.get_local_size();
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscObjectId cells_id = cell_is.get_id();
+    PetscObjectId dm_id, section_id;
+    PETSC_CHECK(PetscObjectGetId((PetscObject) dm, &dm_id));
+    PETSC_CHECK(PetscObjectGetId((PetscObject) section, &section_id));
+    if (coloring.n_cells == n_cells && coloring.cells_id == cells_id && coloring.dm_id == dm_id &&
+        coloring.section_id == section_id)
+        return coloring;
+
+    // Greedy coloring: two cells conflict when they share a point with DoFs in their closures
+    Int p_start, p_end;
+    PETSC_CHECK(PetscSectionGetChart(section, &p_start, &p_end));
+    std::vector<std::vector<Int>> point_colors(p_end - p_start);
+    std::vector<Int> cell_color(n_cells);
+    // forbidden[color] == c means `color` is already used by a neighbor of cell c
+    std::vector<Int> forbidden;
+    std::vector<Int> color_count;
+    Int c_start, c_end;
+    const Int * cells;
+    cell_is.get_point_range(c_start, c_end, cells);
+    for (Int c = c_start; c < c_end; ++c) {
+        const Int cell = cells ? cells[c] : c;
+        Int n_closure;
+        Int * closure = nullptr;
+        PETSC_CHECK(DMPlexGetTransitiveClosure(dm, cell, PETSC_TRUE, &n_closure, &closure));
+        std::vector<Int> dof_points;
+        for (Int i = 0; i < n_closure; ++i) {
+            auto pt = closure[2 * i];
+            if (pt < p_start || pt >= p_end)
+                continue;
+            Int n_dofs;
+            PETSC_CHECK(PetscSectionGetDof(section, pt, &n_dofs));
+            if (n_dofs > 0)
+                dof_points.push_back(pt - p_start);
+        }
+        PETSC_CHECK(DMPlexRestoreTransitiveClosure(dm, cell, PETSC_TRUE, &n_closure, &closure));
+
+        for (auto pt : dof_points)
+            for (auto clr : point_colors[pt])
+                forbidden[clr] = c;
+        Int color = 0;
+        while (color < (Int) forbidden.size() && forbidden[color] == c)
+            ++color;
+        if (color == (Int) forbidden.size()) {
+            forbidden.push_back(c_start - 1);
+            color_count.push_back(0);
+        }
+        cell_color[c - c_start] = color;
+        color_count[color]++;
+        for (auto pt : dof_points)
+            point_colors[pt].push_back(color);
+    }
+
+    Int n_colors = (Int) color_count.size();
+    coloring.color_offsets.assign(n_colors + 1, 0);
+    for (Int i = 0; i < n_colors; ++i)
+        coloring.color_offsets[i + 1] = coloring.color_offsets[i] + color_count[i];
+    // events are registered here rather than per evaluation, ranks with different numbers of colors
+    // are reconciled when the perf log is written
+    coloring.color_events.resize(n_colors);
+    for (Int i = 0; i < n_colors; ++i) {
+        auto name = fmt::format("FENonlinearProblem::JacobianColor{}", i);
+        coloring.color_events[i] = perf_log::is_event_registered(name.c_str())
+                                       ? perf_log::get_event_id(name.c_str())
+                                       : perf_log::register_event(name.c_str());
+    }
+    std::vector<Int> sorted(n_cells);
+    std::vector<Int> pos(coloring.color_offsets.begin(), coloring.color_offsets.end() - 1);
+    for (Int c = c_start; c < c_end; ++c)
+        sorted[pos[cell_color[c - c_start]]++] = cells ? cells[c] : c;
+    cell_is.restore_point_range(c_start, c_end, cells);
+
+    coloring.cells = IndexSet::create_general(cell_is.get_comm(), sorted);
+    coloring.n_cells = n_cells;
+    coloring.cells_id = cells_id;
+    coloring.dm_id = dm_id;
+    coloring.section_id = section_id;
+    coloring.jac = InsertionMap();
+    coloring.prec = InsertionMap();
+    return coloring;
+}
+
+bool
+FENonlinearProblem::can_insert_directly(DM dm, PetscDS ds, Mat mat) const
+{
+    CALL_STACK_MSG();
+    PetscBool is_seq_aij;
+    PETSC_CHECK(PetscObjectTypeCompare((PetscObject) mat, MATSEQAIJ, &is_seq_aij));
+    if (!is_seq_aij)
+        return false;
+    return has_plain_closures(dm, ds);
+}
+
+bool
+FENonlinearProblem::has_plain_closures(DM dm, PetscDS ds) const
+{
+    CALL_STACK_MSG();
+    // Anchors and DoF permutations change element matrices during insertion
+    PetscSection anchor_section;
+    PETSC_CHECK(DMPlexGetAnchors(dm, &anchor_section, nullptr));
+    if (anchor_section)
+        return false;
+    Int n_fields;
+    PETSC_CHECK(PetscDSGetNumFields(ds, &n_fields));
+    for (Int f = 0; f < n_fields; ++f) {
+        PetscFE fe;
+        PETSC_CHECK(PetscDSGetDiscretization(ds, f, (PetscObject *) &fe));
+        PetscDualSpace dual_space;
+        PETSC_CHECK(PetscFEGetDualSpace(fe, &dual_space));
+        const Int *** perms;
+        const Scalar *** flips;
+        PETSC_CHECK(PetscDualSpaceGetSymmetries(dual_space, &perms, &flips));
+        if (perms || flips)
+            return false;
+    }
+    return true;
+}
+
+bool
+FENonlinearProblem::update_insertion_map(DM dm,
+                                         const JacobianColoring & coloring,
+                                         Int tot_dim,
+                                         Mat mat,
+                                         InsertionMap & map)
+{
+    CALL_STACK_MSG();
+    PetscObjectState nnz_state;
+    PETSC_CHECK(MatGetNonzeroState(mat, &nnz_state));
+    if (map.mat == mat && map.nnz_state == nnz_state)
+        return !map.pos.empty();
+
+    map.mat = mat;
+    map.nnz_state = nnz_state;
+    map.pos.clear();
+
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscSection global_section;
+    PETSC_CHECK(DMGetGlobalSection(dm, &global_section));
+    Int n_rows;
+    const Int *ia, *ja;
+    PetscBool done;
+    PETSC_CHECK(MatGetRowIJ(mat, 0, PETSC_FALSE, PETSC_FALSE, &n_rows, &ia, &ja, &done));
+    if (!done)
+        return false;
+
+    std::vector<Int> pos(coloring.n_cells * tot_dim * tot_dim, -1);
+    bool found_all = true;
+    Int c_start, c_end;
+    const Int * cells;
+    coloring.cells.get_point_range(c_start, c_end, cells);
+    for (Int c = c_start; c < c_end && found_all; ++c) {
+        const Int cell = cells ? cells[c] : c;
+        Int * cell_pos = &pos[(c - c_start) * tot_dim * tot_dim];
+        Int n_idx;
+        Int * idx = nullptr;
+        PETSC_CHECK(DMPlexGetClosureIndices(dm,
+                                            section,
+                                            global_section,
+                                            cell,
+                                            PETSC_TRUE,
+                                            &n_idx,
+                                            &idx,
+                                            nullptr,
+                                            nullptr));
+        if (n_idx != tot_dim)
+            found_all = false;
+        for (Int i = 0; i < n_idx && found_all; ++i) {
+            auto row = idx[i];
+            if (row < 0)
+                continue;
+            if (row >= n_rows) {
+                found_all = false;
+                break;
+            }
+            for (Int j = 0; j < n_idx; ++j) {
+                auto col = idx[j];
+                if (col < 0)
+                    continue;
+                auto first = ja + ia[row];
+                auto last = ja + ia[row + 1];
+                auto it = std::lower_bound(first, last, col);
+                if (it == last || *it != col) {
+                    found_all = false;
+                    break;
+                }
+                cell_pos[i * tot_dim + j] = (Int) (it - ja);
+            }
+        }
+        PETSC_CHECK(DMPlexRestoreClosureIndices(dm,
+                                                section,
+                                                global_section,
+                                                cell,
+                                                PETSC_TRUE,
+                                                &n_idx,
+                                                &idx,
+                                                nullptr,
+                                                nullptr));
+    }
+    coloring.cells.restore_point_range(c_start, c_end, cells);
+    PETSC_CHECK(MatRestoreRowIJ(mat, 0, PETSC_FALSE, PETSC_FALSE, &n_rows, &ia, &ja, &done));
+
+    if (found_all)
+        map.pos = std::move(pos);
+    return found_all;
+}
+
+void
+FENonlinearProblem::insert_directly(const InsertionMap & map,
+                                    Int tot_dim,
+                                    Int cs,
+                                    Int ce,
+                                    const Scalar elem_mat[],
+                                    Mat mat)
+{
+    CALL_STACK_MSG();
+    // Cells of one color do not share any DoF, so each thread writes into different rows
+    Scalar * vals;
+    PETSC_CHECK(MatSeqAIJGetArray(mat, &vals));
+    auto & pool = get_assembly_thread_pool();
+    Int n_chunks = std::max<Int>(1, std::min<Int>(pool.get_num_threads(), ce - cs));
+    Int mat_size = tot_dim * tot_dim;
+    pool.parallel_for(n_chunks, [&](Int i) {
+        Int first = cs + ((ce - cs) * i) / n_chunks;
+        Int last = cs + ((ce - cs) * (i + 1)) / n_chunks;
+        for (Int k = first * mat_size; k < last * mat_size; ++k) {
+            auto p = map.pos[k];
+            if (p >= 0)
+                vals[p] += elem_mat[k];
+        }
+    });
+    PETSC_CHECK(MatSeqAIJRestoreArray(mat, &vals));
+}
+
 void
 FENonlinearProblem::compute_bnd_jacobian_internal(DM dm,
                                                   Vec X_loc,
@@ -1010,11 +1652,9 @@ FENonlinearProblem::compute_bnd_jacobian_internal(DM dm,
                                                   Mat Jp)
 {
     CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::compute_bnd_jacobian);
     PetscDS prob;
     PETSC_CHECK(DMGetDS(dm, &prob));
-    auto depth_label = get_mesh()->get_depth_label();
-    auto dim = get_dimension();
-    auto facets = depth_label.get_stratum(dim - 1);
     Int n_bnd;
     PETSC_CHECK(PetscDSGetNumBoundary(prob, &n_bnd));
     DMField coord_field = nullptr;
@@ -1057,8 +1697,7 @@ FENonlinearProblem::compute_bnd_jacobian_internal(DM dm,
                                              x_t_shift,
                                              J,
                                              Jp,
-                                             coord_field,
-                                             facets);
+                                             coord_field);
     }
 }
 
@@ -1074,8 +1713,7 @@ FENonlinearProblem::compute_bnd_jacobian_single_internal(DM dm,
                                                          Real x_t_shift,
                                                          Mat /* J */,
                                                          Mat Jp,
-                                                         DMField coord_field,
-                                                         const IndexSet & facets)
+                                                         DMField coord_field)
 {
     CALL_STACK_MSG();
     DM plex = nullptr;
@@ -1115,15 +1753,10 @@ FENonlinearProblem::compute_bnd_jacobian_single_internal(DM dm,
     PetscSection global_section;
     PETSC_CHECK(DMGetGlobalSection(dm, &global_section));
     for (Int v = 0; v < n_values; ++v) {
-        auto points = label.get_stratum(values[v]);
+        auto points = get_boundary_facets(label, values[v]);
         if (!points)
             continue; /* No points with that id on this process */
 
-        // TODO: Special cases of ISIntersect where it is quick to check a prior if one is a
-        // superset of the other
-        auto isect = IndexSet::intersect_caching(facets, points);
-        points = isect;
-
         Int n_faces = points.get_local_size();
         auto point_idxs = points.borrow_indices();
 
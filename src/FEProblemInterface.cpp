@@ -17,7 +17,10 @@
 #include "godzilla/DependencyGraph.h"
 #include "godzilla/Exception.h"
 #include "godzilla/Assert.h"
+#include "godzilla/PerfLog.h"
 #include "petsc/private/petscfeimpl.h"
+#include <algorithm>
+#include <array>
 
 namespace godzilla {
 
@@ -41,24 +44,176 @@ add_functionals(DependencyGraph<const Functional *> & g,
     }
 }
 
+namespace {
+
+/// Number of quadrature points evaluated together by batched functionals
+constexpr Int QP_BATCH_SIZE = 128;
+
+/// Maximum number of cell geometries kept by `get_cell_geometry`
+constexpr Int MAX_GEOM_CACHE_ENTRIES = 64;
+
+template <typename FUNC>
+bool
+all_batched(const std::vector<FUNC *> & fns)
+{
+    for (auto & f : fns)
+        if (!f->is_batched())
+            return false;
+    return true;
+}
+
+/// Evaluate Jacobian functions into `g` (`n` values) and multiply them by quadrature weight `w`
+void
+evaluate_weighted(const std::vector<JacobianFunc *> & fns, Real w, Int n, Scalar g[])
+{
+    for (Int k = 0; k < n; ++k)
+        g[k] = 0.;
+    if (fns.empty())
+        return;
+    for (auto & func : fns)
+        func->evaluate(g);
+    for (Int k = 0; k < n; ++k)
+        g[k] *= w;
+}
+
+/// Find the position of the region of a weak form key
+///
+/// @return Index into `regions`, -1 if not found
+Int
+find_region(const std::vector<WeakForm::Region> & regions, const WeakForm::Key & key)
+{
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        auto & r = regions[i];
+        if (r.label == key.label && r.value == key.value && r.part == key.part)
+            return i;
+    }
+    return -1;
+}
+
+/// Get the kinds of Jacobian forms (G0-G3) assembled for a Jacobian type
+std::array<WeakForm::JacobianKind, 4>
+get_jacobian_kinds(PetscFEJacobianType jtype)
+{
+    switch (jtype) {
+    case PETSCFE_JACOBIAN_DYN:
+        return { WeakForm::GT0, WeakForm::GT1, WeakForm::GT2, WeakForm::GT3 };
+    case PETSCFE_JACOBIAN_PRE:
+        return { WeakForm::GP0, WeakForm::GP1, WeakForm::GP2, WeakForm::GP3 };
+    default:
+    case PETSCFE_JACOBIAN:
+        return { WeakForm::G0, WeakForm::G1, WeakForm::G2, WeakForm::G3 };
+    }
+}
+
+/// Check if all fields of a discrete system are mapped into real space without a Piola transform,
+/// i.e. values are unchanged and gradients are multiplied by the inverse of the cell Jacobian
+bool
+has_identity_pushforward(PetscDS ds)
+{
+    Int n_fields;
+    PETSC_CHECK(PetscDSGetNumFields(ds, &n_fields));
+    for (Int f = 0; f < n_fields; ++f) {
+        PetscObject obj;
+        PETSC_CHECK(PetscDSGetDiscretization(ds, f, &obj));
+        PetscClassId id;
+        PETSC_CHECK(PetscObjectGetClassId(obj, &id));
+        if (id != PETSCFE_CLASSID)
+            return false;
+        PetscDualSpace sp;
+        PETSC_CHECK(PetscFEGetDualSpace((PetscFE) obj, &sp));
+        Int k;
+        PETSC_CHECK(PetscDualSpaceGetDeRahm(sp, &k));
+        if (k != 0)
+            return false;
+    }
+    return true;
+}
+
+/// Estimate floating point operations needed to evaluate all field jets at the quadrature points
+/// of one cell
+perf_log::LogDouble
+field_jets_flops(PetscDS ds)
+{
+    Int n_fields;
+    PETSC_CHECK(PetscDSGetNumFields(ds, &n_fields));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    perf_log::LogDouble flops = 0;
+    for (Int f = 0; f < n_fields; ++f)
+        flops += 2. * T[f]->Np * T[f]->Nb * T[f]->Nc * (1 + T[f]->cdim);
+    return flops;
+}
+
+/// Estimate floating point operations of integrating a residual block over `n_elems` cells
+///
+/// Counts the evaluation of field jets and the contraction with test functions. Work done inside
+/// the residual functions themselves is not included.
+perf_log::LogDouble
+residual_flops(PetscDS ds, Int field, Int n_elems)
+{
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    auto Tf = T[field];
+    auto test = 2. * Tf->Np * Tf->Nb * Tf->Nc * (1 + Tf->cdim);
+    return n_elems * (field_jets_flops(ds) + test);
+}
+
+/// Estimate floating point operations of integrating a Jacobian block over `n_elems` cells
+///
+/// Counts the evaluation of field jets and the contraction with test and basis functions. Work
+/// done inside the Jacobian functions themselves is not included.
+perf_log::LogDouble
+jacobian_flops(PetscDS ds, Int field_i, Int field_j, Int n_elems)
+{
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    auto Ti = T[field_i];
+    auto Tj = T[field_j];
+    auto n_derivs = (perf_log::LogDouble) (1 + Ti->cdim);
+    auto test_basis = 2. * Ti->Np * Ti->Nb * Ti->Nc * Tj->Nb * Tj->Nc * n_derivs * n_derivs;
+    return n_elems * (field_jets_flops(ds) + test_basis);
+}
+
+} // namespace
+
 FEProblemInterface::AssemblyData::AssemblyData(Dimension dim) :
     dim(dim),
+    xyz(dim),
+    normals(dim),
+    time(0.),
+    u_t_shift(0.)
+{
+}
+
+FEProblemInterface::AssemblyWorkspace::AssemblyWorkspace() :
     u(nullptr),
     u_t(nullptr),
     u_x(nullptr),
-    xyz(dim),
-    normals(dim),
     a(nullptr),
     a_x(nullptr),
-    time(0.),
-    u_t_shift(0.)
+    f0(nullptr),
+    f1(nullptr),
+    g0(nullptr),
+    g1(nullptr),
+    g2(nullptr),
+    g3(nullptr),
+    basis_real(nullptr),
+    basis_der_real(nullptr),
+    test_real(nullptr),
+    test_der_real(nullptr)
 {
 }
 
 FEProblemInterface::FEProblemInterface(Problem & problem, const Parameters & pars) :
     DiscreteProblemInterface(problem, pars),
     DependencyEvaluator(),
-    qorder(PETSC_DETERMINE)
+    qorder(PETSC_DETERMINE),
+    work(1),
+    n_assembly_threads(1),
+    sum_factorization(true),
+    geom_cache_coord_field(nullptr),
+    geom_cache_coord_state(0),
+    geom_cache_clock(0)
 {
     CALL_STACK_MSG();
 }
@@ -66,6 +221,7 @@ FEProblemInterface::FEProblemInterface(Problem & problem, const Parameters & par
 FEProblemInterface::~FEProblemInterface()
 {
     CALL_STACK_MSG();
+    clear_geometry_cache();
     for (auto & [_, info] : this->fields)
         PetscFEDestroy(&info.fe);
     for (auto & [_, info] : this->aux_fields)
@@ -121,6 +277,7 @@ FEProblemInterface::init()
         bc->set_up_weak_form();
 
     sort_functionals();
+    set_up_assembly_threads();
 }
 
 Int
@@ -478,19 +635,21 @@ FEProblemInterface::set_up_assembly_data()
 {
     CALL_STACK_MSG();
     auto ds = get_ds();
-    PETSC_CHECK(
-        PetscDSGetEvaluationArrays(ds, &this->asmbl->u, &this->asmbl->u_t, &this->asmbl->u_x));
+    auto & ws = this->work[0];
+    PETSC_CHECK(PetscDSGetEvaluationArrays(ds, &ws.u, &ws.u_t, &ws.u_x));
     Int *u_offset, *u_offset_x;
     PETSC_CHECK(PetscDSGetComponentOffsets(ds, &u_offset));
     PETSC_CHECK(PetscDSGetComponentDerivativeOffsets(ds, &u_offset_x));
     for (auto & [_, info] : this->fields) {
-        info.values.set(this->asmbl->u + u_offset[info.id.value()]);
-        info.derivs.set(this->asmbl->u_x + u_offset_x[info.id.value()]);
-        info.dots.set(this->asmbl->u_t + u_offset[info.id.value()]);
+        info.values.set(0, ws.u + u_offset[info.id.value()]);
+        info.derivs.set(0, ws.u_x + u_offset_x[info.id.value()]);
+        info.dots.set(0, ws.u_t + u_offset[info.id.value()]);
+        info.batch = BatchField(false, u_offset[info.id.value()]);
     }
     Real * coord;
     PETSC_CHECK(PetscDSGetWorkspace(ds, &coord, nullptr, nullptr, nullptr, nullptr));
-    this->asmbl->xyz.set(coord);
+    this->asmbl->xyz.set(0, coord);
+    this->tensor_bases = create_tensor_bases(ds);
 }
 
 void
@@ -523,16 +682,507 @@ FEProblemInterface::set_up_assembly_data_aux()
     CALL_STACK_MSG();
     auto ds_aux = get_ds_aux();
     if (ds_aux) {
-        PETSC_CHECK(
-            PetscDSGetEvaluationArrays(ds_aux, &this->asmbl->a, nullptr, &this->asmbl->a_x));
+        auto & ws = this->work[0];
+        PETSC_CHECK(PetscDSGetEvaluationArrays(ds_aux, &ws.a, nullptr, &ws.a_x));
         Int *a_offset, *a_offset_x;
         PETSC_CHECK(PetscDSGetComponentOffsets(ds_aux, &a_offset));
         PETSC_CHECK(PetscDSGetComponentDerivativeOffsets(ds_aux, &a_offset_x));
 
         for (auto & [id, fi] : this->aux_fields) {
-            fi.values.set(this->asmbl->a + a_offset[fi.id.value()]);
-            fi.derivs.set(this->asmbl->a_x + a_offset_x[fi.id.value()]);
+            fi.values.set(0, ws.a + a_offset[fi.id.value()]);
+            fi.derivs.set(0, ws.a_x + a_offset_x[fi.id.value()]);
+            fi.batch = BatchField(true, a_offset[fi.id.value()]);
+        }
+        this->tensor_bases_aux = create_tensor_bases(ds_aux);
+    }
+}
+
+void
+FEProblemInterface::set_up_assembly_threads()
+{
+    CALL_STACK_MSG();
+    Int n_threads = this->n_assembly_threads > 1 ? this->n_assembly_threads : 0;
+    this->thread_pool.resize(n_threads);
+    this->work.resize(n_threads + 1);
+    if (n_threads == 0)
+        return;
+
+    // Sizes follow what PetscDSSetUp allocates for the main thread
+    auto ds = get_ds();
+    Int dim_embed;
+    PETSC_CHECK(PetscDSGetCoordinateDimension(ds, &dim_embed));
+    Int n_comp;
+    PETSC_CHECK(PetscDSGetTotalComponents(ds, &n_comp));
+    Int *u_offset, *u_offset_x;
+    PETSC_CHECK(PetscDSGetComponentOffsets(ds, &u_offset));
+    PETSC_CHECK(PetscDSGetComponentDerivativeOffsets(ds, &u_offset_x));
+    Int nq_max = 0, nb_max = 0, nc_max = 0;
+    PetscTabulation *T, *T_face;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    PETSC_CHECK(PetscDSGetFaceTabulation(ds, &T_face));
+    for (Int f = 0; f < get_num_fields(); ++f) {
+        nq_max = std::max({ nq_max, T[f]->Np, T_face[f]->Np });
+        nb_max = std::max(nb_max, T[f]->Nb);
+        nc_max = std::max(nc_max, T[f]->Nc);
+    }
+
+    auto ds_aux = get_ds_aux();
+    Int n_comp_aux = 0;
+    Int *a_offset = nullptr, *a_offset_x = nullptr;
+    if (ds_aux) {
+        PETSC_CHECK(PetscDSGetTotalComponents(ds_aux, &n_comp_aux));
+        PETSC_CHECK(PetscDSGetComponentOffsets(ds_aux, &a_offset));
+        PETSC_CHECK(PetscDSGetComponentDerivativeOffsets(ds_aux, &a_offset_x));
+    }
+
+    // gradients have room for Hessians
+    Int sz_u = n_comp;
+    Int sz_u_x = n_comp * dim_embed * (1 + dim_embed);
+    Int sz_a = n_comp_aux;
+    Int sz_a_x = n_comp_aux * dim_embed * (1 + dim_embed);
+    Int sz_f0 = nq_max * nc_max;
+    Int sz_f1 = sz_f0 * dim_embed;
+    Int sz_g0 = nq_max * nc_max * nc_max;
+    Int sz_g1 = sz_g0 * dim_embed;
+    Int sz_g3 = sz_g1 * dim_embed;
+    Int sz_basis = nb_max * nc_max;
+    Int sz_basis_der = sz_basis * dim_embed;
+    for (Int slot = 1; slot <= n_threads; ++slot) {
+        auto & ws = this->work[slot];
+        ws.storage.assign(3 * sz_u + sz_u_x + sz_a + sz_a_x + sz_f0 + sz_f1 + sz_g0 + 2 * sz_g1 +
+                              sz_g3 + 2 * sz_basis + 2 * sz_basis_der,
+                          0.);
+        ws.coord.assign(dim_embed, 0.);
+        Scalar * p = ws.storage.data();
+        auto take = [&p](Int n) {
+            auto * q = p;
+            p += n;
+            return q;
+        };
+        ws.u = take(sz_u);
+        ws.u_t = take(sz_u);
+        ws.u_x = take(sz_u_x);
+        ws.a = take(sz_a);
+        ws.a_x = take(sz_a_x);
+        ws.f0 = take(sz_f0);
+        ws.f1 = take(sz_f1);
+        ws.g0 = take(sz_g0);
+        ws.g1 = take(sz_g1);
+        ws.g2 = take(sz_g1);
+        ws.g3 = take(sz_g3);
+        ws.basis_real = take(sz_basis);
+        ws.basis_der_real = take(sz_basis_der);
+        ws.test_real = take(sz_basis);
+        ws.test_der_real = take(sz_basis_der);
+
+        for (auto & [_, info] : this->fields) {
+            info.values.set(slot, ws.u + u_offset[info.id.value()]);
+            info.derivs.set(slot, ws.u_x + u_offset_x[info.id.value()]);
+            info.dots.set(slot, ws.u_t + u_offset[info.id.value()]);
+        }
+        if (ds_aux) {
+            for (auto & [_, fi] : this->aux_fields) {
+                fi.values.set(slot, ws.a + a_offset[fi.id.value()]);
+                fi.derivs.set(slot, ws.a_x + a_offset_x[fi.id.value()]);
+            }
+        }
+        this->asmbl->xyz.set(slot, ws.coord.data());
+        this->asmbl->normals.set(slot, nullptr);
+    }
+}
+
+void
+FEProblemInterface::set_num_assembly_threads(Int n_threads)
+{
+    CALL_STACK_MSG();
+    expect_true(n_threads >= 1, "Number of assembly threads must be at least 1.");
+#if defined(PETSC_USE_DEBUG) && !defined(PETSC_HAVE_THREADSAFETY)
+    // PETSc keeps a global function stack in debug builds, so calling into it from several
+    // threads at once is not safe
+    if (n_threads > 1)
+        get_problem()->warning(
+            "PETSc was built with debugging and without thread safety, assembly will run on a "
+            "single thread.");
+    this->n_assembly_threads = 1;
+#else
+    this->n_assembly_threads = n_threads;
+#endif
+}
+
+Int
+FEProblemInterface::get_num_assembly_threads() const
+{
+    CALL_STACK_MSG();
+    return this->n_assembly_threads;
+}
+
+void
+FEProblemInterface::set_sum_factorization(bool use)
+{
+    CALL_STACK_MSG();
+    this->sum_factorization = use;
+}
+
+bool
+FEProblemInterface::uses_sum_factorization() const
+{
+    CALL_STACK_MSG();
+    return this->sum_factorization;
+}
+
+ThreadPool &
+FEProblemInterface::get_assembly_thread_pool()
+{
+    CALL_STACK_MSG();
+    return this->thread_pool;
+}
+
+PetscFEGeom *
+FEProblemInterface::get_cell_geometry(DM dm,
+                                      const WeakForm::Region & region,
+                                      const IndexSet & cells,
+                                      PetscFE fe)
+{
+    CALL_STACK_MSG();
+    return get_shared_cell_geometry(dm, region, cells, fe).get();
+}
+
+std::shared_ptr<PetscFEGeom>
+FEProblemInterface::get_shared_cell_geometry(DM dm,
+                                             const WeakForm::Region & region,
+                                             const IndexSet & cells,
+                                             PetscFE fe)
+{
+    CALL_STACK_MSG();
+    DMField coord_field = nullptr;
+    PETSC_CHECK(DMGetCoordinateField(dm, &coord_field));
+    Vec coords = nullptr;
+    PETSC_CHECK(DMGetCoordinatesLocal(dm, &coords));
+    PetscObjectState coord_state = 0;
+    if (coords)
+        PETSC_CHECK(PetscObjectStateGet((PetscObject) coords, &coord_state));
+    if (coord_field != this->geom_cache_coord_field ||
+        coord_state != this->geom_cache_coord_state) {
+        clear_geometry_cache();
+        this->geom_cache_coord_field = coord_field;
+        this->geom_cache_coord_state = coord_state;
+    }
+
+    PetscQuadrature fe_quad = nullptr;
+    PETSC_CHECK(PetscFEGetQuadrature(fe, &fe_quad));
+    PetscObjectId cells_id = cells.get_id();
+    PetscObjectState cells_state;
+    PETSC_CHECK(PetscObjectStateGet((PetscObject) (IS) cells, &cells_state));
+    ++this->geom_cache_clock;
+    for (auto & entry : this->geom_cache) {
+        if (entry.cells_id == cells_id && entry.cells_state == cells_state &&
+            entry.region == region && (entry.fe_quad == nullptr || entry.fe_quad == fe_quad)) {
+            perf_log::ScopedEvent event(perf_log::event::geometry_cache_hit);
+            entry.last_use = this->geom_cache_clock;
+            return entry.geom;
+        }
+    }
+
+    perf_log::ScopedEvent event(perf_log::event::geometry_cache_miss);
+    // evict the least recently used entry
+    if ((Int) this->geom_cache.size() >= MAX_GEOM_CACHE_ENTRIES) {
+        auto lru = std::min_element(this->geom_cache.begin(),
+                                    this->geom_cache.end(),
+                                    [](const CachedGeometry & a, const CachedGeometry & b) {
+                                        return a.last_use < b.last_use;
+                                    });
+        this->geom_cache.erase(lru);
+    }
+
+    CachedGeometry entry;
+    entry.region = region;
+    entry.fe_quad = nullptr;
+    entry.cells = cells;
+    entry.cells_id = cells_id;
+    entry.cells_state = cells_state;
+    entry.last_use = this->geom_cache_clock;
+    PetscQuadrature quad = nullptr;
+    Int max_degree = PETSC_MAX_INT;
+    PETSC_CHECK(DMFieldGetDegree(coord_field, cells, nullptr, &max_degree));
+    if (max_degree <= 1)
+        PETSC_CHECK(DMFieldCreateDefaultQuadrature(coord_field, cells, &quad));
+    if (!quad) {
+        entry.fe_quad = fe_quad;
+        quad = fe_quad;
+        PETSC_CHECK(PetscObjectReference((PetscObject) quad));
+    }
+    PetscFEGeom * geom = nullptr;
+#if PETSC_VERSION_GE(3, 23, 0)
+    PETSC_CHECK(DMFieldCreateFEGeom(coord_field, cells, quad, PETSC_FEGEOM_BASIC, &geom));
+#else
+    PETSC_CHECK(DMFieldCreateFEGeom(coord_field, cells, quad, PETSC_FALSE, &geom));
+#endif
+    entry.geom = std::shared_ptr<PetscFEGeom>(geom, [quad](PetscFEGeom * g) {
+        PetscQuadrature q = quad;
+        PetscFEGeomDestroy(&g);
+        PetscQuadratureDestroy(&q);
+    });
+    this->geom_cache.push_back(entry);
+    return entry.geom;
+}
+
+void
+FEProblemInterface::clear_geometry_cache()
+{
+    CALL_STACK_MSG();
+    // geometry still held by other owners is destroyed when they release it
+    this->geom_cache.clear();
+    this->geom_cache_coord_field = nullptr;
+    this->geom_cache_coord_state = 0;
+}
+
+Int
+FEProblemInterface::get_num_assembly_chunks(const std::vector<const ValueFunctional *> & fnls,
+                                            Int n_elems) const
+{
+    CALL_STACK_MSG();
+    // Values provided by value functionals live in a single storage, so those keys must be
+    // evaluated serially
+    if (!fnls.empty())
+        return 1;
+    return std::max<Int>(1, std::min(this->thread_pool.get_num_threads(), n_elems));
+}
+
+FEProblemInterface::AssemblyWorkspace &
+FEProblemInterface::get_workspace(PetscDS ds)
+{
+    auto & ws = this->work[get_thread_slot()];
+    if (get_thread_slot() == 0) {
+        PETSC_CHECK(PetscDSGetWorkspace(ds,
+                                        nullptr,
+                                        &ws.basis_real,
+                                        &ws.basis_der_real,
+                                        &ws.test_real,
+                                        &ws.test_der_real));
+        PETSC_CHECK(PetscDSGetWeakFormArrays(ds, &ws.f0, &ws.f1, &ws.g0, &ws.g1, &ws.g2, &ws.g3));
+    }
+    return ws;
+}
+
+std::vector<TensorProductBasis>
+FEProblemInterface::create_tensor_bases(PetscDS ds) const
+{
+    CALL_STACK_MSG();
+    if (!this->sum_factorization || get_mesh()->is_simplex())
+        return {};
+
+    Int n_fields;
+    PETSC_CHECK(PetscDSGetNumFields(ds, &n_fields));
+    std::vector<TensorProductBasis> bases(n_fields);
+    for (Int f = 0; f < n_fields; ++f) {
+        PetscObject obj;
+        PETSC_CHECK(PetscDSGetDiscretization(ds, f, &obj));
+        PetscClassId id;
+        PETSC_CHECK(PetscObjectGetClassId(obj, &id));
+        // hessians are not available from the factorized bases
+        if (id != PETSCFE_CLASSID || ds->jetDegree[f] > 1)
+            return {};
+        if (!bases[f].create((PetscFE) obj))
+            return {};
+    }
+    return bases;
+}
+
+bool
+FEProblemInterface::use_tensor_kernels(PetscDS ds, PetscDS ds_aux, PetscFEGeom * cell_geom) const
+{
+    CALL_STACK_MSG();
+    if (this->tensor_bases.empty() || ds != get_ds())
+        return false;
+    if (ds_aux && (this->tensor_bases_aux.empty() || ds_aux != get_ds_aux()))
+        return false;
+    return cell_geom->dimEmbed == cell_geom->dim;
+}
+
+void
+FEProblemInterface::evaluate_field_jets_tensor(AssemblyWorkspace & ws,
+                                               const std::vector<TensorProductBasis> & bases,
+                                               PetscFEGeom * cell_geom,
+                                               Int e,
+                                               const Scalar coefficients[],
+                                               const Scalar coefficients_t[],
+                                               std::vector<Scalar> & u,
+                                               std::vector<Scalar> & u_x,
+                                               std::vector<Scalar> & u_t)
+{
+    CALL_STACK_MSG();
+    Int dim = cell_geom->dim;
+    Int n_q = bases[0].get_num_qpoints();
+    Int n_comp = 0;
+    for (auto & basis : bases)
+        n_comp += basis.get_num_components();
+    u.resize(n_q * n_comp);
+    u_x.resize(n_q * n_comp * dim);
+    if (coefficients_t)
+        u_t.resize(n_q * n_comp);
+
+    auto & tw = ws.tensor;
+    Int d_offset = 0, f_offset = 0;
+    for (auto & basis : bases) {
+        Int nc = basis.get_num_components();
+        tw.val.resize(n_q * nc);
+        tw.grad.resize(n_q * nc * dim);
+        tw.work.resize(basis.get_work_size());
+        basis.interpolate(&coefficients[d_offset], tw.val.data(), tw.grad.data(), tw.work.data());
+        for (Int q = 0; q < n_q; ++q) {
+            PetscFEGeom fe_geom;
+            PETSC_CHECK(PetscFEGeomGetCellPoint(cell_geom, e, q, &fe_geom));
+            for (Int c = 0; c < nc; ++c) {
+                const Scalar * grad_ref = &tw.grad[(q * nc + c) * dim];
+                Scalar * grad = &u_x[(q * n_comp + f_offset + c) * dim];
+                u[q * n_comp + f_offset + c] = tw.val[q * nc + c];
+                for (Int d = 0; d < dim; ++d) {
+                    grad[d] = 0.;
+                    for (Int k = 0; k < dim; ++k)
+                        grad[d] += grad_ref[k] * fe_geom.invJ[k * dim + d];
+                }
+            }
+        }
+        if (coefficients_t) {
+            basis.interpolate(&coefficients_t[d_offset], tw.val.data(), nullptr, tw.work.data());
+            for (Int q = 0; q < n_q; ++q)
+                for (Int c = 0; c < nc; ++c)
+                    u_t[q * n_comp + f_offset + c] = tw.val[q * nc + c];
+        }
+        d_offset += basis.get_num_basis();
+        f_offset += nc;
+    }
+}
+
+void
+FEProblemInterface::load_field_jets_tensor(AssemblyWorkspace & ws,
+                                           Int q,
+                                           bool has_u_t,
+                                           bool has_aux)
+{
+    auto & tw = ws.tensor;
+    Int n_q = this->tensor_bases[0].get_num_qpoints();
+    Int n_comp = tw.u.size() / n_q;
+    Int n_der = tw.u_x.size() / n_q;
+    std::copy_n(&tw.u[q * n_comp], n_comp, ws.u);
+    std::copy_n(&tw.u_x[q * n_der], n_der, ws.u_x);
+    if (has_u_t)
+        std::copy_n(&tw.u_t[q * n_comp], n_comp, ws.u_t);
+    if (has_aux) {
+        Int n_comp_aux = tw.a.size() / n_q;
+        Int n_der_aux = tw.a_x.size() / n_q;
+        std::copy_n(&tw.a[q * n_comp_aux], n_comp_aux, ws.a);
+        std::copy_n(&tw.a_x[q * n_der_aux], n_der_aux, ws.a_x);
+    }
+}
+
+void
+FEProblemInterface::update_element_vec_tensor(AssemblyWorkspace & ws,
+                                              const TensorProductBasis & basis,
+                                              PetscFEGeom * cell_geom,
+                                              Int e,
+                                              const Scalar f0[],
+                                              const Scalar f1[],
+                                              Scalar elem_vec[])
+{
+    CALL_STACK_MSG();
+    Int dim = cell_geom->dim;
+    Int n_q = basis.get_num_qpoints();
+    Int nc = basis.get_num_components();
+    auto & tw = ws.tensor;
+    // grad phi . f1 = grad_ref phi . (invJ f1)
+    tw.f1.resize(n_q * nc * dim);
+    for (Int q = 0; q < n_q; ++q) {
+        PetscFEGeom fe_geom;
+        PETSC_CHECK(PetscFEGeomGetCellPoint(cell_geom, e, q, &fe_geom));
+        for (Int c = 0; c < nc; ++c) {
+            const Scalar * f1_q = &f1[(q * nc + c) * dim];
+            Scalar * f1_ref = &tw.f1[(q * nc + c) * dim];
+            for (Int k = 0; k < dim; ++k) {
+                f1_ref[k] = 0.;
+                for (Int d = 0; d < dim; ++d)
+                    f1_ref[k] += fe_geom.invJ[k * dim + d] * f1_q[d];
+            }
+        }
+    }
+    tw.work.resize(basis.get_work_size());
+    basis.integrate(f0, tw.f1.data(), elem_vec, tw.work.data());
+}
+
+void
+FEProblemInterface::update_element_mat_tensor(AssemblyWorkspace & ws,
+                                              const TensorProductBasis & basis_i,
+                                              const TensorProductBasis & basis_j,
+                                              PetscFEGeom * cell_geom,
+                                              Int e,
+                                              const Scalar g[],
+                                              Int tot_dim,
+                                              Int offset_i,
+                                              Int offset_j,
+                                              Scalar elem_mat[])
+{
+    CALL_STACK_MSG();
+    Int dim = cell_geom->dim;
+    Int n_q = basis_i.get_num_qpoints();
+    Int nb_i = basis_i.get_num_basis();
+    Int nb_j = basis_j.get_num_basis();
+    Int nc_i = basis_i.get_num_components();
+    Int nc_j = basis_j.get_num_components();
+    Int n_comp_ij = nc_i * nc_j;
+    Int n_g = n_comp_ij * (1 + dim) * (1 + dim);
+    auto & tw = ws.tensor;
+    tw.inv_j.resize(n_q * dim * dim);
+    for (Int q = 0; q < n_q; ++q) {
+        PetscFEGeom fe_geom;
+        PETSC_CHECK(PetscFEGeomGetCellPoint(cell_geom, e, q, &fe_geom));
+        std::copy_n(fe_geom.invJ, dim * dim, &tw.inv_j[q * dim * dim]);
+    }
+    tw.phi.resize(n_q);
+    tw.dphi.resize(n_q * dim);
+    tw.f0.resize(n_q * nc_i);
+    tw.f1.resize(n_q * nc_i * dim);
+    tw.col.resize(nb_i);
+    tw.work.resize(basis_i.get_work_size());
+    // Each trial function gives integrands f0 = g0 phi + g1 . grad phi and f1 = g2 phi + g3 grad
+    // phi, which are integrated against all test functions at once into one column
+    Scalar grad[3], f1_q[3];
+    for (Int gb = 0; gb < nb_j; ++gb) {
+        Int gc = basis_j.get_component(gb);
+        basis_j.tabulate(gb, tw.phi.data(), tw.dphi.data());
+        for (Int q = 0; q < n_q; ++q) {
+            const Real * inv_j = &tw.inv_j[q * dim * dim];
+            for (Int d = 0; d < dim; ++d) {
+                grad[d] = 0.;
+                for (Int k = 0; k < dim; ++k)
+                    grad[d] += tw.dphi[q * dim + k] * inv_j[k * dim + d];
+            }
+            const Scalar * g0 = &g[q * n_g];
+            const Scalar * g1 = g0 + n_comp_ij;
+            const Scalar * g2 = g1 + n_comp_ij * dim;
+            const Scalar * g3 = g2 + n_comp_ij * dim;
+            for (Int fc = 0; fc < nc_i; ++fc) {
+                const Int ij = fc * nc_j + gc;
+                Scalar f0 = g0[ij] * tw.phi[q];
+                for (Int df = 0; df < dim; ++df) {
+                    f0 += g1[ij * dim + df] * grad[df];
+                    f1_q[df] = g2[ij * dim + df] * tw.phi[q];
+                    for (Int dg = 0; dg < dim; ++dg)
+                        f1_q[df] += g3[(ij * dim + df) * dim + dg] * grad[dg];
+                }
+                tw.f0[q * nc_i + fc] = f0;
+                // grad phi . f1 = grad_ref phi . (invJ f1)
+                Scalar * f1_ref = &tw.f1[(q * nc_i + fc) * dim];
+                for (Int k = 0; k < dim; ++k) {
+                    f1_ref[k] = 0.;
+                    for (Int d = 0; d < dim; ++d)
+                        f1_ref[k] += inv_j[k * dim + d] * f1_q[d];
+                }
+            }
         }
+        std::fill(tw.col.begin(), tw.col.end(), 0.);
+        basis_i.integrate(tw.f0.data(), tw.f1.data(), tw.col.data(), tw.work.data());
+        for (Int fb = 0; fb < nb_i; ++fb)
+            elem_mat[(offset_i + fb) * tot_dim + offset_j + gb] += tw.col[fb];
     }
 }
 
@@ -585,6 +1235,20 @@ FEProblemInterface::get_field_dot(String field_name) const
         throw Exception(fmt::format("Field '{}' does not exist. Typo?", field_name));
 }
 
+const BatchField &
+FEProblemInterface::get_batch_field(String field_name) const
+{
+    CALL_STACK_MSG();
+    if (auto fid = get_field_id(field_name); fid.has_value()) {
+        return this->fields.at(fid.value()).batch;
+    }
+    else if (auto fid = get_aux_field_id(field_name); fid.has_value()) {
+        return this->aux_fields.at(fid.value()).batch;
+    }
+    else
+        throw Exception(fmt::format("Field '{}' does not exist. Typo?", field_name));
+}
+
 const Real &
 FEProblemInterface::get_time_shift() const
 {
@@ -619,10 +1283,17 @@ FEProblemInterface::sort_residual_functionals(
 {
     CALL_STACK_MSG();
     auto graph = build_dependecy_graph(suppliers);
-    this->sorted_res_functionals.clear();
-    for (auto & region : this->wf.get_residual_regions()) {
-        for (Int f = 0; f < get_num_fields(); ++f) {
+    auto n_fields = get_num_fields();
+    this->res_regions = this->wf.get_residual_regions();
+    this->res_blocks.assign(this->res_regions.size() * n_fields, ResidualBlock());
+    for (std::size_t r = 0; r < this->res_regions.size(); ++r) {
+        auto & region = this->res_regions[r];
+        for (Int f = 0; f < n_fields; ++f) {
             FieldID fid(f);
+            auto & blk = this->res_blocks[r * n_fields + f];
+            blk.f0 = this->wf.get(WeakForm::F0, region.label, region.value, fid, region.part);
+            blk.f1 = this->wf.get(WeakForm::F1, region.label, region.value, fid, region.part);
+
             auto f0_fnls = this->wf.get(WeakForm::F0, region.label, region.value, fid, 0);
             auto f1_fnls = this->wf.get(WeakForm::F1, region.label, region.value, fid, 0);
 
@@ -634,13 +1305,12 @@ FEProblemInterface::sort_residual_functionals(
             fnls.insert(fnls.end(), f1_fnls.begin(), f1_fnls.end());
             auto sv = graph.bfs(fnls);
 
-            WeakForm::Key key(region, f, 0);
             // bfs gives back a sorted vector, but in reverse order, so
             // we reverse the vector here to get the order of evaluation
             for (auto it = sv.rbegin(); it != sv.rend(); ++it) {
                 auto ofnl = dynamic_cast<const ValueFunctional *>(*it);
                 if (ofnl)
-                    this->sorted_res_functionals[key].push_back(ofnl);
+                    blk.fnls.push_back(ofnl);
             }
         }
     }
@@ -652,12 +1322,27 @@ FEProblemInterface::sort_jacobian_functionals(
 {
     CALL_STACK_MSG();
     auto graph = build_dependecy_graph(suppliers);
-    this->sorted_jac_functionals.clear();
-    for (auto & region : this->wf.get_jacobian_regions()) {
-        for (Int f = 0; f < get_num_fields(); ++f) {
+    auto n_fields = get_num_fields();
+    this->jac_regions = this->wf.get_jacobian_regions();
+    this->jac_blocks.assign(this->jac_regions.size() * n_fields * n_fields, JacobianBlock());
+    for (std::size_t r = 0; r < this->jac_regions.size(); ++r) {
+        auto & region = this->jac_regions[r];
+        for (Int f = 0; f < n_fields; ++f) {
             FieldID fid(f);
-            for (Int g = 0; g < get_num_fields(); ++g) {
+            for (Int g = 0; g < n_fields; ++g) {
                 FieldID gid(g);
+                auto & blk = this->jac_blocks[(r * n_fields + f) * n_fields + g];
+                for (auto jt : { PETSCFE_JACOBIAN, PETSCFE_JACOBIAN_PRE, PETSCFE_JACOBIAN_DYN }) {
+                    auto kinds = get_jacobian_kinds(jt);
+                    for (std::size_t k = 0; k < kinds.size(); ++k)
+                        blk.g[jt][k] = this->wf.get(kinds[k],
+                                                    region.label,
+                                                    region.value,
+                                                    fid,
+                                                    gid,
+                                                    region.part);
+                }
+
                 auto g0_fnls = this->wf.get(WeakForm::G0, region.label, region.value, fid, gid, 0);
                 auto g1_fnls = this->wf.get(WeakForm::G1, region.label, region.value, fid, gid, 0);
                 auto g2_fnls = this->wf.get(WeakForm::G2, region.label, region.value, fid, gid, 0);
@@ -675,13 +1360,12 @@ FEProblemInterface::sort_jacobian_functionals(
                 fnls.insert(fnls.end(), g3_fnls.begin(), g3_fnls.end());
                 auto sv = graph.bfs(fnls);
 
-                WeakForm::Key key(region, f, g);
                 // bfs gives back a sorted vector, but in reverse order, so
                 // we reverse the vector here to get the order of evaluation
                 for (auto it = sv.rbegin(); it != sv.rend(); ++it) {
                     auto ofnl = dynamic_cast<const ValueFunctional *>(*it);
                     if (ofnl)
-                        this->sorted_jac_functionals[key].push_back(ofnl);
+                        blk.fnls.push_back(ofnl);
                 }
             }
         }
@@ -697,6 +1381,30 @@ FEProblemInterface::sort_functionals()
     sort_jacobian_functionals(suppliers);
 }
 
+const FEProblemInterface::ResidualBlock &
+FEProblemInterface::get_residual_block(const WeakForm::Key & key) const
+{
+    static const ResidualBlock empty;
+    auto r = find_region(this->res_regions, key);
+    if (r >= 0)
+        return this->res_blocks[r * get_num_fields() + key.field];
+    else
+        return empty;
+}
+
+const FEProblemInterface::JacobianBlock &
+FEProblemInterface::get_jacobian_block(const WeakForm::Key & key) const
+{
+    static const JacobianBlock empty;
+    auto r = find_region(this->jac_regions, key);
+    if (r >= 0) {
+        auto n_fields = get_num_fields();
+        return this->jac_blocks[(r * n_fields + key.jac.field_i) * n_fields + key.jac.field_j];
+    }
+    else
+        return empty;
+}
+
 void
 FEProblemInterface::add_residual_block(FieldID fid,
                                        ResidualFunc * f0,
@@ -853,22 +1561,45 @@ FEProblemInterface::integrate_residual(PetscDS ds,
     CALL_STACK_MSG();
     Int field = key.field;
     FieldID fid(field);
-    const auto & f0_res_fns = this->wf.get(WeakForm::F0, key.label, key.value, fid, key.part);
-    const auto & f1_res_fns = this->wf.get(WeakForm::F1, key.label, key.value, fid, key.part);
+    const auto & blk = get_residual_block(key);
+    const auto & f0_res_fns = blk.f0;
+    const auto & f1_res_fns = blk.f1;
     if (f0_res_fns.empty() && f1_res_fns.empty())
         return;
 
     PetscFE & fe = this->fields.at(fid).fe;
 
-    Int fe_dim;
-    PETSC_CHECK(PetscFEGetSpatialDimension(fe, &fe_dim));
-    this->asmbl->dim = Dimension::from_int(fe_dim);
-    this->asmbl->time = t;
+    // worker threads only read the shared state, which is set before they are dispatched
+    if (get_thread_slot() == 0) {
+        Int fe_dim;
+        PETSC_CHECK(PetscFEGetSpatialDimension(fe, &fe_dim));
+        this->asmbl->dim = Dimension::from_int(fe_dim);
+        this->asmbl->time = t;
+    }
+
+    const auto & res_fnls = blk.fnls;
+    // value functionals are evaluated point by point, so they rule out batching
+    if (res_fnls.empty() && all_batched(f0_res_fns) && all_batched(f1_res_fns) &&
+        cell_geom->dimEmbed == this->asmbl->dim) {
+        integrate_residual_batched(ds,
+                                   key,
+                                   f0_res_fns,
+                                   f1_res_fns,
+                                   n_elems,
+                                   cell_geom,
+                                   coefficients,
+                                   coefficients_t,
+                                   ds_aux,
+                                   coefficients_aux,
+                                   elem_vec);
+        return;
+    }
 
-    Scalar *basis_real, *basis_der_real;
-    PETSC_CHECK(PetscDSGetWorkspace(ds, nullptr, &basis_real, &basis_der_real, nullptr, nullptr));
-    Scalar *f0, *f1;
-    PETSC_CHECK(PetscDSGetWeakFormArrays(ds, &f0, &f1, nullptr, nullptr, nullptr, nullptr));
+    auto & ws = get_workspace(ds);
+    Scalar * basis_real = ws.basis_real;
+    Scalar * basis_der_real = ws.basis_der_real;
+    Scalar * f0 = ws.f0;
+    Scalar * f1 = ws.f1;
     Int f_offset;
     PETSC_CHECK(PetscDSGetFieldOffset(ds, field, &f_offset));
     PetscTabulation * T;
@@ -904,6 +1635,8 @@ FEProblemInterface::integrate_residual(PetscDS ds,
 
     Int n_fields = get_num_fields();
     Int n_fields_aux = get_num_aux_fields();
+    bool tensor = use_tensor_kernels(ds, ds_aux, cell_geom);
+    auto & tw = ws.tensor;
     Int c_offset = 0;
     Int c_offset_aux = 0;
     for (Int e = 0; e < n_elems; ++e) {
@@ -914,24 +1647,49 @@ FEProblemInterface::integrate_residual(PetscDS ds,
         PETSC_CHECK(PetscArrayzero(f0, q_n_pts * T[field]->Nc));
         PETSC_CHECK(PetscArrayzero(f1, q_n_pts * T[field]->Nc * dim_embed));
 
+        if (tensor) {
+            evaluate_field_jets_tensor(ws,
+                                       this->tensor_bases,
+                                       cell_geom,
+                                       e,
+                                       &coefficients[c_offset],
+                                       coefficients_t ? &coefficients_t[c_offset] : nullptr,
+                                       tw.u,
+                                       tw.u_x,
+                                       tw.u_t);
+            if (ds_aux)
+                evaluate_field_jets_tensor(ws,
+                                           this->tensor_bases_aux,
+                                           cell_geom,
+                                           e,
+                                           &coefficients_aux[c_offset_aux],
+                                           nullptr,
+                                           tw.a,
+                                           tw.a_x,
+                                           tw.u_t);
+        }
+
         for (Int q = 0; q < q_n_pts; ++q) {
             PETSC_CHECK(
                 PetscFEGeomGetPoint(cell_geom, e, q, &q_points[q * cell_geom->dim], &fe_geom));
             this->asmbl->xyz.set(fe_geom.v);
             Real w = fe_geom.detJ[0] * q_weights[q];
 
-            evaluate_field_jets(ds,
-                                n_fields,
-                                0,
-                                q,
-                                T,
-                                &fe_geom,
-                                &coefficients[c_offset],
-                                coefficients_t ? &coefficients_t[c_offset] : nullptr,
-                                this->asmbl->u,
-                                this->asmbl->u_x,
-                                coefficients_t ? this->asmbl->u_t : nullptr);
-            if (ds_aux)
+            if (tensor)
+                load_field_jets_tensor(ws, q, coefficients_t != nullptr, ds_aux != nullptr);
+            else
+                evaluate_field_jets(ds,
+                                    n_fields,
+                                    0,
+                                    q,
+                                    T,
+                                    &fe_geom,
+                                    &coefficients[c_offset],
+                                    coefficients_t ? &coefficients_t[c_offset] : nullptr,
+                                    ws.u,
+                                    ws.u_x,
+                                    coefficients_t ? ws.u_t : nullptr);
+            if (ds_aux && !tensor)
                 evaluate_field_jets(ds_aux,
                                     n_fields_aux,
                                     0,
@@ -940,10 +1698,10 @@ FEProblemInterface::integrate_residual(PetscDS ds,
                                     &fe_geom,
                                     &coefficients_aux[c_offset_aux],
                                     nullptr,
-                                    this->asmbl->a,
-                                    this->asmbl->a_x,
+                                    ws.a,
+                                    ws.a_x,
                                     nullptr);
-            for (auto & f : this->sorted_res_functionals[key])
+            for (auto & f : res_fnls)
                 f->evaluate();
             for (auto & func : f0_res_fns)
                 func->evaluate(&f0[q * T[field]->Nc]);
@@ -956,16 +1714,25 @@ FEProblemInterface::integrate_residual(PetscDS ds,
                     f1[(q * T[field]->Nc + c) * this->asmbl->dim + d] *= w;
         }
 
-        update_element_vec(fe,
-                           T[field],
-                           0,
-                           basis_real,
-                           basis_der_real,
-                           e,
-                           cell_geom,
-                           f0,
-                           f1,
-                           &elem_vec[c_offset + f_offset]);
+        if (tensor)
+            update_element_vec_tensor(ws,
+                                      this->tensor_bases[field],
+                                      cell_geom,
+                                      e,
+                                      f0,
+                                      f1,
+                                      &elem_vec[c_offset + f_offset]);
+        else
+            update_element_vec(fe,
+                               T[field],
+                               0,
+                               basis_real,
+                               basis_der_real,
+                               e,
+                               cell_geom,
+                               f0,
+                               f1,
+                               &elem_vec[c_offset + f_offset]);
 
         c_offset += tot_dim;
         c_offset_aux += tot_dim_aux;
@@ -973,16 +1740,169 @@ FEProblemInterface::integrate_residual(PetscDS ds,
 }
 
 void
-FEProblemInterface::integrate_bnd_residual(PetscDS ds,
-                                           const WeakForm::Key & key,
-                                           Int n_elems,
-                                           PetscFEGeom * face_geom,
-                                           const Scalar coefficients[],
-                                           const Scalar coefficients_t[],
-                                           PetscDS ds_aux,
-                                           const Scalar coefficients_aux[],
-                                           Real t,
-                                           Scalar elem_vec[])
+FEProblemInterface::integrate_residual_chunked(PetscDS ds,
+                                               const WeakForm::Key & key,
+                                               Int n_elems,
+                                               PetscFEGeom * cell_geom,
+                                               const Scalar coefficients[],
+                                               const Scalar coefficients_t[],
+                                               PetscDS ds_aux,
+                                               const Scalar coefficients_aux[],
+                                               Real t,
+                                               Scalar elem_vec[])
+{
+    CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::integrate_residual);
+    const auto & blk = get_residual_block(key);
+    if (!blk.f0.empty() || !blk.f1.empty())
+        perf_log::log_flops(residual_flops(ds, key.field, n_elems));
+
+    auto n_chunks = get_num_assembly_chunks(blk.fnls, n_elems);
+    if (n_chunks == 1) {
+        integrate_residual(ds,
+                           key,
+                           n_elems,
+                           cell_geom,
+                           coefficients,
+                           coefficients_t,
+                           ds_aux,
+                           coefficients_aux,
+                           t,
+                           elem_vec);
+        return;
+    }
+
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    Int tot_dim_aux = 0;
+    if (ds_aux)
+        PETSC_CHECK(PetscDSGetTotalDimension(ds_aux, &tot_dim_aux));
+
+    PetscFE fe;
+    PETSC_CHECK(PetscDSGetDiscretization(ds, key.field, (PetscObject *) &fe));
+    Int fe_dim;
+    PETSC_CHECK(PetscFEGetSpatialDimension(fe, &fe_dim));
+    this->asmbl->dim = Dimension::from_int(fe_dim);
+    this->asmbl->time = t;
+    for_each_chunk(n_chunks, n_elems, cell_geom, [&](Int cs, Int n, PetscFEGeom * chunk_geom) {
+        integrate_residual(ds,
+                           key,
+                           n,
+                           chunk_geom,
+                           &coefficients[cs * tot_dim],
+                           coefficients_t ? &coefficients_t[cs * tot_dim] : nullptr,
+                           ds_aux,
+                           coefficients_aux ? &coefficients_aux[cs * tot_dim_aux] : nullptr,
+                           t,
+                           &elem_vec[cs * tot_dim]);
+    });
+}
+
+void
+FEProblemInterface::integrate_jacobian_chunked(PetscDS ds,
+                                               PetscFEJacobianType jtype,
+                                               const WeakForm::Key & key,
+                                               Int n_elems,
+                                               PetscFEGeom * cell_geom,
+                                               const Scalar coefficients[],
+                                               const Scalar coefficients_t[],
+                                               PetscDS ds_aux,
+                                               const Scalar coefficients_aux[],
+                                               Real t,
+                                               Real u_tshift,
+                                               Scalar elem_mat[])
+{
+    CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::integrate_jacobian);
+    const auto & blk = get_jacobian_block(key);
+    for (auto & fns : blk.g[jtype])
+        if (!fns.empty()) {
+            perf_log::log_flops(jacobian_flops(ds, key.jac.field_i, key.jac.field_j, n_elems));
+            break;
+        }
+
+    auto n_chunks = get_num_assembly_chunks(blk.fnls, n_elems);
+    if (n_chunks == 1) {
+        integrate_jacobian(ds,
+                           jtype,
+                           key,
+                           n_elems,
+                           cell_geom,
+                           coefficients,
+                           coefficients_t,
+                           ds_aux,
+                           coefficients_aux,
+                           t,
+                           u_tshift,
+                           elem_mat);
+        return;
+    }
+
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    Int tot_dim_aux = 0;
+    if (ds_aux)
+        PETSC_CHECK(PetscDSGetTotalDimension(ds_aux, &tot_dim_aux));
+
+    PetscFE fe;
+    PETSC_CHECK(PetscDSGetDiscretization(ds, key.jac.field_i, (PetscObject *) &fe));
+    Int fe_dim;
+    PETSC_CHECK(PetscFEGetSpatialDimension(fe, &fe_dim));
+    this->asmbl->dim = Dimension::from_int(fe_dim);
+    this->asmbl->time = t;
+    this->asmbl->u_t_shift = u_tshift;
+    for_each_chunk(n_chunks, n_elems, cell_geom, [&](Int cs, Int n, PetscFEGeom * chunk_geom) {
+        integrate_jacobian(ds,
+                           jtype,
+                           key,
+                           n,
+                           chunk_geom,
+                           &coefficients[cs * tot_dim],
+                           coefficients_t ? &coefficients_t[cs * tot_dim] : nullptr,
+                           ds_aux,
+                           coefficients_aux ? &coefficients_aux[cs * tot_dim_aux] : nullptr,
+                           t,
+                           u_tshift,
+                           &elem_mat[cs * tot_dim * tot_dim]);
+    });
+}
+
+void
+FEProblemInterface::for_each_chunk(Int n_chunks,
+                                   Int n_elems,
+                                   PetscFEGeom * cell_geom,
+                                   const std::function<void(Int, Int, PetscFEGeom *)> & fn)
+{
+    CALL_STACK_MSG();
+    // chunk geometries are created here, because PETSc allocates memory for them
+    std::vector<Int> chunk_start(n_chunks + 1);
+    std::vector<PetscFEGeom *> chunk_geom(n_chunks, nullptr);
+    for (Int i = 0; i <= n_chunks; ++i)
+        chunk_start[i] = (n_elems * i) / n_chunks;
+    for (Int i = 0; i < n_chunks; ++i)
+        PETSC_CHECK(
+            PetscFEGeomGetChunk(cell_geom, chunk_start[i], chunk_start[i + 1], &chunk_geom[i]));
+
+    this->thread_pool.parallel_for(n_chunks, [&](Int i) {
+        fn(chunk_start[i], chunk_start[i + 1] - chunk_start[i], chunk_geom[i]);
+    });
+
+    for (Int i = 0; i < n_chunks; ++i)
+        PETSC_CHECK(
+            PetscFEGeomRestoreChunk(cell_geom, chunk_start[i], chunk_start[i + 1], &chunk_geom[i]));
+}
+
+void
+FEProblemInterface::integrate_bnd_residual(PetscDS ds,
+                                           const WeakForm::Key & key,
+                                           Int n_elems,
+                                           PetscFEGeom * face_geom,
+                                           const Scalar coefficients[],
+                                           const Scalar coefficients_t[],
+                                           PetscDS ds_aux,
+                                           const Scalar coefficients_aux[],
+                                           Real t,
+                                           Scalar elem_vec[])
 {
     CALL_STACK_MSG();
     Int field = key.field;
@@ -991,6 +1911,7 @@ FEProblemInterface::integrate_bnd_residual(PetscDS ds,
     const auto & f1_res_fns = this->wf.get(WeakForm::BND_F1, key.label, key.value, fid, key.part);
     if (f0_res_fns.empty() && f1_res_fns.empty())
         return;
+    const auto & res_fnls = get_residual_block(key).fnls;
 
     PetscFE & fe = this->fields.at(fid).fe;
 
@@ -999,10 +1920,11 @@ FEProblemInterface::integrate_bnd_residual(PetscDS ds,
     this->asmbl->dim = Dimension::from_int(fe_dim);
     this->asmbl->time = t;
 
-    Scalar *basis_real, *basis_der_real;
-    PETSC_CHECK(PetscDSGetWorkspace(ds, nullptr, &basis_real, &basis_der_real, nullptr, nullptr));
-    Scalar *f0, *f1;
-    PETSC_CHECK(PetscDSGetWeakFormArrays(ds, &f0, &f1, nullptr, nullptr, nullptr, nullptr));
+    auto & ws = get_workspace(ds);
+    Scalar * basis_real = ws.basis_real;
+    Scalar * basis_der_real = ws.basis_der_real;
+    Scalar * f0 = ws.f0;
+    Scalar * f1 = ws.f1;
     Int f_offset;
     PETSC_CHECK(PetscDSGetFieldOffset(ds, field, &f_offset));
     Int tot_dim = 0;
@@ -1076,9 +1998,9 @@ FEProblemInterface::integrate_bnd_residual(PetscDS ds,
                                 &cell_geom,
                                 &coefficients[c_offset],
                                 coefficients_t ? &coefficients_t[c_offset] : nullptr,
-                                this->asmbl->u,
-                                this->asmbl->u_x,
-                                coefficients_t ? this->asmbl->u_t : nullptr);
+                                ws.u,
+                                ws.u_x,
+                                coefficients_t ? ws.u_t : nullptr);
             if (ds_aux)
                 evaluate_field_jets(ds_aux,
                                     n_fields_aux,
@@ -1088,10 +2010,10 @@ FEProblemInterface::integrate_bnd_residual(PetscDS ds,
                                     &cell_geom,
                                     &coefficients_aux[c_offset_aux],
                                     nullptr,
-                                    this->asmbl->a,
-                                    this->asmbl->a_x,
+                                    ws.a,
+                                    ws.a_x,
                                     nullptr);
-            for (auto & f : this->sorted_res_functionals[key])
+            for (auto & f : res_fnls)
                 f->evaluate();
             for (auto & func : f0_res_fns)
                 func->evaluate(&f0[q * n_comp_i]);
@@ -1141,50 +2063,54 @@ FEProblemInterface::integrate_jacobian(PetscDS ds,
     FieldID fid_i(field_i);
     FieldID fid_j(field_j);
 
-    WeakForm::JacobianKind kind0, kind1, kind2, kind3;
-    switch (jtype) {
-    case PETSCFE_JACOBIAN_DYN:
-        kind0 = WeakForm::GT0;
-        kind1 = WeakForm::GT1;
-        kind2 = WeakForm::GT2;
-        kind3 = WeakForm::GT3;
-        break;
-    case PETSCFE_JACOBIAN_PRE:
-        kind0 = WeakForm::GP0;
-        kind1 = WeakForm::GP1;
-        kind2 = WeakForm::GP2;
-        kind3 = WeakForm::GP3;
-        break;
-    default:
-    case PETSCFE_JACOBIAN:
-        kind0 = WeakForm::G0;
-        kind1 = WeakForm::G1;
-        kind2 = WeakForm::G2;
-        kind3 = WeakForm::G3;
-        break;
-    }
-
-    const auto & g0_jac_fns = this->wf.get(kind0, key.label, key.value, fid_i, fid_j, key.part);
-    const auto & g1_jac_fns = this->wf.get(kind1, key.label, key.value, fid_i, fid_j, key.part);
-    const auto & g2_jac_fns = this->wf.get(kind2, key.label, key.value, fid_i, fid_j, key.part);
-    const auto & g3_jac_fns = this->wf.get(kind3, key.label, key.value, fid_i, fid_j, key.part);
+    const auto & blk = get_jacobian_block(key);
+    const auto & [g0_jac_fns, g1_jac_fns, g2_jac_fns, g3_jac_fns] = blk.g[jtype];
     if (g0_jac_fns.empty() && g1_jac_fns.empty() && g2_jac_fns.empty() && g3_jac_fns.empty())
         return;
 
     PetscFE & fe_i = this->fields.at(fid_i).fe;
     PetscFE & fe_j = this->fields.at(fid_j).fe;
 
-    Int fe_dim;
-    PETSC_CHECK(PetscFEGetSpatialDimension(fe_i, &fe_dim));
-    this->asmbl->dim = Dimension::from_int(fe_dim);
-    this->asmbl->time = t;
-    this->asmbl->u_t_shift = u_tshift;
+    // worker threads only read the shared state, which is set before they are dispatched
+    if (get_thread_slot() == 0) {
+        Int fe_dim;
+        PETSC_CHECK(PetscFEGetSpatialDimension(fe_i, &fe_dim));
+        this->asmbl->dim = Dimension::from_int(fe_dim);
+        this->asmbl->time = t;
+        this->asmbl->u_t_shift = u_tshift;
+    }
 
-    Scalar *basis_real, *basis_der_real, *test_real, *test_der_real;
-    PETSC_CHECK(
-        PetscDSGetWorkspace(ds, nullptr, &basis_real, &basis_der_real, &test_real, &test_der_real));
-    Scalar *g0, *g1, *g2, *g3;
-    PETSC_CHECK(PetscDSGetWeakFormArrays(ds, nullptr, nullptr, &g0, &g1, &g2, &g3));
+    const auto & jac_fnls = blk.fnls;
+    // value functionals are evaluated point by point, so they rule out batching
+    if (jac_fnls.empty() && all_batched(g0_jac_fns) && all_batched(g1_jac_fns) &&
+        all_batched(g2_jac_fns) && all_batched(g3_jac_fns) &&
+        cell_geom->dimEmbed == this->asmbl->dim) {
+        const std::vector<JacobianFunc *> * g_fns[4] = { &g0_jac_fns,
+                                                         &g1_jac_fns,
+                                                         &g2_jac_fns,
+                                                         &g3_jac_fns };
+        integrate_jacobian_batched(ds,
+                                   key,
+                                   g_fns,
+                                   n_elems,
+                                   cell_geom,
+                                   coefficients,
+                                   coefficients_t,
+                                   ds_aux,
+                                   coefficients_aux,
+                                   elem_mat);
+        return;
+    }
+
+    auto & ws = get_workspace(ds);
+    Scalar * basis_real = ws.basis_real;
+    Scalar * basis_der_real = ws.basis_der_real;
+    Scalar * test_real = ws.test_real;
+    Scalar * test_der_real = ws.test_der_real;
+    Scalar * g0 = ws.g0;
+    Scalar * g1 = ws.g1;
+    Scalar * g2 = ws.g2;
+    Scalar * g3 = ws.g3;
     Int offset_i;
     PETSC_CHECK(PetscDSGetFieldOffset(ds, field_i, &offset_i));
     Int offset_j;
@@ -1212,6 +2138,13 @@ FEProblemInterface::integrate_jacobian(PetscDS ds,
     Int n_pts = cell_geom->numPoints;
     Int dim_embed = cell_geom->dimEmbed;
     bool is_affine = cell_geom->isAffine;
+    // with sum factorization, integrands of all points of a cell are collected first
+    bool tensor = use_tensor_kernels(ds, nullptr, cell_geom);
+    Int g_size[4] = { n_comp_i * n_comp_j,
+                      n_comp_i * n_comp_j * dim_embed,
+                      n_comp_i * n_comp_j * dim_embed,
+                      n_comp_i * n_comp_j * dim_embed * dim_embed };
+    Int n_g = g_size[0] + g_size[1] + g_size[2] + g_size[3];
 
     // Initialize here in case the function is not defined
     PETSC_CHECK(PetscArrayzero(g0, n_comp_i * n_comp_j));
@@ -1227,6 +2160,8 @@ FEProblemInterface::integrate_jacobian(PetscDS ds,
         PetscQuadratureGetData(quad, nullptr, &q_n_comp, &q_n_points, &q_points, &q_weights));
     expect_true(q_n_comp == 1,
                 fmt::format("Only supports scalar quadrature, not {} components", q_n_comp));
+    if (tensor)
+        ws.tensor.g.resize(q_n_points * n_g);
 
     // Offset into elem_mat[] for element e
     Int e_offset = 0;
@@ -1273,9 +2208,9 @@ FEProblemInterface::integrate_jacobian(PetscDS ds,
                                     &fe_geom,
                                     &coefficients[c_offset],
                                     coefficients_t ? &coefficients_t[c_offset] : nullptr,
-                                    this->asmbl->u,
-                                    this->asmbl->u_x,
-                                    coefficients_t ? this->asmbl->u_t : nullptr);
+                                    ws.u,
+                                    ws.u_x,
+                                    coefficients_t ? ws.u_t : nullptr);
             if (ds_aux)
                 evaluate_field_jets(ds_aux,
                                     n_fields_aux,
@@ -1285,10 +2220,10 @@ FEProblemInterface::integrate_jacobian(PetscDS ds,
                                     &fe_geom,
                                     &coefficients_aux[c_offset_aux],
                                     nullptr,
-                                    this->asmbl->a,
-                                    this->asmbl->a_x,
+                                    ws.a,
+                                    ws.a_x,
                                     nullptr);
-            for (auto & f : this->sorted_jac_functionals[key])
+            for (auto & f : jac_fnls)
                 f->evaluate();
             if (!g0_jac_fns.empty()) {
                 PETSC_CHECK(PetscArrayzero(g0, n_comp_i * n_comp_j));
@@ -1319,33 +2254,350 @@ FEProblemInterface::integrate_jacobian(PetscDS ds,
                     g3[c] *= w;
             }
 
-            update_element_mat(fe_i,
-                               fe_j,
-                               0,
-                               q,
-                               T[field_i],
-                               basis_real,
-                               basis_der_real,
-                               T[field_j],
-                               test_real,
-                               test_der_real,
-                               &fe_geom,
-                               g0,
-                               g1,
-                               g2,
-                               g3,
-                               e_offset,
-                               tot_dim,
-                               offset_i,
-                               offset_j,
-                               elem_mat);
+            if (tensor) {
+                Scalar * g_q = &ws.tensor.g[q * n_g];
+                g_q = std::copy_n(g0, g_size[0], g_q);
+                g_q = std::copy_n(g1, g_size[1], g_q);
+                g_q = std::copy_n(g2, g_size[2], g_q);
+                std::copy_n(g3, g_size[3], g_q);
+            }
+            else
+                update_element_mat(fe_i,
+                                   fe_j,
+                                   0,
+                                   q,
+                                   T[field_i],
+                                   basis_real,
+                                   basis_der_real,
+                                   T[field_j],
+                                   test_real,
+                                   test_der_real,
+                                   &fe_geom,
+                                   g0,
+                                   g1,
+                                   g2,
+                                   g3,
+                                   e_offset,
+                                   tot_dim,
+                                   offset_i,
+                                   offset_j,
+                                   elem_mat);
         }
+        if (tensor)
+            update_element_mat_tensor(ws,
+                                      this->tensor_bases[field_i],
+                                      this->tensor_bases[field_j],
+                                      cell_geom,
+                                      e,
+                                      ws.tensor.g.data(),
+                                      tot_dim,
+                                      offset_i,
+                                      offset_j,
+                                      &elem_mat[e_offset]);
         c_offset += tot_dim;
         c_offset_aux += tot_dim_aux;
         e_offset += PetscSqr(tot_dim);
     }
 }
 
+Int
+FEProblemInterface::get_jacobian_qp_size(PetscDS ds, const WeakForm::Key & key, Int dim_embed) const
+{
+    CALL_STACK_MSG();
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int n_comp_i = T[key.jac.field_i]->Nc;
+    Int n_comp_j = T[key.jac.field_j]->Nc;
+    return T[key.jac.field_i]->Np * n_comp_i * n_comp_j * (1 + dim_embed) * (1 + dim_embed);
+}
+
+void
+FEProblemInterface::evaluate_jacobian_qp(PetscDS ds,
+                                         PetscFEJacobianType jtype,
+                                         const WeakForm::Key & key,
+                                         Int n_elems,
+                                         PetscFEGeom * cell_geom,
+                                         const Scalar coefficients[],
+                                         const Scalar coefficients_t[],
+                                         PetscDS ds_aux,
+                                         const Scalar coefficients_aux[],
+                                         Real t,
+                                         Real u_tshift,
+                                         Scalar qp_data[])
+{
+    CALL_STACK_MSG();
+    Int field_i = key.jac.field_i;
+    Int field_j = key.jac.field_j;
+    const auto & blk = get_jacobian_block(key);
+    const auto & [g0_jac_fns, g1_jac_fns, g2_jac_fns, g3_jac_fns] = blk.g[jtype];
+    if (g0_jac_fns.empty() && g1_jac_fns.empty() && g2_jac_fns.empty() && g3_jac_fns.empty())
+        return;
+
+    PetscFE & fe_i = this->fields.at(FieldID(field_i)).fe;
+    Int fe_dim;
+    PETSC_CHECK(PetscFEGetSpatialDimension(fe_i, &fe_dim));
+    this->asmbl->dim = Dimension::from_int(fe_dim);
+    this->asmbl->time = t;
+    this->asmbl->u_t_shift = u_tshift;
+
+    auto & ws = get_workspace(ds);
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int n_comp_ij = T[field_i]->Nc * T[field_j]->Nc;
+
+    Int tot_dim_aux = 0;
+    PetscTabulation * T_aux = nullptr;
+    if (ds_aux) {
+        PETSC_CHECK(PetscDSGetTotalDimension(ds_aux, &tot_dim_aux));
+        PETSC_CHECK(PetscDSGetTabulation(ds_aux, &T_aux));
+    }
+
+    PetscQuadrature quad;
+    PETSC_CHECK(PetscFEGetQuadrature(fe_i, &quad));
+    Int q_n_pts;
+    const Real *q_points, *q_weights;
+    PETSC_CHECK(PetscQuadratureGetData(quad, nullptr, nullptr, &q_n_pts, &q_points, &q_weights));
+
+    Int dim_embed = cell_geom->dimEmbed;
+    Int n_qp = get_jacobian_qp_size(ds, key, dim_embed) / q_n_pts;
+    Int n_fields = get_num_fields();
+    Int n_fields_aux = get_num_aux_fields();
+    for (Int e = 0; e < n_elems; ++e) {
+        PetscFEGeom fe_geom;
+        fe_geom.v = this->asmbl->xyz.get();
+        for (Int q = 0; q < q_n_pts; ++q) {
+            PETSC_CHECK(
+                PetscFEGeomGetPoint(cell_geom, e, q, &q_points[q * cell_geom->dim], &fe_geom));
+            this->asmbl->xyz.set(fe_geom.v);
+            Real w = fe_geom.detJ[0] * q_weights[q];
+            evaluate_field_jets(ds,
+                                n_fields,
+                                0,
+                                q,
+                                T,
+                                &fe_geom,
+                                &coefficients[e * tot_dim],
+                                coefficients_t ? &coefficients_t[e * tot_dim] : nullptr,
+                                ws.u,
+                                ws.u_x,
+                                coefficients_t ? ws.u_t : nullptr);
+            if (ds_aux)
+                evaluate_field_jets(ds_aux,
+                                    n_fields_aux,
+                                    0,
+                                    q,
+                                    T_aux,
+                                    &fe_geom,
+                                    &coefficients_aux[e * tot_dim_aux],
+                                    nullptr,
+                                    ws.a,
+                                    ws.a_x,
+                                    nullptr);
+            for (auto & f : blk.fnls)
+                f->evaluate();
+
+            Scalar * g0 = &qp_data[(e * q_n_pts + q) * n_qp];
+            Scalar * g1 = g0 + n_comp_ij;
+            Scalar * g2 = g1 + n_comp_ij * dim_embed;
+            Scalar * g3 = g2 + n_comp_ij * dim_embed;
+            evaluate_weighted(g0_jac_fns, w, n_comp_ij, g0);
+            evaluate_weighted(g1_jac_fns, w, n_comp_ij * dim_embed, g1);
+            evaluate_weighted(g2_jac_fns, w, n_comp_ij * dim_embed, g2);
+            evaluate_weighted(g3_jac_fns, w, n_comp_ij * dim_embed * dim_embed, g3);
+        }
+    }
+}
+
+void
+FEProblemInterface::apply_jacobian_qp(PetscDS ds,
+                                      const WeakForm::Key & key,
+                                      Int n_elems,
+                                      PetscFEGeom * cell_geom,
+                                      const Scalar qp_data[],
+                                      const Scalar x[],
+                                      Scalar y[])
+{
+    CALL_STACK_MSG();
+    Int field_i = key.jac.field_i;
+    Int field_j = key.jac.field_j;
+    PetscFE & fe_i = this->fields.at(FieldID(field_i)).fe;
+
+    auto & ws = get_workspace(ds);
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int n_comp_i = T[field_i]->Nc;
+    Int n_comp_j = T[field_j]->Nc;
+    Int n_comp_ij = n_comp_i * n_comp_j;
+    Int offset_i;
+    PETSC_CHECK(PetscDSGetFieldOffset(ds, field_i, &offset_i));
+    // offset of field `j` among the components evaluated by `evaluate_field_jets`
+    Int u_offset;
+    PETSC_CHECK(PetscDSGetComponentOffset(ds, field_j, &u_offset));
+
+    Int q_n_pts = T[field_i]->Np;
+    Int dE = cell_geom->dimEmbed;
+    Int n_qp = get_jacobian_qp_size(ds, key, dE) / q_n_pts;
+    Int n_fields = get_num_fields();
+    bool tensor = use_tensor_kernels(ds, nullptr, cell_geom);
+    auto & tw = ws.tensor;
+    Scalar * f0 = ws.f0;
+    Scalar * f1 = ws.f1;
+    for (Int e = 0; e < n_elems; ++e) {
+        PETSC_CHECK(PetscArrayzero(f0, q_n_pts * n_comp_i));
+        PETSC_CHECK(PetscArrayzero(f1, q_n_pts * n_comp_i * dE));
+        if (tensor)
+            evaluate_field_jets_tensor(ws,
+                                       this->tensor_bases,
+                                       cell_geom,
+                                       e,
+                                       &x[e * tot_dim],
+                                       nullptr,
+                                       tw.u,
+                                       tw.u_x,
+                                       tw.u_t);
+        for (Int q = 0; q < q_n_pts; ++q) {
+            const Scalar * u;
+            const Scalar * u_x;
+            if (tensor) {
+                Int n_comp = tw.u.size() / q_n_pts;
+                u = &tw.u[q * n_comp + u_offset];
+                u_x = &tw.u_x[(q * n_comp + u_offset) * dE];
+            }
+            else {
+                PetscFEGeom fe_geom;
+                PETSC_CHECK(PetscFEGeomGetCellPoint(cell_geom, e, q, &fe_geom));
+                evaluate_field_jets(ds,
+                                    n_fields,
+                                    0,
+                                    q,
+                                    T,
+                                    &fe_geom,
+                                    &x[e * tot_dim],
+                                    nullptr,
+                                    ws.u,
+                                    ws.u_x,
+                                    nullptr);
+                u = &ws.u[u_offset];
+                u_x = &ws.u_x[u_offset * dE];
+            }
+            const Scalar * g0 = &qp_data[(e * q_n_pts + q) * n_qp];
+            const Scalar * g1 = g0 + n_comp_ij;
+            const Scalar * g2 = g1 + n_comp_ij * dE;
+            const Scalar * g3 = g2 + n_comp_ij * dE;
+            // f0 = g0 u + g1 grad u, f1 = g2 u + g3 grad u
+            for (Int fc = 0; fc < n_comp_i; ++fc) {
+                Scalar * f0_q = &f0[q * n_comp_i + fc];
+                Scalar * f1_q = &f1[(q * n_comp_i + fc) * dE];
+                for (Int gc = 0; gc < n_comp_j; ++gc) {
+                    const Int ij = fc * n_comp_j + gc;
+                    *f0_q += g0[ij] * u[gc];
+                    for (Int df = 0; df < dE; ++df) {
+                        *f0_q += g1[ij * dE + df] * u_x[gc * dE + df];
+                        f1_q[df] += g2[ij * dE + df] * u[gc];
+                        for (Int dg = 0; dg < dE; ++dg)
+                            f1_q[df] += g3[(ij * dE + df) * dE + dg] * u_x[gc * dE + dg];
+                    }
+                }
+            }
+        }
+        if (tensor)
+            update_element_vec_tensor(ws,
+                                      this->tensor_bases[field_i],
+                                      cell_geom,
+                                      e,
+                                      f0,
+                                      f1,
+                                      &y[e * tot_dim + offset_i]);
+        else
+            update_element_vec(fe_i,
+                               T[field_i],
+                               0,
+                               ws.basis_real,
+                               ws.basis_der_real,
+                               e,
+                               cell_geom,
+                               f0,
+                               f1,
+                               &y[e * tot_dim + offset_i]);
+    }
+}
+
+void
+FEProblemInterface::add_jacobian_qp_diagonal(PetscDS ds,
+                                             const WeakForm::Key & key,
+                                             Int n_elems,
+                                             PetscFEGeom * cell_geom,
+                                             const Scalar qp_data[],
+                                             Scalar diag[])
+{
+    CALL_STACK_MSG();
+    Int field = key.jac.field_i;
+    if (key.jac.field_j != field)
+        return;
+    PetscFE & fe = this->fields.at(FieldID(field)).fe;
+
+    auto & ws = get_workspace(ds);
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int n_comp_ij = T[field]->Nc * T[field]->Nc;
+    Int offset;
+    PETSC_CHECK(PetscDSGetFieldOffset(ds, field, &offset));
+
+    Int q_n_pts = T[field]->Np;
+    Int n_basis = T[field]->Nb;
+    Int n_comp = T[field]->Nc;
+    Int dE = cell_geom->dimEmbed;
+    Int n_qp = get_jacobian_qp_size(ds, key, dE) / q_n_pts;
+    Scalar * phi = ws.basis_real;
+    Scalar * dphi = ws.basis_der_real;
+    // only the b == b terms of the element matrix are accumulated
+    for (Int e = 0; e < n_elems; ++e) {
+        for (Int q = 0; q < q_n_pts; ++q) {
+            PetscFEGeom fe_geom;
+            PETSC_CHECK(PetscFEGeomGetCellPoint(cell_geom, e, q, &fe_geom));
+            const Real * basis = &T[field]->T[0][q * n_basis * n_comp];
+            const Real * basis_der = &T[field]->T[1][q * n_basis * n_comp * dE];
+            for (Int i = 0; i < n_basis * n_comp; ++i) {
+                phi[i] = basis[i];
+                for (Int d = 0; d < dE; ++d)
+                    dphi[i * dE + d] = basis_der[i * dE + d];
+            }
+            PETSC_CHECK(PetscFEPushforward(fe, &fe_geom, n_basis, phi));
+            PETSC_CHECK(PetscFEPushforwardGradient(fe, &fe_geom, n_basis, dphi));
+
+            const Scalar * g0 = &qp_data[(e * q_n_pts + q) * n_qp];
+            const Scalar * g1 = g0 + n_comp_ij;
+            const Scalar * g2 = g1 + n_comp_ij * dE;
+            const Scalar * g3 = g2 + n_comp_ij * dE;
+            for (Int b = 0; b < n_basis; ++b) {
+                Scalar val = 0.;
+                for (Int fc = 0; fc < n_comp; ++fc) {
+                    const Int fidx = b * n_comp + fc;
+                    for (Int gc = 0; gc < n_comp; ++gc) {
+                        const Int gidx = b * n_comp + gc;
+                        const Int ij = fc * n_comp + gc;
+                        val += phi[fidx] * g0[ij] * phi[gidx];
+                        for (Int df = 0; df < dE; ++df) {
+                            val += phi[fidx] * g1[ij * dE + df] * dphi[gidx * dE + df];
+                            val += dphi[fidx * dE + df] * g2[ij * dE + df] * phi[gidx];
+                            for (Int dg = 0; dg < dE; ++dg)
+                                val += dphi[fidx * dE + df] * g3[(ij * dE + df) * dE + dg] *
+                                       dphi[gidx * dE + dg];
+                        }
+                    }
+                }
+                diag[e * tot_dim + offset + b] += val;
+            }
+        }
+    }
+}
+
 void
 FEProblemInterface::integrate_bnd_jacobian(PetscDS ds,
                                            const WeakForm::Key & key,
@@ -1378,6 +2630,7 @@ FEProblemInterface::integrate_bnd_jacobian(PetscDS ds,
         this->wf.get(WeakForm::BND_G3, key.label, key.value, fid_i, fid_j, key.part);
     if (g0_jac_fns.empty() && g1_jac_fns.empty() && g2_jac_fns.empty() && g3_jac_fns.empty())
         return;
+    const auto & jac_fnls = get_jacobian_block(key).fnls;
 
     PetscFE & fe_i = this->fields.at(fid_i).fe;
     PetscFE & fe_j = this->fields.at(fid_j).fe;
@@ -1388,11 +2641,15 @@ FEProblemInterface::integrate_bnd_jacobian(PetscDS ds,
     this->asmbl->time = t;
     this->asmbl->u_t_shift = u_tshift;
 
-    Scalar *basis_real, *basis_der_real, *test_real, *test_der_real;
-    PETSC_CHECK(
-        PetscDSGetWorkspace(ds, nullptr, &basis_real, &basis_der_real, &test_real, &test_der_real));
-    Scalar *g0, *g1, *g2, *g3;
-    PETSC_CHECK(PetscDSGetWeakFormArrays(ds, nullptr, nullptr, &g0, &g1, &g2, &g3));
+    auto & ws = get_workspace(ds);
+    Scalar * basis_real = ws.basis_real;
+    Scalar * basis_der_real = ws.basis_der_real;
+    Scalar * test_real = ws.test_real;
+    Scalar * test_der_real = ws.test_der_real;
+    Scalar * g0 = ws.g0;
+    Scalar * g1 = ws.g1;
+    Scalar * g2 = ws.g2;
+    Scalar * g3 = ws.g3;
     Int offset_i;
     PETSC_CHECK(PetscDSGetFieldOffset(ds, field_i, &offset_i));
     Int offset_j;
@@ -1494,9 +2751,9 @@ FEProblemInterface::integrate_bnd_jacobian(PetscDS ds,
                                     &cell_geom,
                                     &coefficients[c_offset],
                                     coefficients_t ? &coefficients_t[c_offset] : nullptr,
-                                    this->asmbl->u,
-                                    this->asmbl->u_x,
-                                    coefficients_t ? this->asmbl->u_t : nullptr);
+                                    ws.u,
+                                    ws.u_x,
+                                    coefficients_t ? ws.u_t : nullptr);
             if (ds_aux)
                 evaluate_field_jets(ds_aux,
                                     n_fields_aux,
@@ -1506,11 +2763,11 @@ FEProblemInterface::integrate_bnd_jacobian(PetscDS ds,
                                     &cell_geom,
                                     &coefficients_aux[c_offset_aux],
                                     nullptr,
-                                    this->asmbl->a,
-                                    this->asmbl->a_x,
+                                    ws.a,
+                                    ws.a_x,
                                     nullptr);
 
-            for (auto & f : this->sorted_jac_functionals[key])
+            for (auto & f : jac_fnls)
                 f->evaluate();
             if (!g0_jac_fns.empty()) {
                 PETSC_CHECK(PetscArrayzero(g0, n_comp_i * n_comp_j));
@@ -1712,6 +2969,474 @@ FEProblemInterface::update_element_mat(PetscFE fe_i,
     }
 }
 
+QuadratureBatch
+FEProblemInterface::fill_batch(AssemblyWorkspace & ws,
+                               PetscDS ds,
+                               PetscDS ds_aux,
+                               PetscFEGeom * cell_geom,
+                               PetscQuadrature quad,
+                               Int e_start,
+                               Int n_blk,
+                               const Scalar coefficients[],
+                               const Scalar coefficients_t[],
+                               const Scalar coefficients_aux[])
+{
+    CALL_STACK_MSG();
+    Int q_n_pts;
+    const Real *q_points, *q_weights;
+    PETSC_CHECK(PetscQuadratureGetData(quad, nullptr, nullptr, &q_n_pts, &q_points, &q_weights));
+    Int dim = this->asmbl->dim;
+    Int n_fields = get_num_fields();
+    Int n_fields_aux = get_num_aux_fields();
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int tot_dim, n_comp;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PETSC_CHECK(PetscDSGetTotalComponents(ds, &n_comp));
+    PetscTabulation * T_aux = nullptr;
+    Int tot_dim_aux = 0, n_comp_aux = 0;
+    if (ds_aux) {
+        PETSC_CHECK(PetscDSGetTabulation(ds_aux, &T_aux));
+        PETSC_CHECK(PetscDSGetTotalDimension(ds_aux, &tot_dim_aux));
+        PETSC_CHECK(PetscDSGetTotalComponents(ds_aux, &n_comp_aux));
+    }
+
+    Int n = n_blk * q_n_pts;
+    auto & b = ws.batch;
+    b.w.resize(n);
+    b.xyz.resize(dim * n);
+    b.u.assign(n_comp * n, 0.);
+    b.u_t.assign(coefficients_t ? n_comp * n : 0, 0.);
+    b.u_x.assign(n_comp * dim * n, 0.);
+    b.a.assign(n_comp_aux * n, 0.);
+    b.a_x.assign(n_comp_aux * dim * n, 0.);
+
+    bool tensor = use_tensor_kernels(ds, ds_aux, cell_geom);
+    // fields without a Piola transform are evaluated straight into the batch arrays
+    bool direct =
+        !tensor && has_identity_pushforward(ds) && (!ds_aux || has_identity_pushforward(ds_aux));
+    if (direct) {
+        if (coefficients)
+            evaluate_field_jets_batch(n_fields,
+                                      T,
+                                      cell_geom,
+                                      e_start,
+                                      n_blk,
+                                      tot_dim,
+                                      coefficients,
+                                      coefficients_t,
+                                      n,
+                                      b.u.data(),
+                                      b.u_x.data(),
+                                      coefficients_t ? b.u_t.data() : nullptr);
+        if (ds_aux)
+            evaluate_field_jets_batch(n_fields_aux,
+                                      T_aux,
+                                      cell_geom,
+                                      e_start,
+                                      n_blk,
+                                      tot_dim_aux,
+                                      coefficients_aux,
+                                      nullptr,
+                                      n,
+                                      b.a.data(),
+                                      b.a_x.data(),
+                                      nullptr);
+    }
+
+    auto & tw = ws.tensor;
+    Real coord[3];
+    for (Int i = 0; i < n_blk; ++i) {
+        Int e = e_start + i;
+        PetscFEGeom fe_geom;
+        if (tensor) {
+            if (coefficients)
+                evaluate_field_jets_tensor(ws,
+                                           this->tensor_bases,
+                                           cell_geom,
+                                           e,
+                                           &coefficients[e * tot_dim],
+                                           coefficients_t ? &coefficients_t[e * tot_dim] : nullptr,
+                                           tw.u,
+                                           tw.u_x,
+                                           tw.u_t);
+            if (ds_aux)
+                evaluate_field_jets_tensor(ws,
+                                           this->tensor_bases_aux,
+                                           cell_geom,
+                                           e,
+                                           &coefficients_aux[e * tot_dim_aux],
+                                           nullptr,
+                                           tw.a,
+                                           tw.a_x,
+                                           tw.u_t);
+        }
+        for (Int q = 0; q < q_n_pts; ++q) {
+            Int p = i * q_n_pts + q;
+            fe_geom.v = coord;
+            PETSC_CHECK(
+                PetscFEGeomGetPoint(cell_geom, e, q, &q_points[q * cell_geom->dim], &fe_geom));
+            b.w[p] = fe_geom.detJ[0] * q_weights[q];
+            for (Int d = 0; d < dim; ++d)
+                b.xyz[d * n + p] = fe_geom.v[d];
+
+            if (direct)
+                continue;
+            if (tensor) {
+                if (coefficients) {
+                    for (Int k = 0; k < n_comp; ++k)
+                        b.u[k * n + p] = tw.u[q * n_comp + k];
+                    if (coefficients_t)
+                        for (Int k = 0; k < n_comp; ++k)
+                            b.u_t[k * n + p] = tw.u_t[q * n_comp + k];
+                    for (Int k = 0; k < n_comp * dim; ++k)
+                        b.u_x[k * n + p] = tw.u_x[q * n_comp * dim + k];
+                }
+                if (ds_aux) {
+                    for (Int k = 0; k < n_comp_aux; ++k)
+                        b.a[k * n + p] = tw.a[q * n_comp_aux + k];
+                    for (Int k = 0; k < n_comp_aux * dim; ++k)
+                        b.a_x[k * n + p] = tw.a_x[q * n_comp_aux * dim + k];
+                }
+                continue;
+            }
+            if (coefficients) {
+                evaluate_field_jets(ds,
+                                    n_fields,
+                                    0,
+                                    q,
+                                    T,
+                                    &fe_geom,
+                                    &coefficients[e * tot_dim],
+                                    coefficients_t ? &coefficients_t[e * tot_dim] : nullptr,
+                                    ws.u,
+                                    ws.u_x,
+                                    coefficients_t ? ws.u_t : nullptr);
+                for (Int k = 0; k < n_comp; ++k)
+                    b.u[k * n + p] = ws.u[k];
+                if (coefficients_t)
+                    for (Int k = 0; k < n_comp; ++k)
+                        b.u_t[k * n + p] = ws.u_t[k];
+                for (Int k = 0; k < n_comp * dim; ++k)
+                    b.u_x[k * n + p] = ws.u_x[k];
+            }
+            if (ds_aux) {
+                evaluate_field_jets(ds_aux,
+                                    n_fields_aux,
+                                    0,
+                                    q,
+                                    T_aux,
+                                    &fe_geom,
+                                    &coefficients_aux[e * tot_dim_aux],
+                                    nullptr,
+                                    ws.a,
+                                    ws.a_x,
+                                    nullptr);
+                for (Int k = 0; k < n_comp_aux; ++k)
+                    b.a[k * n + p] = ws.a[k];
+                for (Int k = 0; k < n_comp_aux * dim; ++k)
+                    b.a_x[k * n + p] = ws.a_x[k];
+            }
+        }
+    }
+
+    QuadratureBatch qb;
+    qb.n = n;
+    qb.dim = dim;
+    qb.time = this->asmbl->time;
+    qb.u_t_shift = this->asmbl->u_t_shift;
+    qb.xyz = b.xyz.data();
+    qb.u = b.u.data();
+    qb.u_t = coefficients_t ? b.u_t.data() : nullptr;
+    qb.u_x = b.u_x.data();
+    qb.a = ds_aux ? b.a.data() : nullptr;
+    qb.a_x = ds_aux ? b.a_x.data() : nullptr;
+    return qb;
+}
+
+void
+FEProblemInterface::evaluate_field_jets_batch(Int nf,
+                                              PetscTabulation tab[],
+                                              PetscFEGeom * cell_geom,
+                                              Int e_start,
+                                              Int n_blk,
+                                              Int tot_dim,
+                                              const Scalar coefficients[],
+                                              const Scalar coefficients_t[],
+                                              Int n,
+                                              Scalar u[],
+                                              Scalar u_x[],
+                                              Scalar u_t[])
+{
+    CALL_STACK_MSG();
+    const Int dim = cell_geom->dim;
+    Int d_offset = 0, f_offset = 0;
+    for (Int f = 0; f < nf; ++f) {
+        const Int n_q = tab[f]->Np;
+        const Int n_bf = tab[f]->Nb;
+        const Int n_cf = tab[f]->Nc;
+        const Real * B = tab[f]->T[0];
+        const Real * D = tab[f]->T[1];
+        for (Int i = 0; i < n_blk; ++i) {
+            const Int e = e_start + i;
+            const Int p0 = i * n_q;
+            const Scalar * coef = &coefficients[e * tot_dim + d_offset];
+            const Scalar * coef_t =
+                coefficients_t ? &coefficients_t[e * tot_dim + d_offset] : nullptr;
+            // values and reference gradients, contiguous over the quadrature points of the cell
+            for (Int c = 0; c < n_cf; ++c) {
+                Scalar * uc = &u[(f_offset + c) * n + p0];
+                Scalar * u_tc = coef_t ? &u_t[(f_offset + c) * n + p0] : nullptr;
+                for (Int b = 0; b < n_bf; ++b) {
+                    const Int cidx = b * n_cf + c;
+                    const Int stride = n_bf * n_cf;
+                    for (Int q = 0; q < n_q; ++q)
+                        uc[q] += B[q * stride + cidx] * coef[b];
+                    if (coef_t)
+                        for (Int q = 0; q < n_q; ++q)
+                            u_tc[q] += B[q * stride + cidx] * coef_t[b];
+                    for (Int d = 0; d < dim; ++d) {
+                        Scalar * u_xcd = &u_x[((f_offset + c) * dim + d) * n + p0];
+                        for (Int q = 0; q < n_q; ++q)
+                            u_xcd[q] += D[(q * stride + cidx) * dim + d] * coef[b];
+                    }
+                }
+            }
+            // map reference gradients into real space
+            for (Int q = 0; q < n_q; ++q) {
+                PetscFEGeom fe_geom;
+                PETSC_CHECK(PetscFEGeomGetCellPoint(cell_geom, e, q, &fe_geom));
+                for (Int c = 0; c < n_cf; ++c) {
+                    Scalar grad_ref[3];
+                    for (Int k = 0; k < dim; ++k)
+                        grad_ref[k] = u_x[((f_offset + c) * dim + k) * n + p0 + q];
+                    for (Int d = 0; d < dim; ++d) {
+                        Scalar val = 0.;
+                        for (Int k = 0; k < dim; ++k)
+                            val += grad_ref[k] * fe_geom.invJ[k * dim + d];
+                        u_x[((f_offset + c) * dim + d) * n + p0 + q] = val;
+                    }
+                }
+            }
+        }
+        f_offset += n_cf;
+        d_offset += n_bf;
+    }
+}
+
+void
+FEProblemInterface::integrate_residual_batched(PetscDS ds,
+                                               const WeakForm::Key & key,
+                                               const std::vector<ResidualFunc *> & f0_fns,
+                                               const std::vector<ResidualFunc *> & f1_fns,
+                                               Int n_elems,
+                                               PetscFEGeom * cell_geom,
+                                               const Scalar coefficients[],
+                                               const Scalar coefficients_t[],
+                                               PetscDS ds_aux,
+                                               const Scalar coefficients_aux[],
+                                               Scalar elem_vec[])
+{
+    CALL_STACK_MSG();
+    Int field = key.field;
+    PetscFE & fe = this->fields.at(FieldID(field)).fe;
+    auto & ws = get_workspace(ds);
+    Int f_offset;
+    PETSC_CHECK(PetscDSGetFieldOffset(ds, field, &f_offset));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PetscQuadrature quad;
+    PETSC_CHECK(PetscFEGetQuadrature(fe, &quad));
+    Int q_n_pts;
+    PETSC_CHECK(PetscQuadratureGetData(quad, nullptr, nullptr, &q_n_pts, nullptr, nullptr));
+
+    Int dim = this->asmbl->dim;
+    Int n_comp = T[field]->Nc;
+    Int blk_size = std::max<Int>(1, QP_BATCH_SIZE / q_n_pts);
+    bool tensor = use_tensor_kernels(ds, ds_aux, cell_geom);
+    auto & f0_b = ws.batch.v[0];
+    auto & f1_b = ws.batch.v[1];
+    for (Int e_start = 0; e_start < n_elems; e_start += blk_size) {
+        Int n_blk = std::min(blk_size, n_elems - e_start);
+        auto qb = fill_batch(ws,
+                             ds,
+                             ds_aux,
+                             cell_geom,
+                             quad,
+                             e_start,
+                             n_blk,
+                             coefficients,
+                             coefficients_t,
+                             coefficients_aux);
+        Int n = qb.n;
+        f0_b.assign(n_comp * n, 0.);
+        for (auto & func : f0_fns)
+            func->evaluate_batch(qb, f0_b.data());
+        f1_b.assign(n_comp * dim * n, 0.);
+        for (auto & func : f1_fns)
+            func->evaluate_batch(qb, f1_b.data());
+
+        for (Int i = 0; i < n_blk; ++i) {
+            Int e = e_start + i;
+            for (Int q = 0; q < q_n_pts; ++q) {
+                Int p = i * q_n_pts + q;
+                Real w = ws.batch.w[p];
+                for (Int c = 0; c < n_comp; ++c)
+                    ws.f0[q * n_comp + c] = f0_b[c * n + p] * w;
+                for (Int k = 0; k < n_comp * dim; ++k)
+                    ws.f1[q * n_comp * dim + k] = f1_b[k * n + p] * w;
+            }
+            if (tensor)
+                update_element_vec_tensor(ws,
+                                          this->tensor_bases[field],
+                                          cell_geom,
+                                          e,
+                                          ws.f0,
+                                          ws.f1,
+                                          &elem_vec[e * tot_dim + f_offset]);
+            else
+                update_element_vec(fe,
+                                   T[field],
+                                   0,
+                                   ws.basis_real,
+                                   ws.basis_der_real,
+                                   e,
+                                   cell_geom,
+                                   ws.f0,
+                                   ws.f1,
+                                   &elem_vec[e * tot_dim + f_offset]);
+        }
+    }
+}
+
+void
+FEProblemInterface::integrate_jacobian_batched(PetscDS ds,
+                                               const WeakForm::Key & key,
+                                               const std::vector<JacobianFunc *> * g_fns[4],
+                                               Int n_elems,
+                                               PetscFEGeom * cell_geom,
+                                               const Scalar coefficients[],
+                                               const Scalar coefficients_t[],
+                                               PetscDS ds_aux,
+                                               const Scalar coefficients_aux[],
+                                               Scalar elem_mat[])
+{
+    CALL_STACK_MSG();
+    Int field_i = key.jac.field_i;
+    Int field_j = key.jac.field_j;
+    PetscFE & fe_i = this->fields.at(FieldID(field_i)).fe;
+    PetscFE & fe_j = this->fields.at(FieldID(field_j)).fe;
+    auto & ws = get_workspace(ds);
+    Int offset_i;
+    PETSC_CHECK(PetscDSGetFieldOffset(ds, field_i, &offset_i));
+    Int offset_j;
+    PETSC_CHECK(PetscDSGetFieldOffset(ds, field_j, &offset_j));
+    Int tot_dim;
+    PETSC_CHECK(PetscDSGetTotalDimension(ds, &tot_dim));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    PetscQuadrature quad;
+    PETSC_CHECK(PetscFEGetQuadrature(fe_i, &quad));
+    Int q_n_pts;
+    const Real * q_points;
+    PETSC_CHECK(PetscQuadratureGetData(quad, nullptr, nullptr, &q_n_pts, &q_points, nullptr));
+
+    Int dim = this->asmbl->dim;
+    Int n_comp_ij = T[field_i]->Nc * T[field_j]->Nc;
+    // sizes of per-point g0, g1, g2 and g3
+    Int g_size[4] = { n_comp_ij, n_comp_ij * dim, n_comp_ij * dim, n_comp_ij * dim * dim };
+    Scalar * g[4] = { ws.g0, ws.g1, ws.g2, ws.g3 };
+    for (Int k = 0; k < 4; ++k)
+        PETSC_CHECK(PetscArrayzero(g[k], g_size[k]));
+    // with sum factorization, integrands of all points of a cell are collected first
+    bool tensor = use_tensor_kernels(ds, nullptr, cell_geom);
+    Int n_g = g_size[0] + g_size[1] + g_size[2] + g_size[3];
+    if (tensor)
+        ws.tensor.g.resize(q_n_pts * n_g);
+
+    Int blk_size = std::max<Int>(1, QP_BATCH_SIZE / q_n_pts);
+    for (Int e_start = 0; e_start < n_elems; e_start += blk_size) {
+        Int n_blk = std::min(blk_size, n_elems - e_start);
+        auto qb = fill_batch(ws,
+                             ds,
+                             ds_aux,
+                             cell_geom,
+                             quad,
+                             e_start,
+                             n_blk,
+                             coefficients,
+                             coefficients_t,
+                             coefficients_aux);
+        Int n = qb.n;
+        for (Int k = 0; k < 4; ++k) {
+            if (g_fns[k]->empty())
+                continue;
+            ws.batch.v[k].assign(g_size[k] * n, 0.);
+            for (auto & func : *g_fns[k])
+                func->evaluate_batch(qb, ws.batch.v[k].data());
+        }
+
+        Real coord[3];
+        for (Int i = 0; i < n_blk; ++i) {
+            Int e = e_start + i;
+            PetscFEGeom fe_geom;
+            for (Int q = 0; q < q_n_pts; ++q) {
+                Int p = i * q_n_pts + q;
+                Real w = ws.batch.w[p];
+                fe_geom.v = coord;
+                PETSC_CHECK(
+                    PetscFEGeomGetPoint(cell_geom, e, q, &q_points[q * cell_geom->dim], &fe_geom));
+                for (Int k = 0; k < 4; ++k) {
+                    if (g_fns[k]->empty())
+                        continue;
+                    const auto & gb = ws.batch.v[k];
+                    for (Int j = 0; j < g_size[k]; ++j)
+                        g[k][j] = gb[j * n + p] * w;
+                }
+                if (tensor) {
+                    Scalar * g_q = &ws.tensor.g[q * n_g];
+                    for (Int k = 0; k < 4; ++k)
+                        g_q = std::copy_n(g[k], g_size[k], g_q);
+                }
+                else
+                    update_element_mat(fe_i,
+                                       fe_j,
+                                       0,
+                                       q,
+                                       T[field_i],
+                                       ws.basis_real,
+                                       ws.basis_der_real,
+                                       T[field_j],
+                                       ws.test_real,
+                                       ws.test_der_real,
+                                       &fe_geom,
+                                       ws.g0,
+                                       ws.g1,
+                                       ws.g2,
+                                       ws.g3,
+                                       e * PetscSqr(tot_dim),
+                                       tot_dim,
+                                       offset_i,
+                                       offset_j,
+                                       elem_mat);
+            }
+            if (tensor)
+                update_element_mat_tensor(ws,
+                                          this->tensor_bases[field_i],
+                                          this->tensor_bases[field_j],
+                                          cell_geom,
+                                          e,
+                                          ws.tensor.g.data(),
+                                          tot_dim,
+                                          offset_i,
+                                          offset_j,
+                                          &elem_mat[e * PetscSqr(tot_dim)]);
+        }
+    }
+}
+
 // This is a copy of petsc/fe.c, PetscFEEvaluateFieldJets_Internal
 void
 FEProblemInterface::evaluate_field_jets(PetscDS ds,
@@ -1797,7 +3522,7 @@ void
 FENonlinearProblem::output_with(FileOutput & out)
 {
     compute_solution_vector_local();
-    out.output_step();
+    write_output(out);
 }
 
 } // namespace godzilla
@@ -0,0 +1,232 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/FVFaceList.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Error.h"
+#include "petscdmplex.h"
+#include <cmath>
+
+namespace godzilla {
+
+FVFaceList::FVFaceList() : dim(0), dm_id(0), section_id(0), n_interior(0) {}
+
+void
+FVFaceList::create(DM dm, Int block_size)
+{
+    CALL_STACK_MSG();
+    PETSC_CHECK(DMGetCoordinateDim(dm, &this->dim));
+
+    Vec face_geom, cell_geom;
+    Real min_radius;
+    PETSC_CHECK(DMPlexGetGeometryFVM(dm, &face_geom, &cell_geom, &min_radius));
+    DM dm_face, dm_cell;
+    PETSC_CHECK(VecGetDM(face_geom, &dm_face));
+    PETSC_CHECK(VecGetDM(cell_geom, &dm_cell));
+    const Scalar * fgeom;
+    const Scalar * cgeom;
+    PETSC_CHECK(VecGetArrayRead(face_geom, &fgeom));
+    PETSC_CHECK(VecGetArrayRead(cell_geom, &cgeom));
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PETSC_CHECK(PetscObjectGetId((PetscObject) dm, &this->dm_id));
+    PETSC_CHECK(PetscObjectGetId((PetscObject) section, &this->section_id));
+    DMLabel ghost_label = nullptr;
+    PETSC_CHECK(DMGetLabel(dm, "ghost", &ghost_label));
+    auto get_ghost = [&](Int point) {
+        Int ghost = -1;
+        if (ghost_label)
+            PETSC_CHECK(DMLabelGetValue(ghost_label, point, &ghost));
+        return ghost;
+    };
+
+    // interior faces first, faces with a ghost cell last
+    std::vector<Int> interior, boundary;
+    Int f_start, f_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 1, &f_start, &f_end));
+    for (Int face = f_start; face < f_end; ++face) {
+        Int n_support;
+        PETSC_CHECK(DMPlexGetSupportSize(dm, face, &n_support));
+        // skip faces owned by other ranks
+        if (get_ghost(face) >= 0 || n_support != 2)
+            continue;
+        const Int * cells;
+        PETSC_CHECK(DMPlexGetSupport(dm, face, &cells));
+        if (get_ghost(cells[0]) > 0 || get_ghost(cells[1]) > 0)
+            boundary.push_back(face);
+        else
+            interior.push_back(face);
+    }
+    this->n_interior = interior.size();
+    this->faces = std::move(interior);
+    this->faces.insert(this->faces.end(), boundary.begin(), boundary.end());
+    Int n_faces = this->faces.size();
+
+    this->block_start.clear();
+    for (Int i = 0; i < this->n_interior; i += block_size)
+        this->block_start.push_back(i);
+    for (Int i = this->n_interior; i < n_faces; i += block_size)
+        this->block_start.push_back(i);
+    this->block_start.push_back(n_faces);
+
+    this->centroid.resize(this->dim * n_faces);
+    this->normal.resize(this->dim * n_faces);
+    this->area.resize(n_faces);
+    this->cell_l.resize(n_faces);
+    this->cell_r.resize(n_faces);
+    this->offset_l.resize(n_faces);
+    this->offset_r.resize(n_faces);
+    this->inv_vol_l.resize(n_faces);
+    this->inv_vol_r.resize(n_faces);
+    for (Int blk = 0; blk < get_num_blocks(); ++blk) {
+        auto rng = get_block(blk);
+        Int n = rng.size();
+        for (Int i = 0; i < n; ++i) {
+            Int idx = rng.first() + i;
+            Int face = this->faces[idx];
+            const Int * cells;
+            PETSC_CHECK(DMPlexGetSupport(dm, face, &cells));
+            PetscFVFaceGeom * fg;
+            PETSC_CHECK(DMPlexPointLocalRead(dm_face, face, fgeom, &fg));
+            // ghost cell goes to the right, flip the normal so it still points left to right
+            Real sign = 1.;
+            Int cl = cells[0], cr = cells[1];
+            if (get_ghost(cl) > 0) {
+                std::swap(cl, cr);
+                sign = -1.;
+            }
+            Real a2 = 0.;
+            for (Int d = 0; d < this->dim; ++d) {
+                this->centroid[this->dim * rng.first() + d * n + i] = fg->centroid[d];
+                this->normal[this->dim * rng.first() + d * n + i] = sign * fg->normal[d];
+                a2 += fg->normal[d] * fg->normal[d];
+            }
+            this->area[idx] = std::sqrt(a2);
+
+            this->cell_l[idx] = cl;
+            this->cell_r[idx] = cr;
+            PETSC_CHECK(PetscSectionGetOffset(section, cl, &this->offset_l[idx]));
+            PETSC_CHECK(PetscSectionGetOffset(section, cr, &this->offset_r[idx]));
+            PetscFVCellGeom * cg;
+            PETSC_CHECK(DMPlexPointLocalRead(dm_cell, cl, cgeom, &cg));
+            this->inv_vol_l[idx] = 1. / cg->volume;
+            PETSC_CHECK(DMPlexPointLocalRead(dm_cell, cr, cgeom, &cg));
+            this->inv_vol_r[idx] = 1. / cg->volume;
+        }
+    }
+
+    PETSC_CHECK(VecRestoreArrayRead(face_geom, &fgeom));
+    PETSC_CHECK(VecRestoreArrayRead(cell_geom, &cgeom));
+}
+
+bool
+FVFaceList::is_created() const
+{
+    return !this->block_start.empty();
+}
+
+bool
+FVFaceList::is_up_to_date(DM dm) const
+{
+    CALL_STACK_MSG();
+    if (!is_created())
+        return false;
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    PetscObjectId id, sec_id;
+    PETSC_CHECK(PetscObjectGetId((PetscObject) dm, &id));
+    PETSC_CHECK(PetscObjectGetId((PetscObject) section, &sec_id));
+    return id == this->dm_id && sec_id == this->section_id;
+}
+
+Int
+FVFaceList::get_num_faces() const
+{
+    return this->faces.size();
+}
+
+Int
+FVFaceList::get_num_interior_faces() const
+{
+    return this->n_interior;
+}
+
+Int
+FVFaceList::get_num_blocks() const
+{
+    return this->block_start.empty() ? 0 : this->block_start.size() - 1;
+}
+
+Range
+FVFaceList::get_block(Int blk) const
+{
+    return Range(this->block_start[blk], this->block_start[blk + 1]);
+}
+
+bool
+FVFaceList::is_boundary_block(Int blk) const
+{
+    return this->block_start[blk] >= this->n_interior;
+}
+
+const Real *
+FVFaceList::get_centroids(Int blk) const
+{
+    return this->centroid.data() + this->dim * this->block_start[blk];
+}
+
+const Real *
+FVFaceList::get_normals(Int blk) const
+{
+    return this->normal.data() + this->dim * this->block_start[blk];
+}
+
+Span<const Real>
+FVFaceList::get_areas() const
+{
+    return this->area;
+}
+
+Span<const Int>
+FVFaceList::get_faces() const
+{
+    return this->faces;
+}
+
+Span<const Int>
+FVFaceList::get_left_cells() const
+{
+    return this->cell_l;
+}
+
+Span<const Int>
+FVFaceList::get_right_cells() const
+{
+    return this->cell_r;
+}
+
+Span<const Int>
+FVFaceList::get_left_offsets() const
+{
+    return this->offset_l;
+}
+
+Span<const Int>
+FVFaceList::get_right_offsets() const
+{
+    return this->offset_r;
+}
+
+Span<const Real>
+FVFaceList::get_left_inv_volumes() const
+{
+    return this->inv_vol_l;
+}
+
+Span<const Real>
+FVFaceList::get_right_inv_volumes() const
+{
+    return this->inv_vol_r;
+}
+
+} // namespace godzilla
@@ -12,6 +12,7 @@
 #include "godzilla/Utils.h"
 #include "godzilla/Exception.h"
 #include "godzilla/Assert.h"
+#include "godzilla/Validation.h"
 
 namespace godzilla {
 
@@ -34,11 +35,41 @@ FVProblemInterface::compute_flux(Int /* dim */,
 
 const String FVProblemInterface::empty_name;
 
+Parameters
+FVProblemInterface::parameters()
+{
+    auto params = Parameters();
+    params.add_param<String>("reconstruction",
+                             "none",
+                             "Reconstruction of face states: [none, least_squares]");
+    params.add_param<String>("limiter",
+                             "none",
+                             "Slope limiter: [none, barth_jespersen, venkatakrishnan]");
+    params.add_param<Real>("venkatakrishnan_k", 5., "Constant K of the Venkatakrishnan limiter");
+    return params;
+}
+
 FVProblemInterface::FVProblemInterface(Problem & problem, const Parameters & pars) :
     DiscreteProblemInterface(problem, pars),
-    fvm(nullptr)
+    fvm(nullptr),
+    lsq_reconstruction(false),
+    limiter(FVReconstruction::Limiter::NONE),
+    venkat_k(pars.get<Real>("venkatakrishnan_k"))
 {
     CALL_STACK_MSG();
+    auto recon = pars.get<String>("reconstruction");
+    expect_true(validation::in(recon, { "none", "least_squares" }),
+                "The 'reconstruction' parameter can be either 'none' or 'least_squares'.");
+    this->lsq_reconstruction = recon == "least_squares";
+
+    auto lim = pars.get<String>("limiter");
+    expect_true(validation::in(lim, { "none", "barth_jespersen", "venkatakrishnan" }),
+                "The 'limiter' parameter can be either 'none', 'barth_jespersen' or "
+                "'venkatakrishnan'.");
+    if (lim == "barth_jespersen")
+        this->limiter = FVReconstruction::Limiter::BARTH_JESPERSEN;
+    else if (lim == "venkatakrishnan")
+        this->limiter = FVReconstruction::Limiter::VENKATAKRISHNAN;
 }
 
 FVProblemInterface::~FVProblemInterface()
@@ -374,6 +405,8 @@ FVProblemInterface::create()
     if (get_mesh()->get_dimension() == 1_D)
         throw Exception("FV in 1D is not possible due to a bug in PETSc. Use PETSc 3.20 instead.");
 #endif
+    if (this->lsq_reconstruction && !has_batched_riemann_solver())
+        throw Exception("Least-squares reconstruction requires a batched Riemann solver.");
 }
 
 void
@@ -413,6 +446,84 @@ FVProblemInterface::set_up_ds()
     set_up_weak_form();
 }
 
+bool
+FVProblemInterface::has_batched_riemann_solver() const
+{
+    CALL_STACK_MSG();
+    return static_cast<bool>(this->compute_flux_batch_method);
+}
+
+void
+FVProblemInterface::compute_flux_residual_local(Real time, const Vector & loc_x, Vector & loc_f)
+{
+    // this is based on the FV part of DMPlexComputeResidual_Internal()
+    CALL_STACK_MSG();
+    auto dm = get_mesh()->get_dm();
+    Vec face_geom, cell_geom;
+    Real min_radius;
+    PETSC_CHECK(DMPlexGetGeometryFVM(dm, &face_geom, &cell_geom, &min_radius));
+    // ghost cells get their states from the Riemann boundary conditions
+    PETSC_CHECK(
+        DMPlexInsertBoundaryValues(dm, PETSC_FALSE, loc_x, time, face_geom, cell_geom, nullptr));
+
+    Int nc = get_field_num_components(FieldID(0)).value();
+    // a new mesh or DoF layout invalidates the face list and everything built on top of it
+    if (!this->face_list.is_up_to_date(dm)) {
+        this->face_list.create(dm, FACE_BLOCK_SIZE);
+        if (this->lsq_reconstruction)
+            this->reconstruction.create(dm, this->face_list, nc, this->limiter, this->venkat_k);
+    }
+
+    std::vector<Scalar> u_l(nc * FACE_BLOCK_SIZE);
+    std::vector<Scalar> u_r(nc * FACE_BLOCK_SIZE);
+    std::vector<Scalar> flux(nc * FACE_BLOCK_SIZE);
+
+    auto x_arr = loc_x.borrow_array_read();
+    auto f_arr = loc_f.borrow_array();
+    const Scalar * x = x_arr.data();
+    Scalar * f = f_arr.data();
+    const Int * off_l = this->face_list.get_left_offsets().data();
+    const Int * off_r = this->face_list.get_right_offsets().data();
+    const Real * inv_vol_l = this->face_list.get_left_inv_volumes().data();
+    const Real * inv_vol_r = this->face_list.get_right_inv_volumes().data();
+
+    if (this->lsq_reconstruction)
+        this->reconstruction.compute_gradients(x);
+
+    for (Int blk = 0; blk < this->face_list.get_num_blocks(); ++blk) {
+        auto rng = this->face_list.get_block(blk);
+        Int first = rng.first();
+        Int n = rng.size();
+        if (this->lsq_reconstruction)
+            this->reconstruction.reconstruct(this->face_list, blk, x, u_l.data(), u_r.data());
+        else {
+            for (Int c = 0; c < nc; ++c) {
+                for (Int i = 0; i < n; ++i) {
+                    u_l[c * n + i] = x[off_l[first + i] + c];
+                    u_r[c * n + i] = x[off_r[first + i] + c];
+                }
+            }
+        }
+
+        this->compute_flux_batch_method.invoke(n,
+                                               this->face_list.get_centroids(blk),
+                                               this->face_list.get_normals(blk),
+                                               u_l.data(),
+                                               u_r.data(),
+                                               flux.data());
+
+        for (Int c = 0; c < nc; ++c)
+            for (Int i = 0; i < n; ++i)
+                f[off_l[first + i] + c] -= flux[c * n + i] * inv_vol_l[first + i];
+        // right cells of boundary faces are ghost cells and get no residual
+        if (!this->face_list.is_boundary_block(blk)) {
+            for (Int c = 0; c < nc; ++c)
+                for (Int i = 0; i < n; ++i)
+                    f[off_r[first + i] + c] += flux[c * n + i] * inv_vol_r[first + i];
+        }
+    }
+}
+
 void
 FVProblemInterface::create_aux_fields()
 {
@@ -0,0 +1,397 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/FVReconstruction.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Error.h"
+#include "petscdmplex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace godzilla {
+
+namespace {
+
+/// Invert a symmetric positive definite `dim x dim` matrix in place
+///
+/// @return `false` if the matrix is singular
+bool
+invert(Int dim, Real a[])
+{
+    if (dim == 1) {
+        if (a[0] == 0.)
+            return false;
+        a[0] = 1. / a[0];
+    }
+    else if (dim == 2) {
+        auto det = a[0] * a[3] - a[1] * a[2];
+        if (std::abs(det) < 1e-14 * (a[0] * a[3]))
+            return false;
+        Real inv[4] = { a[3] / det, -a[1] / det, -a[2] / det, a[0] / det };
+        std::copy(inv, inv + 4, a);
+    }
+    else {
+        Real inv[9];
+        inv[0] = a[4] * a[8] - a[5] * a[7];
+        inv[1] = a[2] * a[7] - a[1] * a[8];
+        inv[2] = a[1] * a[5] - a[2] * a[4];
+        inv[3] = a[5] * a[6] - a[3] * a[8];
+        inv[4] = a[0] * a[8] - a[2] * a[6];
+        inv[5] = a[2] * a[3] - a[0] * a[5];
+        inv[6] = a[3] * a[7] - a[4] * a[6];
+        inv[7] = a[1] * a[6] - a[0] * a[7];
+        inv[8] = a[0] * a[4] - a[1] * a[3];
+        auto det = a[0] * inv[0] + a[1] * inv[3] + a[2] * inv[6];
+        if (std::abs(det) < 1e-14 * (a[0] * a[4] * a[8]))
+            return false;
+        for (Int i = 0; i < 9; ++i)
+            a[i] = inv[i] / det;
+    }
+    return true;
+}
+
+/// Limiter value for one face
+///
+/// @param d2 Unlimited change from the cell center to the face
+/// @param d_max Maximum neighbor value minus the cell value
+/// @param d_min Minimum neighbor value minus the cell value
+/// @param eps2 Venkatakrishnan's epsilon squared
+inline Real
+barth_jespersen(Real d2, Real d_max, Real d_min)
+{
+    if (d2 > 0.)
+        return std::min(1., d_max / d2);
+    else if (d2 < 0.)
+        return std::min(1., d_min / d2);
+    else
+        return 1.;
+}
+
+inline Real
+venkatakrishnan(Real d2, Real d_max, Real d_min, Real eps2)
+{
+    if (d2 == 0.)
+        return 1.;
+    auto d1 = d2 > 0. ? d_max : d_min;
+    auto num = (d1 * d1 + eps2) * d2 + 2. * d2 * d2 * d1;
+    auto den = d1 * d1 + 2. * d2 * d2 + d1 * d2 + eps2;
+    return std::min(1., num / (den * d2));
+}
+
+} // namespace
+
+FVReconstruction::FVReconstruction() :
+    dim(0),
+    nc(0),
+    c_start(0),
+    n_cells(0),
+    limiter(Limiter::NONE),
+    cell_sf(nullptr)
+{
+}
+
+FVReconstruction::~FVReconstruction()
+{
+    PetscSFDestroy(&this->cell_sf);
+}
+
+void
+FVReconstruction::create(DM dm,
+                         const FVFaceList & faces,
+                         Int n_comps,
+                         Limiter limiter,
+                         Real venkat_k)
+{
+    CALL_STACK_MSG();
+    // the operator can be rebuilt, e.g. after the mesh changed
+    PETSC_CHECK(PetscSFDestroy(&this->cell_sf));
+    this->nc = n_comps;
+    this->limiter = limiter;
+    PETSC_CHECK(DMGetCoordinateDim(dm, &this->dim));
+    Int c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &this->c_start, &c_end));
+    this->n_cells = c_end - this->c_start;
+
+    PetscSection section;
+    PETSC_CHECK(DMGetLocalSection(dm, &section));
+    this->cell_offset.resize(this->n_cells);
+    for (Int i = 0; i < this->n_cells; ++i)
+        PETSC_CHECK(PetscSectionGetOffset(section, this->c_start + i, &this->cell_offset[i]));
+
+    Vec face_geom, cell_geom;
+    Real min_radius;
+    PETSC_CHECK(DMPlexGetGeometryFVM(dm, &face_geom, &cell_geom, &min_radius));
+    DM dm_cell;
+    PETSC_CHECK(VecGetDM(cell_geom, &dm_cell));
+    const Scalar * cgeom;
+    PETSC_CHECK(VecGetArrayRead(cell_geom, &cgeom));
+    auto get_cell_geom = [&](Int cell) {
+        PetscFVCellGeom * cg;
+        PETSC_CHECK(DMPlexPointLocalRead(dm_cell, cell, cgeom, &cg));
+        return cg;
+    };
+    DMLabel ghost_label = nullptr;
+    PETSC_CHECK(DMGetLabel(dm, "ghost", &ghost_label));
+    auto is_ghost_cell = [&](Int cell) {
+        Int ghost = -1;
+        if (ghost_label)
+            PETSC_CHECK(DMLabelGetValue(ghost_label, cell, &ghost));
+        return ghost > 0;
+    };
+
+    // Neighbors come from all local faces, including the ones owned by other ranks (which are not
+    // in the face list), so that owned cells next to a partition boundary see all their neighbors.
+    // Ghost cells have no neighbors.
+    std::vector<std::vector<Int>> adj(this->n_cells);
+    this->face_cell_l.clear();
+    this->face_cell_r.clear();
+    this->face_dx_l.clear();
+    this->face_dx_r.clear();
+    Int f_start, f_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 1, &f_start, &f_end));
+    for (Int face = f_start; face < f_end; ++face) {
+        Int n_support;
+        PETSC_CHECK(DMPlexGetSupportSize(dm, face, &n_support));
+        if (n_support != 2)
+            continue;
+        const Int * cells;
+        PETSC_CHECK(DMPlexGetSupport(dm, face, &cells));
+        Int cl = cells[0], cr = cells[1];
+        if (is_ghost_cell(cl))
+            std::swap(cl, cr);
+        bool ghost_r = is_ghost_cell(cr);
+        adj[cl - this->c_start].push_back(cr - this->c_start);
+        if (!ghost_r)
+            adj[cr - this->c_start].push_back(cl - this->c_start);
+
+        // PETSc does not compute geometry of faces owned by other ranks
+        Real area, xf[3], nrm[3];
+        PETSC_CHECK(DMPlexComputeCellGeometryFVM(dm, face, &area, xf, nrm));
+        auto cgl = get_cell_geom(cl);
+        auto cgr = get_cell_geom(cr);
+        this->face_cell_l.push_back(cl - this->c_start);
+        this->face_cell_r.push_back(ghost_r ? -1 : cr - this->c_start);
+        for (Int d = 0; d < this->dim; ++d) {
+            this->face_dx_l.push_back(xf[d] - cgl->centroid[d]);
+            this->face_dx_r.push_back(xf[d] - cgr->centroid[d]);
+        }
+    }
+
+    this->row_ptr.assign(this->n_cells + 1, 0);
+    for (Int i = 0; i < this->n_cells; ++i)
+        this->row_ptr[i + 1] = this->row_ptr[i] + adj[i].size();
+    this->nbr.resize(this->row_ptr[this->n_cells]);
+    this->weight.assign(this->dim * this->row_ptr[this->n_cells], 0.);
+    this->eps2.resize(this->n_cells);
+    std::vector<Real> dxs;
+    for (Int i = 0; i < this->n_cells; ++i) {
+        auto cgi = get_cell_geom(this->c_start + i);
+        auto h = std::pow(cgi->volume, 1. / this->dim);
+        this->eps2[i] = std::pow(venkat_k * h, 3);
+
+        // w_j = (sum_k dx_k dx_k^T)^-1 dx_j
+        Real ata[9] = { 0. };
+        dxs.resize(this->dim * adj[i].size());
+        for (std::size_t k = 0; k < adj[i].size(); ++k) {
+            auto cgj = get_cell_geom(this->c_start + adj[i][k]);
+            for (Int d = 0; d < this->dim; ++d)
+                dxs[k * this->dim + d] = cgj->centroid[d] - cgi->centroid[d];
+            for (Int r = 0; r < this->dim; ++r)
+                for (Int s = 0; s < this->dim; ++s)
+                    ata[r * this->dim + s] += dxs[k * this->dim + r] * dxs[k * this->dim + s];
+        }
+        bool ok = invert(this->dim, ata);
+        for (std::size_t k = 0; k < adj[i].size(); ++k) {
+            auto idx = this->row_ptr[i] + k;
+            this->nbr[idx] = adj[i][k];
+            if (!ok)
+                continue;
+            for (Int r = 0; r < this->dim; ++r)
+                for (Int s = 0; s < this->dim; ++s)
+                    this->weight[idx * this->dim + r] +=
+                        ata[r * this->dim + s] * dxs[k * this->dim + s];
+        }
+    }
+
+    auto n_faces = faces.get_num_faces();
+    auto cell_l = faces.get_left_cells();
+    auto cell_r = faces.get_right_cells();
+    this->dx_l.resize(this->dim * n_faces);
+    this->dx_r.resize(this->dim * n_faces);
+    for (Int blk = 0; blk < faces.get_num_blocks(); ++blk) {
+        auto rng = faces.get_block(blk);
+        Int n = rng.size();
+        auto xf = faces.get_centroids(blk);
+        for (Int i = 0; i < n; ++i) {
+            auto idx = rng.first() + i;
+            auto cgl = get_cell_geom(cell_l[idx]);
+            auto cgr = get_cell_geom(cell_r[idx]);
+            for (Int d = 0; d < this->dim; ++d) {
+                this->dx_l[idx * this->dim + d] = xf[d * n + i] - cgl->centroid[d];
+                this->dx_r[idx * this->dim + d] = xf[d * n + i] - cgr->centroid[d];
+            }
+        }
+    }
+    PETSC_CHECK(VecRestoreArrayRead(cell_geom, &cgeom));
+
+    this->grad.assign(this->n_cells * this->nc * this->dim, 0.);
+    this->phi.resize(this->n_cells * this->nc);
+    this->u_min.resize(this->n_cells * this->nc);
+    this->u_max.resize(this->n_cells * this->nc);
+
+    // overlap cells do not have all their neighbors, so they take gradients from their owners. The
+    // star forest works on `grad`, i.e. on offsets relative to the first cell.
+    PetscSF sf;
+    PETSC_CHECK(DMGetPointSF(dm, &sf));
+    Int n_roots;
+    PETSC_CHECK(PetscSFGetGraph(sf, &n_roots, nullptr, nullptr, nullptr));
+    if (n_roots >= 0) {
+        PetscSection grad_section;
+        PETSC_CHECK(PetscSectionCreate(PETSC_COMM_SELF, &grad_section));
+        PETSC_CHECK(PetscSectionSetChart(grad_section, this->c_start, c_end));
+        for (Int c = this->c_start; c < c_end; ++c)
+            PETSC_CHECK(PetscSectionSetDof(grad_section, c, this->nc * this->dim));
+        PETSC_CHECK(PetscSectionSetUp(grad_section));
+        Int * remote_offsets = nullptr;
+        PETSC_CHECK(PetscSFCreateRemoteOffsets(sf, grad_section, grad_section, &remote_offsets));
+        PETSC_CHECK(PetscSFCreateSectionSF(sf,
+                                           grad_section,
+                                           remote_offsets,
+                                           grad_section,
+                                           &this->cell_sf));
+        PETSC_CHECK(PetscFree(remote_offsets));
+        PETSC_CHECK(PetscSectionDestroy(&grad_section));
+    }
+}
+
+bool
+FVReconstruction::is_created() const
+{
+    return !this->row_ptr.empty();
+}
+
+void
+FVReconstruction::compute_gradients(const Scalar x[])
+{
+    CALL_STACK_MSG();
+    const Int ncd = this->nc * this->dim;
+    for (Int i = 0; i < this->n_cells; ++i) {
+        auto g = this->grad.data() + i * ncd;
+        std::fill(g, g + ncd, 0.);
+        auto uc = x + this->cell_offset[i];
+        for (Int k = this->row_ptr[i]; k < this->row_ptr[i + 1]; ++k) {
+            auto uj = x + this->cell_offset[this->nbr[k]];
+            auto w = this->weight.data() + k * this->dim;
+            for (Int c = 0; c < this->nc; ++c) {
+                auto du = uj[c] - uc[c];
+                for (Int d = 0; d < this->dim; ++d)
+                    g[c * this->dim + d] += w[d] * du;
+            }
+        }
+    }
+
+    if (this->limiter != Limiter::NONE)
+        limit(x);
+
+    if (this->cell_sf) {
+        PETSC_CHECK(PetscSFBcastBegin(this->cell_sf,
+                                      MPIU_SCALAR,
+                                      this->grad.data(),
+                                      this->grad.data(),
+                                      MPI_REPLACE));
+        PETSC_CHECK(PetscSFBcastEnd(this->cell_sf,
+                                    MPIU_SCALAR,
+                                    this->grad.data(),
+                                    this->grad.data(),
+                                    MPI_REPLACE));
+    }
+}
+
+void
+FVReconstruction::limit(const Scalar x[])
+{
+    CALL_STACK_MSG();
+    for (Int i = 0; i < this->n_cells; ++i) {
+        auto uc = x + this->cell_offset[i];
+        for (Int c = 0; c < this->nc; ++c) {
+            this->u_min[i * this->nc + c] = uc[c];
+            this->u_max[i * this->nc + c] = uc[c];
+        }
+        for (Int k = this->row_ptr[i]; k < this->row_ptr[i + 1]; ++k) {
+            auto uj = x + this->cell_offset[this->nbr[k]];
+            for (Int c = 0; c < this->nc; ++c) {
+                this->u_min[i * this->nc + c] = std::min(this->u_min[i * this->nc + c], uj[c]);
+                this->u_max[i * this->nc + c] = std::max(this->u_max[i * this->nc + c], uj[c]);
+            }
+        }
+    }
+
+    // every face limits the gradients of the cells on both of its sides
+    std::fill(this->phi.begin(), this->phi.end(), 1.);
+    Int n_faces = this->face_cell_l.size();
+    for (Int f = 0; f < n_faces; ++f) {
+        for (Int side = 0; side < 2; ++side) {
+            const auto & dx = side == 0 ? this->face_dx_l : this->face_dx_r;
+            Int i = side == 0 ? this->face_cell_l[f] : this->face_cell_r[f];
+            if (i < 0)
+                continue;
+            auto uc = x + this->cell_offset[i];
+            for (Int c = 0; c < this->nc; ++c) {
+                auto g = this->grad.data() + (i * this->nc + c) * this->dim;
+                Real d2 = 0.;
+                for (Int d = 0; d < this->dim; ++d)
+                    d2 += g[d] * dx[f * this->dim + d];
+                auto d_max = this->u_max[i * this->nc + c] - uc[c];
+                auto d_min = this->u_min[i * this->nc + c] - uc[c];
+                auto p = this->limiter == Limiter::BARTH_JESPERSEN
+                             ? barth_jespersen(d2, d_max, d_min)
+                             : venkatakrishnan(d2, d_max, d_min, this->eps2[i]);
+                this->phi[i * this->nc + c] = std::min(this->phi[i * this->nc + c], p);
+            }
+        }
+    }
+
+    for (Int i = 0; i < this->n_cells; ++i)
+        for (Int c = 0; c < this->nc; ++c)
+            for (Int d = 0; d < this->dim; ++d)
+                this->grad[(i * this->nc + c) * this->dim + d] *= this->phi[i * this->nc + c];
+}
+
+const Scalar *
+FVReconstruction::get_gradient(Int cell) const
+{
+    return this->grad.data() + (cell - this->c_start) * this->nc * this->dim;
+}
+
+void
+FVReconstruction::reconstruct(const FVFaceList & faces,
+                              Int blk,
+                              const Scalar x[],
+                              Scalar u_l[],
+                              Scalar u_r[]) const
+{
+    auto rng = faces.get_block(blk);
+    Int first = rng.first();
+    Int n = rng.size();
+    auto cell_l = faces.get_left_cells().data();
+    auto cell_r = faces.get_right_cells().data();
+    auto off_l = faces.get_left_offsets().data();
+    auto off_r = faces.get_right_offsets().data();
+    for (Int c = 0; c < this->nc; ++c) {
+        for (Int i = 0; i < n; ++i) {
+            auto idx = first + i;
+            auto gl = get_gradient(cell_l[idx]) + c * this->dim;
+            auto gr = get_gradient(cell_r[idx]) + c * this->dim;
+            auto ul = x[off_l[idx] + c];
+            auto ur = x[off_r[idx] + c];
+            for (Int d = 0; d < this->dim; ++d) {
+                ul += gl[d] * this->dx_l[idx * this->dim + d];
+                ur += gr[d] * this->dx_r[idx * this->dim + d];
+            }
+            u_l[c * n + i] = ul;
+            u_r[c * n + i] = ur;
+        }
+    }
+}
+
+} // namespace godzilla
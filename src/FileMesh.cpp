@@ -16,15 +16,19 @@ Parameters
 FileMesh::parameters()
 {
     auto params = Object::parameters();
-    params.add_required_param<fs::path>("file", "The name of the file.");
+    params.add_required_param<fs::path>("file", "The name of the file.")
+        .add_param<bool>("parallel_read",
+                         false,
+                         "Read the mesh on all ranks, each rank reading a slice of cells and "
+                         "vertices (ExodusII only).");
     return params;
 }
 
 FileMesh::FileMesh(const Parameters & pars) :
     Object(pars),
     file_format(UNKNOWN),
-    file_name(pars.get<fs::path>("file"))
-
+    file_name(pars.get<fs::path>("file")),
+    parallel_read(pars.get<bool>("parallel_read"))
 {
     CALL_STACK_MSG();
 
@@ -55,7 +59,7 @@ FileMesh::create_mesh()
 {
     CALL_STACK_MSG();
     if (this->file_format == EXODUSII)
-        return create_from_exodus();
+        return this->parallel_read ? create_from_exodus_parallel() : create_from_exodus();
     else if (this->file_format == GMSH)
         return create_from_gmsh();
     else {
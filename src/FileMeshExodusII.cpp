@@ -4,10 +4,15 @@
 #include "godzilla/FileMesh.h"
 #include "godzilla/UnstructuredMesh.h"
 #include "godzilla/Types.h"
+#include "godzilla/IO.h"
+#include "godzilla/StarForest.h"
 #include "exodusIIcpp/exodusIIcpp.h"
+#include "exodusII.h"
 #include "petscdm.h"
 #include "petsc/private/dmimpl.h"
 #include "petscdmplex.h"
+#include <algorithm>
+#include <map>
 
 namespace godzilla {
 
@@ -33,6 +38,132 @@ get_cell_type_ex2(String elem_type)
         throw Exception(fmt::format("Unrecognized element type {}", elem_type));
 }
 
+void
+exodus_check(int ierr, const char * what)
+{
+    if (ierr < 0)
+        throw Exception(fmt::format("exodusII: failed to {}", what));
+}
+
+/// Get range `[start, end)` of `n` items owned by `rank` when split evenly among `size` ranks
+std::pair<Int, Int>
+get_ownership_range(Int n, int rank, int size)
+{
+    Int chunk = n / size;
+    Int rem = n % size;
+    Int start = rank * chunk + std::min<Int>(rank, rem);
+    return { start, start + chunk + (rank < rem ? 1 : 0) };
+}
+
+/// Closes an ExodusII file when going out of scope
+struct ExodusFileGuard {
+    int exoid;
+
+    explicit ExodusFileGuard(int exoid) : exoid(exoid) {}
+    ~ExodusFileGuard() { ex_close(this->exoid); }
+};
+
+String
+get_entity_name(int exoid, ex_entity_type type, int id)
+{
+    char name[MAX_STR_LENGTH + 1] = { 0 };
+    exodus_check(ex_get_name(exoid, type, id, name), "read entity name");
+    if (name[0] == '\0')
+        return fmt::format("{}", id);
+    else
+        return name;
+}
+
+std::vector<int>
+get_entity_ids(int exoid, ex_entity_type type, Int n)
+{
+    std::vector<int> ids(n);
+    if (n > 0)
+        exodus_check(ex_get_ids(exoid, type, ids.data()), "read entity IDs");
+    return ids;
+}
+
+/// Get rank owning item `i` of `n` items split evenly among `size` ranks (see
+/// `get_ownership_range`)
+int
+get_owner(Int i, Int n, int size)
+{
+    Int chunk = n / size;
+    Int rem = n % size;
+    if (i < rem * (chunk + 1))
+        return (int) (i / (chunk + 1));
+    else
+        return (int) (rem + (i - rem * (chunk + 1)) / chunk);
+}
+
+/// Read the slice of a set that belongs to this rank
+///
+/// Entries of the set are split evenly among the ranks, so no rank reads the whole set.
+///
+/// @param exoid ExodusII file ID
+/// @param type Type of the set
+/// @param id ID of the set
+/// @param comm Communicator
+/// @param entries Entries of the slice
+/// @param extra Extra entries of the slice (side numbers for side sets), can be `nullptr`
+void
+read_set_slice(int exoid,
+               ex_entity_type type,
+               int id,
+               mpi::Communicator comm,
+               std::vector<int> & entries,
+               std::vector<int> * extra)
+{
+    int n_entries, n_dist_factors;
+    exodus_check(ex_get_set_param(exoid, type, id, &n_entries, &n_dist_factors),
+                 "read set parameters");
+    auto [start, end] = get_ownership_range(n_entries, comm.rank(), comm.size());
+    entries.resize(end - start);
+    if (extra)
+        extra->resize(end - start);
+    if (end > start)
+        exodus_check(ex_get_partial_set(exoid,
+                                        type,
+                                        id,
+                                        start + 1,
+                                        end - start,
+                                        entries.data(),
+                                        extra ? extra->data() : nullptr),
+                     "read set");
+}
+
+/// Flag items listed by any rank on the rank that owns them
+///
+/// Items are split evenly among the ranks (see `get_ownership_range`) and each of them has `width`
+/// slots.
+///
+/// @param comm Communicator
+/// @param entries Slots listed by this rank, `item * width + slot`
+/// @param n_items Total number of items
+/// @param width Number of slots per item
+/// @return Flags of the slots of the items owned by this rank, 1 if listed by any rank
+std::vector<Int>
+flag_owned(mpi::Communicator comm, const std::vector<Int> & entries, Int n_items, Int width)
+{
+    auto [start, end] = get_ownership_range(n_items, comm.rank(), comm.size());
+    std::vector<StarForest::Node> remote(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        auto item = entries[i] / width;
+        auto owner = get_owner(item, n_items, comm.size());
+        auto owner_start = get_ownership_range(n_items, owner, comm.size()).first;
+        remote[i].rank = owner;
+        remote[i].index = (item - owner_start) * width + entries[i] % width;
+    }
+    StarForest sf;
+    sf.create(comm);
+    sf.set_graph((end - start) * width, (Int) entries.size(), {}, remote);
+    std::vector<Int> leaf(entries.size(), 1);
+    std::vector<Int> root((end - start) * width, 0);
+    sf.reduce_begin(leaf, root, mpi::op::max<Int>());
+    sf.reduce_end(leaf, root, mpi::op::max<Int>());
+    return root;
+}
+
 } // namespace
 
 // This is a rewrite of `DMPlexCreateExodus` from PETSc (`plexexodusii.c`) using exodusIIcpp
@@ -282,4 +413,229 @@ FileMesh::create_from_exodus()
     return m;
 }
 
+// Every rank opens the file and reads only a contiguous slice of cells (following the order of
+// element blocks in the file), vertices and entries of each node and side set. The DMPlex is then
+// built with `DMPlexCreateFromCellListParallelPetsc`, so no rank ever holds the whole mesh.
+//
+// exodusIIcpp reads whole entities only, so the partial reads use the ExodusII C API directly.
+Qtr<UnstructuredMesh>
+FileMesh::create_from_exodus_parallel()
+{
+    CALL_STACK_MSG();
+
+    auto comm = get_comm();
+
+    int cpu_ws = sizeof(Real);
+    int io_ws = 0;
+    float version;
+    int exoid = ex_open(get_file_name().c_str(), EX_READ, &cpu_ws, &io_ws, &version);
+    expect_true(exoid >= 0, fmt::format("Unable to open '{}' for reading.", get_file_name()));
+    ExodusFileGuard guard(exoid);
+
+    ex_init_params info;
+    exodus_check(ex_get_init_ext(exoid, &info), "read initialization parameters");
+    Int dim_embed = info.num_dim;
+    Int n_vertices = info.num_nodes;
+
+    // element blocks
+    auto blk_ids = get_entity_ids(exoid, EX_ELEM_BLOCK, info.num_elem_blk);
+    std::vector<Int> blk_offsets(blk_ids.size() + 1, 0);
+    PolytopeType cell_type = PolytopeType::POINT;
+    Int n_corners = 0;
+    for (std::size_t i = 0; i < blk_ids.size(); ++i) {
+        char elem_type[MAX_STR_LENGTH + 1];
+        int n_blk_elems, n_elem_nodes, n_edges, n_faces, n_attrs;
+        exodus_check(ex_get_block(exoid,
+                                  EX_ELEM_BLOCK,
+                                  blk_ids[i],
+                                  elem_type,
+                                  &n_blk_elems,
+                                  &n_elem_nodes,
+                                  &n_edges,
+                                  &n_faces,
+                                  &n_attrs),
+                     "read element block");
+        auto ct = get_cell_type_ex2(elem_type);
+        if (i == 0) {
+            cell_type = ct;
+            n_corners = n_elem_nodes;
+        }
+        else
+            expect_true(ct == cell_type,
+                        "Parallel reading of ExodusII files requires a single element type.");
+        blk_offsets[i + 1] = blk_offsets[i] + n_blk_elems;
+    }
+    auto dim = UnstructuredMesh::get_polytope_dim(cell_type);
+
+    // connectivity of owned cells
+    auto [c_start, c_end] = get_ownership_range(info.num_elem, comm.rank(), comm.size());
+    Int n_cells = c_end - c_start;
+    std::vector<Int> cells(n_cells * n_corners);
+    std::vector<int> cell_blk(n_cells);
+    {
+        std::vector<int> connect;
+        for (std::size_t i = 0; i < blk_ids.size(); ++i) {
+            auto lo = std::max(c_start, blk_offsets[i]);
+            auto hi = std::min(c_end, blk_offsets[i + 1]);
+            if (lo >= hi)
+                continue;
+            connect.resize((hi - lo) * n_corners);
+            exodus_check(ex_get_partial_conn(exoid,
+                                             EX_ELEM_BLOCK,
+                                             blk_ids[i],
+                                             lo - blk_offsets[i] + 1,
+                                             hi - lo,
+                                             connect.data(),
+                                             nullptr,
+                                             nullptr),
+                         "read element connectivity");
+            for (Int c = lo; c < hi; ++c) {
+                auto cone = Span<Int>(&cells[(c - c_start) * n_corners], n_corners);
+                // EXO uses Fortran-based indexing
+                for (Int k = 0; k < n_corners; ++k)
+                    cone[k] = connect[(c - lo) * n_corners + k] - 1;
+                UnstructuredMesh::invert_cell(cell_type, cone);
+                cell_blk[c - c_start] = blk_ids[i];
+            }
+        }
+    }
+
+    // coordinates of owned vertices
+    auto [v_start, v_end] = get_ownership_range(n_vertices, comm.rank(), comm.size());
+    Int n_owned_vertices = v_end - v_start;
+    std::vector<Real> vertices(n_owned_vertices * dim_embed);
+    if (n_owned_vertices > 0) {
+        std::vector<Real> xyz[3];
+        for (Int d = 0; d < dim_embed; ++d)
+            xyz[d].resize(n_owned_vertices);
+        exodus_check(ex_get_partial_coord(exoid,
+                                          v_start + 1,
+                                          n_owned_vertices,
+                                          xyz[0].data(),
+                                          dim_embed > 1 ? xyz[1].data() : nullptr,
+                                          dim_embed > 2 ? xyz[2].data() : nullptr),
+                     "read coordinates");
+        for (Int i = 0; i < n_owned_vertices; ++i)
+            for (Int d = 0; d < dim_embed; ++d)
+                vertices[i * dim_embed + d] = xyz[d][i];
+    }
+
+    DM dm;
+    PetscSF vertex_sf;
+    PETSC_CHECK(DMPlexCreateFromCellListParallelPetsc(comm,
+                                                      dim,
+                                                      n_cells,
+                                                      n_owned_vertices,
+                                                      n_vertices,
+                                                      n_corners,
+                                                      PETSC_TRUE,
+                                                      cells.data(),
+                                                      dim_embed,
+                                                      vertices.data(),
+                                                      &vertex_sf,
+                                                      nullptr,
+                                                      &dm));
+    // roots are the owned vertices, leaves the local ones
+    StarForest vtx_sf(vertex_sf);
+    auto m = Qtr<UnstructuredMesh>::alloc(dm);
+
+    // Local vertices are numbered after local cells, in the order of their (sorted) global IDs
+    Int n_local_vertices = m->get_vertex_range().size();
+
+    m->create_label("Cell Sets");
+    m->create_label("Face Sets");
+    m->create_label("Vertex Sets");
+
+    // cell sets
+    auto cell_sets = m->get_label("Cell Sets");
+    std::map<int, Label> block_labels;
+    for (auto id : blk_ids) {
+        auto name = get_entity_name(exoid, EX_ELEM_BLOCK, id);
+        m->create_label(name);
+        block_labels[id] = m->get_label(name);
+        m->set_cell_set_name(id, name);
+    }
+    for (Int cell = 0; cell < n_cells; ++cell) {
+        auto id = cell_blk[cell];
+        cell_sets.set_value(cell, id);
+        block_labels[id].set_value(cell, id);
+    }
+
+    // Every rank reads a slice of each set and sends its entries to the ranks owning the
+    // vertices (or cells) they refer to
+
+    // vertex sets
+    auto vertex_sets = m->get_label("Vertex Sets");
+    std::vector<int> set_entries, set_extra;
+    std::vector<Int> entries;
+    std::vector<Int> in_set(n_local_vertices);
+    for (auto id : get_entity_ids(exoid, EX_NODE_SET, info.num_node_sets)) {
+        auto name = get_entity_name(exoid, EX_NODE_SET, id);
+        m->create_label(name);
+        auto vertex_set_label = m->get_label(name);
+        m->set_vertex_set_name(id, name);
+
+        read_set_slice(exoid, EX_NODE_SET, id, comm, set_entries, nullptr);
+        entries.resize(set_entries.size());
+        // EXO uses Fortran-based indexing
+        for (std::size_t i = 0; i < set_entries.size(); ++i)
+            entries[i] = set_entries[i] - 1;
+        auto owned = flag_owned(comm, entries, n_vertices, 1);
+        vtx_sf.broadcast_begin(owned, in_set, mpi::op::replace<Int>());
+        vtx_sf.broadcast_end(owned, in_set, mpi::op::replace<Int>());
+        for (Int i = 0; i < n_local_vertices; ++i) {
+            if (in_set[i]) {
+                vertex_sets.set_value(n_cells + i, id);
+                vertex_set_label.set_value(n_cells + i, id);
+            }
+        }
+    }
+
+    // side sets
+    auto face_sets = m->get_label("Face Sets");
+    auto side_ordering = io::get_elem_side_ordering(cell_type);
+    Int n_elem_sides = side_ordering.size();
+    auto point_sf = m->get_point_star_forest();
+    bool has_point_sf = point_sf.get_graph().get_num_roots() >= 0;
+    auto n_points = m->get_chart().last();
+    std::vector<Int> face_flags(n_points), root_flags(n_points);
+    for (auto id : get_entity_ids(exoid, EX_SIDE_SET, info.num_side_sets)) {
+        auto name = get_entity_name(exoid, EX_SIDE_SET, id);
+        m->create_label(name);
+        auto face_set_label = m->get_label(name);
+        m->set_face_set_name(id, name);
+
+        read_set_slice(exoid, EX_SIDE_SET, id, comm, set_entries, &set_extra);
+        entries.resize(set_entries.size());
+        for (std::size_t i = 0; i < set_entries.size(); ++i)
+            entries[i] = (set_entries[i] - 1) * n_elem_sides + set_extra[i] - 1;
+        auto owned = flag_owned(comm, entries, info.num_elem, n_elem_sides);
+
+        std::fill(face_flags.begin(), face_flags.end(), 0);
+        for (Int cell = 0; cell < n_cells; ++cell) {
+            auto cone = m->get_cone(cell);
+            for (Int i = 0; i < n_elem_sides; ++i)
+                if (owned[cell * n_elem_sides + side_ordering[i] - 1])
+                    face_flags[cone[i]] = 1;
+        }
+        // faces shared with other ranks are labeled there as well
+        if (has_point_sf) {
+            root_flags = face_flags;
+            point_sf.reduce_begin(face_flags, root_flags, mpi::op::max<Int>());
+            point_sf.reduce_end(face_flags, root_flags, mpi::op::max<Int>());
+            face_flags = root_flags;
+            point_sf.broadcast_begin(root_flags, face_flags, mpi::op::replace<Int>());
+            point_sf.broadcast_end(root_flags, face_flags, mpi::op::replace<Int>());
+        }
+        for (Int face = 0; face < n_points; ++face) {
+            if (face_flags[face]) {
+                face_sets.set_value(face, id);
+                face_set_label.set_value(face, id);
+            }
+        }
+    }
+
+    return m;
+}
+
 } // namespace godzilla
@@ -42,6 +42,20 @@ FileOutput::get_file_name() const
     return this->file_name;
 }
 
+std::function<void()>
+FileOutput::create_output_task()
+{
+    CALL_STACK_MSG();
+    return {};
+}
+
+bool
+FileOutput::is_snapshot_thread_safe() const
+{
+    CALL_STACK_MSG();
+    return true;
+}
+
 fs::path
 FileOutput::create_file_name() const
 {
@@ -64,6 +64,13 @@ Functional::get_field_dot(String field_name) const
     return get_fe_problem()->get_field_dot(field_name);
 }
 
+const BatchField &
+Functional::get_batch_field(String field_name) const
+{
+    CALL_STACK_MSG();
+    return get_fe_problem()->get_batch_field(field_name);
+}
+
 const Real &
 Functional::get_time() const
 {
@@ -4,6 +4,7 @@
 #include "godzilla/HDF5File.h"
 #include "godzilla/CallStack.h"
 #include "godzilla/Enums.h"
+#include <algorithm>
 
 namespace godzilla {
 
@@ -20,13 +21,31 @@ disable_hdf5_output()
 } // namespace
 
 HDF5File::HDF5File(mpi::Communicator comm, fs::path file_name, FileAccess faccess) :
-    file_name(std::move(file_name))
+    HDF5File(comm, std::move(file_name), faccess, hdf5::FileOptions())
+{
+}
+
+HDF5File::HDF5File(mpi::Communicator comm,
+                   fs::path file_name,
+                   FileAccess faccess,
+                   const hdf5::FileOptions & opts) :
+    file_name(std::move(file_name)),
+    dset_opts(opts.datasets)
 {
     std::call_once(hdf5_init, disable_hdf5_output);
 
     MPI_Info info = MPI_INFO_NULL;
+    if (!opts.mpi_hints.empty()) {
+        MPI_Info_create(&info);
+        for (auto & [key, value] : opts.mpi_hints)
+            MPI_Info_set(info, key.c_str(), value.c_str());
+    }
     auto fapl = H5Pcreate(H5P_FILE_ACCESS);
     H5Pset_fapl_mpio(fapl, comm, info);
+    if (info != MPI_INFO_NULL)
+        MPI_Info_free(&info);
+    if (opts.alignment > 0)
+        H5Pset_alignment(fapl, opts.alignment_threshold, opts.alignment);
 
     if (faccess == FileAccess::READ)
         this->id = H5Fopen(this->file_name.c_str(), H5F_ACC_RDONLY, fapl);
@@ -42,18 +61,38 @@ HDF5File::HDF5File(mpi::Communicator comm, fs::path file_name, FileAccess facces
                                     this->file_name.string()));
 }
 
-HDF5File::HDF5File(fs::path file_name, FileAccess faccess) : file_name(std::move(file_name))
+HDF5File::HDF5File(fs::path file_name, FileAccess faccess) :
+    HDF5File(std::move(file_name), faccess, hdf5::FileOptions())
+{
+}
+
+HDF5File::HDF5File(fs::path file_name, FileAccess faccess, const hdf5::FileOptions & opts) :
+    file_name(std::move(file_name)),
+    dset_opts(opts.datasets)
 {
     std::call_once(hdf5_init, disable_hdf5_output);
 
+    // MPI-IO hints do not apply to a file accessed by a single process
+    auto fapl = H5Pcreate(H5P_FILE_ACCESS);
+    if (opts.alignment > 0)
+        H5Pset_alignment(fapl, opts.alignment_threshold, opts.alignment);
+
     if (faccess == FileAccess::READ)
-        this->id = H5Fopen(this->file_name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        this->id = H5Fopen(this->file_name.c_str(), H5F_ACC_RDONLY, fapl);
     else if (faccess == FileAccess::WRITE)
-        this->id = H5Fopen(this->file_name.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+        this->id = H5Fopen(this->file_name.c_str(), H5F_ACC_RDWR, fapl);
     else if (faccess == FileAccess::CREATE)
-        this->id = H5Fcreate(this->file_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-    else
+        this->id = H5Fcreate(this->file_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    else if (faccess == FileAccess::CREATE_IN_MEMORY) {
+        constexpr std::size_t INCREMENT = 1 << 20;
+        H5Pset_fapl_core(fapl, INCREMENT, 0);
+        this->id = H5Fcreate(this->file_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    }
+    else {
+        H5Pclose(fapl);
         throw Exception("Unsupported file access");
+    }
+    H5Pclose(fapl);
 
     if (this->id == H5I_INVALID_HID)
         throw Exception(fmt::format("Unable to open {} or it is not a valid HDF5 file.",
@@ -78,13 +117,50 @@ HDF5File::get_file_path() const
     return this->file_name;
 }
 
+std::vector<char>
+HDF5File::get_file_image() const
+{
+    H5Fflush(this->id, H5F_SCOPE_LOCAL);
+    auto size = H5Fget_file_image(this->id, nullptr, 0);
+    if (size < 0)
+        throw Exception(
+            fmt::format("Failed to get image of HDF5 file {}.", this->file_name.string()));
+    std::vector<char> image(size);
+    if (H5Fget_file_image(this->id, image.data(), size) < 0)
+        throw Exception(
+            fmt::format("Failed to get image of HDF5 file {}.", this->file_name.string()));
+    return image;
+}
+
+hid_t
+HDF5File::Dataset::create_property_list(const Dataspace & dspace,
+                                        const hdf5::DatasetOptions & opts)
+{
+    auto dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    auto dims = dspace.get_simple_extent_dims();
+    if (opts.chunk_size > 0 && dims.size() == 1 && dims[0] > 0) {
+        hsize_t chunk = std::min(opts.chunk_size, dims[0]);
+        H5Pset_chunk(dcpl, 1, &chunk);
+        if (opts.compression == hdf5::Compression::DEFLATE &&
+            H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+            H5Pset_deflate(dcpl, opts.deflate_level);
+        else if (opts.compression == hdf5::Compression::SZIP &&
+                 H5Zfilter_avail(H5Z_FILTER_SZIP) > 0) {
+            constexpr unsigned int PIXELS_PER_BLOCK = 32;
+            if (chunk >= PIXELS_PER_BLOCK)
+                H5Pset_szip(dcpl, H5_SZIP_NN_OPTION_MASK, PIXELS_PER_BLOCK);
+        }
+    }
+    return dcpl;
+}
+
 void
 HDF5File::Group::write_global_vector(String name, const Vector & data)
 {
     auto rng = data.get_ownership_range();
 
     auto space = Dataspace::create(data.get_size());
-    auto dset = Dataset::create<Real>(this->id, name.c_str(), space);
+    auto dset = Dataset::create<Real>(this->id, name.c_str(), space, this->dset_opts);
 
     auto filespace = dset.get_space();
     filespace.select_hyperslab(rng);
@@ -6,6 +6,7 @@
 #include "godzilla/DiscreteProblemInterface.h"
 #include "godzilla/FEProblemInterface.h"
 #include "godzilla/DGProblemInterface.h"
+#include "godzilla/ParallelExodusIIFile.h"
 #include "godzilla/CallStack.h"
 #include "godzilla/Exception.h"
 #include "petscdmplex.h"
@@ -39,24 +40,16 @@ struct ContinousPolicy {
                 const Int * cells)
     {
         CALL_STACK_MSG();
-        auto dm = mesh.get_dm();
         Int n_all_elems = mesh.get_num_all_cells();
         auto elem_type = get_elem_type(polytope_type);
         int n_nodes_per_elem = UnstructuredMesh::get_num_cell_nodes(polytope_type);
         auto ordering = get_elem_node_ordering(polytope_type);
+        const auto & cell_conn = mesh.get_cell_connectivity();
         std::vector<int> connect((std::size_t) n_elems_in_block * n_nodes_per_elem);
         for (Int i = 0, j = 0; i < n_elems_in_block; ++i) {
-            Int elem_id = cells[i];
-            Int closure_size;
-            Int * closure = nullptr;
-            PETSC_CHECK(
-                DMPlexGetTransitiveClosure(dm, elem_id, PETSC_TRUE, &closure_size, &closure));
-            for (Int k = 0; k < n_nodes_per_elem; ++k, ++j) {
-                Int l = 2 * (closure_size - n_nodes_per_elem + ordering[k]);
-                connect[j] = (int) (closure[l] - n_all_elems + 1);
-            }
-            PETSC_CHECK(
-                DMPlexRestoreTransitiveClosure(dm, elem_id, PETSC_TRUE, &closure_size, &closure));
+            auto conn = cell_conn[cells[i]];
+            for (Int k = 0; k < n_nodes_per_elem; ++k, ++j)
+                connect[j] = (int) (conn[ordering[k]] - n_all_elems + 1);
         }
         f.write_block(blk_id, elem_type, n_elems_in_block, connect);
     }
@@ -347,10 +340,11 @@ write_coords<DiscontinousPolicy>(exodusIIcpp::File & f, const UnstructuredMesh &
         z.resize(n_nodes);
 
     auto n_all_cells = mesh.get_num_all_cells();
+    const auto & cell_conn = mesh.get_cell_connectivity();
     std::size_t i = 0;
     for (auto & cid : mesh.get_cell_range()) {
-        auto conn = mesh.get_connectivity(cid);
-        for (std::size_t j = 0; j < conn.size(); ++j, ++i) {
+        auto conn = cell_conn[cid];
+        for (Int j = 0; j < conn.size(); ++j, ++i) {
             Int ni = conn[j] - n_all_cells;
             x[i] = xyz[ni * dim + 0];
             if (dim >= 2)
@@ -588,14 +582,15 @@ get_aux_var_names(DiscreteProblemInterface & dpi, FieldID fid)
 
 // Solution writing
 
-template <typename Policy>
+template <typename Policy, typename File>
 void
-write_nodal_field_values(exodusIIcpp::File & f,
+write_nodal_field_values(File & f,
                          const DiscreteProblemInterface & dpi,
                          int step_num,
                          Real /* time */,
                          FieldID fid,
-                         int exo_var_id)
+                         int exo_var_id,
+                         std::vector<double> & buffer)
 {
     CALL_STACK_MSG();
     auto sln = Policy::get_solution(dpi);
@@ -603,13 +598,15 @@ write_nodal_field_values(exodusIIcpp::File & f,
     auto mesh = dpi.get_mesh();
     auto n_all_elems = mesh->get_num_all_cells();
     auto nc = Policy::get_num_components(dpi, fid).value();
+    auto vertex_range = mesh->get_vertex_range();
 
-    for (auto n : mesh->get_vertex_range()) {
-        auto offset = Policy::get_dof(dpi, n, fid);
-        for (Int c = 0; c < nc; ++c) {
-            int exo_idx = n - n_all_elems + 1;
-            f.write_partial_nodal_var(step_num, exo_var_id + c, 1, exo_idx, sln_vals[offset + c]);
+    buffer.resize(vertex_range.size());
+    for (Int c = 0; c < nc; ++c) {
+        for (auto n : vertex_range) {
+            auto offset = Policy::get_dof(dpi, n, fid);
+            buffer[n - n_all_elems] = sln_vals[offset + c];
         }
+        f.write_nodal_var(step_num, exo_var_id + c, buffer);
     }
 }
 
@@ -622,7 +619,21 @@ write_field_values(exodusIIcpp::File & f,
                    int exo_var_id)
 {
     CALL_STACK_MSG();
-    write_nodal_field_values<PrimaryFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id);
+    std::vector<double> buffer;
+    write_field_values(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_field_values(exodusIIcpp::File & f,
+                   const DiscreteProblemInterface & dpi,
+                   int step_num,
+                   Real time,
+                   FieldID fid,
+                   int exo_var_id,
+                   std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<PrimaryFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
 }
 
 void
@@ -634,7 +645,21 @@ write_aux_field_values(exodusIIcpp::File & f,
                        int exo_var_id)
 {
     CALL_STACK_MSG();
-    write_nodal_field_values<AuxFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id);
+    std::vector<double> buffer;
+    write_aux_field_values(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_aux_field_values(exodusIIcpp::File & f,
+                       const DiscreteProblemInterface & dpi,
+                       int step_num,
+                       Real time,
+                       FieldID fid,
+                       int exo_var_id,
+                       std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<AuxFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
 }
 
 template <typename Policy>
@@ -644,28 +669,27 @@ write_nodal_field_values(exodusIIcpp::File & f,
                          int step_num,
                          Real /* time */,
                          FieldID fid,
-                         int exo_var_id)
+                         int exo_var_id,
+                         std::vector<double> & buffer)
 {
     CALL_STACK_MSG();
     auto sln = Policy::get_solution(dgpi);
     auto sln_vals = sln.borrow_array_read();
     auto mesh = dgpi.get_mesh();
     auto nc = Policy::get_num_components(dgpi, fid).value();
+    auto cell_range = mesh->get_cell_range();
     int n_nodes_per_elem =
-        UnstructuredMesh::get_num_cell_nodes(mesh->get_cell_type(*mesh->get_cell_range().begin()));
+        UnstructuredMesh::get_num_cell_nodes(mesh->get_cell_type(*cell_range.begin()));
 
-    for (auto cid : mesh->get_cell_range()) {
-        for (Int c = 0; c < nc; ++c) {
+    buffer.resize((std::size_t) cell_range.size() * n_nodes_per_elem);
+    for (Int c = 0; c < nc; ++c) {
+        for (auto cid : cell_range) {
             for (int lni = 0; lni < n_nodes_per_elem; ++lni) {
-                int exo_idx = (cid * n_nodes_per_elem + lni) + 1;
                 auto offset = Policy::get_dof(dgpi, cid, lni, fid);
-                f.write_partial_nodal_var(step_num,
-                                          exo_var_id + c,
-                                          1,
-                                          exo_idx,
-                                          sln_vals[offset + c]);
+                buffer[cid * n_nodes_per_elem + lni] = sln_vals[offset + c];
             }
         }
+        f.write_nodal_var(step_num, exo_var_id + c, buffer);
     }
 }
 
@@ -678,7 +702,21 @@ write_field_values(exodusIIcpp::File & f,
                    int exo_var_id)
 {
     CALL_STACK_MSG();
-    write_nodal_field_values<PrimaryFieldPolicy>(f, dgpi, step_num, time, fid, exo_var_id);
+    std::vector<double> buffer;
+    write_field_values(f, dgpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_field_values(exodusIIcpp::File & f,
+                   const DGProblemInterface & dgpi,
+                   int step_num,
+                   Real time,
+                   FieldID fid,
+                   int exo_var_id,
+                   std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<PrimaryFieldPolicy>(f, dgpi, step_num, time, fid, exo_var_id, buffer);
 }
 
 void
@@ -690,76 +728,87 @@ write_aux_field_values(exodusIIcpp::File & f,
                        int exo_var_id)
 {
     CALL_STACK_MSG();
-    write_nodal_field_values<AuxFieldPolicy>(f, dgpi, step_num, time, fid, exo_var_id);
+    std::vector<double> buffer;
+    write_aux_field_values(f, dgpi, step_num, time, fid, exo_var_id, buffer);
 }
 
-template <typename Policy>
 void
-write_elem_field_values(exodusIIcpp::File & f,
+write_aux_field_values(exodusIIcpp::File & f,
+                       const DGProblemInterface & dgpi,
+                       int step_num,
+                       Real time,
+                       FieldID fid,
+                       int exo_var_id,
+                       std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<AuxFieldPolicy>(f, dgpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+template <typename Policy, typename File>
+void
+write_elem_field_values(File & f,
                         DiscreteProblemInterface & dpi,
                         int step_num,
                         Real /* time */,
                         FieldID fid,
                         int exo_var_id,
-                        int blk_id)
+                        int blk_id,
+                        std::vector<double> & buffer)
 {
     CALL_STACK_MSG();
     auto sln = Policy::get_solution(dpi);
     auto sln_vals = sln.borrow_array_read();
     auto mesh = dpi.get_mesh();
     auto nc = Policy::get_num_components(dpi, fid).value();
+    auto cell_range = mesh->get_cell_range();
 
-    for (auto cell : mesh->get_cell_range()) {
-        auto offset = Policy::get_dof(dpi, cell, fid);
-        for (Int c = 0; c < nc; ++c) {
-            int exo_idx = (int) (cell + 1);
-            f.write_partial_elem_var(step_num,
-                                     exo_var_id + c,
-                                     blk_id,
-                                     exo_idx,
-                                     sln_vals[offset + c]);
+    buffer.resize(cell_range.size());
+    for (Int c = 0; c < nc; ++c) {
+        for (auto cell : cell_range) {
+            auto offset = Policy::get_dof(dpi, cell, fid);
+            buffer[cell] = sln_vals[offset + c];
         }
+        f.write_elem_var(step_num, exo_var_id + c, blk_id, buffer);
     }
 }
 
-template <typename Policy>
+template <typename Policy, typename File>
 void
-write_elem_field_values(exodusIIcpp::File & f,
+write_elem_field_values(File & f,
                         DiscreteProblemInterface & dpi,
                         int step_num,
                         Real /* time */,
                         FieldID fid,
                         int exo_var_id,
                         int blk_id,
-                        Span<const Int> cells)
+                        Span<const Int> cells,
+                        std::vector<double> & buffer)
 {
     CALL_STACK_MSG();
     auto sln = Policy::get_solution(dpi);
     auto sln_vals = sln.borrow_array_read();
     auto nc = Policy::get_num_components(dpi, fid).value();
 
-    for (auto i : make_range(cells.size())) {
-        auto elem_id = cells[i];
-        auto offset = Policy::get_dof(dpi, elem_id, fid);
-        for (Int c = 0; c < nc; ++c) {
-            auto exo_idx = (int) (i + 1);
-            f.write_partial_elem_var(step_num,
-                                     exo_var_id + c,
-                                     blk_id,
-                                     exo_idx,
-                                     sln_vals[offset + c]);
+    buffer.resize(cells.size());
+    for (Int c = 0; c < nc; ++c) {
+        for (auto i : make_range(cells.size())) {
+            auto offset = Policy::get_dof(dpi, cells[i], fid);
+            buffer[i] = sln_vals[offset + c];
         }
+        f.write_elem_var(step_num, exo_var_id + c, blk_id, buffer);
     }
 }
 
-template <typename Policy>
+template <typename Policy, typename File>
 void
-write_block_elem_values(exodusIIcpp::File & f,
+write_block_elem_values(File & f,
                         DiscreteProblemInterface & dpi,
                         int step_num,
                         Real time,
                         FieldID fid,
-                        int exo_var_id)
+                        int exo_var_id,
+                        std::vector<double> & buffer)
 {
     CALL_STACK_MSG();
     auto mesh = dpi.get_mesh();
@@ -779,11 +828,19 @@ write_block_elem_values(exodusIIcpp::File & f,
                                             fid,
                                             exo_var_id,
                                             (int) cell_set_idx[i],
-                                            Span(cells.data(), cells.size()));
+                                            Span(cells.data(), cells.size()),
+                                            buffer);
         }
     }
     else
-        write_elem_field_values<Policy>(f, dpi, step_num, time, fid, exo_var_id, SINGLE_BLK_ID);
+        write_elem_field_values<Policy>(f,
+                                        dpi,
+                                        step_num,
+                                        time,
+                                        fid,
+                                        exo_var_id,
+                                        SINGLE_BLK_ID,
+                                        buffer);
 }
 
 void
@@ -795,7 +852,21 @@ write_elemental_field_values(exodusIIcpp::File & f,
                              int exo_var_id)
 {
     CALL_STACK_MSG();
-    write_block_elem_values<PrimaryFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id);
+    std::vector<double> buffer;
+    write_elemental_field_values(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_elemental_field_values(exodusIIcpp::File & f,
+                             DiscreteProblemInterface & dpi,
+                             int step_num,
+                             Real time,
+                             FieldID fid,
+                             int exo_var_id,
+                             std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_block_elem_values<PrimaryFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
 }
 
 void
@@ -807,7 +878,243 @@ write_aux_elemental_field_values(exodusIIcpp::File & f,
                                  int exo_var_id)
 {
     CALL_STACK_MSG();
-    write_block_elem_values<AuxFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id);
+    std::vector<double> buffer;
+    write_aux_elemental_field_values(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_aux_elemental_field_values(exodusIIcpp::File & f,
+                                 DiscreteProblemInterface & dpi,
+                                 int step_num,
+                                 Real time,
+                                 FieldID fid,
+                                 int exo_var_id,
+                                 std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_block_elem_values<AuxFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+// Solution snapshots
+
+void
+StepData::start(int step_num, Real time)
+{
+    CALL_STACK_MSG();
+    this->step_num = step_num;
+    this->time = time;
+    this->n_nodal_vars = 0;
+    this->n_elem_vars = 0;
+    this->global_vars.clear();
+}
+
+StepData::Var &
+StepData::next_var(std::vector<Var> & vars, Int & n)
+{
+    CALL_STACK_MSG();
+    if (n == (Int) vars.size())
+        vars.emplace_back();
+    return vars[n++];
+}
+
+void
+StepData::write_nodal_var(int /* step_num */, int var_idx, const std::vector<double> & values)
+{
+    CALL_STACK_MSG();
+    auto & var = next_var(this->nodal_vars, this->n_nodal_vars);
+    var.var_idx = var_idx;
+    var.blk_id = 0;
+    var.values.assign(values.begin(), values.end());
+}
+
+void
+StepData::write_elem_var(int /* step_num */,
+                         int var_idx,
+                         int blk_id,
+                         const std::vector<double> & values)
+{
+    CALL_STACK_MSG();
+    auto & var = next_var(this->elem_vars, this->n_elem_vars);
+    var.var_idx = var_idx;
+    var.blk_id = blk_id;
+    var.values.assign(values.begin(), values.end());
+}
+
+void
+StepData::write_global_vars(const std::vector<double> & values)
+{
+    CALL_STACK_MSG();
+    this->global_vars.assign(values.begin(), values.end());
+}
+
+void
+StepData::write(exodusIIcpp::File & f) const
+{
+    CALL_STACK_MSG();
+    f.write_time(this->step_num, this->time);
+    for (Int i = 0; i < this->n_nodal_vars; ++i) {
+        auto & var = this->nodal_vars[i];
+        f.write_nodal_var(this->step_num, var.var_idx, var.values);
+    }
+    for (Int i = 0; i < this->n_elem_vars; ++i) {
+        auto & var = this->elem_vars[i];
+        f.write_elem_var(this->step_num, var.var_idx, var.blk_id, var.values);
+    }
+    for (std::size_t i = 0; i < this->global_vars.size(); ++i)
+        f.write_global_var(this->step_num, (int) i + 1, this->global_vars[i]);
+}
+
+void
+write_field_values(StepData & f,
+                   const DiscreteProblemInterface & dpi,
+                   int step_num,
+                   Real time,
+                   FieldID fid,
+                   int exo_var_id,
+                   std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<PrimaryFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_aux_field_values(StepData & f,
+                       const DiscreteProblemInterface & dpi,
+                       int step_num,
+                       Real time,
+                       FieldID fid,
+                       int exo_var_id,
+                       std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<AuxFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_elemental_field_values(StepData & f,
+                             DiscreteProblemInterface & dpi,
+                             int step_num,
+                             Real time,
+                             FieldID fid,
+                             int exo_var_id,
+                             std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_block_elem_values<PrimaryFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+void
+write_aux_elemental_field_values(StepData & f,
+                                 DiscreteProblemInterface & dpi,
+                                 int step_num,
+                                 Real time,
+                                 FieldID fid,
+                                 int exo_var_id,
+                                 std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_block_elem_values<AuxFieldPolicy>(f, dpi, step_num, time, fid, exo_var_id, buffer);
+}
+
+// Solution writing into a single file shared by all ranks
+
+template <typename Policy>
+void
+write_nodal_field_values(ParallelExodusIIFile & f,
+                         const DiscreteProblemInterface & dpi,
+                         int step_num,
+                         FieldID fid,
+                         int exo_var_id,
+                         std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    auto sln = Policy::get_solution(dpi);
+    auto sln_vals = sln.borrow_array_read();
+    auto nc = Policy::get_num_components(dpi, fid).value();
+    auto & vertices = f.get_owned_vertices();
+
+    buffer.resize(vertices.size());
+    for (Int c = 0; c < nc; ++c) {
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            auto offset = Policy::get_dof(dpi, vertices[i], fid);
+            buffer[i] = sln_vals[offset + c];
+        }
+        f.write_nodal_var(step_num, exo_var_id + c, buffer);
+    }
+}
+
+template <typename Policy>
+void
+write_elem_field_values(ParallelExodusIIFile & f,
+                        const DiscreteProblemInterface & dpi,
+                        int step_num,
+                        FieldID fid,
+                        int exo_var_id,
+                        std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    auto sln = Policy::get_solution(dpi);
+    auto sln_vals = sln.borrow_array_read();
+    auto nc = Policy::get_num_components(dpi, fid).value();
+
+    for (auto & blk : f.get_blocks()) {
+        buffer.resize(blk.cells.size());
+        for (Int c = 0; c < nc; ++c) {
+            for (std::size_t i = 0; i < blk.cells.size(); ++i) {
+                auto offset = Policy::get_dof(dpi, blk.cells[i], fid);
+                buffer[i] = sln_vals[offset + c];
+            }
+            f.write_elem_var(step_num, exo_var_id + c, blk, buffer);
+        }
+    }
+}
+
+void
+write_field_values(ParallelExodusIIFile & f,
+                   const DiscreteProblemInterface & dpi,
+                   int step_num,
+                   FieldID fid,
+                   int exo_var_id,
+                   std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<PrimaryFieldPolicy>(f, dpi, step_num, fid, exo_var_id, buffer);
+}
+
+void
+write_aux_field_values(ParallelExodusIIFile & f,
+                       const DiscreteProblemInterface & dpi,
+                       int step_num,
+                       FieldID fid,
+                       int exo_var_id,
+                       std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_nodal_field_values<AuxFieldPolicy>(f, dpi, step_num, fid, exo_var_id, buffer);
+}
+
+void
+write_elemental_field_values(ParallelExodusIIFile & f,
+                             const DiscreteProblemInterface & dpi,
+                             int step_num,
+                             FieldID fid,
+                             int exo_var_id,
+                             std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_elem_field_values<PrimaryFieldPolicy>(f, dpi, step_num, fid, exo_var_id, buffer);
+}
+
+void
+write_aux_elemental_field_values(ParallelExodusIIFile & f,
+                                 const DiscreteProblemInterface & dpi,
+                                 int step_num,
+                                 FieldID fid,
+                                 int exo_var_id,
+                                 std::vector<double> & buffer)
+{
+    CALL_STACK_MSG();
+    write_elem_field_values<AuxFieldPolicy>(f, dpi, step_num, fid, exo_var_id, buffer);
 }
 
 } // namespace io
@@ -120,6 +120,13 @@ ImplicitFENonlinearProblem::set_up_callbacks()
     set_time_boundary_local(ref(*this), &ImplicitFENonlinearProblem::compute_boundary_fem);
     set_ifunction_local(ref(*this), &ImplicitFENonlinearProblem::compute_ifunction_fem);
     set_ijacobian_local(ref(*this), &ImplicitFENonlinearProblem::compute_ijacobian_fem);
+    // the solver must assemble into the matrix the COO pattern was set on
+    if (uses_coo_assembly())
+        PETSC_CHECK(TSSetIJacobian(get_ts(), get_jacobian(), get_jacobian(), nullptr, nullptr));
+    else if (uses_matrix_free()) {
+        auto & J = get_matrix_free_jacobian();
+        PETSC_CHECK(TSSetIJacobian(get_ts(), J, J, nullptr, nullptr));
+    }
 }
 
 void
@@ -160,17 +167,8 @@ ImplicitFENonlinearProblem::compute_ifunction_fem(Real time,
 {
     // this is based on DMSNESComputeResidual() and DMPlexTSComputeIFunctionFEM()
     CALL_STACK_MSG();
-    auto all_cells = get_mesh()->get_all_cells();
-
     for (auto & region : get_weak_form().get_residual_regions()) {
-        IndexSet cells;
-        if (region.label.is_null()) {
-            cells = all_cells;
-        }
-        else {
-            auto points = region.label.get_stratum(region.value);
-            cells = IndexSet::intersect_caching(all_cells, points);
-        }
+        auto & cells = get_region_cells(region);
         compute_residual_internal(get_dm(), region, cells, time, x, x_t, time, F);
     }
 }
@@ -186,21 +184,31 @@ ImplicitFENonlinearProblem::compute_ijacobian_fem(Real time,
     // this is based on DMPlexSNESComputeJacobianFEM(), DMSNESComputeJacobianAction() and
     // DMPlexTSComputeIJacobianFEM()
     CALL_STACK_MSG();
-    auto all_cells = get_mesh()->get_all_cells();
+    if (uses_matrix_free()) {
+        for (auto & region : get_weak_form().get_jacobian_regions())
+            compute_matrix_free_jacobian(get_dm(),
+                                         region,
+                                         get_region_cells(region),
+                                         time,
+                                         x_t_shift,
+                                         x,
+                                         x_t);
+        // bump the state of the shell matrix, so the preconditioner is rebuilt from the new
+        // coefficients
+        J.assemble();
+        return;
+    }
 
-    Jp.zero();
+    auto coo = coo_overwrites(J, Jp);
+    if (!coo)
+        Jp.zero();
 
     for (auto & region : get_weak_form().get_jacobian_regions()) {
-        IndexSet cells;
-        if (region.label.is_null()) {
-            cells = all_cells;
-        }
-        else {
-            auto points = region.label.get_stratum(region.value);
-            cells = IndexSet::intersect_caching(all_cells, points);
-        }
+        auto & cells = get_region_cells(region);
         compute_jacobian_internal(get_dm(), region, cells, time, x_t_shift, x, x_t, J, Jp);
     }
+    if (coo)
+        assemble_coo_jacobian(get_dm(), x, x_t, time, x_t_shift, J, Jp);
 }
 
 void
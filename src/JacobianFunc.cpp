@@ -4,6 +4,7 @@
 #include "godzilla/JacobianFunc.h"
 #include "godzilla/FEProblemInterface.h"
 #include "godzilla/CallStack.h"
+#include "godzilla/Exception.h"
 
 namespace godzilla {
 
@@ -11,6 +12,19 @@ JacobianFunc::JacobianFunc(Ref<FEProblemInterface> fepi, String region) : Functi
 {
 }
 
+bool
+JacobianFunc::is_batched() const
+{
+    return false;
+}
+
+void
+JacobianFunc::evaluate_batch(const QuadratureBatch &, Scalar[]) const
+{
+    CALL_STACK_MSG();
+    throw Exception("Batched evaluation is not implemented for this Jacobian functional");
+}
+
 const Real &
 JacobianFunc::get_time_shift() const
 {
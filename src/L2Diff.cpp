@@ -6,6 +6,8 @@
 #include "godzilla/Problem.h"
 #include "godzilla/DiscreteProblemInterface.h"
 #include "godzilla/Ref.h"
+#include "godzilla/ReductionBatch.h"
+#include "godzilla/L2DiffLocal.h"
 #include "petscdmplex.h"
 
 namespace godzilla {
@@ -32,7 +34,9 @@ L2Diff::parameters()
     return params;
 }
 
-L2Diff::L2Diff(const Parameters & pars) : Postprocessor(pars), l2_diff(0.) {}
+L2Diff::L2Diff(const Parameters & pars) : Postprocessor(pars), l2_diff(0.), l2_diff_sq_handle(0)
+{
+}
 
 void
 L2Diff::create()
@@ -59,6 +63,33 @@ L2Diff::compute()
                                          &this->l2_diff));
 }
 
+bool
+L2Diff::compute_local(ReductionBatch & batch)
+{
+    CALL_STACK_MSG();
+    auto problem = get_problem();
+    auto dpio = try_dynamic_ref_cast<DiscreteProblemInterface>(problem);
+    GODZILLA_ASSERT_TRUE(dpio.has_value(), "Discrete problem is null");
+    std::vector<PetscFunc *> funcs(1, L2Diff__invoke_delegate);
+    std::vector<void *> ctxs(1, this);
+    auto dpi = dpio.value();
+    dpi->compute_solution_vector_local();
+    auto diff = compute_l2_field_diff_squared_local(problem->get_dm(),
+                                                    problem->get_time(),
+                                                    funcs,
+                                                    ctxs,
+                                                    dpi->get_solution_vector_local());
+    this->l2_diff_sq_handle = batch.add_sum(diff[0]);
+    return true;
+}
+
+void
+L2Diff::finish_compute(const ReductionBatch & batch)
+{
+    CALL_STACK_MSG();
+    this->l2_diff = std::sqrt(batch.get(this->l2_diff_sq_handle));
+}
+
 std::vector<Real>
 L2Diff::get_value()
 {
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/L2DiffLocal.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Error.h"
+#include "godzilla/Exception.h"
+#include "petscdmplex.h"
+#include "petscds.h"
+#include "petscfe.h"
+
+namespace godzilla {
+
+std::vector<Real>
+compute_l2_field_diff_squared_local(DM dm,
+                                    Real time,
+                                    const std::vector<PetscFunc *> & funcs,
+                                    const std::vector<void *> & ctxs,
+                                    const Vector & loc_x)
+{
+    CALL_STACK_MSG();
+    Int dim_embed;
+    PETSC_CHECK(DMGetCoordinateDim(dm, &dim_embed));
+    PetscDS ds;
+    PETSC_CHECK(DMGetDS(dm, &ds));
+    PetscTabulation * T;
+    PETSC_CHECK(PetscDSGetTabulation(ds, &T));
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetSimplexOrBoxCells(dm, 0, &c_start, &c_end));
+
+    // cells that are leaves of the point SF are owned (and integrated) by another rank
+    std::vector<bool> ghost(c_end - c_start, false);
+    PetscSF sf;
+    PETSC_CHECK(DMGetPointSF(dm, &sf));
+    Int n_leaves;
+    const Int * leaves;
+    PETSC_CHECK(PetscSFGetGraph(sf, nullptr, &n_leaves, &leaves, nullptr));
+    for (Int i = 0; i < n_leaves; ++i) {
+        auto p = leaves ? leaves[i] : i;
+        if (p >= c_start && p < c_end)
+            ghost[p - c_start] = true;
+    }
+
+    std::vector<Real> diff(funcs.size(), 0.);
+    std::vector<Real> v, jac, inv_jac, det_jac;
+    std::vector<Scalar> u;
+    for (std::size_t f = 0; f < funcs.size(); ++f) {
+        if (funcs[f] == nullptr)
+            continue;
+
+        PetscObject obj;
+        PETSC_CHECK(PetscDSGetDiscretization(ds, f, &obj));
+        PetscClassId id;
+        PETSC_CHECK(PetscObjectGetClassId(obj, &id));
+        if (id != PETSCFE_CLASSID)
+            throw Exception(fmt::format("Field {} is not discretized with finite elements", f));
+        auto fe = reinterpret_cast<PetscFE>(obj);
+
+        PetscQuadrature quad;
+        PETSC_CHECK(PetscFEGetQuadrature(fe, &quad));
+        Int q_n_comp, q_n_pts;
+        const Real * q_weights;
+        PETSC_CHECK(
+            PetscQuadratureGetData(quad, nullptr, &q_n_comp, &q_n_pts, nullptr, &q_weights));
+        Int offset;
+        PETSC_CHECK(PetscDSGetFieldOffset(ds, f, &offset));
+        auto n_basis = T[f]->Nb;
+        auto n_comp = T[f]->Nc;
+        auto * basis = T[f]->T[0];
+
+        v.resize(q_n_pts * dim_embed);
+        jac.resize(q_n_pts * dim_embed * dim_embed);
+        inv_jac.resize(q_n_pts * dim_embed * dim_embed);
+        det_jac.resize(q_n_pts);
+        u.resize(n_comp);
+        for (Int c = c_start; c < c_end; ++c) {
+            if (ghost[c - c_start])
+                continue;
+            PETSC_CHECK(DMPlexComputeCellGeometryFEM(dm,
+                                                     c,
+                                                     quad,
+                                                     v.data(),
+                                                     jac.data(),
+                                                     inv_jac.data(),
+                                                     det_jac.data()));
+            Scalar * x = nullptr;
+            PETSC_CHECK(DMPlexVecGetClosure(dm, nullptr, loc_x, c, nullptr, &x));
+            for (Int q = 0; q < q_n_pts; ++q) {
+                PETSC_CHECK(
+                    funcs[f](dim_embed, time, &v[q * dim_embed], n_comp, u.data(), ctxs[f]));
+                for (Int i = 0; i < n_comp; ++i) {
+                    Scalar u_h = 0.;
+                    for (Int b = 0; b < n_basis; ++b)
+                        u_h += x[offset + b] * basis[(q * n_basis + b) * n_comp + i];
+                    auto d = PetscRealPart(u_h - u[i]);
+                    auto w = q_weights[q * q_n_comp + (q_n_comp == 1 ? 0 : i)];
+                    diff[f] += d * d * w * det_jac[q];
+                }
+            }
+            PETSC_CHECK(DMPlexVecRestoreClosure(dm, nullptr, loc_x, c, nullptr, &x));
+        }
+    }
+    return diff;
+}
+
+} // namespace godzilla
@@ -6,6 +6,8 @@
 #include "godzilla/Problem.h"
 #include "godzilla/FEProblemInterface.h"
 #include "godzilla/Types.h"
+#include "godzilla/ReductionBatch.h"
+#include "godzilla/L2DiffLocal.h"
 
 namespace godzilla {
 
@@ -32,18 +34,19 @@ L2FieldDiff::create()
     auto fpi = this->fepi.value();
     this->n_fields = fpi->get_num_fields();
     this->l2_diff.resize(this->n_fields, 0.);
+    this->l2_diff_sq_handles.resize(this->n_fields, 0);
     set_up_callbacks();
 }
 
 void
-L2FieldDiff::compute()
+L2FieldDiff::get_functions(std::vector<PetscFunc *> & funcs, std::vector<void *> & contexts)
 {
     CALL_STACK_MSG();
     GODZILLA_ASSERT_TRUE(this->n_fields > 0, "No fields to evaluate");
     GODZILLA_ASSERT_TRUE(this->delegates.size() > 0, "No evaluation function(s) set");
 
-    std::vector<PetscFunc *> funcs(this->n_fields, nullptr);
-    std::vector<void *> contexts(this->n_fields, nullptr);
+    funcs.assign(this->n_fields, nullptr);
+    contexts.assign(this->n_fields, nullptr);
     for (auto & [fid, d] : this->delegates) {
         if (d) {
             GODZILLA_ASSERT_TRUE(
@@ -53,6 +56,15 @@ L2FieldDiff::compute()
             funcs[fid] = internal::invoke_function_delegate;
         }
     }
+}
+
+void
+L2FieldDiff::compute()
+{
+    CALL_STACK_MSG();
+    std::vector<PetscFunc *> funcs;
+    std::vector<void *> contexts;
+    get_functions(funcs, contexts);
     auto problem = get_problem();
     PETSC_CHECK(DMComputeL2FieldDiff(problem->get_dm(),
                                      problem->get_time(),
@@ -62,6 +74,35 @@ L2FieldDiff::compute()
                                      this->l2_diff.data()));
 }
 
+bool
+L2FieldDiff::compute_local(ReductionBatch & batch)
+{
+    CALL_STACK_MSG();
+    std::vector<PetscFunc *> funcs;
+    std::vector<void *> contexts;
+    get_functions(funcs, contexts);
+    auto problem = get_problem();
+    auto dpi = try_dynamic_ref_cast<DiscreteProblemInterface>(problem);
+    GODZILLA_ASSERT_TRUE(dpi.has_value(), "Discrete problem is null");
+    dpi.value()->compute_solution_vector_local();
+    auto diff = compute_l2_field_diff_squared_local(problem->get_dm(),
+                                                    problem->get_time(),
+                                                    funcs,
+                                                    contexts,
+                                                    dpi.value()->get_solution_vector_local());
+    for (Int i = 0; i < this->n_fields; ++i)
+        this->l2_diff_sq_handles[i] = batch.add_sum(diff[i]);
+    return true;
+}
+
+void
+L2FieldDiff::finish_compute(const ReductionBatch & batch)
+{
+    CALL_STACK_MSG();
+    for (Int i = 0; i < this->n_fields; ++i)
+        this->l2_diff[i] = std::sqrt(batch.get(this->l2_diff_sq_handles[i]));
+}
+
 std::vector<Real>
 L2FieldDiff::get_value()
 {
@@ -213,7 +213,7 @@ LinearProblem::write_restart_file(RestartFile & file) const
 {
     CALL_STACK_MSG();
     const auto & sln = get_solution_vector();
-    file.write_global_vector(get_name(), "/", "sln", sln);
+    file.write_natural_vector(get_name(), "/", "sln", get_dm(), sln);
 }
 
 void
@@ -221,7 +221,7 @@ LinearProblem::read_restart_file(const RestartFile & file)
 {
     CALL_STACK_MSG();
     auto & sln = get_solution_vector();
-    file.read_global_vector(get_name(), "/", "sln", sln);
+    file.read_natural_vector(get_name(), "/", "sln", get_dm(), sln);
 }
 
 void
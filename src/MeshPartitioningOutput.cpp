@@ -14,10 +14,13 @@ Parameters
 MeshPartitioningOutput::parameters()
 {
     auto params = FileOutput::parameters();
+    params.add_param<bool>("collective_io", false, "Use collective MPI-IO to write the file");
     return params;
 }
 
-MeshPartitioningOutput::MeshPartitioningOutput(const Parameters & pars) : FileOutput(pars)
+MeshPartitioningOutput::MeshPartitioningOutput(const Parameters & pars) :
+    FileOutput(pars),
+    collective_io(pars.get<bool>("collective_io"))
 {
     CALL_STACK_MSG();
     set_file_base("part");
@@ -36,6 +39,8 @@ MeshPartitioningOutput::output_step()
     CALL_STACK_MSG();
     PetscViewer viewer;
     PETSC_CHECK(PetscViewerHDF5Open(get_comm(), get_file_name().c_str(), FILE_MODE_WRITE, &viewer));
+    if (this->collective_io)
+        PETSC_CHECK(PetscViewerHDF5SetCollective(viewer, PETSC_TRUE));
 
     GODZILLA_ASSERT_TRUE(get_problem()->get_dm() != nullptr, "DM is null");
     DM dmp = clone(get_problem()->get_dm());
@@ -368,7 +368,7 @@ NonlinearProblem::write_restart_file(RestartFile & file) const
 {
     CALL_STACK_MSG();
     const auto & sln = get_solution_vector();
-    file.write_global_vector(get_name(), "/", "sln", sln);
+    file.write_natural_vector(get_name(), "/", "sln", get_dm(), sln);
 }
 
 void
@@ -376,7 +376,7 @@ NonlinearProblem::read_restart_file(const RestartFile & file)
 {
     CALL_STACK_MSG();
     auto & sln = get_solution_vector();
-    file.read_global_vector(get_name(), "/", "sln", sln);
+    file.read_natural_vector(get_name(), "/", "sln", get_dm(), sln);
 }
 
 } // namespace godzilla
@@ -0,0 +1,475 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/ParallelExodusIIFile.h"
+#include "godzilla/UnstructuredMesh.h"
+#include "godzilla/IO.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Exception.h"
+#include "exodusII.h"
+#include "petscdmplex.h"
+#include <algorithm>
+#include <tuple>
+
+namespace godzilla {
+
+namespace {
+
+void
+exodus_check(int ierr, const char * what)
+{
+    if (ierr < 0)
+        throw Exception(fmt::format("exodusII: failed to {}", what));
+}
+
+/// Build array of C strings for the ExodusII API
+std::vector<char *>
+to_c_strings(const std::vector<std::string> & strs)
+{
+    std::vector<char *> c_strs(strs.size());
+    for (std::size_t i = 0; i < strs.size(); ++i)
+        c_strs[i] = const_cast<char *>(strs[i].c_str());
+    return c_strs;
+}
+
+/// Convert entry of a DMPlex numbering into a global (0-based) index
+inline Int
+global_index(Int num)
+{
+    return num >= 0 ? num : -(num + 1);
+}
+
+} // namespace
+
+ParallelExodusIIFile::ParallelExodusIIFile(mpi::Communicator comm, const fs::path & file_name) :
+    comm(comm),
+    exoid(-1),
+    vertex_start(0),
+    n_global_vertices(0)
+{
+    CALL_STACK_MSG();
+    int cpu_ws = sizeof(Real);
+    int io_ws = sizeof(Real);
+    int mode = EX_CLOBBER | EX_NETCDF4;
+#if defined(GODZILLA_HAVE_PARALLEL_EXODUSII)
+    this->exoid = ex_create_par(file_name.c_str(), mode, &cpu_ws, &io_ws, comm, MPI_INFO_NULL);
+#else
+    expect_true(comm.size() == 1,
+                "Writing a single ExodusII file from multiple ranks requires ExodusII built with "
+                "parallel I/O support.");
+    this->exoid = ex_create(file_name.c_str(), mode, &cpu_ws, &io_ws);
+#endif
+    if (this->exoid < 0)
+        throw Exception(fmt::format("Could not open file '{}' for writing.", file_name.string()));
+}
+
+ParallelExodusIIFile::~ParallelExodusIIFile()
+{
+    CALL_STACK_MSG();
+    close();
+}
+
+void
+ParallelExodusIIFile::close()
+{
+    CALL_STACK_MSG();
+    if (this->exoid >= 0) {
+        ex_close(this->exoid);
+        this->exoid = -1;
+    }
+}
+
+void
+ParallelExodusIIFile::update()
+{
+    CALL_STACK_MSG();
+    exodus_check(ex_update(this->exoid), "update file");
+}
+
+const std::vector<Int> &
+ParallelExodusIIFile::get_owned_vertices() const
+{
+    CALL_STACK_MSG();
+    return this->owned_vertices;
+}
+
+const std::vector<ParallelExodusIIFile::Block> &
+ParallelExodusIIFile::get_blocks() const
+{
+    CALL_STACK_MSG();
+    return this->blocks;
+}
+
+std::pair<Int, Int>
+ParallelExodusIIFile::exscan(Int n) const
+{
+    CALL_STACK_MSG();
+    Int offset = 0;
+    MPI_Exscan(&n, &offset, 1, MPIU_INT, MPI_SUM, this->comm);
+    if (this->comm.rank() == 0)
+        offset = 0;
+    Int total;
+    this->comm.all_reduce(n, total, mpi::op::sum<Int>());
+    return { offset, total };
+}
+
+void
+ParallelExodusIIFile::write_mesh(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    build_numbering(mesh);
+    write_init(mesh);
+    write_coords(mesh);
+    write_elements(mesh);
+    write_node_sets(mesh);
+    write_face_sets(mesh);
+}
+
+void
+ParallelExodusIIFile::build_numbering(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    // vertices
+    auto vtx_range = mesh.get_vertex_range();
+    auto vtx_numbering = mesh.get_vertex_numbering();
+    auto vtx_nums = vtx_numbering.borrow_indices();
+    this->owned_vertices.clear();
+    this->exo_vertex_ids.resize(vtx_range.size());
+    for (auto v : vtx_range) {
+        auto num = vtx_nums[v - vtx_range.first()];
+        if (num >= 0)
+            this->owned_vertices.push_back(v);
+        this->exo_vertex_ids[v - vtx_range.first()] = global_index(num) + 1;
+    }
+    std::tie(this->vertex_start, this->n_global_vertices) =
+        exscan((Int) this->owned_vertices.size());
+
+    // cells
+    auto cell_numbering = mesh.get_cell_numbering();
+    auto cell_nums = cell_numbering.borrow_indices();
+    Int n_cells = cell_nums.size();
+    std::vector<int> blk_ids;
+    auto & cell_sets = mesh.get_cell_sets();
+    if (cell_sets.size() > 1)
+        for (auto & [id, name] : cell_sets)
+            blk_ids.push_back((int) id);
+    else
+        blk_ids.push_back(io::SINGLE_BLK_ID);
+    Label cell_sets_label;
+    if (cell_sets.size() > 1)
+        cell_sets_label = mesh.get_label("Cell Sets");
+
+    this->blocks.assign(blk_ids.size(), Block());
+    std::vector<int> local_types(blk_ids.size(), -1);
+    for (std::size_t b = 0; b < blk_ids.size(); ++b)
+        this->blocks[b].id = blk_ids[b];
+    for (Int cell = 0; cell < n_cells; ++cell) {
+        if (cell_nums[cell] < 0)
+            continue;
+        std::size_t b = 0;
+        if (cell_sets_label) {
+            auto id = cell_sets_label.get_value(cell);
+            b = std::lower_bound(blk_ids.begin(), blk_ids.end(), (int) id) - blk_ids.begin();
+        }
+        this->blocks[b].cells.push_back(cell);
+        local_types[b] = (int) mesh.get_cell_type(cell);
+    }
+
+    this->n_global_block_cells.resize(blk_ids.size());
+    this->block_cell_types.resize(blk_ids.size());
+    this->exo_elem_ids.assign(n_cells, 0);
+    Int blk_offset = 0;
+    for (std::size_t b = 0; b < blk_ids.size(); ++b) {
+        auto & blk = this->blocks[b];
+        auto [start, total] = exscan((Int) blk.cells.size());
+        blk.start = start;
+        this->n_global_block_cells[b] = total;
+        int type;
+        this->comm.all_reduce(local_types[b], type, mpi::op::max<int>());
+        this->block_cell_types[b] = (PolytopeType) type;
+        for (std::size_t i = 0; i < blk.cells.size(); ++i)
+            this->exo_elem_ids[blk.cells[i]] = blk_offset + start + (Int) i + 1;
+        blk_offset += total;
+    }
+}
+
+void
+ParallelExodusIIFile::write_init(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    ex_init_params par = {};
+    par.num_dim = mesh.get_dimension();
+    par.num_nodes = this->n_global_vertices;
+    for (auto n : this->n_global_block_cells)
+        par.num_elem += n;
+    par.num_elem_blk = (int64_t) this->blocks.size();
+    par.num_node_sets = (int64_t) mesh.get_vertex_sets().size();
+    par.num_side_sets = (int64_t) mesh.get_face_sets().size();
+    exodus_check(ex_put_init_ext(this->exoid, &par), "write initialization parameters");
+}
+
+void
+ParallelExodusIIFile::write_coords(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    int dim = mesh.get_dimension();
+    auto v_start = mesh.get_vertex_range().first();
+    auto coord = mesh.get_coordinates_local();
+    auto xyz = coord.borrow_array_read();
+
+    auto n_owned = this->owned_vertices.size();
+    std::vector<double> x[3];
+    for (int d = 0; d < dim; ++d) {
+        x[d].resize(n_owned);
+        for (std::size_t i = 0; i < n_owned; ++i)
+            x[d][i] = xyz[(this->owned_vertices[i] - v_start) * dim + d];
+    }
+    exodus_check(ex_put_partial_coord(this->exoid,
+                                      this->vertex_start + 1,
+                                      (int64_t) n_owned,
+                                      x[0].data(),
+                                      dim > 1 ? x[1].data() : nullptr,
+                                      dim > 2 ? x[2].data() : nullptr),
+                 "write coordinates");
+
+    std::vector<std::string> coord_names = { "x", "y", "z" };
+    coord_names.resize(dim);
+    auto c_names = to_c_strings(coord_names);
+    exodus_check(ex_put_coord_names(this->exoid, c_names.data()), "write coordinate names");
+}
+
+void
+ParallelExodusIIFile::write_elements(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    auto dm = mesh.get_dm();
+    auto v_start = mesh.get_vertex_range().first();
+    for (std::size_t b = 0; b < this->blocks.size(); ++b) {
+        auto & blk = this->blocks[b];
+        auto polytope_type = this->block_cell_types[b];
+        int n_nodes_per_elem = UnstructuredMesh::get_num_cell_nodes(polytope_type);
+        exodus_check(ex_put_block(this->exoid,
+                                  EX_ELEM_BLOCK,
+                                  blk.id,
+                                  io::get_elem_type(polytope_type),
+                                  this->n_global_block_cells[b],
+                                  n_nodes_per_elem,
+                                  0,
+                                  0,
+                                  0),
+                     "write element block");
+
+        auto ordering = io::get_elem_node_ordering(polytope_type);
+        std::vector<int> connect(blk.cells.size() * n_nodes_per_elem);
+        for (std::size_t i = 0, j = 0; i < blk.cells.size(); ++i) {
+            Int closure_size;
+            Int * closure = nullptr;
+            PETSC_CHECK(
+                DMPlexGetTransitiveClosure(dm, blk.cells[i], PETSC_TRUE, &closure_size, &closure));
+            for (Int k = 0; k < n_nodes_per_elem; ++k, ++j) {
+                Int l = 2 * (closure_size - n_nodes_per_elem + ordering[k]);
+                connect[j] = (int) this->exo_vertex_ids[closure[l] - v_start];
+            }
+            PETSC_CHECK(DMPlexRestoreTransitiveClosure(dm,
+                                                       blk.cells[i],
+                                                       PETSC_TRUE,
+                                                       &closure_size,
+                                                       &closure));
+        }
+        exodus_check(ex_put_partial_conn(this->exoid,
+                                         EX_ELEM_BLOCK,
+                                         blk.id,
+                                         blk.start + 1,
+                                         (int64_t) blk.cells.size(),
+                                         connect.data(),
+                                         nullptr,
+                                         nullptr),
+                     "write connectivity");
+    }
+
+    if (this->blocks.size() > 1) {
+        std::vector<std::string> names;
+        for (auto & blk : this->blocks)
+            names.push_back(mesh.get_cell_set_name(blk.id).value());
+        auto c_names = to_c_strings(names);
+        exodus_check(ex_put_names(this->exoid, EX_ELEM_BLOCK, c_names.data()),
+                     "write block names");
+    }
+}
+
+void
+ParallelExodusIIFile::write_node_sets(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    auto & vertex_sets = mesh.get_vertex_sets();
+    if (vertex_sets.empty())
+        return;
+
+    auto v_start = mesh.get_vertex_range().first();
+    auto vertex_sets_label = mesh.get_label("Vertex Sets");
+    std::vector<std::string> names;
+    for (auto & [id, name] : vertex_sets) {
+        auto stratum = vertex_sets_label.get_stratum(id);
+        auto vertices = stratum.borrow_indices();
+        std::vector<int> node_set;
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            auto v = vertices[i];
+            if (std::binary_search(this->owned_vertices.begin(), this->owned_vertices.end(), v))
+                node_set.push_back((int) this->exo_vertex_ids[v - v_start]);
+        }
+        auto [start, total] = exscan((Int) node_set.size());
+        exodus_check(ex_put_set_param(this->exoid, EX_NODE_SET, id, total, 0),
+                     "write node set parameters");
+        exodus_check(ex_put_partial_set(this->exoid,
+                                        EX_NODE_SET,
+                                        id,
+                                        start + 1,
+                                        (int64_t) node_set.size(),
+                                        node_set.data(),
+                                        nullptr),
+                     "write node set");
+        names.push_back(name);
+    }
+    auto c_names = to_c_strings(names);
+    exodus_check(ex_put_names(this->exoid, EX_NODE_SET, c_names.data()), "write node set names");
+}
+
+void
+ParallelExodusIIFile::write_face_sets(const UnstructuredMesh & mesh)
+{
+    CALL_STACK_MSG();
+    auto & face_sets = mesh.get_face_sets();
+    if (face_sets.empty())
+        return;
+
+    auto dm = mesh.get_dm();
+    auto face_sets_label = mesh.get_label("Face Sets");
+    std::vector<std::string> names;
+    for (auto & [id, name] : face_sets) {
+        auto stratum = face_sets_label.get_stratum(id);
+        auto faces = stratum.borrow_indices();
+        std::vector<int> elem_list;
+        std::vector<int> side_list;
+        for (std::size_t i = 0; i < faces.size(); ++i) {
+            auto support = mesh.get_support(faces[i]);
+            if (support.size() == 0)
+                continue;
+            Int el = support[0];
+            // sides are written by the rank that owns the element
+            if (el >= (Int) this->exo_elem_ids.size() || this->exo_elem_ids[el] == 0)
+                continue;
+
+            auto side_ordering = io::get_elem_side_ordering(mesh.get_cell_type(el));
+            Int num_points;
+            Int * points = nullptr;
+            PETSC_CHECK(DMPlexGetTransitiveClosure(dm, el, PETSC_TRUE, &num_points, &points));
+            for (Int j = 1; j < num_points; ++j) {
+                if (points[j * 2] == faces[i]) {
+                    elem_list.push_back((int) this->exo_elem_ids[el]);
+                    side_list.push_back((int) side_ordering[j - 1]);
+                    break;
+                }
+            }
+            PETSC_CHECK(DMPlexRestoreTransitiveClosure(dm, el, PETSC_TRUE, &num_points, &points));
+        }
+        auto [start, total] = exscan((Int) elem_list.size());
+        exodus_check(ex_put_set_param(this->exoid, EX_SIDE_SET, id, total, 0),
+                     "write side set parameters");
+        exodus_check(ex_put_partial_set(this->exoid,
+                                        EX_SIDE_SET,
+                                        id,
+                                        start + 1,
+                                        (int64_t) elem_list.size(),
+                                        elem_list.data(),
+                                        side_list.data()),
+                     "write side set");
+        names.push_back(name);
+    }
+    auto c_names = to_c_strings(names);
+    exodus_check(ex_put_names(this->exoid, EX_SIDE_SET, c_names.data()), "write side set names");
+}
+
+void
+ParallelExodusIIFile::write_info(const std::vector<std::string> & info)
+{
+    CALL_STACK_MSG();
+    auto c_info = to_c_strings(info);
+    exodus_check(ex_put_info(this->exoid, (int) c_info.size(), c_info.data()), "write info");
+}
+
+void
+ParallelExodusIIFile::write_var_names(const std::vector<std::string> & nodal_var_names,
+                                      const std::vector<std::string> & elem_var_names,
+                                      const std::vector<std::string> & global_var_names)
+{
+    CALL_STACK_MSG();
+    std::pair<ex_entity_type, const std::vector<std::string> *> vars[] = {
+        { EX_NODAL, &nodal_var_names },
+        { EX_ELEM_BLOCK, &elem_var_names },
+        { EX_GLOBAL, &global_var_names }
+    };
+    for (auto & [type, names] : vars) {
+        if (names->empty())
+            continue;
+        auto n = (int) names->size();
+        exodus_check(ex_put_variable_param(this->exoid, type, n), "write variable parameters");
+        auto c_names = to_c_strings(*names);
+        exodus_check(ex_put_variable_names(this->exoid, type, n, c_names.data()),
+                     "write variable names");
+    }
+}
+
+void
+ParallelExodusIIFile::write_time(int step_num, Real time)
+{
+    CALL_STACK_MSG();
+    exodus_check(ex_put_time(this->exoid, step_num, &time), "write time");
+}
+
+void
+ParallelExodusIIFile::write_nodal_var(int step_num,
+                                      int var_idx,
+                                      const std::vector<double> & values)
+{
+    CALL_STACK_MSG();
+    exodus_check(ex_put_partial_var(this->exoid,
+                                    step_num,
+                                    EX_NODAL,
+                                    var_idx,
+                                    1,
+                                    this->vertex_start + 1,
+                                    (int64_t) this->owned_vertices.size(),
+                                    values.data()),
+                 "write nodal variable");
+}
+
+void
+ParallelExodusIIFile::write_elem_var(int step_num,
+                                     int var_idx,
+                                     const Block & blk,
+                                     const std::vector<double> & values)
+{
+    CALL_STACK_MSG();
+    exodus_check(ex_put_partial_var(this->exoid,
+                                    step_num,
+                                    EX_ELEM_BLOCK,
+                                    var_idx,
+                                    blk.id,
+                                    blk.start + 1,
+                                    (int64_t) blk.cells.size(),
+                                    values.data()),
+                 "write elemental variable");
+}
+
+void
+ParallelExodusIIFile::write_global_vars(int step_num, const std::vector<double> & values)
+{
+    CALL_STACK_MSG();
+    if (values.empty())
+        return;
+    exodus_check(
+        ex_put_var(this->exoid, step_num, EX_GLOBAL, 1, 0, (int64_t) values.size(), values.data()),
+        "write global variables");
+}
+
+} // namespace godzilla
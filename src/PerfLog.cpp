@@ -21,10 +21,50 @@ std::vector<EventID> my_event_ids;
 const Int INVALID_EVENT_ID = -1;
 const Int INVALID_STAGE_ID = -1;
 
+namespace event {
+
+EventID compute_residual = INVALID_EVENT_ID;
+EventID compute_jacobian = INVALID_EVENT_ID;
+EventID compute_bnd_residual = INVALID_EVENT_ID;
+EventID compute_bnd_jacobian = INVALID_EVENT_ID;
+EventID integrate_residual = INVALID_EVENT_ID;
+EventID integrate_jacobian = INVALID_EVENT_ID;
+EventID geometry_cache_hit = INVALID_EVENT_ID;
+EventID geometry_cache_miss = INVALID_EVENT_ID;
+EventID global_to_local = INVALID_EVENT_ID;
+EventID compute_postprocessors = INVALID_EVENT_ID;
+EventID output = INVALID_EVENT_ID;
+
+} // namespace event
+
+namespace {
+
+EventID
+get_or_register_event(const char * name)
+{
+    return is_event_registered(name) ? get_event_id(name) : register_event(name);
+}
+
+} // namespace
+
 void
 init()
 {
     PetscLogDefaultBegin();
+
+    event::compute_residual = get_or_register_event("FENonlinearProblem::compute_residual");
+    event::compute_jacobian = get_or_register_event("FENonlinearProblem::compute_jacobian");
+    event::compute_bnd_residual =
+        get_or_register_event("FENonlinearProblem::compute_bnd_residual");
+    event::compute_bnd_jacobian =
+        get_or_register_event("FENonlinearProblem::compute_bnd_jacobian");
+    event::integrate_residual = get_or_register_event("FEProblemInterface::integrate_residual");
+    event::integrate_jacobian = get_or_register_event("FEProblemInterface::integrate_jacobian");
+    event::geometry_cache_hit = get_or_register_event("FEProblemInterface::GeometryCacheHit");
+    event::geometry_cache_miss = get_or_register_event("FEProblemInterface::GeometryCacheMiss");
+    event::global_to_local = get_or_register_event("Problem::global_to_local");
+    event::compute_postprocessors = get_or_register_event("Problem::compute_postprocessors");
+    event::output = get_or_register_event("Problem::output");
 }
 
 bool
@@ -276,6 +316,11 @@ ScopedEvent::ScopedEvent(String name) : Event(name)
     begin();
 }
 
+ScopedEvent::ScopedEvent(EventID id) : Event(id)
+{
+    begin();
+}
+
 ScopedEvent::~ScopedEvent()
 {
     end();
@@ -50,6 +50,19 @@ Postprocessor::get_problem() const
     return this->problem;
 }
 
+bool
+Postprocessor::compute_local(ReductionBatch &)
+{
+    CALL_STACK_MSG();
+    return false;
+}
+
+void
+Postprocessor::finish_compute(const ReductionBatch &)
+{
+    CALL_STACK_MSG();
+}
+
 bool
 Postprocessor::should_execute(ExecuteOn flag)
 {
@@ -11,6 +11,8 @@
 #include "godzilla/Section.h"
 #include "godzilla/Types.h"
 #include "godzilla/Assert.h"
+#include "godzilla/PerfLog.h"
+#include "godzilla/ReductionBatch.h"
 
 namespace godzilla {
 
@@ -27,6 +29,15 @@ Problem::parameters()
 {
     auto params = Object::parameters();
     params.add_param<LateRef<Mesh>>("mesh", "Mesh to be used");
+    params.add_param<bool>("async_output",
+                           false,
+                           "Write output files on a background thread while the solve continues");
+    params.add_param<Int>("output_queue_depth",
+                          2,
+                          "Maximum number of output steps waiting to be written asynchronously");
+    params.add_param<bool>("batch_postprocessor_reductions",
+                           false,
+                           "Reduce values of all postprocessors with a single collective call");
     return params;
 }
 
@@ -36,10 +47,16 @@ Problem::Problem(const Parameters & pars) :
     mesh(pars.is_param_valid("mesh") ? pars.get<Ref<Mesh>>("mesh")
                                      : Optional<Ref<Mesh>>(std::nullopt)),
     partitioner(nullptr),
-    partition_overlap(0)
+    partition_overlap(0),
+    batch_pps(pars.get<bool>("batch_postprocessor_reductions"))
 {
     set_output_monitor(ref(*this), &Problem::output_monitor);
     this->partitioner.create(get_comm());
+    if (pars.get<bool>("async_output")) {
+        auto depth = pars.get<Int>("output_queue_depth");
+        expect_true(depth > 0, "Parameter 'output_queue_depth' must be positive.");
+        this->output_queue = Qtr<AsyncOutputQueue>::alloc(depth);
+    }
 }
 
 DM
@@ -129,18 +146,47 @@ void
 Problem::compute_postprocessors()
 {
     CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::compute_postprocessors);
+    std::vector<Postprocessor *> pps;
+    pps.reserve(this->pps.size());
     for (auto & [_, pp] : this->pps)
-        pp->compute();
+        pps.push_back(pp.get());
+    compute_postprocessors(pps);
 }
 
 void
 Problem::compute_postprocessors(ExecuteOn flag)
 {
     CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::compute_postprocessors);
+    std::vector<Postprocessor *> pps;
     for (auto & [_, pp] : this->pps)
-        if (pp->should_execute(flag)) {
-            pp->compute();
+        if (pp->should_execute(flag))
+            pps.push_back(pp.get());
+    compute_postprocessors(pps);
+}
+
+void
+Problem::compute_postprocessors(const std::vector<Postprocessor *> & pps)
+{
+    CALL_STACK_MSG();
+    if (this->batch_pps) {
+        ReductionBatch batch(get_comm());
+        std::vector<Postprocessor *> batched;
+        for (auto & pp : pps) {
+            if (pp->compute_local(batch))
+                batched.push_back(pp);
+            else
+                pp->compute();
         }
+        batch.reduce();
+        for (auto & pp : batched)
+            pp->finish_compute(batch);
+    }
+    else {
+        for (auto & pp : pps)
+            pp->compute();
+    }
 }
 
 Expected<Ref<Postprocessor>, ErrorCode>
@@ -165,12 +211,48 @@ void
 Problem::output(ExecuteOn flag)
 {
     CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::output);
     for (auto & out : this->file_outputs)
         if (out->should_output(flag)) {
             if (this->output_monitor_delegate)
                 this->output_monitor_delegate(out->get_file_name().string());
             output_with(*out);
         }
+    if (flag == ExecuteOn::FINAL)
+        flush_output();
+}
+
+void
+Problem::flush_output()
+{
+    CALL_STACK_MSG();
+    if (this->output_queue)
+        this->output_queue->flush();
+}
+
+bool
+Problem::is_output_async() const
+{
+    CALL_STACK_MSG();
+    return this->output_queue != nullptr;
+}
+
+void
+Problem::write_output(FileOutput & out)
+{
+    CALL_STACK_MSG();
+    if (this->output_queue) {
+        // ExodusII/HDF5 are not thread-safe, so nothing may call into them while the I/O thread is
+        // busy
+        if (!out.is_snapshot_thread_safe())
+            this->output_queue->flush();
+        if (auto task = out.create_output_task()) {
+            this->output_queue->push(std::move(task));
+            return;
+        }
+        this->output_queue->flush();
+    }
+    out.output_step();
 }
 
 void
@@ -455,7 +537,7 @@ void
 Problem::output_with(FileOutput & out)
 {
     CALL_STACK_MSG();
-    out.output_step();
+    write_output(out);
 }
 
 void
@@ -479,9 +561,38 @@ void
 Problem::global_to_local(const Vector & g, InsertMode mode, Vector & l) const
 {
     CALL_STACK_MSG();
+    perf_log::ScopedEvent event(perf_log::event::global_to_local);
     godzilla::global_to_local(get_dm(), g, mode, l);
 }
 
+void
+Problem::local_to_global_begin(const Vector & l, InsertMode mode, Vector & g) const
+{
+    CALL_STACK_MSG();
+    PETSC_CHECK(DMLocalToGlobalBegin(get_dm(), l, mode, g));
+}
+
+void
+Problem::local_to_global_end(const Vector & l, InsertMode mode, Vector & g) const
+{
+    CALL_STACK_MSG();
+    PETSC_CHECK(DMLocalToGlobalEnd(get_dm(), l, mode, g));
+}
+
+void
+Problem::global_to_local_begin(const Vector & g, InsertMode mode, Vector & l) const
+{
+    CALL_STACK_MSG();
+    PETSC_CHECK(DMGlobalToLocalBegin(get_dm(), g, mode, l));
+}
+
+void
+Problem::global_to_local_end(const Vector & g, InsertMode mode, Vector & l) const
+{
+    CALL_STACK_MSG();
+    PETSC_CHECK(DMGlobalToLocalEnd(get_dm(), g, mode, l));
+}
+
 void
 Problem::set_matrix_structure_only(bool only)
 {
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/ReductionBatch.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Assert.h"
+
+namespace godzilla {
+
+ReductionBatch::ReductionBatch(mpi::Communicator comm) : comm(comm) {}
+
+ReductionBatch::Handle
+ReductionBatch::add_sum(double val)
+{
+    CALL_STACK_MSG();
+    this->entries.push_back({ SUM, this->sums.size(), 1. });
+    this->sums.push_back(val);
+    return this->entries.size() - 1;
+}
+
+ReductionBatch::Handle
+ReductionBatch::add_min(double val)
+{
+    CALL_STACK_MSG();
+    this->entries.push_back({ MIN_MAX, this->min_max.size(), 1. });
+    this->min_max.push_back(val);
+    return this->entries.size() - 1;
+}
+
+ReductionBatch::Handle
+ReductionBatch::add_max(double val)
+{
+    CALL_STACK_MSG();
+    this->entries.push_back({ MIN_MAX, this->min_max.size(), -1. });
+    this->min_max.push_back(-val);
+    return this->entries.size() - 1;
+}
+
+std::size_t
+ReductionBatch::size() const
+{
+    CALL_STACK_MSG();
+    return this->entries.size();
+}
+
+void
+ReductionBatch::reduce()
+{
+    CALL_STACK_MSG();
+    if (!this->sums.empty())
+        MPI_Allreduce(MPI_IN_PLACE,
+                      this->sums.data(),
+                      (int) this->sums.size(),
+                      MPI_DOUBLE,
+                      MPI_SUM,
+                      this->comm);
+    if (!this->min_max.empty())
+        MPI_Allreduce(MPI_IN_PLACE,
+                      this->min_max.data(),
+                      (int) this->min_max.size(),
+                      MPI_DOUBLE,
+                      MPI_MIN,
+                      this->comm);
+}
+
+double
+ReductionBatch::get(Handle h) const
+{
+    CALL_STACK_MSG();
+    GODZILLA_ASSERT_TRUE(h < this->entries.size(), "Invalid reduction handle");
+    auto & e = this->entries[h];
+    if (e.op == SUM)
+        return this->sums[e.idx];
+    else
+        return e.sign * this->min_max[e.idx];
+}
+
+void
+ReductionBatch::clear()
+{
+    CALL_STACK_MSG();
+    this->sums.clear();
+    this->min_max.clear();
+    this->entries.clear();
+}
+
+} // namespace godzilla
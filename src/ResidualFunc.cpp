@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: MIT
 
 #include "godzilla/ResidualFunc.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Exception.h"
 
 namespace godzilla {
 
@@ -9,4 +11,17 @@ ResidualFunc::ResidualFunc(Ref<FEProblemInterface> fepi, String region) : Functi
 {
 }
 
+bool
+ResidualFunc::is_batched() const
+{
+    return false;
+}
+
+void
+ResidualFunc::evaluate_batch(const QuadratureBatch &, Scalar[]) const
+{
+    CALL_STACK_MSG();
+    throw Exception("Batched evaluation is not implemented for this residual functional");
+}
+
 } // namespace godzilla
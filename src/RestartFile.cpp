@@ -4,20 +4,75 @@
 #include "godzilla/RestartFile.h"
 #include "godzilla/Enums.h"
 #include "godzilla/Vector.h"
+#include "godzilla/Error.h"
+#include "godzilla/Exception.h"
 #include "fmt/format.h"
+#include "petscdmplex.h"
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
 namespace godzilla {
 
+namespace {
+
+/// Get the star forest mapping the global ordering of `dm` into the natural ordering
+///
+/// @return Star forest or `nullptr` if the global ordering is the natural ordering (for example
+///         the mesh was never distributed or `dm` is not a DMPlex)
+/// @throw Exception if `dm` was created distributed and has no map to its natural ordering
+PetscSF
+get_natural_sf(DM dm)
+{
+    PetscBool is_plex;
+    PETSC_CHECK(PetscObjectTypeCompare((PetscObject) dm, DMPLEX, &is_plex));
+    if (!is_plex)
+        return nullptr;
+
+    PetscSF sf_natural;
+    PETSC_CHECK(DMGetNaturalSF(dm, &sf_natural));
+    if (sf_natural == nullptr) {
+        PetscSF sf_migration;
+        PETSC_CHECK(DMPlexGetMigrationSF(dm, &sf_migration));
+        if (sf_migration == nullptr) {
+            PetscBool distributed;
+            PETSC_CHECK(DMPlexIsDistributed(dm, &distributed));
+            if (distributed)
+                throw Exception("Mesh was created distributed, its natural ordering is unknown.");
+            return nullptr;
+        }
+        PetscSection section;
+        PETSC_CHECK(DMGetLocalSection(dm, &section));
+        PETSC_CHECK(DMPlexCreateGlobalToNaturalSF(dm, section, sf_migration, &sf_natural));
+        PETSC_CHECK(DMSetNaturalSF(dm, sf_natural));
+        PETSC_CHECK(PetscSFDestroy(&sf_natural));
+        PETSC_CHECK(DMGetNaturalSF(dm, &sf_natural));
+    }
+    return sf_natural;
+}
+
+} // namespace
+
 RestartFile::RestartFile(mpi::Communicator comm, fs::path file_name, FileAccess faccess) :
     h5f(comm, file_name, faccess)
 {
 }
 
+RestartFile::RestartFile(mpi::Communicator comm,
+                         fs::path file_name,
+                         FileAccess faccess,
+                         const hdf5::FileOptions & opts) :
+    h5f(comm, file_name, faccess, opts)
+{
+}
+
 RestartFile::RestartFile(fs::path file_name, FileAccess faccess) : h5f(file_name, faccess) {}
 
+RestartFile::RestartFile(fs::path file_name, FileAccess faccess, const hdf5::FileOptions & opts) :
+    h5f(file_name, faccess, opts)
+{
+}
+
 fs::path
 RestartFile::file_name() const
 {
@@ -30,6 +85,12 @@ RestartFile::file_path() const
     return this->h5f.get_file_path();
 }
 
+std::vector<char>
+RestartFile::get_file_image() const
+{
+    return this->h5f.get_file_image();
+}
+
 String
 RestartFile::get_full_path(String app_name, String path) const
 {
@@ -89,6 +150,32 @@ RestartFile::write_global_vector(String path, String name, const Vector & data)
     }
 }
 
+void
+RestartFile::write_natural_vector(String app_name,
+                                  String path,
+                                  String name,
+                                  DM dm,
+                                  const Vector & data)
+{
+    write_natural_vector(get_full_path(app_name, path), name, dm, data);
+}
+
+void
+RestartFile::write_natural_vector(String path, String name, DM dm, const Vector & data)
+{
+    if (get_natural_sf(dm) == nullptr) {
+        write_global_vector(path, name, data);
+        return;
+    }
+
+    Vec nat;
+    PETSC_CHECK(DMPlexCreateNaturalVector(dm, &nat));
+    Vector natural(nat);
+    PETSC_CHECK(DMPlexGlobalToNaturalBegin(dm, data, natural));
+    PETSC_CHECK(DMPlexGlobalToNaturalEnd(dm, data, natural));
+    write_global_vector(path, name, natural);
+}
+
 template <>
 void
 RestartFile::read<Vector>(String path, String name, Vector & data) const
@@ -131,4 +218,30 @@ RestartFile::read_global_vector(String app_name, String path, String name, Vecto
     read_global_vector(get_full_path(app_name, path), name, data);
 }
 
+void
+RestartFile::read_natural_vector(String path, String name, DM dm, Vector & data) const
+{
+    if (get_natural_sf(dm) == nullptr) {
+        read_global_vector(path, name, data);
+        return;
+    }
+
+    Vec nat;
+    PETSC_CHECK(DMPlexCreateNaturalVector(dm, &nat));
+    Vector natural(nat);
+    read_global_vector(path, name, natural);
+    PETSC_CHECK(DMPlexNaturalToGlobalBegin(dm, natural, data));
+    PETSC_CHECK(DMPlexNaturalToGlobalEnd(dm, natural, data));
+}
+
+void
+RestartFile::read_natural_vector(String app_name,
+                                 String path,
+                                 String name,
+                                 DM dm,
+                                 Vector & data) const
+{
+    read_natural_vector(get_full_path(app_name, path), name, dm, data);
+}
+
 } // namespace godzilla
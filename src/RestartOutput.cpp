@@ -3,27 +3,110 @@
 
 #include "godzilla/RestartOutput.h"
 #include "godzilla/CallStack.h"
+#include "godzilla/DiscreteProblemInterface.h"
 #include "godzilla/Enums.h"
+#include "godzilla/Exception.h"
 #include "godzilla/Parameters.h"
 #include "godzilla/Problem.h"
 #include "godzilla/RestartFile.h"
 #include "godzilla/RestartInterface.h"
+#include "godzilla/UnstructuredMesh.h"
+#include "godzilla/Validation.h"
+#include <fstream>
+#include <system_error>
 
 namespace godzilla {
 
+namespace {
+
+/// Make a completely written temporary file the newest checkpoint and shift the older ones
+///
+/// The newest checkpoint stays in place until the new one atomically replaces it. This runs on
+/// the I/O thread, so it must not use the call stack.
+///
+/// @param temp_file_name Temporary file with the new checkpoint
+/// @param checkpoints File names of the checkpoints, newest first
+void
+commit_checkpoint(const fs::path & temp_file_name, const std::vector<fs::path> & checkpoints)
+{
+    auto & newest = checkpoints[0];
+    if (checkpoints.size() > 1 && fs::exists(newest)) {
+        for (auto i = checkpoints.size() - 1; i > 1; --i)
+            if (fs::exists(checkpoints[i - 1]))
+                fs::rename(checkpoints[i - 1], checkpoints[i]);
+        fs::remove(checkpoints[1]);
+        std::error_code ec;
+        fs::create_hard_link(newest, checkpoints[1], ec);
+        if (ec)
+            fs::copy_file(newest, checkpoints[1]);
+    }
+    fs::rename(temp_file_name, newest);
+}
+
+} // namespace
+
 Parameters
 RestartOutput::parameters()
 {
     auto params = FileOutput::parameters();
     params.set<ExecuteOnFlags>("on", ExecuteOn::FINAL);
+    params.add_param<Int>("num_checkpoints", 1, "Number of most recent checkpoints to keep")
+        .add_param<Int>("chunk_size",
+                        0,
+                        "Number of values per chunk of large datasets, 0 for contiguous storage")
+        .add_param<String>("compression",
+                           "none",
+                           "Compression of chunked datasets: 'none', 'deflate' or 'szip'")
+        .add_param<Int>("alignment", 0, "Alignment of objects in the file in bytes, 0 for none")
+        .add_param<Int>("cb_nodes",
+                        0,
+                        "Number of MPI-IO aggregators, 0 keeps the MPI-IO default")
+        .add_param<String>("collective_buffering",
+                           "automatic",
+                           "Collective buffering for writes: 'automatic', 'enable' or 'disable'");
     return params;
 }
 
 RestartOutput::RestartOutput(const Parameters & pars) :
     FileOutput(pars),
     ri(dynamic_ref_cast<RestartInterface>(get_problem())),
-    file_base(pars.get<fs::path>("file"))
+    file_base(pars.get<fs::path>("file")),
+    n_checkpoints(pars.get<Int>("num_checkpoints"))
 {
+    CALL_STACK_MSG();
+    if (this->n_checkpoints < 1)
+        error("Parameter 'num_checkpoints' must be positive.");
+
+    auto chunk_size = pars.get<Int>("chunk_size");
+    if (chunk_size < 0)
+        error("Parameter 'chunk_size' must be non-negative.");
+    this->file_opts.datasets.chunk_size = chunk_size;
+
+    auto compression = pars.get<String>("compression").to_lower();
+    if (compression == "none")
+        this->file_opts.datasets.compression = hdf5::Compression::NONE;
+    else if (compression == "deflate")
+        this->file_opts.datasets.compression = hdf5::Compression::DEFLATE;
+    else if (compression == "szip")
+        this->file_opts.datasets.compression = hdf5::Compression::SZIP;
+    else
+        error("The 'compression' parameter can be either 'none', 'deflate' or 'szip'.");
+
+    auto alignment = pars.get<Int>("alignment");
+    if (alignment < 0)
+        error("Parameter 'alignment' must be non-negative.");
+    this->file_opts.alignment = alignment;
+
+    auto cb_nodes = pars.get<Int>("cb_nodes");
+    if (cb_nodes > 0)
+        this->file_opts.mpi_hints.emplace_back("cb_nodes", std::to_string(cb_nodes));
+
+    auto cb = pars.get<String>("collective_buffering").to_lower();
+    if (!validation::in(cb, { "automatic", "enable", "disable" }))
+        error("The 'collective_buffering' parameter can be either 'automatic', 'enable' or "
+              "'disable'.");
+    if (cb != "automatic")
+        this->file_opts.mpi_hints.emplace_back("romio_cb_write", cb);
 }
 
 void
@@ -33,6 +116,21 @@ RestartOutput::create()
     FileOutput::create();
     if (!this->ri.has_value())
         warning("RestartOutput works only with problems that support restart.");
+    // restart data is stored in the natural ordering, so it can be read on any number of ranks
+    if (auto dpi = try_dynamic_ref_cast<DiscreteProblemInterface>(get_problem());
+        dpi.has_value() && !dpi.value()->get_mesh()->has_natural_ordering())
+        error("RestartOutput does not support meshes created distributed (e.g. with "
+              "'parallel_read'), their natural ordering is unknown.");
+    // an in-memory file holds only the data of this rank, so the checkpoint cannot be assembled
+    // from it
+    if (get_problem()->is_output_async() && get_comm().size() > 1)
+        error("RestartOutput does not support 'async_output' when running on more than one "
+              "process.");
+
+    this->checkpoint_file_names.clear();
+    for (Int i = 0; i < this->n_checkpoints; ++i)
+        this->checkpoint_file_names.push_back(get_checkpoint_file_name(i));
+    this->temp_file_name = fmt::format("{}.tmp", get_file_name().string());
 }
 
 void
@@ -40,8 +138,50 @@ RestartOutput::output_step()
 {
     CALL_STACK_MSG();
     auto comm = get_comm();
-    RestartFile file(comm, get_file_name(), FileAccess::CREATE);
+    {
+        RestartFile file(comm, this->temp_file_name, FileAccess::CREATE, this->file_opts);
+        this->ri.value()->write_restart_file(file);
+    }
+    comm.barrier();
+    if (comm.rank() == 0)
+        commit_checkpoint(this->temp_file_name, this->checkpoint_file_names);
+    comm.barrier();
+}
+
+std::function<void()>
+RestartOutput::create_output_task()
+{
+    CALL_STACK_MSG();
+    RestartFile file(this->temp_file_name, FileAccess::CREATE_IN_MEMORY, this->file_opts);
     this->ri.value()->write_restart_file(file);
+    return [image = file.get_file_image(),
+            temp_file_name = this->temp_file_name,
+            checkpoints = this->checkpoint_file_names]() {
+        std::ofstream out(temp_file_name, std::ios::binary);
+        out.write(image.data(), image.size());
+        out.close();
+        if (!out)
+            throw Exception(fmt::format("Failed to write '{}'.", temp_file_name.string()));
+        commit_checkpoint(temp_file_name, checkpoints);
+    };
+}
+
+bool
+RestartOutput::is_snapshot_thread_safe() const
+{
+    CALL_STACK_MSG();
+    // the in-memory image is built with HDF5
+    return false;
+}
+
+fs::path
+RestartOutput::get_checkpoint_file_name(Int idx) const
+{
+    CALL_STACK_MSG();
+    if (idx == 0)
+        return get_file_name();
+    else
+        return fmt::format("{}-{}.{}", this->file_base.string(), idx, get_file_ext());
 }
 
 String
@@ -28,6 +28,23 @@ ShellMatrix::invoke_matmult_op_delegate(Mat matrix, Vec vector, Vec action)
     return 0;
 }
 
+PetscErrorCode
+ShellMatrix::invoke_get_diagonal_op_delegate(Mat matrix, Vec diagonal)
+{
+    CALL_STACK_MSG();
+    ShellMatrix * shell_matrix = nullptr;
+    PETSC_CHECK(MatShellGetContext(matrix, &shell_matrix));
+    Matrix A(matrix);
+    A.inc_reference();
+    Vector diag(diagonal);
+    diag.inc_reference();
+    if (shell_matrix->get_diagonal_delegate)
+        shell_matrix->get_diagonal_delegate.invoke(A, diag);
+    else
+        throw Exception("Delegate not set for MatGetDiagonal operation");
+    return 0;
+}
+
 ShellMatrix::ShellMatrix() : Matrix() {}
 
 ShellMatrix::ShellMatrix(Mat m) : Matrix(m)
@@ -316,11 +316,12 @@ TecplotOutput::write_connectivity(int32_t zone)
     std::vector<int32_t> connectivity;
     connectivity.reserve(this->mesh->get_num_vertices());
     auto n_all_elems = this->mesh->get_num_all_cells();
+    const auto & cell_conn = this->mesh->get_cell_connectivity();
     for (auto & cell_id : this->mesh->get_cell_range()) {
         auto polytope_type = this->mesh->get_cell_type(cell_id);
         auto * ordering = get_elem_node_ordering(polytope_type);
-        auto cell_connect = this->mesh->get_connectivity(cell_id);
-        for (std::size_t k = 0; k < cell_connect.size(); ++k)
+        auto cell_connect = cell_conn[cell_id];
+        for (Int k = 0; k < cell_connect.size(); ++k)
             connectivity.push_back(cell_connect[ordering[k]] - n_all_elems + 1);
     }
     this->file->zone_node_map_write(zone, rank, connectivity);
@@ -0,0 +1,373 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/TensorProductBasis.h"
+#include "godzilla/CallStack.h"
+#include "godzilla/Error.h"
+#include <algorithm>
+#include <cmath>
+
+namespace godzilla {
+
+namespace {
+
+/// Tolerance used when matching the factorization against the tabulation of the element
+constexpr Real MATCH_TOL = 1e-10;
+
+Int
+ipow(Int base, Int exp)
+{
+    Int r = 1;
+    for (Int i = 0; i < exp; ++i)
+        r *= base;
+    return r;
+}
+
+} // namespace
+
+TensorProductBasis::TensorProductBasis() : dim(0), n_comp(0), n_b1(0), n_q1(0) {}
+
+bool
+TensorProductBasis::create(PetscFE fe)
+{
+    CALL_STACK_MSG();
+    *this = TensorProductBasis();
+
+    Int fe_dim, nc, nb;
+    PETSC_CHECK(PetscFEGetSpatialDimension(fe, &fe_dim));
+    PETSC_CHECK(PetscFEGetNumComponents(fe, &nc));
+    PETSC_CHECK(PetscFEGetDimension(fe, &nb));
+    if (fe_dim < 2 || fe_dim > 3 || nb % nc != 0)
+        return false;
+    Int n_nodes = nb / nc;
+    auto n_b = (Int) std::lround(std::pow((Real) n_nodes, 1. / fe_dim));
+    if (ipow(n_b, fe_dim) != n_nodes)
+        return false;
+
+    PetscQuadrature quad;
+    PETSC_CHECK(PetscFEGetQuadrature(fe, &quad));
+    Int q_dim, q_n_comp, n_q;
+    const Real * q_points;
+    PETSC_CHECK(PetscQuadratureGetData(quad, &q_dim, &q_n_comp, &n_q, &q_points, nullptr));
+    if (q_dim != fe_dim || q_n_comp != 1)
+        return false;
+
+    // 1D quadrature points are the distinct coordinates along the first axis
+    std::vector<Real> pts1;
+    for (Int q = 0; q < n_q; ++q) {
+        auto x = q_points[q * q_dim];
+        auto found = std::any_of(pts1.begin(), pts1.end(), [x](Real y) {
+            return std::abs(x - y) < MATCH_TOL;
+        });
+        if (!found)
+            pts1.push_back(x);
+    }
+    std::sort(pts1.begin(), pts1.end());
+    Int n_q1 = pts1.size();
+    if (ipow(n_q1, fe_dim) != n_q)
+        return false;
+
+    std::vector<Int> qpt(n_q);
+    std::vector<bool> taken(n_q, false);
+    for (Int q = 0; q < n_q; ++q) {
+        Int lex = 0;
+        Int stride = 1;
+        for (Int a = 0; a < fe_dim; ++a) {
+            auto x = q_points[q * q_dim + a];
+            auto it = std::find_if(pts1.begin(), pts1.end(), [x](Real y) {
+                return std::abs(x - y) < MATCH_TOL;
+            });
+            if (it == pts1.end())
+                return false;
+            lex += (it - pts1.begin()) * stride;
+            stride *= n_q1;
+        }
+        if (taken[lex])
+            return false;
+        taken[lex] = true;
+        qpt[q] = lex;
+    }
+
+    // 1D Lagrange basis of the same degree
+    PetscFE fe1;
+    PETSC_CHECK(PetscFECreateLagrange(PETSC_COMM_SELF,
+                                      1,
+                                      1,
+                                      PETSC_FALSE,
+                                      n_b - 1,
+                                      PETSC_DETERMINE,
+                                      &fe1));
+    PetscTabulation T1;
+    PETSC_CHECK(PetscFECreateTabulation(fe1, 1, n_q1, pts1.data(), 1, &T1));
+    bool ok = T1->Nb == n_b;
+    if (ok) {
+        this->B.assign(T1->T[0], T1->T[0] + n_q1 * n_b);
+        this->D.assign(T1->T[1], T1->T[1] + n_q1 * n_b);
+    }
+    PETSC_CHECK(PetscTabulationDestroy(&T1));
+    PETSC_CHECK(PetscFEDestroy(&fe1));
+    if (!ok)
+        return false;
+
+    // Match every basis function of the element with a product of 1D ones
+    PetscTabulation T;
+    PETSC_CHECK(PetscFEGetCellTabulation(fe, 1, &T));
+    if (T->Np != n_q || T->Nb != nb || T->cdim != fe_dim)
+        return false;
+    auto prod = [&](Int l, Int q, Int k) {
+        Real v = 1.;
+        Int ll = l;
+        Int lq = qpt[q];
+        for (Int a = 0; a < fe_dim; ++a) {
+            auto & M = a == k ? this->D : this->B;
+            v *= M[(lq % n_q1) * n_b + ll % n_b];
+            ll /= n_b;
+            lq /= n_q1;
+        }
+        return v;
+    };
+    auto matches = [&](Int b, Int c, Int l) {
+        for (Int q = 0; q < n_q; ++q) {
+            for (Int cc = 0; cc < nc; ++cc) {
+                auto val = T->T[0][(q * nb + b) * nc + cc];
+                if (std::abs(val - (cc == c ? prod(l, q, -1) : 0.)) > MATCH_TOL)
+                    return false;
+                for (Int d = 0; d < fe_dim; ++d) {
+                    auto der = T->T[1][((q * nb + b) * nc + cc) * fe_dim + d];
+                    if (std::abs(der - (cc == c ? prod(l, q, d) : 0.)) > MATCH_TOL)
+                        return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    std::vector<Int> nd(nb, -1), cmp(nb, -1);
+    std::vector<bool> used(n_nodes * nc, false);
+    for (Int b = 0; b < nb; ++b) {
+        // component of a Lagrange basis function is the only one with nonzero values
+        Int c = 0;
+        Real c_max = -1.;
+        for (Int cc = 0; cc < nc; ++cc) {
+            Real s = 0.;
+            for (Int q = 0; q < n_q; ++q)
+                s += std::abs(T->T[0][(q * nb + b) * nc + cc]);
+            if (s > c_max) {
+                c_max = s;
+                c = cc;
+            }
+        }
+        for (Int l = 0; l < n_nodes; ++l) {
+            if (!used[l * nc + c] && matches(b, c, l)) {
+                used[l * nc + c] = true;
+                nd[b] = l;
+                cmp[b] = c;
+                break;
+            }
+        }
+        if (nd[b] == -1) {
+            this->B.clear();
+            this->D.clear();
+            return false;
+        }
+    }
+
+    this->dim = fe_dim;
+    this->n_comp = nc;
+    this->n_b1 = n_b;
+    this->n_q1 = n_q1;
+    this->node = std::move(nd);
+    this->comp = std::move(cmp);
+    this->qpoint = std::move(qpt);
+    return true;
+}
+
+bool
+TensorProductBasis::is_valid() const
+{
+    return this->dim > 0;
+}
+
+Int
+TensorProductBasis::get_dimension() const
+{
+    return this->dim;
+}
+
+Int
+TensorProductBasis::get_num_basis() const
+{
+    return this->node.size();
+}
+
+Int
+TensorProductBasis::get_num_components() const
+{
+    return this->n_comp;
+}
+
+Int
+TensorProductBasis::get_num_qpoints() const
+{
+    return this->qpoint.size();
+}
+
+Int
+TensorProductBasis::get_work_size() const
+{
+    return 4 * ipow(std::max(this->n_b1, this->n_q1), this->dim);
+}
+
+Int
+TensorProductBasis::get_component(Int b) const
+{
+    return this->comp[b];
+}
+
+void
+TensorProductBasis::tabulate(Int b, Real val[], Real grad_ref[]) const
+{
+    CALL_STACK_MSG();
+    Int n_q = this->qpoint.size();
+    for (Int q = 0; q < n_q; ++q) {
+        // k = -1 gives the value, k >= 0 the derivative along axis k
+        for (Int k = -1; k < this->dim; ++k) {
+            Real v = 1.;
+            Int l = this->node[b];
+            Int lq = this->qpoint[q];
+            for (Int a = 0; a < this->dim; ++a) {
+                auto & M = a == k ? this->D : this->B;
+                v *= M[(lq % this->n_q1) * this->n_b1 + l % this->n_b1];
+                l /= this->n_b1;
+                lq /= this->n_q1;
+            }
+            if (k < 0)
+                val[q] = v;
+            else
+                grad_ref[q * this->dim + k] = v;
+        }
+    }
+}
+
+void
+TensorProductBasis::contract(const std::vector<Real> & M,
+                             bool transpose,
+                             Int axis,
+                             Int shape[],
+                             const Scalar in[],
+                             Scalar out[]) const
+{
+    Int rows = transpose ? this->n_b1 : this->n_q1;
+    Int cols = shape[axis];
+    Int inner = 1;
+    for (Int a = 0; a < axis; ++a)
+        inner *= shape[a];
+    Int outer = 1;
+    for (Int a = axis + 1; a < this->dim; ++a)
+        outer *= shape[a];
+    for (Int o = 0; o < outer; ++o) {
+        for (Int r = 0; r < rows; ++r) {
+            Scalar * out_row = &out[(o * rows + r) * inner];
+            for (Int i = 0; i < inner; ++i)
+                out_row[i] = 0.;
+            for (Int c = 0; c < cols; ++c) {
+                Real m = transpose ? M[c * this->n_b1 + r] : M[r * this->n_b1 + c];
+                const Scalar * in_row = &in[(o * cols + c) * inner];
+                for (Int i = 0; i < inner; ++i)
+                    out_row[i] += m * in_row[i];
+            }
+        }
+    }
+    shape[axis] = rows;
+}
+
+void
+TensorProductBasis::interpolate(const Scalar coefs[],
+                                Scalar u[],
+                                Scalar u_ref[],
+                                Scalar work[]) const
+{
+    CALL_STACK_MSG();
+    Int n = get_work_size() / 4;
+    Int n_nodes = ipow(this->n_b1, this->dim);
+    Int n_q = this->qpoint.size();
+    Int nb = this->node.size();
+    Scalar * src = work;
+    Scalar * tmp[2] = { work + n, work + 2 * n };
+    for (Int c = 0; c < this->n_comp; ++c) {
+        for (Int l = 0; l < n_nodes; ++l)
+            src[l] = 0.;
+        for (Int b = 0; b < nb; ++b)
+            if (this->comp[b] == c)
+                src[this->node[b]] = coefs[b];
+
+        // k = -1 gives values, k >= 0 derivatives along axis k
+        Int n_k = u_ref ? this->dim : 0;
+        for (Int k = -1; k < n_k; ++k) {
+            Int shape[3] = { this->n_b1, this->n_b1, this->n_b1 };
+            const Scalar * in = src;
+            for (Int a = 0; a < this->dim; ++a) {
+                Scalar * out = tmp[a % 2];
+                contract(a == k ? this->D : this->B, false, a, shape, in, out);
+                in = out;
+            }
+            if (k < 0)
+                for (Int q = 0; q < n_q; ++q)
+                    u[q * this->n_comp + c] = in[this->qpoint[q]];
+            else
+                for (Int q = 0; q < n_q; ++q)
+                    u_ref[(q * this->n_comp + c) * this->dim + k] = in[this->qpoint[q]];
+        }
+    }
+}
+
+void
+TensorProductBasis::integrate(const Scalar f0[],
+                              const Scalar f1_ref[],
+                              Scalar elem_vec[],
+                              Scalar work[]) const
+{
+    CALL_STACK_MSG();
+    Int n = get_work_size() / 4;
+    Int n_nodes = ipow(this->n_b1, this->dim);
+    Int n_q = this->qpoint.size();
+    Int nb = this->node.size();
+    Scalar * src = work;
+    Scalar * tmp[2] = { work + n, work + 2 * n };
+    Scalar * acc = work + 3 * n;
+    for (Int c = 0; c < this->n_comp; ++c) {
+        for (Int l = 0; l < n_nodes; ++l)
+            acc[l] = 0.;
+
+        // k = -1 integrates against test functions, k >= 0 against their derivatives along axis k
+        for (Int k = -1; k < this->dim; ++k) {
+            if (k < 0) {
+                if (f0 == nullptr)
+                    continue;
+                for (Int q = 0; q < n_q; ++q)
+                    src[this->qpoint[q]] = f0[q * this->n_comp + c];
+            }
+            else {
+                if (f1_ref == nullptr)
+                    continue;
+                for (Int q = 0; q < n_q; ++q)
+                    src[this->qpoint[q]] = f1_ref[(q * this->n_comp + c) * this->dim + k];
+            }
+            Int shape[3] = { this->n_q1, this->n_q1, this->n_q1 };
+            const Scalar * in = src;
+            for (Int a = 0; a < this->dim; ++a) {
+                Scalar * out = tmp[a % 2];
+                contract(a == k ? this->D : this->B, true, a, shape, in, out);
+                in = out;
+            }
+            for (Int l = 0; l < n_nodes; ++l)
+                acc[l] += in[l];
+        }
+
+        for (Int b = 0; b < nb; ++b)
+            if (this->comp[b] == c)
+                elem_vec[b] += acc[this->node[b]];
+    }
+}
+
+} // namespace godzilla
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText: 2026 David Andrs <andrsd@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "godzilla/ThreadPool.h"
+#include "godzilla/CallStack.h"
+
+namespace godzilla {
+
+namespace {
+
+thread_local Int thread_slot = 0;
+
+} // namespace
+
+Int
+get_thread_slot()
+{
+    return thread_slot;
+}
+
+ThreadPool::ThreadPool(Int n_threads) :
+    job(nullptr),
+    n_items(0),
+    next_item(0),
+    n_active(0),
+    generation(0),
+    quit(false)
+{
+    CALL_STACK_MSG();
+    start(n_threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+Int
+ThreadPool::get_num_threads() const
+{
+    CALL_STACK_MSG();
+    return (Int) this->threads.size();
+}
+
+void
+ThreadPool::resize(Int n_threads)
+{
+    CALL_STACK_MSG();
+    if (n_threads == get_num_threads())
+        return;
+    stop();
+    start(n_threads);
+}
+
+void
+ThreadPool::start(Int n_threads)
+{
+    std::uint64_t gen;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->quit = false;
+        gen = this->generation;
+    }
+    this->threads.reserve(n_threads);
+    for (Int i = 0; i < n_threads; ++i)
+        this->threads.emplace_back(&ThreadPool::worker, this, i + 1, gen);
+}
+
+void
+ThreadPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->quit = true;
+    }
+    this->work_cv.notify_all();
+    for (auto & th : this->threads)
+        th.join();
+    this->threads.clear();
+}
+
+void
+ThreadPool::parallel_for(Int n, const std::function<void(Int)> & fn)
+{
+    CALL_STACK_MSG();
+    if (this->threads.empty() || n <= 1) {
+        for (Int i = 0; i < n; ++i)
+            fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->job = &fn;
+        this->n_items = n;
+        this->next_item = 0;
+        this->n_active = get_num_threads();
+        this->error = nullptr;
+        ++this->generation;
+    }
+    this->work_cv.notify_all();
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->done_cv.wait(lock, [this] { return this->n_active == 0; });
+    this->job = nullptr;
+    if (this->error)
+        std::rethrow_exception(this->error);
+}
+
+void
+ThreadPool::worker(Int slot, std::uint64_t seen)
+{
+    thread_slot = slot;
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->work_cv.wait(lock, [&] { return this->quit || this->generation != seen; });
+        if (this->quit)
+            return;
+        seen = this->generation;
+        while (this->next_item < this->n_items) {
+            Int i = this->next_item++;
+            lock.unlock();
+            try {
+                (*this->job)(i);
+            }
+            catch (...) {
+                lock.lock();
+                if (!this->error)
+                    this->error = std::current_exception();
+                lock.unlock();
+            }
+            lock.lock();
+        }
+        if (--this->n_active == 0)
+            this->done_cv.notify_one();
+    }
+}
+
+} // namespace godzilla
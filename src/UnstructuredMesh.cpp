@@ -12,16 +12,222 @@
 #include "godzilla/Types.h"
 #include "petscdmplex.h"
 #include "petscdmtypes.h"
+#include "petsc/private/dmimpl.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 
 namespace godzilla {
 
+namespace {
+
+/// Number of bits per coordinate of Hilbert keys
+constexpr int HILBERT_BITS = 21;
+
+/// Compute the position of a point along a Hilbert curve
+///
+/// Uses the algorithm from J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707
+/// (2004).
+///
+/// @param x Integer coordinates with `HILBERT_BITS` bits each (overwritten)
+/// @param dim Number of coordinates
+/// @return Hilbert key
+std::uint64_t
+hilbert_key(std::uint32_t x[], Int dim)
+{
+    if (dim == 1)
+        return x[0];
+
+    const std::uint32_t m = 1u << (HILBERT_BITS - 1);
+    // inverse undo
+    for (std::uint32_t q = m; q > 1; q >>= 1) {
+        std::uint32_t p = q - 1;
+        for (Int i = 0; i < dim; ++i) {
+            if (x[i] & q)
+                x[0] ^= p;
+            else {
+                std::uint32_t t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+    // Gray encode
+    for (Int i = 1; i < dim; ++i)
+        x[i] ^= x[i - 1];
+    std::uint32_t t = 0;
+    for (std::uint32_t q = m; q > 1; q >>= 1)
+        if (x[dim - 1] & q)
+            t ^= q - 1;
+    for (Int i = 0; i < dim; ++i)
+        x[i] ^= t;
+
+    std::uint64_t key = 0;
+    for (int b = HILBERT_BITS - 1; b >= 0; --b)
+        for (Int i = 0; i < dim; ++i)
+            key = (key << 1) | ((x[i] >> b) & 1u);
+    return key;
+}
+
+/// Build a point permutation from an ordering of cells
+///
+/// Other points are numbered within their depth stratum in the order they first appear in the
+/// closures of the cells.
+///
+/// @param dm DMPlex
+/// @param cells Cells in the new order
+/// @return New number of each point
+std::vector<Int>
+closure_ordering(DM dm, const std::vector<Int> & cells)
+{
+    CALL_STACK_MSG();
+    Int p_start, p_end;
+    PETSC_CHECK(DMPlexGetChart(dm, &p_start, &p_end));
+    Int depth;
+    PETSC_CHECK(DMPlexGetDepth(dm, &depth));
+    std::vector<Int> next(depth + 1);
+    for (Int d = 0; d <= depth; ++d)
+        PETSC_CHECK(DMPlexGetDepthStratum(dm, d, &next[d], nullptr));
+
+    std::vector<Int> perm(p_end - p_start, -1);
+    auto number = [&](Int p) {
+        if (perm[p - p_start] < 0) {
+            Int d;
+            PETSC_CHECK(DMPlexGetPointDepth(dm, p, &d));
+            perm[p - p_start] = next[d]++;
+        }
+    };
+    for (auto & c : cells) {
+        Int n_closure;
+        Int * closure = nullptr;
+        PETSC_CHECK(DMPlexGetTransitiveClosure(dm, c, PETSC_TRUE, &n_closure, &closure));
+        for (Int i = 0; i < n_closure; ++i)
+            number(closure[2 * i]);
+        PETSC_CHECK(DMPlexRestoreTransitiveClosure(dm, c, PETSC_TRUE, &n_closure, &closure));
+    }
+    // points that are not in the closure of any cell
+    for (Int p = p_start; p < p_end; ++p)
+        number(p);
+    return perm;
+}
+
+/// Order points so that cells follow a Hilbert curve through their centroids
+///
+/// @param dm DMPlex
+/// @return New number of each point
+std::vector<Int>
+hilbert_ordering(DM dm)
+{
+    CALL_STACK_MSG();
+    Int dim;
+    PETSC_CHECK(DMGetCoordinateDim(dm, &dim));
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+    Int n_cells = c_end - c_start;
+
+    std::vector<Real> centroids(n_cells * dim);
+    Real lo[3], hi[3];
+    for (Int d = 0; d < dim; ++d) {
+        lo[d] = std::numeric_limits<Real>::max();
+        hi[d] = std::numeric_limits<Real>::lowest();
+    }
+    for (Int i = 0; i < n_cells; ++i) {
+        Real vol;
+        Real * ctr = &centroids[i * dim];
+        PETSC_CHECK(DMPlexComputeCellGeometryFVM(dm, c_start + i, &vol, ctr, nullptr));
+        for (Int d = 0; d < dim; ++d) {
+            lo[d] = std::min(lo[d], ctr[d]);
+            hi[d] = std::max(hi[d], ctr[d]);
+        }
+    }
+
+    const Real n_max = (Real) ((1u << HILBERT_BITS) - 1);
+    std::vector<std::pair<std::uint64_t, Int>> keys(n_cells);
+    for (Int i = 0; i < n_cells; ++i) {
+        std::uint32_t x[3];
+        for (Int d = 0; d < dim; ++d) {
+            Real len = hi[d] - lo[d];
+            Real s = len > 0. ? (centroids[i * dim + d] - lo[d]) / len : 0.;
+            x[d] = (std::uint32_t) (s * n_max);
+        }
+        keys[i] = { hilbert_key(x, dim), c_start + i };
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<Int> cells(n_cells);
+    for (Int i = 0; i < n_cells; ++i)
+        cells[i] = keys[i].second;
+    return closure_ordering(dm, cells);
+}
+
+/// Renumber the graph of a star forest after local mesh points were permuted
+///
+/// @param sf Star forest whose leaves are local mesh points
+/// @param perm New number of each local mesh point
+/// @param permute_roots `true` if roots are mesh points permuted on their owning rank as well
+/// @return Renumbered star forest, `nullptr` if `sf` has no graph
+PetscSF
+permute_star_forest(PetscSF sf, const std::vector<Int> & perm, bool permute_roots)
+{
+    CALL_STACK_MSG();
+    Int n_roots, n_leaves;
+    const Int * ilocal;
+    const PetscSFNode * iremote;
+    PETSC_CHECK(PetscSFGetGraph(sf, &n_roots, &n_leaves, &ilocal, &iremote));
+    if (n_roots < 0)
+        return nullptr;
+
+    // owners send the new numbers of their points to the ranks referencing them
+    std::vector<Int> remote_perm;
+    if (permute_roots) {
+        remote_perm.assign(perm.size(), -1);
+        PETSC_CHECK(
+            PetscSFBcastBegin(sf, MPIU_INT, perm.data(), remote_perm.data(), MPI_REPLACE));
+        PETSC_CHECK(PetscSFBcastEnd(sf, MPIU_INT, perm.data(), remote_perm.data(), MPI_REPLACE));
+    }
+
+    std::vector<std::pair<Int, PetscSFNode>> leaves(n_leaves);
+    for (Int i = 0; i < n_leaves; ++i) {
+        Int p = ilocal ? ilocal[i] : i;
+        PetscSFNode remote = iremote[i];
+        if (permute_roots)
+            remote.index = remote_perm[p];
+        leaves[i] = { perm[p], remote };
+    }
+    std::sort(leaves.begin(), leaves.end(), [](const auto & a, const auto & b) {
+        return a.first < b.first;
+    });
+
+    Int * new_local;
+    PetscSFNode * new_remote;
+    PETSC_CHECK(PetscMalloc1(n_leaves, &new_local));
+    PETSC_CHECK(PetscMalloc1(n_leaves, &new_remote));
+    for (Int i = 0; i < n_leaves; ++i) {
+        new_local[i] = leaves[i].first;
+        new_remote[i] = leaves[i].second;
+    }
+    PetscSF psf;
+    PETSC_CHECK(PetscSFCreate(PetscObjectComm((PetscObject) sf), &psf));
+    PETSC_CHECK(PetscSFSetGraph(psf,
+                                n_roots,
+                                n_leaves,
+                                new_local,
+                                PETSC_OWN_POINTER,
+                                new_remote,
+                                PETSC_OWN_POINTER));
+    return psf;
+}
+
+} // namespace
+
 std::map<Int, std::vector<Int>>
 common_cells_by_vertex(const UnstructuredMesh & mesh)
 {
     CALL_STACK_MSG();
     std::map<Int, std::vector<Int>> data;
+    const auto & cell_conn = mesh.get_cell_connectivity();
     for (auto & cell : mesh.get_cell_range()) {
-        auto connect = mesh.get_connectivity(cell);
+        auto connect = cell_conn[cell];
         for (auto & vtx : connect)
             data[vtx].push_back(cell);
     }
@@ -257,6 +463,61 @@ UnstructuredMesh::get_connectivity(Int point) const
     return elem_connect;
 }
 
+const UnstructuredMesh::CellConnectivity &
+UnstructuredMesh::get_cell_connectivity() const
+{
+    CALL_STACK_MSG();
+    auto dm = get_dm();
+    PetscObjectId dm_id;
+    PETSC_CHECK(PetscObjectGetId((PetscObject) dm, &dm_id));
+    PetscObjectState dm_state;
+    PETSC_CHECK(PetscObjectStateGet((PetscObject) dm, &dm_state));
+    if (this->connectivity_dm_id == dm_id && this->connectivity_dm_state == dm_state)
+        return this->connectivity;
+
+    auto cells = get_cell_range();
+    Int v_start, v_end;
+    PETSC_CHECK(DMPlexGetDepthStratum(dm, 0, &v_start, &v_end));
+    auto & conn = this->connectivity;
+    conn.cells = cells;
+    conn.offsets.assign(cells.size() + 1, 0);
+    conn.vertices.clear();
+    // vertices are the last points in the closure, `DMPlexGetTransitiveClosure` reuses its work
+    // array, so there is no allocation per cell
+    Int closure_size;
+    Int * closure = nullptr;
+    for (auto & cell : cells) {
+        PETSC_CHECK(DMPlexGetTransitiveClosure(dm, cell, PETSC_TRUE, &closure_size, &closure));
+        for (Int k = 0; k < closure_size; ++k) {
+            auto pt = closure[2 * k];
+            if (pt >= v_start && pt < v_end)
+                conn.vertices.push_back(pt);
+        }
+        conn.offsets[cell - cells.first() + 1] = conn.vertices.size();
+        PETSC_CHECK(
+            DMPlexRestoreTransitiveClosure(dm, cell, PETSC_TRUE, &closure_size, &closure));
+    }
+    this->connectivity_dm_id = dm_id;
+    this->connectivity_dm_state = dm_state;
+    return conn;
+}
+
+UnstructuredMesh::VertexCoordinates
+UnstructuredMesh::get_vertex_coordinates() const
+{
+    CALL_STACK_MSG();
+    return VertexCoordinates(*this);
+}
+
+UnstructuredMesh::VertexCoordinates::VertexCoordinates(const UnstructuredMesh & mesh) :
+    coords(mesh.get_coordinates_local()),
+    array(this->coords.borrow_array_read()),
+    dim(mesh.get_coordinate_dim()),
+    v_start(mesh.get_vertex_range().first())
+{
+    CALL_STACK_MSG();
+}
+
 Span<const Int>
 UnstructuredMesh::get_support(Int point) const
 {
@@ -339,12 +600,65 @@ UnstructuredMesh::distribute(Int overlap)
 {
     CALL_STACK_MSG();
 
+    // keep the map to the original ordering, so restart files do not depend on partitioning
+    PETSC_CHECK(DMSetUseNatural(get_dm(), PETSC_TRUE));
     DM dm_dist = nullptr;
     PETSC_CHECK(DMPlexDistribute(get_dm(), overlap, nullptr, &dm_dist));
     if (dm_dist)
         set_dm(dm_dist);
 }
 
+void
+UnstructuredMesh::reorder(Ordering ordering)
+{
+    CALL_STACK_MSG();
+    auto dm = get_dm();
+    // sections, fields and discrete systems are tied to the point numbering and would not follow
+    // the permutation
+    Int n_fields;
+    PETSC_CHECK(DMGetNumFields(dm, &n_fields));
+    expect_true(dm->localSection == nullptr && n_fields == 0,
+                "Mesh can only be reordered before any fields or sections are set up on it.");
+
+    std::vector<Int> perm;
+    if (ordering == Ordering::RCM) {
+        IS is;
+        PETSC_CHECK(DMPlexGetOrdering(dm, MATORDERINGRCM, nullptr, &is));
+        IndexSet perm_is(is);
+        auto idx = perm_is.borrow_indices();
+        perm.assign(idx.begin(), idx.end());
+    }
+    else
+        perm = hilbert_ordering(dm);
+
+    auto perm_is = IndexSet::create_general(PETSC_COMM_SELF, perm);
+    DM pdm;
+    PETSC_CHECK(DMPlexPermute(dm, perm_is, &pdm));
+
+    PetscBool use_natural;
+    PETSC_CHECK(DMGetUseNatural(dm, &use_natural));
+    PETSC_CHECK(DMSetUseNatural(pdm, use_natural));
+    PetscSF sf;
+    PETSC_CHECK(DMGetPointSF(dm, &sf));
+    auto point_sf = permute_star_forest(sf, perm, true);
+    if (point_sf) {
+        PETSC_CHECK(DMSetPointSF(pdm, point_sf));
+        PETSC_CHECK(PetscSFDestroy(&point_sf));
+    }
+    // the migration star forest maps the original mesh into this one and is used to build the
+    // natural ordering
+    PetscSF mig_sf;
+    PETSC_CHECK(DMPlexGetMigrationSF(dm, &mig_sf));
+    if (mig_sf) {
+        auto pmig_sf = permute_star_forest(mig_sf, perm, false);
+        if (pmig_sf) {
+            PETSC_CHECK(DMPlexSetMigrationSF(pdm, pmig_sf));
+            PETSC_CHECK(PetscSFDestroy(&pmig_sf));
+        }
+    }
+    set_dm(pdm);
+}
+
 bool
 UnstructuredMesh::is_distributed() const
 {
@@ -354,6 +668,17 @@ UnstructuredMesh::is_distributed() const
     return flag == PETSC_TRUE;
 }
 
+bool
+UnstructuredMesh::has_natural_ordering() const
+{
+    CALL_STACK_MSG();
+    if (!is_distributed())
+        return true;
+    PetscSF mig_sf;
+    PETSC_CHECK(DMPlexGetMigrationSF(get_dm(), &mig_sf));
+    return mig_sf != nullptr;
+}
+
 bool
 UnstructuredMesh::is_simplex() const
 {
@@ -709,6 +1034,8 @@ UnstructuredMesh::stratify()
 {
     CALL_STACK_MSG();
     PETSC_CHECK(DMPlexStratify(get_dm()));
+    // the topology was edited in place, let caches keyed on the DM state know
+    PETSC_CHECK(PetscObjectStateIncrease((PetscObject) get_dm()));
 }
 
 std::vector<Int>
@@ -144,4 +144,15 @@ WeakForm::has_jacobian_preconditioner() const
     return (n0 + n1 + n2 + n3) > 0;
 }
 
+bool
+WeakForm::has_bnd_jacobian() const
+{
+    CALL_STACK_MSG();
+    auto n0 = this->jac_forms[WeakForm::BND_G0].size();
+    auto n1 = this->jac_forms[WeakForm::BND_G1].size();
+    auto n2 = this->jac_forms[WeakForm::BND_G2].size();
+    auto n3 = this->jac_forms[WeakForm::BND_G3].size();
+    return (n0 + n1 + n2 + n3) > 0;
+}
+
 } // namespace godzilla
@@ -5,8 +5,11 @@
 #include "godzilla/Problem.h"
 #include "godzilla/LineMesh.h"
 #include "godzilla/Ref.h"
+#include "godzilla/PerfLog.h"
 #include "ExceptionTestMacros.h"
+#include "yaml-cpp/yaml.h"
 #include <filesystem>
+#include <set>
 
 using namespace godzilla;
 
@@ -181,3 +184,32 @@ TEST(AppTest, duplicate_app_name_throws)
     App app1(comm, "app");
     EXPECT_DEATH({ App app2(comm, "app"); }, "Application name 'app' is already in use.");
 }
+
+TEST(AppTest, write_perf_log_rank_local_events)
+{
+    class PerfLogApp : public App {
+    public:
+        explicit PerfLogApp(mpi::Communicator comm) : App(comm, "perf_log_app") {}
+
+        using App::write_perf_log;
+    };
+
+    mpi::Communicator comm(MPI_COMM_WORLD);
+    PerfLogApp app(comm);
+
+    // every rank has an event the other ranks do not know about
+    perf_log::Event evt(fmt::format("AppTest::rank_event_{}", comm.rank()));
+    evt.begin();
+    evt.end();
+
+    app.write_perf_log("perf_log_rank_events.yml", std::chrono::duration<double>(1.));
+
+    if (comm.rank() == 0) {
+        auto yml = YAML::LoadFile("perf_log_rank_events.yml");
+        std::set<std::string> names;
+        for (auto ev : yml["perf-log"]["events"])
+            names.insert(ev["name"].as<std::string>());
+        for (int r = 0; r < comm.size(); ++r)
+            EXPECT_TRUE(names.contains(fmt::format("AppTest::rank_event_{}", r)));
+    }
+}
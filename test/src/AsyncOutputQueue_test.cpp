@@ -0,0 +1,63 @@
+#include "gmock/gmock.h"
+#include "godzilla/AsyncOutputQueue.h"
+#include "godzilla/Exception.h"
+#include <atomic>
+#include <thread>
+
+using namespace godzilla;
+
+TEST(AsyncOutputQueueTest, in_order)
+{
+    AsyncOutputQueue queue(2);
+    EXPECT_EQ(queue.get_max_depth(), 2);
+    std::vector<int> order;
+    for (int i = 0; i < 10; ++i)
+        queue.push([&order, i]() { order.push_back(i); });
+    queue.flush();
+    EXPECT_THAT(order, testing::ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+}
+
+TEST(AsyncOutputQueueTest, background_thread)
+{
+    AsyncOutputQueue queue;
+    std::thread::id id;
+    queue.push([&id]() { id = std::this_thread::get_id(); });
+    queue.flush();
+    EXPECT_NE(id, std::this_thread::get_id());
+}
+
+TEST(AsyncOutputQueueTest, bounded_depth)
+{
+    AsyncOutputQueue queue(1);
+    std::atomic<int> running(0);
+    std::atomic<int> max_running(0);
+    for (int i = 0; i < 5; ++i)
+        queue.push([&]() {
+            int n = ++running;
+            max_running = std::max(max_running.load(), n);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            --running;
+        });
+    queue.flush();
+    EXPECT_EQ(max_running, 1);
+}
+
+TEST(AsyncOutputQueueTest, error)
+{
+    AsyncOutputQueue queue;
+    queue.push([]() { throw Exception("write failed"); });
+    EXPECT_THROW(queue.flush(), Exception);
+    // error is reported once
+    queue.flush();
+}
+
+TEST(AsyncOutputQueueTest, destructor_drains)
+{
+    std::atomic<int> n(0);
+    {
+        AsyncOutputQueue queue(3);
+        for (int i = 0; i < 3; ++i)
+            queue.push([&n]() { ++n; });
+    }
+    EXPECT_EQ(n, 3);
+}
@@ -5,6 +5,7 @@
 #include "godzilla/CSVOutput.h"
 #include "godzilla/Postprocessor.h"
 #include "godzilla/Types.h"
+#include "ExceptionTestMacros.h"
 
 using namespace godzilla;
 
@@ -101,6 +102,61 @@ TEST_F(CSVOutputTest, output)
     }
 }
 
+TEST_F(CSVOutputTest, output_vector_values)
+{
+    class TestPostprocessor : public Postprocessor {
+    public:
+        explicit TestPostprocessor(const Parameters & pars) : Postprocessor(pars) {}
+
+        void compute() override {};
+
+        std::vector<Real>
+        get_value() override
+        {
+            return { 1., 2., 3. };
+        }
+    };
+
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+
+    auto pp_params = this->app->make_parameters<TestPostprocessor>();
+    pp_params.set<String>("name", "vec");
+    prob->add_postprocessor<TestPostprocessor>(pp_params);
+
+    auto params = this->app->make_parameters<TestCSVOutput>();
+    params.set<fs::path>("file", "vec_out").set<Int>("flush_interval", 2);
+    auto out = prob->add_output<TestCSVOutput>(params);
+
+    prob->create();
+
+    // rows are written in blocks of `flush_interval`, the rest when the file is closed
+    for (int i = 0; i < 3; ++i)
+        out->output_step();
+    out->close();
+
+    std::ifstream f("vec_out.csv");
+    ASSERT_TRUE(f.is_open());
+    std::string line;
+    std::getline(f, line);
+    EXPECT_EQ(line, "time,vec_0,vec_1,vec_2");
+    for (int i = 0; i < 3; ++i) {
+        std::getline(f, line);
+        EXPECT_EQ(line, "0,1,2,3");
+    }
+    EXPECT_FALSE(std::getline(f, line));
+}
+
+TEST_F(CSVOutputTest, invalid_flush_interval)
+{
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+
+    auto params = this->app->make_parameters<CSVOutput>();
+    params.set<Ref<Problem>>("_problem", prob);
+    params.set<fs::path>("file", "asdf");
+    params.set<Int>("flush_interval", 0);
+    EXPECT_THROW_MSG(CSVOutput out(params), "The 'flush_interval' parameter must be positive.");
+}
+
 TEST_F(CSVOutputTest, set_file_name)
 {
     auto prob = this->app->get_problem<GTestFENonlinearProblem>();
@@ -116,3 +172,28 @@ TEST_F(CSVOutputTest, set_file_name)
 
     EXPECT_EQ(out.get_file_name(), "asdf.csv");
 }
+
+TEST_F(CSVOutputTest, short_write)
+{
+    if (!fs::exists("/dev/full"))
+        GTEST_SKIP() << "/dev/full is not available";
+
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+
+    // writes into /dev/full fail with ENOSPC
+    fs::remove("full.csv");
+    fs::create_symlink("/dev/full", "full.csv");
+
+    auto params = this->app->make_parameters<TestCSVOutput>();
+    params.set<fs::path>("file", "full");
+    auto out = prob->add_output<TestCSVOutput>(params);
+
+    prob->create();
+
+    EXPECT_DEATH(
+        {
+            out->output_step();
+            out->close();
+        },
+        "Failed to write into 'full.csv'");
+}
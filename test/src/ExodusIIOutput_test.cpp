@@ -6,6 +6,7 @@
 #include "godzilla/MeshFactory.h"
 #include "godzilla/LineMesh.h"
 #include "godzilla/Types.h"
+#include "exodusII.h"
 
 using namespace godzilla;
 
@@ -215,3 +216,156 @@ TEST(ExodusIIOutputTest, append)
         EXPECT_NEAR(vals2[2], 9., 1e-10);
     }
 }
+
+TEST(ExodusIIOutputTest, single_file)
+{
+    TestApp app;
+
+    {
+        auto mesh_pars = app.make_parameters<LineMesh>();
+        mesh_pars.set<Int>("nx", 2);
+        auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+        auto prob_pars = app.make_parameters<GTestImplicitFENonlinearProblem>();
+        prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+        prob_pars.set<Real>("start_time", 0.);
+        prob_pars.set<Int>("num_steps", 1);
+        prob_pars.set<Real>("dt", 0.1);
+        GTestImplicitFENonlinearProblem prob(prob_pars);
+
+        auto params = app.make_parameters<ExodusIIOutput>();
+        params.set<fs::path>("file", "single_file");
+        params.set<bool>("single_file", true);
+        auto out = prob.add_output<ExodusIIOutput>(params);
+
+        prob.create();
+        EXPECT_EQ(out->get_file_name(), "single_file.exo");
+
+        auto & sln = prob.get_solution_vector_local();
+        sln.set_values({ 0, 1, 2 }, { 10., 11., 12. });
+        out->output_step();
+        out->output_step();
+    }
+
+    {
+        exodusIIcpp::File exo("single_file.exo", exodusIIcpp::FileAccess::READ);
+        exo.read();
+        EXPECT_EQ(exo.get_num_nodes(), 3);
+        EXPECT_EQ(exo.get_num_elements(), 2);
+        EXPECT_EQ(exo.get_num_times(), 2);
+
+        auto vals = exo.get_nodal_variable_values(2, 1);
+        ASSERT_EQ(vals.size(), 3);
+        EXPECT_NEAR(vals[0], 10., 1e-10);
+        EXPECT_NEAR(vals[1], 11., 1e-10);
+        EXPECT_NEAR(vals[2], 12., 1e-10);
+    }
+}
+
+TEST(ExodusIIOutputTest, single_file_parallel)
+{
+    TestApp app;
+    auto comm = app.get_comm();
+
+    {
+        auto mesh_pars = app.make_parameters<LineMesh>();
+        mesh_pars.set<Int>("nx", 6);
+        auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+        auto prob_pars = app.make_parameters<GTestImplicitFENonlinearProblem>();
+        prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+        prob_pars.set<Real>("start_time", 0.);
+        prob_pars.set<Int>("num_steps", 1);
+        prob_pars.set<Real>("dt", 0.1);
+        GTestImplicitFENonlinearProblem prob(prob_pars);
+
+        auto params = app.make_parameters<ExodusIIOutput>();
+        params.set<fs::path>("file", "single_file_par");
+        params.set<bool>("single_file", true);
+        auto out = prob.add_output<ExodusIIOutput>(params);
+
+        prob.create();
+        EXPECT_EQ(out->get_file_name(), "single_file_par.exo");
+
+        // nodal values are 10 x, so they can be checked against the coordinates in the file
+        auto & sln = prob.get_solution_vector_local();
+        for (auto & v : mesh->get_vertex_range()) {
+            auto xyz = mesh->get_vertex_coordinates(v);
+            sln.set_value(prob.get_field_dof(v, FieldID(0)), 10. * xyz[0]);
+        }
+        out->output_step();
+    }
+    comm.barrier();
+
+    if (comm.rank() == 0) {
+        exodusIIcpp::File exo("single_file_par.exo", exodusIIcpp::FileAccess::READ);
+        exo.read();
+        EXPECT_EQ(exo.get_num_nodes(), 7);
+        EXPECT_EQ(exo.get_num_elements(), 6);
+        EXPECT_EQ(exo.get_num_times(), 1);
+
+        auto vals = exo.get_nodal_variable_values(1, 1);
+        ASSERT_EQ(vals.size(), 7);
+
+        int cpu_word_size = sizeof(double);
+        int io_word_size = 0;
+        float version;
+        int exoid =
+            ex_open("single_file_par.exo", EX_READ, &cpu_word_size, &io_word_size, &version);
+        ASSERT_GE(exoid, 0);
+        std::vector<double> x(7);
+        ex_get_coord(exoid, x.data(), nullptr, nullptr);
+        ex_close(exoid);
+        for (std::size_t i = 0; i < x.size(); ++i)
+            EXPECT_NEAR(vals[i], 10. * x[i], 1e-10);
+    }
+}
+
+TEST(ExodusIIOutputTest, async_output)
+{
+    TestApp app;
+
+    {
+        auto mesh_pars = app.make_parameters<LineMesh>();
+        mesh_pars.set<Int>("nx", 2);
+        auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+        auto prob_pars = app.make_parameters<GTestImplicitFENonlinearProblem>();
+        prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+        prob_pars.set<Real>("start_time", 0.);
+        prob_pars.set<Int>("num_steps", 1);
+        prob_pars.set<Real>("dt", 0.1);
+        prob_pars.set<bool>("async_output", true);
+        prob_pars.set<Int>("output_queue_depth", 1);
+        GTestImplicitFENonlinearProblem prob(prob_pars);
+
+        auto params = app.make_parameters<ExodusIIOutput>();
+        params.set<fs::path>("file", "async");
+        auto out = prob.add_output<ExodusIIOutput>(params);
+
+        prob.create();
+        // first step stores the mesh and is written synchronously
+        EXPECT_FALSE(out->create_output_task());
+        out->output_step();
+
+        auto & sln = prob.get_solution_vector_local();
+        sln.set_values({ 0, 1, 2 }, { 10., 11., 12. });
+        auto task = out->create_output_task();
+        ASSERT_TRUE(task);
+        // snapshot must not see later changes
+        sln.set_values({ 0, 1, 2 }, { 0., 0., 0. });
+        task();
+    }
+
+    {
+        exodusIIcpp::File exo("async.exo", exodusIIcpp::FileAccess::READ);
+        exo.read();
+        EXPECT_EQ(exo.get_num_times(), 2);
+
+        auto vals = exo.get_nodal_variable_values(2, 1);
+        ASSERT_EQ(vals.size(), 3);
+        EXPECT_NEAR(vals[0], 10., 1e-10);
+        EXPECT_NEAR(vals[1], 11., 1e-10);
+        EXPECT_NEAR(vals[2], 12., 1e-10);
+    }
+}
@@ -7,6 +7,7 @@
 #include "godzilla/Output.h"
 #include "TestApp.h"
 #include "godzilla/Types.h"
+#include <cmath>
 
 using namespace godzilla;
 
@@ -269,6 +270,89 @@ TEST(ExplicitFELinearProblemTest, solve_w_lumped_mass_matrix)
     EXPECT_NEAR(lx[3], 1., 1e-15);
 }
 
+TEST(ExplicitFELinearProblemTest, solve_w_overlap_communication)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<LineMesh>();
+    mesh_pars.set<Int>("nx", 3);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+    auto prob_pars = app.make_parameters<TestExplicitFELinearProblem>();
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh))
+        .set<Real>("start_time", 0.)
+        .set<Real>("end_time", 1e-3)
+        .set<Real>("dt", 1e-3)
+        .set<bool>("overlap_communication", true);
+    auto prob = app.make_problem<TestExplicitFELinearProblem>(prob_pars);
+
+    auto bc_left_pars = app.make_parameters<DirichletBC>();
+    bc_left_pars.set<Ref<App>>("app", ref(app));
+    bc_left_pars.set<std::vector<String>>("boundary", { "left" });
+    prob->add_boundary_condition<DirichletBC>(bc_left_pars);
+
+    auto bc_right_pars = app.make_parameters<DirichletBC>();
+    bc_right_pars.set<Ref<App>>("app", ref(app));
+    bc_right_pars.set<std::vector<String>>("boundary", { "right" });
+    prob->add_boundary_condition<DirichletBC>(bc_right_pars);
+
+    prob->create_w_lumped_mass_matrix();
+
+    prob->run();
+
+    EXPECT_TRUE(prob->converged());
+    EXPECT_EQ(prob->get_step_num(), 1);
+
+    auto sln = prob->get_solution_vector();
+    auto x = sln.borrow_array_read();
+    EXPECT_NEAR(x[0], 0.0095, 1e-15);
+    EXPECT_NEAR(x[1], 0.0085, 1e-15);
+}
+
+TEST(ExplicitFELinearProblemTest, rhs_w_overlap_communication)
+{
+    // overlapped and blocking evaluation give the same residual (in parallel, too)
+    TestApp app;
+
+    std::vector<Qtr<LineMesh>> meshes;
+    std::vector<Qtr<TestExplicitFELinearProblem>> probs;
+    for (auto overlap : { false, true }) {
+        auto mesh_pars = app.make_parameters<LineMesh>();
+        mesh_pars.set<Int>("nx", 20);
+        auto & mesh = meshes.emplace_back(MeshFactory::create<LineMesh>(mesh_pars));
+
+        auto prob_pars = app.make_parameters<TestExplicitFELinearProblem>();
+        prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh))
+            .set<Real>("start_time", 0.)
+            .set<Real>("end_time", 1e-3)
+            .set<Real>("dt", 1e-3)
+            .set<bool>("overlap_communication", overlap);
+        auto & prob = probs.emplace_back(Qtr<TestExplicitFELinearProblem>::alloc(prob_pars));
+
+        auto bc_pars = app.make_parameters<DirichletBC>();
+        bc_pars.set<Ref<App>>("app", ref(app));
+        bc_pars.set<std::vector<String>>("boundary", { "left" });
+        prob->add_boundary_condition<DirichletBC>(bc_pars);
+
+        prob->create_w_lumped_mass_matrix();
+    }
+
+    std::vector<Vector> res;
+    for (auto & prob : probs) {
+        auto x = prob->get_solution_vector().duplicate();
+        auto rng = x.get_ownership_range();
+        for (auto i = rng.first(); i < rng.last(); ++i)
+            x.set_value(i, std::sin(0.1 * i));
+        x.assemble();
+        auto & F = res.emplace_back(x.duplicate());
+        PETSC_CHECK(TSComputeRHSFunction(prob->get_ts(), 0., x, F));
+        // second evaluation reuses the overlap sets
+        PETSC_CHECK(TSComputeRHSFunction(prob->get_ts(), 0., x, F));
+    }
+    axpy(res[1], -1., res[0]);
+    EXPECT_NEAR(res[1].norm(NORM_INFINITY), 0., 1e-12);
+}
+
 TEST(ExplicitFELinearProblemTest, allocate_mass_matrix)
 {
     TestApp app;
@@ -103,6 +103,36 @@ protected:
     }
 };
 
+class TestBatchedFVLinearProblem : public TestExplicitFVLinearProblem {
+public:
+    explicit TestBatchedFVLinearProblem(const Parameters & pars) :
+        TestExplicitFVLinearProblem(pars)
+    {
+    }
+
+    void
+    compute_flux_batch(Int n,
+                       const Real[],
+                       const Real normal[],
+                       const Scalar u_l[],
+                       const Scalar u_r[],
+                       Scalar flux[])
+    {
+        for (Int i = 0; i < n; ++i) {
+            Real wn = 0.5 * normal[i];
+            flux[i] = (wn > 0 ? u_l[i] : u_r[i]) * wn;
+        }
+    }
+
+protected:
+    void
+    set_up_weak_form() override
+    {
+        TestExplicitFVLinearProblem::set_up_weak_form();
+        set_batched_riemann_solver(ref(*this), &TestBatchedFVLinearProblem::compute_flux_batch);
+    }
+};
+
 } // namespace
 
 TEST(ExplicitFVLinearProblemTest, api)
@@ -367,3 +397,46 @@ TEST(ExplicitFVLinearProblemTest, set_schemes)
         EXPECT_EQ(prob->get_scheme(), types[i]);
     }
 }
+
+TEST(ExplicitFVLinearProblemTest, batched_riemann_solver)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<RectangleMesh>();
+    mesh_pars.set<Int>("nx", 4);
+    mesh_pars.set<Int>("ny", 2);
+    auto mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+    auto mesh_b = MeshFactory::create<RectangleMesh>(mesh_pars);
+
+    auto prob_pars = app.make_parameters<TestExplicitFVLinearProblem>();
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh))
+        .set<Real>("start_time", 0.)
+        .set<Real>("end_time", 1e-3)
+        .set<Real>("dt", 1e-3);
+    auto prob = app.make_problem<TestExplicitFVLinearProblem>(prob_pars);
+    prob->create();
+
+    auto prob_b_pars = app.make_parameters<TestBatchedFVLinearProblem>();
+    prob_b_pars.set<Ref<Mesh>>("mesh", ref(*mesh_b))
+        .set<Real>("start_time", 0.)
+        .set<Real>("end_time", 1e-3)
+        .set<Real>("dt", 1e-3);
+    auto prob_b = app.make_problem<TestBatchedFVLinearProblem>(prob_b_pars);
+    prob_b->create();
+    EXPECT_FALSE(prob->has_batched_riemann_solver());
+    EXPECT_TRUE(prob_b->has_batched_riemann_solver());
+
+    auto x = prob->create_global_vector();
+    auto rng = x.get_ownership_range();
+    for (auto i = rng.first(); i < rng.last(); ++i)
+        x.set_value(i, 1. + i * i);
+    x.assemble();
+
+    auto F = prob->create_global_vector();
+    prob->compute_rhs(0., x, F);
+    auto F_b = prob_b->create_global_vector();
+    prob_b->compute_rhs(0., x, F_b);
+
+    for (auto i = rng.first(); i < rng.last(); ++i)
+        EXPECT_NEAR(F_b(i), F(i), 1e-12);
+}
@@ -10,6 +10,9 @@
 #include "godzilla/InitialCondition.h"
 #include "godzilla/ConstantInitialCondition.h"
 #include "godzilla/BoundaryCondition.h"
+#include "godzilla/PerfLog.h"
+#include "godzilla/ResidualFunc.h"
+#include "godzilla/JacobianFunc.h"
 #include "ExceptionTestMacros.h"
 #include "petscvec.h"
 
@@ -48,6 +51,246 @@ public:
     }
 };
 
+/// Same problem as GTestFENonlinearProblem, but with batched functionals
+class BatchedF0 : public ResidualFunc {
+public:
+    explicit BatchedF0(Ref<FEProblemInterface> fepi) : ResidualFunc(fepi) {}
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        f[0] = 2.0;
+    }
+
+    bool
+    is_batched() const override
+    {
+        return true;
+    }
+
+    void
+    evaluate_batch(const QuadratureBatch & batch, Scalar f[]) const override
+    {
+        for (Int p = 0; p < batch.n; ++p)
+            f[p] = 2.0;
+    }
+};
+
+class BatchedF1 : public ResidualFunc {
+public:
+    explicit BatchedF1(Ref<FEProblemInterface> fepi) :
+        ResidualFunc(fepi),
+        dim(get_spatial_dimension()),
+        u_x(get_field_gradient("u")),
+        u_b(get_batch_field("u"))
+    {
+    }
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            f[d] = this->u_x(d);
+    }
+
+    bool
+    is_batched() const override
+    {
+        return true;
+    }
+
+    void
+    evaluate_batch(const QuadratureBatch & batch, Scalar f[]) const override
+    {
+        for (Int d = 0; d < batch.dim; ++d) {
+            const Scalar * u_x = batch.gradient(this->u_b, 0, d);
+            for (Int p = 0; p < batch.n; ++p)
+                f[d * batch.n + p] = u_x[p];
+        }
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldGradient & u_x;
+    const BatchField & u_b;
+};
+
+class BatchedG3 : public JacobianFunc {
+public:
+    explicit BatchedG3(Ref<FEProblemInterface> fepi) :
+        JacobianFunc(fepi),
+        dim(get_spatial_dimension())
+    {
+    }
+
+    void
+    evaluate(Scalar g[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            g[d * this->dim + d] = 1.;
+    }
+
+    bool
+    is_batched() const override
+    {
+        return true;
+    }
+
+    void
+    evaluate_batch(const QuadratureBatch & batch, Scalar g[]) const override
+    {
+        for (Int d = 0; d < batch.dim; ++d)
+            for (Int p = 0; p < batch.n; ++p)
+                g[(d * batch.dim + d) * batch.n + p] = 1.;
+    }
+
+protected:
+    const Dimension & dim;
+};
+
+class GTestBatchedFENonlinearProblem : public GTestFENonlinearProblem {
+public:
+    explicit GTestBatchedFENonlinearProblem(const Parameters & pars) :
+        GTestFENonlinearProblem(pars)
+    {
+    }
+
+protected:
+    void
+    set_up_weak_form() override
+    {
+        add_residual_block(this->iu, new BatchedF0(ref(*this)), new BatchedF1(ref(*this)));
+        add_jacobian_block(this->iu,
+                           this->iu,
+                           nullptr,
+                           nullptr,
+                           nullptr,
+                           new BatchedG3(ref(*this)));
+    }
+};
+
+/// Same problem as GTestFENonlinearProblem, but with the Jacobian split into the regions of the
+/// `blocks` label
+class GTestRegionsFENonlinearProblem : public GTestFENonlinearProblem {
+public:
+    explicit GTestRegionsFENonlinearProblem(const Parameters & pars) :
+        GTestFENonlinearProblem(pars)
+    {
+    }
+
+protected:
+    void
+    set_up_weak_form() override
+    {
+        add_residual_block(this->iu, new BatchedF0(ref(*this)), new BatchedF1(ref(*this)));
+        add_jacobian_block(this->iu,
+                           this->iu,
+                           nullptr,
+                           nullptr,
+                           nullptr,
+                           new BatchedG3(ref(*this)),
+                           "blocks");
+    }
+};
+
+/// Nonlinear problem `-u'' + u^3 + 2 = 0`
+class CubicF0 : public ResidualFunc {
+public:
+    explicit CubicF0(Ref<FEProblemInterface> fepi) :
+        ResidualFunc(fepi),
+        u(get_field_value("u"))
+    {
+    }
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        f[0] = this->u(0) * this->u(0) * this->u(0) + 2.0;
+    }
+
+protected:
+    const FieldValue & u;
+};
+
+class CubicF1 : public ResidualFunc {
+public:
+    explicit CubicF1(Ref<FEProblemInterface> fepi) :
+        ResidualFunc(fepi),
+        dim(get_spatial_dimension()),
+        u_x(get_field_gradient("u"))
+    {
+    }
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            f[d] = this->u_x(d);
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldGradient & u_x;
+};
+
+class CubicG0 : public JacobianFunc {
+public:
+    explicit CubicG0(Ref<FEProblemInterface> fepi) :
+        JacobianFunc(fepi),
+        u(get_field_value("u"))
+    {
+    }
+
+    void
+    evaluate(Scalar g[]) const override
+    {
+        g[0] = 3. * this->u(0) * this->u(0);
+    }
+
+protected:
+    const FieldValue & u;
+};
+
+class CubicG3 : public JacobianFunc {
+public:
+    explicit CubicG3(Ref<FEProblemInterface> fepi) :
+        JacobianFunc(fepi),
+        dim(get_spatial_dimension())
+    {
+    }
+
+    void
+    evaluate(Scalar g[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            g[d * this->dim + d] = 1.;
+    }
+
+protected:
+    const Dimension & dim;
+};
+
+class GTestCubicFENonlinearProblem : public GTestFENonlinearProblem {
+public:
+    explicit GTestCubicFENonlinearProblem(const Parameters & pars) :
+        GTestFENonlinearProblem(pars)
+    {
+    }
+
+protected:
+    void
+    set_up_weak_form() override
+    {
+        add_residual_block(this->iu, new CubicF0(ref(*this)), new CubicF1(ref(*this)));
+        add_jacobian_block(this->iu,
+                           this->iu,
+                           new CubicG0(ref(*this)),
+                           nullptr,
+                           nullptr,
+                           new CubicG3(ref(*this)));
+    }
+};
+
 } // namespace
 
 TEST_F(FENonlinearProblemTest, fields)
@@ -223,6 +466,293 @@ TEST_F(FENonlinearProblemTest, solve)
     EXPECT_DOUBLE_EQ(x(0), 0.25);
 }
 
+TEST_F(FENonlinearProblemTest, geometry_cache)
+{
+    auto num_calls = [](const String & name) {
+        return perf_log::is_event_registered(name) ? perf_log::get_event_info(name).num_calls()
+                                                   : 0;
+    };
+
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+
+    auto n_hits = num_calls("FEProblemInterface::GeometryCacheHit");
+    auto n_misses = num_calls("FEProblemInterface::GeometryCacheMiss");
+    prob->run();
+    EXPECT_TRUE(prob->converged());
+    // geometry is computed once and reused by all subsequent residual and Jacobian evaluations
+    EXPECT_EQ(num_calls("FEProblemInterface::GeometryCacheMiss") - n_misses, 1);
+    EXPECT_GE(num_calls("FEProblemInterface::GeometryCacheHit") - n_hits, 2);
+}
+
+TEST_F(FENonlinearProblemTest, region_cache)
+{
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+    prob->create();
+    auto mesh = prob->get_mesh();
+
+    auto & cells = prob->get_region_cells(WeakForm::Region());
+    EXPECT_TRUE(cells.equal(mesh->get_all_cells()));
+    // parts of a region share the cached cells
+    EXPECT_EQ(&prob->get_region_cells(WeakForm::Region(Label(), 0, 100)), &cells);
+
+    auto left = mesh->get_label("left");
+    auto & facets = prob->get_boundary_facets(left, 1);
+    EXPECT_EQ(facets.get_local_size(), 1);
+    EXPECT_EQ(&prob->get_boundary_facets(left, 1), &facets);
+    EXPECT_TRUE(prob->get_boundary_facets(left, 2).is_null());
+
+    prob->invalidate_region_cache();
+    EXPECT_TRUE(prob->get_region_cells(WeakForm::Region()).equal(cells));
+}
+
+TEST_F(FENonlinearProblemTest, region_cache_label_change)
+{
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+    prob->create();
+    auto mesh = prob->get_mesh();
+
+    mesh->create_label("blocks");
+    auto blocks = mesh->get_label("blocks");
+    blocks.set_value(0, 1);
+    WeakForm::Region region(blocks, 1, 0);
+    EXPECT_EQ(prob->get_region_cells(region).get_local_size(), 1);
+
+    // cached cells follow the label without an explicit invalidation
+    blocks.set_value(1, 1);
+    EXPECT_EQ(prob->get_region_cells(region).get_local_size(), 2);
+
+    auto left = mesh->get_label("left");
+    EXPECT_EQ(prob->get_boundary_facets(left, 1).get_local_size(), 1);
+    left.set_value(4, 1);
+    EXPECT_EQ(prob->get_boundary_facets(left, 1).get_local_size(), 2);
+}
+
+TEST_F(FENonlinearProblemTest, perf_log_events)
+{
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+
+    auto info = [](perf_log::EventID id) { return perf_log::get_event_info(id); };
+    auto n_res = info(perf_log::event::compute_residual).num_calls();
+    auto n_jac = info(perf_log::event::compute_jacobian).num_calls();
+    auto n_int_res = info(perf_log::event::integrate_residual).num_calls();
+    auto res_flops = info(perf_log::event::integrate_residual).flops();
+    auto jac_flops = info(perf_log::event::integrate_jacobian).flops();
+    prob->run();
+    EXPECT_TRUE(prob->converged());
+    EXPECT_GT(info(perf_log::event::compute_residual).num_calls(), n_res);
+    EXPECT_GT(info(perf_log::event::compute_jacobian).num_calls(), n_jac);
+    EXPECT_GT(info(perf_log::event::integrate_residual).num_calls(), n_int_res);
+    EXPECT_GT(info(perf_log::event::integrate_residual).flops(), res_flops);
+    EXPECT_GT(info(perf_log::event::integrate_jacobian).flops(), jac_flops);
+}
+
+TEST_F(FENonlinearProblemTest, solve_threaded_assembly)
+{
+    auto prob = this->app->get_problem<GTestFENonlinearProblem>();
+    prob->set_num_assembly_threads(2);
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+
+    // each color is timed by its own event
+    auto color_calls = [](Int color) {
+        auto name = fmt::format("FENonlinearProblem::JacobianColor{}", color);
+        if (!perf_log::is_event_registered(name.c_str()))
+            return 0;
+        return perf_log::get_event_info(perf_log::get_event_id(name.c_str())).num_calls();
+    };
+    auto n_color0_calls = color_calls(0);
+    auto n_color1_calls = color_calls(1);
+    prob->run();
+
+    EXPECT_TRUE(prob->converged());
+    auto x = prob->get_solution_vector();
+    EXPECT_DOUBLE_EQ(x(0), 0.25);
+    // assembly is serial with PETSc debug builds that are not thread-safe
+    if (prob->get_num_assembly_threads() > 1) {
+        EXPECT_GT(color_calls(0), n_color0_calls);
+        EXPECT_GT(color_calls(1), n_color1_calls);
+    }
+}
+
+TEST_F(FENonlinearProblemTest, solve_coo_assembly)
+{
+    auto pars = this->app->make_parameters<GTestFENonlinearProblem>();
+    pars.set<Ref<Mesh>>("mesh", ref(*this->mesh)).set<bool>("coo_assembly", true);
+    auto prob = this->app->make_problem<GTestFENonlinearProblem>(pars);
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+
+    // the solver assembles into the matrix with the COO pattern
+    Mat J;
+    PETSC_CHECK(SNESGetJacobian(prob->get_snes(), &J, nullptr, nullptr, nullptr));
+    EXPECT_EQ(J, (Mat) prob->get_jacobian());
+
+    prob->run();
+
+    EXPECT_TRUE(prob->converged());
+    auto x = prob->get_solution_vector();
+    EXPECT_DOUBLE_EQ(x(0), 0.25);
+}
+
+TEST_F(FENonlinearProblemTest, solve_coo_assembly_regions)
+{
+    this->mesh->create_label("blocks");
+    auto blocks = this->mesh->get_label("blocks");
+    blocks.set_value(0, 1);
+    blocks.set_value(1, 2);
+
+    auto pars = this->app->make_parameters<GTestRegionsFENonlinearProblem>();
+    pars.set<Ref<Mesh>>("mesh", ref(*this->mesh)).set<bool>("coo_assembly", true);
+    auto prob = this->app->make_problem<GTestRegionsFENonlinearProblem>(pars);
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+    EXPECT_EQ(prob->get_weak_form().get_jacobian_regions().size(), 2);
+
+    prob->run();
+
+    EXPECT_TRUE(prob->converged());
+    auto x = prob->get_solution_vector();
+    EXPECT_NEAR(x(0), 0.25, 1e-10);
+}
+
+TEST_F(FENonlinearProblemTest, solve_matrix_free)
+{
+    auto pars = this->app->make_parameters<GTestFENonlinearProblem>();
+    pars.set<Ref<Mesh>>("mesh", ref(*this->mesh)).set<bool>("matrix_free", true);
+    auto prob = this->app->make_problem<GTestFENonlinearProblem>(pars);
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+
+    // the solver applies the Jacobian through a shell matrix
+    Mat J;
+    PETSC_CHECK(SNESGetJacobian(prob->get_snes(), &J, nullptr, nullptr, nullptr));
+    MatType type;
+    PETSC_CHECK(MatGetType(J, &type));
+    EXPECT_STREQ(type, MATSHELL);
+
+    prob->run();
+
+    EXPECT_TRUE(prob->converged());
+    auto x = prob->get_solution_vector();
+    EXPECT_NEAR(x(0), 0.25, 1e-10);
+}
+
+TEST_F(FENonlinearProblemTest, matrix_free_nonlinear_iterations)
+{
+    // with an exact Jacobian action, Newton converges like with the assembled Jacobian
+    std::vector<Qtr<LineMesh>> meshes;
+    std::vector<Qtr<GTestCubicFENonlinearProblem>> probs;
+    for (auto matrix_free : { false, true }) {
+        auto mesh_pars = this->app->make_parameters<LineMesh>();
+        mesh_pars.set<Int>("nx", 10);
+        auto & mesh = meshes.emplace_back(MeshFactory::create<LineMesh>(mesh_pars));
+
+        auto pars = this->app->make_parameters<GTestCubicFENonlinearProblem>();
+        pars.set<Ref<Mesh>>("mesh", ref(*mesh))
+            .set<bool>("matrix_free", matrix_free)
+            .set<Real>("lin_rel_tol", 1e-12);
+        auto & prob = probs.emplace_back(Qtr<GTestCubicFENonlinearProblem>::alloc(pars));
+
+        auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+        ic_pars.set<std::vector<Real>>("value", { 0.1 });
+        prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+        auto bc_pars = this->app->make_parameters<DirichletBC>();
+        bc_pars.set<std::vector<String>>("boundary", { "left", "right" });
+        prob->add_boundary_condition<DirichletBC>(bc_pars);
+        prob->create();
+        prob->run();
+        EXPECT_TRUE(prob->converged());
+    }
+
+    auto n_its = probs[0]->get_snes().get_iteration_number();
+    EXPECT_GT(n_its, 1);
+    EXPECT_EQ(probs[1]->get_snes().get_iteration_number(), n_its);
+
+    auto x = probs[1]->get_solution_vector().duplicate();
+    copy(probs[1]->get_solution_vector(), x);
+    axpy(x, -1., probs[0]->get_solution_vector());
+    EXPECT_NEAR(x.norm(NORM_INFINITY), 0., 1e-8);
+}
+
+TEST_F(FENonlinearProblemTest, matrix_free_with_coo_assembly)
+{
+    auto pars = this->app->make_parameters<GTestFENonlinearProblem>();
+    pars.set<Ref<Mesh>>("mesh", ref(*this->mesh))
+        .set<bool>("coo_assembly", true)
+        .set<bool>("matrix_free", true);
+    EXPECT_DEATH(this->app->make_problem<GTestFENonlinearProblem>(pars),
+                 "Parameters 'coo_assembly' and 'matrix_free' cannot be used together.");
+}
+
+TEST_F(FENonlinearProblemTest, solve_batched)
+{
+    auto pars = this->app->make_parameters<GTestBatchedFENonlinearProblem>();
+    pars.set<Ref<Mesh>>("mesh", ref(*this->mesh));
+    auto prob = this->app->make_problem<GTestBatchedFENonlinearProblem>(pars);
+
+    auto ic_pars = this->app->make_parameters<ConstantInitialCondition>();
+    ic_pars.set<std::vector<Real>>("value", { 0.1 });
+    prob->add_initial_condition<ConstantInitialCondition>(ic_pars);
+
+    auto params = this->app->make_parameters<DirichletBC>();
+    params.set<std::vector<String>>("boundary", { "left", "right" });
+    prob->add_boundary_condition<DirichletBC>(params);
+    prob->create();
+
+    prob->run();
+
+    EXPECT_TRUE(prob->converged());
+    auto x = prob->get_solution_vector();
+    EXPECT_DOUBLE_EQ(x(0), 0.25);
+}
+
 TEST_F(FENonlinearProblemTest, solve_no_ic)
 {
     auto prob = this->app->get_problem<GTestFENonlinearProblem>();
@@ -0,0 +1,121 @@
+#include "gmock/gmock.h"
+#include "TestApp.h"
+#include "godzilla/FVFaceList.h"
+#include "godzilla/MeshFactory.h"
+#include "godzilla/RectangleMesh.h"
+#include "petscdmplex.h"
+#include <cmath>
+
+using namespace godzilla;
+
+TEST(FVFaceListTest, create)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<RectangleMesh>();
+    mesh_pars.set<Int>("nx", 2);
+    mesh_pars.set<Int>("ny", 1);
+    auto mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+    mesh->construct_ghost_cells();
+
+    // one dof per cell, including ghost cells
+    auto dm = mesh->get_dm();
+    PetscSection section;
+    PETSC_CHECK(PetscSectionCreate(app.get_comm(), &section));
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+    PETSC_CHECK(PetscSectionSetChart(section, c_start, c_end));
+    for (Int c = c_start; c < c_end; ++c)
+        PETSC_CHECK(PetscSectionSetDof(section, c, 1));
+    PETSC_CHECK(PetscSectionSetUp(section));
+    PETSC_CHECK(DMSetLocalSection(dm, section));
+    PETSC_CHECK(PetscSectionDestroy(&section));
+
+    FVFaceList fl;
+    EXPECT_FALSE(fl.is_created());
+    EXPECT_FALSE(fl.is_up_to_date(dm));
+    fl.create(dm, 4);
+    EXPECT_TRUE(fl.is_created());
+    EXPECT_TRUE(fl.is_up_to_date(dm));
+
+    EXPECT_EQ(fl.get_num_faces(), 7);
+    EXPECT_EQ(fl.get_num_interior_faces(), 1);
+    ASSERT_EQ(fl.get_num_blocks(), 3);
+    EXPECT_EQ(fl.get_block(0).size(), 1);
+    EXPECT_EQ(fl.get_block(1).size(), 4);
+    EXPECT_EQ(fl.get_block(2).size(), 2);
+    EXPECT_FALSE(fl.is_boundary_block(0));
+    EXPECT_TRUE(fl.is_boundary_block(1));
+    EXPECT_TRUE(fl.is_boundary_block(2));
+
+    // interior face
+    auto centroid = fl.get_centroids(0);
+    EXPECT_DOUBLE_EQ(centroid[0], 0.5);
+    EXPECT_DOUBLE_EQ(centroid[1], 0.5);
+    EXPECT_DOUBLE_EQ(fl.get_areas()[0], 1.);
+    EXPECT_DOUBLE_EQ(std::abs(fl.get_normals(0)[0]), 1.);
+    EXPECT_DOUBLE_EQ(fl.get_left_inv_volumes()[0], 2.);
+    EXPECT_DOUBLE_EQ(fl.get_right_inv_volumes()[0], 2.);
+    EXPECT_THAT((std::vector<Int> { fl.get_left_cells()[0], fl.get_right_cells()[0] }),
+                testing::UnorderedElementsAre(0, 1));
+
+    // boundary faces have the ghost cell on the right
+    auto ghost_range = mesh->get_ghost_cell_range();
+    for (Int i = fl.get_num_interior_faces(); i < fl.get_num_faces(); ++i) {
+        EXPECT_LT(fl.get_left_cells()[i], ghost_range.first());
+        EXPECT_GE(fl.get_right_cells()[i], ghost_range.first());
+        EXPECT_EQ(fl.get_left_offsets()[i], fl.get_left_cells()[i] - c_start);
+    }
+
+    // normals of boundary faces point out of the domain
+    for (Int blk = 1; blk < fl.get_num_blocks(); ++blk) {
+        auto rng = fl.get_block(blk);
+        Int n = rng.size();
+        auto x = fl.get_centroids(blk);
+        auto nrm = fl.get_normals(blk);
+        for (Int i = 0; i < n; ++i) {
+            auto dot = (x[i] - 0.5) * nrm[i] + (x[n + i] - 0.5) * nrm[n + i];
+            EXPECT_GT(dot, 0.);
+        }
+    }
+}
+
+TEST(FVFaceListTest, is_up_to_date)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<RectangleMesh>();
+    mesh_pars.set<Int>("nx", 2);
+    mesh_pars.set<Int>("ny", 1);
+    auto mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+    mesh->construct_ghost_cells();
+
+    auto dm = mesh->get_dm();
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+    auto set_section = [&](Int n_dofs) {
+        PetscSection section;
+        PETSC_CHECK(PetscSectionCreate(app.get_comm(), &section));
+        PETSC_CHECK(PetscSectionSetChart(section, c_start, c_end));
+        for (Int c = c_start; c < c_end; ++c)
+            PETSC_CHECK(PetscSectionSetDof(section, c, n_dofs));
+        PETSC_CHECK(PetscSectionSetUp(section));
+        PETSC_CHECK(DMSetLocalSection(dm, section));
+        PETSC_CHECK(PetscSectionDestroy(&section));
+    };
+
+    set_section(1);
+    FVFaceList fl;
+    fl.create(dm, 4);
+    EXPECT_TRUE(fl.is_up_to_date(dm));
+    for (Int i = 0; i < fl.get_num_faces(); ++i)
+        EXPECT_EQ(fl.get_left_offsets()[i], fl.get_left_cells()[i] - c_start);
+
+    // new DoF layout
+    set_section(2);
+    EXPECT_FALSE(fl.is_up_to_date(dm));
+    fl.create(dm, 4);
+    EXPECT_TRUE(fl.is_up_to_date(dm));
+    for (Int i = 0; i < fl.get_num_faces(); ++i)
+        EXPECT_EQ(fl.get_left_offsets()[i], 2 * (fl.get_left_cells()[i] - c_start));
+}
@@ -0,0 +1,201 @@
+#include "gmock/gmock.h"
+#include "TestApp.h"
+#include "godzilla/FVReconstruction.h"
+#include "godzilla/MeshFactory.h"
+#include "godzilla/RectangleMesh.h"
+#include "godzilla/UnstructuredMesh.h"
+#include "petscdmplex.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <set>
+
+using namespace godzilla;
+
+namespace {
+
+/// Set up an `n`x`n` mesh with ghost cells and one dof per cell
+///
+/// @param overlap Partition overlap, the mesh is not distributed if negative
+Qtr<UnstructuredMesh>
+create_mesh(App & app, Int n = 4, Int overlap = -1)
+{
+    auto mesh_pars = app.make_parameters<RectangleMesh>();
+    mesh_pars.set<Int>("nx", n);
+    mesh_pars.set<Int>("ny", n);
+    Qtr<UnstructuredMesh> mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+    if (overlap >= 0)
+        mesh->distribute(overlap);
+    mesh->construct_ghost_cells();
+
+    auto dm = mesh->get_dm();
+    PetscSection section;
+    PETSC_CHECK(PetscSectionCreate(app.get_comm(), &section));
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+    PETSC_CHECK(PetscSectionSetChart(section, c_start, c_end));
+    for (Int c = c_start; c < c_end; ++c)
+        PETSC_CHECK(PetscSectionSetDof(section, c, 1));
+    PETSC_CHECK(PetscSectionSetUp(section));
+    PETSC_CHECK(DMSetLocalSection(dm, section));
+    PETSC_CHECK(PetscSectionDestroy(&section));
+    return mesh;
+}
+
+/// Evaluate `fn` at centroids of all cells (including ghost cells)
+std::vector<Scalar>
+eval_at_centroids(DM dm, std::function<Real(const Real *)> fn)
+{
+    Vec face_geom, cell_geom;
+    Real min_radius;
+    PETSC_CHECK(DMPlexGetGeometryFVM(dm, &face_geom, &cell_geom, &min_radius));
+    DM dm_cell;
+    PETSC_CHECK(VecGetDM(cell_geom, &dm_cell));
+    const Scalar * cgeom;
+    PETSC_CHECK(VecGetArrayRead(cell_geom, &cgeom));
+    Int c_start, c_end;
+    PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+    std::vector<Scalar> x(c_end - c_start);
+    for (Int c = c_start; c < c_end; ++c) {
+        PetscFVCellGeom * cg;
+        PETSC_CHECK(DMPlexPointLocalRead(dm_cell, c, cgeom, &cg));
+        x[c - c_start] = fn(cg->centroid);
+    }
+    PETSC_CHECK(VecRestoreArrayRead(cell_geom, &cgeom));
+    return x;
+}
+
+} // namespace
+
+TEST(FVReconstructionTest, linear_field)
+{
+    TestApp app;
+    auto mesh = create_mesh(app);
+    auto dm = mesh->get_dm();
+
+    FVFaceList fl;
+    fl.create(dm, 8);
+    auto x = eval_at_centroids(dm, [](const Real * xc) { return 2. * xc[0] + 3. * xc[1]; });
+
+    for (auto lim : { FVReconstruction::Limiter::NONE,
+                      FVReconstruction::Limiter::BARTH_JESPERSEN,
+                      FVReconstruction::Limiter::VENKATAKRISHNAN }) {
+        FVReconstruction recon;
+        EXPECT_FALSE(recon.is_created());
+        recon.create(dm, fl, 1, lim);
+        EXPECT_TRUE(recon.is_created());
+        recon.compute_gradients(x.data());
+
+        // least squares is exact for linear fields and limiters do not clip smooth data
+        auto ghost_range = mesh->get_ghost_cell_range();
+        for (Int c = 0; c < ghost_range.first(); ++c) {
+            auto grad = recon.get_gradient(c);
+            EXPECT_NEAR(grad[0], 2., 1e-12);
+            EXPECT_NEAR(grad[1], 3., 1e-12);
+        }
+
+        // left states are the exact values at face centroids
+        std::vector<Scalar> u_l(8), u_r(8);
+        for (Int blk = 0; blk < fl.get_num_blocks(); ++blk) {
+            Int n = fl.get_block(blk).size();
+            recon.reconstruct(fl, blk, x.data(), u_l.data(), u_r.data());
+            auto xf = fl.get_centroids(blk);
+            for (Int i = 0; i < n; ++i)
+                EXPECT_NEAR(u_l[i], 2. * xf[i] + 3. * xf[n + i], 1e-12);
+        }
+    }
+}
+
+TEST(FVReconstructionTest, barth_jespersen_step)
+{
+    TestApp app;
+    auto mesh = create_mesh(app);
+    auto dm = mesh->get_dm();
+
+    FVFaceList fl;
+    fl.create(dm, 8);
+    auto x = eval_at_centroids(dm, [](const Real * xc) { return xc[0] < 0.5 ? 1. : 0.; });
+
+    FVReconstruction recon;
+    recon.create(dm, fl, 1, FVReconstruction::Limiter::BARTH_JESPERSEN);
+    recon.compute_gradients(x.data());
+
+    // reconstructed states must not create new extrema
+    std::vector<Scalar> u_l(8), u_r(8);
+    for (Int blk = 0; blk < fl.get_num_blocks(); ++blk) {
+        Int n = fl.get_block(blk).size();
+        recon.reconstruct(fl, blk, x.data(), u_l.data(), u_r.data());
+        for (Int i = 0; i < n; ++i) {
+            EXPECT_GE(u_l[i], -1e-12);
+            EXPECT_LE(u_l[i], 1. + 1e-12);
+            EXPECT_GE(u_r[i], -1e-12);
+            EXPECT_LE(u_r[i], 1. + 1e-12);
+        }
+    }
+}
+
+TEST(FVReconstructionTest, parallel_matches_serial)
+{
+    // gradients of owned cells must not depend on the partitioning
+    TestApp app;
+    auto fn = [](const Real * xc) { return xc[0] * xc[0] + xc[0] * xc[1]; };
+
+    struct CellGrad {
+        Real xc[2];
+        Scalar grad[2];
+    };
+    auto compute = [&](UnstructuredMesh & mesh, FVReconstruction::Limiter lim) {
+        auto dm = mesh.get_dm();
+        FVFaceList fl;
+        fl.create(dm, 8);
+        auto x = eval_at_centroids(dm, fn);
+        FVReconstruction recon;
+        recon.create(dm, fl, 1, lim);
+        recon.compute_gradients(x.data());
+
+        PetscSF sf;
+        PETSC_CHECK(DMGetPointSF(dm, &sf));
+        Int n_leaves;
+        const Int * leaves;
+        PETSC_CHECK(PetscSFGetGraph(sf, nullptr, &n_leaves, &leaves, nullptr));
+        std::set<Int> not_owned;
+        for (Int i = 0; i < std::max<Int>(n_leaves, 0); ++i)
+            not_owned.insert(leaves ? leaves[i] : i);
+
+        std::vector<CellGrad> res;
+        auto ghost_range = mesh.get_ghost_cell_range();
+        Int c_start, c_end;
+        PETSC_CHECK(DMPlexGetHeightStratum(dm, 0, &c_start, &c_end));
+        for (Int c = c_start; c < ghost_range.first(); ++c) {
+            if (not_owned.contains(c))
+                continue;
+            CellGrad cg;
+            Real vol;
+            PETSC_CHECK(DMPlexComputeCellGeometryFVM(dm, c, &vol, cg.xc, nullptr));
+            auto g = recon.get_gradient(c);
+            cg.grad[0] = g[0];
+            cg.grad[1] = g[1];
+            res.push_back(cg);
+        }
+        return res;
+    };
+
+    App serial_app(mpi::Communicator(MPI_COMM_SELF), "fv_reconstruction_serial");
+    auto serial_mesh = create_mesh(serial_app, 8);
+    auto mesh = create_mesh(app, 8, 1);
+
+    for (auto lim : { FVReconstruction::Limiter::NONE,
+                      FVReconstruction::Limiter::BARTH_JESPERSEN }) {
+        auto serial = compute(*serial_mesh, lim);
+        auto par = compute(*mesh, lim);
+        for (auto & pc : par) {
+            auto it = std::find_if(serial.begin(), serial.end(), [&](const CellGrad & sc) {
+                return std::abs(sc.xc[0] - pc.xc[0]) < 1e-12 &&
+                       std::abs(sc.xc[1] - pc.xc[1]) < 1e-12;
+            });
+            ASSERT_NE(it, serial.end());
+            EXPECT_NEAR(pc.grad[0], it->grad[0], 1e-12);
+            EXPECT_NEAR(pc.grad[1], it->grad[1], 1e-12);
+        }
+    }
+}
@@ -43,3 +43,56 @@ TEST(FileMesh, unknown_mesh_format)
     mesh_pars.set<fs::path>("file", file);
     EXPECT_DEATH(MeshFactory::create<FileMesh>(mesh_pars), "Unknown mesh format");
 }
+
+TEST(FileMesh, exoii_parallel_read)
+{
+    TestApp app;
+
+    auto file = fs::path(GODZILLA_UNIT_TESTS_ROOT) / "assets" / "mesh" / "2blk.exo";
+
+    auto mesh_pars = app.make_parameters<FileMesh>();
+    mesh_pars.set<fs::path>("file", file);
+    auto mesh = MeshFactory::create<FileMesh>(mesh_pars);
+
+    auto par_mesh_pars = app.make_parameters<FileMesh>();
+    par_mesh_pars.set<fs::path>("file", file);
+    par_mesh_pars.set<bool>("parallel_read", true);
+    auto par_mesh = MeshFactory::create<FileMesh>(par_mesh_pars);
+
+    EXPECT_EQ(par_mesh->get_dimension(), mesh->get_dimension());
+    EXPECT_EQ(par_mesh->get_num_cells(), mesh->get_num_cells());
+    EXPECT_EQ(par_mesh->get_num_vertices(), mesh->get_num_vertices());
+    EXPECT_EQ(par_mesh->get_num_cell_sets(), mesh->get_num_cell_sets());
+    EXPECT_EQ(par_mesh->get_num_face_sets(), mesh->get_num_face_sets());
+    EXPECT_EQ(par_mesh->get_num_vertex_sets(), mesh->get_num_vertex_sets());
+
+    // sets are read in slices and sent to the ranks owning their vertices and cells, the sizes of
+    // the strata summed over ranks match the serial mesh (faces shared by ranks are counted once
+    // per rank)
+    auto comm = app.get_comm();
+    // the mesh is created distributed, there is no map to a serial ordering
+    EXPECT_EQ(par_mesh->has_natural_ordering(), comm.size() == 1);
+    for (auto & [label_name, sets] : { std::pair { "Face Sets", mesh->get_face_sets() },
+                                       std::pair { "Vertex Sets", mesh->get_vertex_sets() } }) {
+        auto label = mesh->get_label(label_name);
+        auto par_label = par_mesh->get_label(label_name);
+        for (auto & [id, name] : sets) {
+            Int n = par_label.get_stratum_size(id);
+            EXPECT_EQ(par_mesh->get_label(name).get_stratum_size(id), n);
+            Int n_total;
+            comm.all_reduce(n, n_total, mpi::op::sum<Int>());
+            if (comm.size() == 1)
+                EXPECT_EQ(n_total, label.get_stratum_size(id));
+            else
+                EXPECT_GE(n_total, label.get_stratum_size(id));
+        }
+    }
+
+    auto coords = mesh->get_coordinates_local();
+    auto par_coords = par_mesh->get_coordinates_local();
+    ASSERT_EQ(par_coords.get_size(), coords.get_size());
+    auto xyz = coords.borrow_array_read();
+    auto par_xyz = par_coords.borrow_array_read();
+    for (Int i = 0; i < coords.get_size(); ++i)
+        EXPECT_DOUBLE_EQ(par_xyz[i], xyz[i]);
+}
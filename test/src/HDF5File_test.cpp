@@ -1,9 +1,11 @@
 #include "gmock/gmock.h"
 #include "TestApp.h"
 #include "godzilla/HDF5File.h"
+#include "godzilla/Vector.h"
 #include "godzilla/DenseVector.h"
 #include "godzilla/DenseMatrix.h"
 #include <array>
+#include <fstream>
 
 using namespace godzilla;
 
@@ -87,3 +89,72 @@ TEST(HDF5FileTest, write_read)
         EXPECT_EQ(my_data.read_dataset<double>("double"), 987.69);
     }
 }
+
+TEST(HDF5FileTest, write_read_global_vector_chunked)
+{
+    TestApp app;
+
+    hdf5::FileOptions opts;
+    opts.datasets.chunk_size = 4;
+    opts.datasets.compression = hdf5::Compression::DEFLATE;
+    opts.alignment = 4096;
+    opts.mpi_hints.emplace_back("romio_cb_write", "enable");
+
+    auto n = 10;
+    auto v = Vector::create_mpi(app.get_comm(), PETSC_DECIDE, n);
+    auto rng = v.get_ownership_range();
+    for (auto i = rng.first(); i < rng.last(); ++i)
+        v.set_value(i, 2. * i);
+    v.assemble();
+
+    {
+        HDF5File f(app.get_comm(), "vec.h5", FileAccess::CREATE, opts);
+        auto g = f.create_group("data");
+        g.write_global_vector("vec", v);
+    }
+
+    {
+        HDF5File f(app.get_comm(), "vec.h5", FileAccess::READ);
+        auto g = f.open_group("data");
+        auto w = Vector::create_mpi(app.get_comm(), PETSC_DECIDE, n);
+        g.read_global_vector("vec", w);
+        for (auto i = rng.first(); i < rng.last(); ++i)
+            EXPECT_DOUBLE_EQ(w(i), 2. * i);
+    }
+}
+
+TEST(HDF5FileTest, in_memory_file_options)
+{
+    TestApp app;
+
+    hdf5::FileOptions opts;
+    opts.datasets.chunk_size = 4;
+
+    auto n = 10;
+    auto v = Vector::create_seq(MPI_COMM_SELF, n);
+    for (Int i = 0; i < n; ++i)
+        v.set_value(i, 2. * i);
+    v.assemble();
+
+    std::vector<char> image;
+    {
+        HDF5File f("vec_in_memory.h5", FileAccess::CREATE_IN_MEMORY, opts);
+        auto g = f.create_group("data");
+        g.write_global_vector("vec", v);
+        image = f.get_file_image();
+    }
+    {
+        std::ofstream out("vec_in_memory.h5", std::ios::binary);
+        out.write(image.data(), image.size());
+    }
+
+    // dataset options are applied to files kept in memory too
+    auto fid = H5Fopen("vec_in_memory.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+    ASSERT_NE(fid, H5I_INVALID_HID);
+    auto dset = H5Dopen2(fid, "/data/vec", H5P_DEFAULT);
+    auto dcpl = H5Dget_create_plist(dset);
+    EXPECT_EQ(H5Pget_layout(dcpl), H5D_CHUNKED);
+    H5Pclose(dcpl);
+    H5Dclose(dset);
+    H5Fclose(fid);
+}
@@ -6,6 +6,10 @@
 #include "godzilla/ConstantInitialCondition.h"
 #include "godzilla/BoundaryCondition.h"
 #include "godzilla/TransientProblemInterface.h"
+#include "godzilla/RectangleMesh.h"
+#include "godzilla/AuxiliaryField.h"
+#include "godzilla/ResidualFunc.h"
+#include "godzilla/JacobianFunc.h"
 
 using namespace godzilla;
 
@@ -22,8 +26,233 @@ public:
     }
 };
 
+class LinearAuxField : public AuxiliaryField {
+public:
+    explicit LinearAuxField(const Parameters & pars) : AuxiliaryField(pars) {}
+
+    Int
+    get_num_components() const override
+    {
+        return 1;
+    }
+
+    void
+    evaluate(Real, const Real x[], Scalar u[]) override
+    {
+        u[0] = x[0] + 2. * x[1];
+    }
+};
+
+/// Residual `u_t + a u^2 + grad a . grad u - div((1 + a) grad u)` with auxiliary field `a`
+class AuxF0 : public ResidualFunc {
+public:
+    explicit AuxF0(Ref<FEProblemInterface> fepi) :
+        ResidualFunc(fepi),
+        dim(get_spatial_dimension()),
+        u(get_field_value("u")),
+        u_t(get_field_dot("u")),
+        u_x(get_field_gradient("u")),
+        a(get_field_value("a")),
+        a_x(get_field_gradient("a"))
+    {
+    }
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        f[0] = this->u_t(0) + this->a(0) * this->u(0) * this->u(0);
+        for (Int d = 0; d < this->dim; ++d)
+            f[0] += this->a_x(d) * this->u_x(d);
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldValue & u;
+    const FieldValue & u_t;
+    const FieldGradient & u_x;
+    const FieldValue & a;
+    const FieldGradient & a_x;
+};
+
+class AuxF1 : public ResidualFunc {
+public:
+    explicit AuxF1(Ref<FEProblemInterface> fepi) :
+        ResidualFunc(fepi),
+        dim(get_spatial_dimension()),
+        u_x(get_field_gradient("u")),
+        a(get_field_value("a"))
+    {
+    }
+
+    void
+    evaluate(Scalar f[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            f[d] = (1. + this->a(0)) * this->u_x(d);
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldGradient & u_x;
+    const FieldValue & a;
+};
+
+class AuxG0 : public JacobianFunc {
+public:
+    explicit AuxG0(Ref<FEProblemInterface> fepi) :
+        JacobianFunc(fepi),
+        u(get_field_value("u")),
+        a(get_field_value("a")),
+        u_t_shift(get_time_shift())
+    {
+    }
+
+    void
+    evaluate(Scalar g[]) const override
+    {
+        g[0] = this->u_t_shift + 2. * this->a(0) * this->u(0);
+    }
+
+protected:
+    const FieldValue & u;
+    const FieldValue & a;
+    const Real & u_t_shift;
+};
+
+class AuxG1 : public JacobianFunc {
+public:
+    explicit AuxG1(Ref<FEProblemInterface> fepi) :
+        JacobianFunc(fepi),
+        dim(get_spatial_dimension()),
+        a_x(get_field_gradient("a"))
+    {
+    }
+
+    void
+    evaluate(Scalar g[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            g[d] = this->a_x(d);
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldGradient & a_x;
+};
+
+class AuxG3 : public JacobianFunc {
+public:
+    explicit AuxG3(Ref<FEProblemInterface> fepi) :
+        JacobianFunc(fepi),
+        dim(get_spatial_dimension()),
+        a(get_field_value("a"))
+    {
+    }
+
+    void
+    evaluate(Scalar g[]) const override
+    {
+        for (Int d = 0; d < this->dim; ++d)
+            g[d * this->dim + d] = 1. + this->a(0);
+    }
+
+protected:
+    const Dimension & dim;
+    const FieldValue & a;
+};
+
+class GTestAuxImplicitFENonlinearProblem : public ImplicitFENonlinearProblem {
+public:
+    explicit GTestAuxImplicitFENonlinearProblem(const Parameters & pars) :
+        ImplicitFENonlinearProblem(pars)
+    {
+    }
+
+    using ImplicitFENonlinearProblem::compute_aux_fields;
+
+protected:
+    void
+    set_up_fields() override
+    {
+        set_field(FieldID(0), "u", 1, Order(2));
+        set_aux_field(FieldID(0), "a", 1, Order(1));
+    }
+
+    void
+    set_up_weak_form() override
+    {
+        add_residual_block(FieldID(0), new AuxF0(ref(*this)), new AuxF1(ref(*this)));
+        add_jacobian_block(FieldID(0),
+                           FieldID(0),
+                           new AuxG0(ref(*this)),
+                           new AuxG1(ref(*this)),
+                           nullptr,
+                           new AuxG3(ref(*this)));
+    }
+};
+
 } // namespace
 
+TEST_F(ImplicitFENonlinearProblemTest, sum_factorization_matches_dense)
+{
+    // the sum-factorized and the dense kernels integrate the same quadrature, so on a
+    // quadrilateral mesh both must give the same residual and Jacobian
+    auto mesh_pars = this->app->make_parameters<RectangleMesh>();
+    mesh_pars.set<Int>("nx", 3).set<Int>("ny", 2).set<Real>("xmax", 2.).set<bool>("simplex", false);
+    auto mesh = MeshFactory::create<RectangleMesh>(mesh_pars);
+
+    std::vector<Qtr<GTestAuxImplicitFENonlinearProblem>> probs;
+    for (auto sum_factorization : { true, false }) {
+        auto pars = this->app->make_parameters<GTestAuxImplicitFENonlinearProblem>();
+        pars.set<Ref<Mesh>>("mesh", ref(*mesh))
+            .set<Real>("start_time", 0.)
+            .set<Real>("end_time", 1.)
+            .set<Real>("dt", 0.5)
+            .set<bool>("sum_factorization", sum_factorization);
+        auto & prob = probs.emplace_back(Qtr<GTestAuxImplicitFENonlinearProblem>::alloc(pars));
+
+        auto aux_pars = this->app->make_parameters<LinearAuxField>();
+        aux_pars.set<String>("name", "aux").set<String>("field", "a");
+        prob->add_auxiliary_field<LinearAuxField>(aux_pars);
+        prob->create();
+        prob->compute_aux_fields();
+    }
+    EXPECT_TRUE(probs[0]->uses_sum_factorization());
+    EXPECT_FALSE(probs[1]->uses_sum_factorization());
+
+    auto x = probs[0]->get_solution_vector().duplicate();
+    auto x_t = x.duplicate();
+    auto rng = x.get_ownership_range();
+    for (auto i = rng.first(); i < rng.last(); ++i) {
+        x.set_value(i, std::sin(1. + i));
+        x_t.set_value(i, std::cos(2. * i));
+    }
+    x.assemble();
+    x_t.assemble();
+
+    Real t = 0.25;
+    Real shift = 3.;
+    std::vector<Vector> res;
+    std::vector<Vector> jac_v;
+    for (auto & prob : probs) {
+        auto & F = res.emplace_back(x.duplicate());
+        PETSC_CHECK(TSComputeIFunction(prob->get_ts(), t, x, x_t, F, PETSC_FALSE));
+
+        auto & J = prob->get_jacobian();
+        PETSC_CHECK(TSComputeIJacobian(prob->get_ts(), t, x, x_t, shift, J, J, PETSC_FALSE));
+        auto & y = jac_v.emplace_back(x.duplicate());
+        J.mult(x, y);
+    }
+
+    EXPECT_GT(res[1].norm(NORM_INFINITY), 0.);
+    axpy(res[0], -1., res[1]);
+    EXPECT_NEAR(res[0].norm(NORM_INFINITY), 0., 1e-12);
+
+    EXPECT_GT(jac_v[1].norm(NORM_INFINITY), 0.);
+    axpy(jac_v[0], -1., jac_v[1]);
+    EXPECT_NEAR(jac_v[0].norm(NORM_INFINITY), 0., 1e-12);
+}
+
 TEST_F(ImplicitFENonlinearProblemTest, run)
 {
     auto prob = this->app->get_problem<GTestImplicitFENonlinearProblem>();
@@ -4,6 +4,7 @@
 #include "godzilla/LineMesh.h"
 #include "GTestFENonlinearProblem.h"
 #include "godzilla/L2Diff.h"
+#include "godzilla/ReductionBatch.h"
 
 using namespace godzilla;
 
@@ -66,3 +67,79 @@ TEST(L2DiffTest, compute)
     ASSERT_TRUE(!l2_err.empty());
     EXPECT_NEAR(l2_err[0], 0.000416667, 1e-7);
 }
+
+TEST(L2DiffTest, compute_batched)
+{
+    TestApp app;
+
+    auto mesh_params = app.make_parameters<LineMesh>();
+    mesh_params.set<Int>("nx", 20);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_params);
+
+    auto prob_params = app.make_parameters<GTestFENonlinearProblem>();
+    prob_params.set<Ref<Mesh>>("mesh", ref(*mesh));
+    prob_params.set<bool>("batch_postprocessor_reductions", true);
+    auto prob = app.make_problem<GTestFENonlinearProblem>(prob_params);
+
+    auto bc_left_params = app.make_parameters<DirichletBC>();
+    bc_left_params.set<std::vector<String>>("boundary", { "left" });
+    prob->add_boundary_condition<DirichletBC>(bc_left_params);
+
+    auto bc_right_params = app.make_parameters<DirichletBC>();
+    bc_right_params.set<std::vector<String>>("boundary", { "right" });
+    prob->add_boundary_condition<DirichletBC>(bc_right_params);
+
+    auto ps_params = app.make_parameters<L2Error>();
+    ps_params.set<String>("name", "l2err");
+    auto ps = prob->add_postprocessor<L2Error>(ps_params);
+
+    prob->create();
+
+    prob->run();
+    prob->compute_postprocessors();
+
+    auto l2_err = ps->get_value();
+    ASSERT_TRUE(!l2_err.empty());
+    EXPECT_NEAR(l2_err[0], 0.000416667, 1e-7);
+}
+
+TEST(L2DiffTest, compute_batched_overlap)
+{
+    TestApp app;
+
+    auto mesh_params = app.make_parameters<LineMesh>();
+    mesh_params.set<Int>("nx", 20);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_params);
+
+    auto prob_params = app.make_parameters<GTestFENonlinearProblem>();
+    prob_params.set<Ref<Mesh>>("mesh", ref(*mesh));
+    auto prob = app.make_problem<GTestFENonlinearProblem>(prob_params);
+    prob->set_partition_overlap(1);
+
+    auto bc_left_params = app.make_parameters<DirichletBC>();
+    bc_left_params.set<std::vector<String>>("boundary", { "left" });
+    prob->add_boundary_condition<DirichletBC>(bc_left_params);
+
+    auto bc_right_params = app.make_parameters<DirichletBC>();
+    bc_right_params.set<std::vector<String>>("boundary", { "right" });
+    prob->add_boundary_condition<DirichletBC>(bc_right_params);
+
+    auto ps_params = app.make_parameters<L2Error>();
+    ps_params.set<String>("name", "l2err");
+    auto ps = prob->add_postprocessor<L2Error>(ps_params);
+
+    prob->create();
+    prob->run();
+
+    ps->compute();
+    auto l2_err = ps->get_value()[0];
+
+    // overlap cells must be counted only once
+    ReductionBatch batch(app.get_comm());
+    ASSERT_TRUE(ps->compute_local(batch));
+    batch.reduce();
+    ps->finish_compute(batch);
+    auto l2_err_batched = ps->get_value()[0];
+    EXPECT_NEAR(l2_err_batched, l2_err, 1e-12);
+    EXPECT_NEAR(l2_err_batched, 0.000416667, 1e-7);
+}
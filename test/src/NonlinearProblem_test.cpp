@@ -279,3 +279,98 @@ TEST(NonlinearProblemTest, restart_file)
         EXPECT_NEAR(v(1), 3, 1e-10);
     }
 }
+
+TEST(NonlinearProblemTest, restart_file_async)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<LineMesh>();
+    mesh_pars.set<Int>("nx", 1);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+    auto prob_pars = G1DTestNonlinearProblem::parameters();
+    prob_pars.set<Ref<App>>("app", ref(app));
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+    prob_pars.set<bool>("async_output", true);
+    G1DTestNonlinearProblem prob(prob_pars);
+
+    auto ro_pars = app.make_parameters<RestartOutput>();
+    ro_pars.set<fs::path>("file", "nl-async");
+    prob.add_output<RestartOutput>(ro_pars);
+
+    prob.create();
+    prob.run();
+
+    {
+        RestartFile f("nl-async.restart.h5", FileAccess::READ);
+        auto v = Vector::create_seq(app.get_comm(), 2);
+        f.read<Vector>("/", "sln", v);
+        EXPECT_NEAR(v(0), 2, 1e-10);
+        EXPECT_NEAR(v(1), 3, 1e-10);
+    }
+    EXPECT_FALSE(fs::exists("nl-async.restart.h5.tmp"));
+}
+
+TEST(NonlinearProblemTest, restart_file_ring)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<LineMesh>();
+    mesh_pars.set<Int>("nx", 1);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+    auto prob_pars = G1DTestNonlinearProblem::parameters();
+    prob_pars.set<Ref<App>>("app", ref(app));
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+    G1DTestNonlinearProblem prob(prob_pars);
+
+    auto ro_pars = app.make_parameters<RestartOutput>();
+    ro_pars.set<fs::path>("file", "nl-ring");
+    ro_pars.set<Int>("num_checkpoints", 2);
+    auto ro = prob.add_output<RestartOutput>(ro_pars);
+
+    prob.create();
+    EXPECT_EQ(ro->get_checkpoint_file_name(0), "nl-ring.restart.h5");
+    EXPECT_EQ(ro->get_checkpoint_file_name(1), "nl-ring-1.restart.h5");
+
+    fs::remove(ro->get_checkpoint_file_name(1));
+    fs::remove(ro->get_checkpoint_file_name(2));
+    for (int i = 0; i < 3; ++i)
+        ro->output_step();
+
+    EXPECT_TRUE(fs::exists("nl-ring.restart.h5"));
+    EXPECT_TRUE(fs::exists("nl-ring-1.restart.h5"));
+    EXPECT_FALSE(fs::exists("nl-ring-2.restart.h5"));
+    EXPECT_FALSE(fs::exists("nl-ring.restart.h5.tmp"));
+}
+
+TEST(NonlinearProblemTest, restart_file_read)
+{
+    TestApp app;
+
+    auto mesh_pars = app.make_parameters<LineMesh>();
+    mesh_pars.set<Int>("nx", 1);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_pars);
+
+    auto prob_pars = G1DTestNonlinearProblem::parameters();
+    prob_pars.set<Ref<App>>("app", ref(app));
+    prob_pars.set<Ref<Mesh>>("mesh", ref(*mesh));
+    G1DTestNonlinearProblem prob(prob_pars);
+
+    auto ro_pars = app.make_parameters<RestartOutput>();
+    ro_pars.set<fs::path>("file", "nl-read");
+    prob.add_output<RestartOutput>(ro_pars);
+
+    prob.create();
+    prob.run();
+
+    prob.get_solution_vector().set(0.);
+    {
+        RestartFile f(app.get_comm(), "nl-read.restart.h5", FileAccess::READ);
+        prob.read_restart_file(f);
+    }
+    auto & sln = prob.get_solution_vector();
+    auto rng = sln.get_ownership_range();
+    for (auto i = rng.first(); i < rng.last(); ++i)
+        EXPECT_NEAR(sln(i), i + 2., 1e-10);
+}
@@ -115,3 +115,18 @@ TEST(PerfLogTest, is_event_registered)
     perf_log::register_event("event3");
     EXPECT_TRUE(perf_log::is_event_registered("event3"));
 }
+
+TEST(PerfLogTest, builtin_events)
+{
+    EXPECT_TRUE(perf_log::is_event_registered("FENonlinearProblem::compute_residual"));
+    EXPECT_TRUE(perf_log::is_event_registered("FEProblemInterface::integrate_jacobian"));
+    EXPECT_TRUE(perf_log::is_event_registered("Problem::output"));
+    EXPECT_EQ(perf_log::get_event_id("Problem::global_to_local"),
+              perf_log::event::global_to_local);
+
+    auto n_calls = perf_log::get_event_info(perf_log::event::output).num_calls();
+    {
+        perf_log::ScopedEvent event(perf_log::event::output);
+    }
+    EXPECT_EQ(perf_log::get_event_info(perf_log::event::output).num_calls(), n_calls + 1);
+}
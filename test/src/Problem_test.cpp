@@ -16,6 +16,10 @@
 #include "ExceptionTestMacros.h"
 #include "petscsystypes.h"
 #include "petscfe.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
 
 using namespace godzilla;
 
@@ -106,6 +110,97 @@ TEST(ProblemTest, add_pp)
     problem.output(ExecuteOn::INITIAL);
 }
 
+TEST(ProblemTest, async_output_flush_before_unsafe_snapshot)
+{
+    TestApp app;
+
+    // writes on the I/O thread and reports when it is done
+    class SlowOutput : public FileOutput {
+    public:
+        explicit SlowOutput(const Parameters & pars) : FileOutput(pars) {}
+
+        void
+        output_step() override
+        {
+        }
+
+        std::function<void()>
+        create_output_task() override
+        {
+            return [done = this->done]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                *done = true;
+            };
+        }
+
+        String
+        get_file_ext() const override
+        {
+            return "slow";
+        }
+
+        std::shared_ptr<std::atomic<bool>> done = std::make_shared<std::atomic<bool>>(false);
+    };
+
+    // snapshots through a library that is not thread-safe
+    class UnsafeOutput : public FileOutput {
+    public:
+        explicit UnsafeOutput(const Parameters & pars) : FileOutput(pars) {}
+
+        void
+        output_step() override
+        {
+        }
+
+        std::function<void()>
+        create_output_task() override
+        {
+            this->slow_done_at_snapshot = *this->slow_done;
+            return [] {};
+        }
+
+        bool
+        is_snapshot_thread_safe() const override
+        {
+            return false;
+        }
+
+        String
+        get_file_ext() const override
+        {
+            return "unsafe";
+        }
+
+        std::shared_ptr<std::atomic<bool>> slow_done;
+        bool slow_done_at_snapshot = false;
+    };
+
+    auto mesh_params = app.make_parameters<LineMesh>();
+    mesh_params.set<Int>("nx", 2);
+    auto mesh = MeshFactory::create<LineMesh>(mesh_params);
+
+    auto prob_params = app.make_parameters<TestProblem>();
+    prob_params.set<Ref<Mesh>>("mesh", ref(*mesh));
+    prob_params.set<bool>("async_output", true);
+    TestProblem problem(prob_params);
+    EXPECT_TRUE(problem.is_output_async());
+
+    auto slow_params = app.make_parameters<SlowOutput>();
+    slow_params.set<fs::path>("file", "slow");
+    slow_params.set<ExecuteOnFlags>("on", ExecuteOn::INITIAL);
+    auto slow = problem.add_output<SlowOutput>(slow_params);
+
+    auto unsafe_params = app.make_parameters<UnsafeOutput>();
+    unsafe_params.set<fs::path>("file", "unsafe");
+    unsafe_params.set<ExecuteOnFlags>("on", ExecuteOn::INITIAL);
+    auto unsafe = problem.add_output<UnsafeOutput>(unsafe_params);
+    unsafe->slow_done = slow->done;
+
+    problem.output(ExecuteOn::INITIAL);
+    problem.flush_output();
+    EXPECT_TRUE(unsafe->slow_done_at_snapshot);
+}
+
 TEST(ProblemTest, local_vec)
 {
     TestApp app;
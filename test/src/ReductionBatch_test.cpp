@@ -0,0 +1,38 @@
+#include "gmock/gmock.h"
+#include "godzilla/ReductionBatch.h"
+
+using namespace godzilla;
+
+TEST(ReductionBatchTest, reduce)
+{
+    mpi::Communicator comm(MPI_COMM_WORLD);
+    auto rank = comm.rank();
+    auto n_procs = comm.size();
+
+    ReductionBatch batch(comm);
+    auto h_sum = batch.add_sum(1.);
+    auto h_min = batch.add_min(rank + 1.);
+    auto h_max = batch.add_max(rank + 1.);
+    auto h_rank_sum = batch.add_sum(rank);
+    EXPECT_EQ(batch.size(), 4);
+
+    batch.reduce();
+    EXPECT_DOUBLE_EQ(batch.get(h_sum), n_procs);
+    EXPECT_DOUBLE_EQ(batch.get(h_min), 1.);
+    EXPECT_DOUBLE_EQ(batch.get(h_max), n_procs);
+    EXPECT_DOUBLE_EQ(batch.get(h_rank_sum), n_procs * (n_procs - 1) / 2.);
+}
+
+TEST(ReductionBatchTest, clear)
+{
+    mpi::Communicator comm(MPI_COMM_WORLD);
+    ReductionBatch batch(comm);
+    batch.add_sum(2.);
+    batch.add_max(-3.);
+    batch.clear();
+    EXPECT_EQ(batch.size(), 0);
+
+    auto h = batch.add_max(-3.);
+    batch.reduce();
+    EXPECT_DOUBLE_EQ(batch.get(h), -3.);
+}
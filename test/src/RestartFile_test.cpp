@@ -2,6 +2,10 @@
 #include "TestApp.h"
 #include "godzilla/RestartFile.h"
 #include "godzilla/Utils.h"
+#include "godzilla/MeshFactory.h"
+#include "godzilla/LineMesh.h"
+#include "godzilla/Vector.h"
+#include "petscdmplex.h"
 
 using namespace godzilla;
 
@@ -13,6 +17,61 @@ struct TestStruct {
     String str;
 };
 
+/// Create a distributed line mesh with one DoF per vertex
+Qtr<LineMesh>
+create_line_mesh(App & app)
+{
+    auto pars = app.make_parameters<LineMesh>();
+    pars.set<Int>("nx", 10);
+    auto mesh = MeshFactory::create<LineMesh>(pars);
+    mesh->distribute(0);
+
+    auto dm = mesh->get_dm();
+    Int nc[1] = { 1 };
+    Int n_dofs[2] = { 1, 0 };
+    PetscSection s;
+    PETSC_CHECK(DMSetNumFields(dm, 1));
+    PETSC_CHECK(
+        DMPlexCreateSection(dm, nullptr, nc, n_dofs, 0, nullptr, nullptr, nullptr, nullptr, &s));
+    PETSC_CHECK(DMSetLocalSection(dm, s));
+    PETSC_CHECK(PetscSectionDestroy(&s));
+    return mesh;
+}
+
+/// Create a global vector holding the x-coordinate of each vertex, which does not depend on the
+/// partitioning
+Vector
+create_x_vector(DM dm)
+{
+    Vec loc, glob, coords;
+    PETSC_CHECK(DMGetLocalVector(dm, &loc));
+    PETSC_CHECK(DMCreateGlobalVector(dm, &glob));
+    PETSC_CHECK(DMGetCoordinatesLocal(dm, &coords));
+    DM cdm;
+    PETSC_CHECK(DMGetCoordinateDM(dm, &cdm));
+    PetscSection s, cs;
+    PETSC_CHECK(DMGetLocalSection(dm, &s));
+    PETSC_CHECK(DMGetLocalSection(cdm, &cs));
+
+    Int v_start, v_end;
+    PETSC_CHECK(DMPlexGetDepthStratum(dm, 0, &v_start, &v_end));
+    const Scalar * xc;
+    Scalar * xl;
+    PETSC_CHECK(VecGetArrayRead(coords, &xc));
+    PETSC_CHECK(VecGetArray(loc, &xl));
+    for (Int v = v_start; v < v_end; ++v) {
+        Int off, coff;
+        PETSC_CHECK(PetscSectionGetOffset(s, v, &off));
+        PETSC_CHECK(PetscSectionGetOffset(cs, v, &coff));
+        xl[off] = xc[coff];
+    }
+    PETSC_CHECK(VecRestoreArray(loc, &xl));
+    PETSC_CHECK(VecRestoreArrayRead(coords, &xc));
+    PETSC_CHECK(DMLocalToGlobal(dm, loc, INSERT_VALUES, glob));
+    PETSC_CHECK(DMRestoreLocalVector(dm, &loc));
+    return Vector(glob);
+}
+
 } // namespace
 
 namespace godzilla {
@@ -78,3 +137,34 @@ TEST(RestartFileTest, read_write)
         EXPECT_EQ(data.str, "world");
     }
 }
+
+TEST(RestartFileTest, natural_vector_n_to_m)
+{
+    // written on all ranks but one and read on all ranks, i.e. 2 -> 3 when run on 3 ranks
+    mpi::Communicator comm(MPI_COMM_WORLD);
+    int n_writers = std::max(1, comm.size() - 1);
+    MPI_Comm writer_comm;
+    MPI_Comm_split(comm, comm.rank() < n_writers ? 0 : MPI_UNDEFINED, comm.rank(), &writer_comm);
+    if (writer_comm != MPI_COMM_NULL) {
+        App app(mpi::Communicator(writer_comm), "restart_writer");
+        auto mesh = create_line_mesh(app);
+        auto x = create_x_vector(mesh->get_dm());
+        RestartFile f(app.get_comm(), "n_to_m.h5", FileAccess::CREATE);
+        f.write_natural_vector("/", "x", mesh->get_dm(), x);
+    }
+    comm.barrier();
+
+    TestApp app;
+    auto mesh = create_line_mesh(app);
+    auto x = create_x_vector(mesh->get_dm());
+    auto u = x.duplicate();
+    {
+        RestartFile f(app.get_comm(), "n_to_m.h5", FileAccess::READ);
+        f.read_natural_vector("/", "x", mesh->get_dm(), u);
+    }
+    axpy(u, -1., x);
+    EXPECT_NEAR(u.norm(NORM_INFINITY), 0., 1e-12);
+
+    if (writer_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&writer_comm);
+}
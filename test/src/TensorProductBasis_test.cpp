@@ -0,0 +1,99 @@
+#include "gmock/gmock.h"
+#include "godzilla/TensorProductBasis.h"
+#include "godzilla/Error.h"
+#include "petscfe.h"
+#include <cmath>
+#include <vector>
+
+using namespace godzilla;
+
+namespace {
+
+/// Compare sum-factorized evaluation with the dense tabulation of a tensor-product element
+void
+check_against_tabulation(Int dim, Int nc, Int k)
+{
+    PetscFE fe;
+    PETSC_CHECK(
+        PetscFECreateLagrange(PETSC_COMM_SELF, dim, nc, PETSC_FALSE, k, PETSC_DETERMINE, &fe));
+    TensorProductBasis tpb;
+    ASSERT_TRUE(tpb.create(fe));
+    EXPECT_TRUE(tpb.is_valid());
+    EXPECT_EQ(tpb.get_dimension(), dim);
+    EXPECT_EQ(tpb.get_num_components(), nc);
+
+    PetscTabulation T;
+    PETSC_CHECK(PetscFEGetCellTabulation(fe, 1, &T));
+    Int n_q = T->Np;
+    Int nb = T->Nb;
+    EXPECT_EQ(tpb.get_num_qpoints(), n_q);
+    EXPECT_EQ(tpb.get_num_basis(), nb);
+
+    std::vector<Scalar> coefs(nb);
+    for (Int b = 0; b < nb; ++b)
+        coefs[b] = std::sin(1. + 0.7 * b);
+    std::vector<Scalar> work(tpb.get_work_size());
+    std::vector<Scalar> u(n_q * nc), u_ref(n_q * nc * dim);
+    tpb.interpolate(coefs.data(), u.data(), u_ref.data(), work.data());
+    for (Int q = 0; q < n_q; ++q) {
+        for (Int c = 0; c < nc; ++c) {
+            Scalar val = 0.;
+            for (Int b = 0; b < nb; ++b)
+                val += T->T[0][(q * nb + b) * nc + c] * coefs[b];
+            EXPECT_NEAR(u[q * nc + c], val, 1e-12);
+            for (Int d = 0; d < dim; ++d) {
+                Scalar der = 0.;
+                for (Int b = 0; b < nb; ++b)
+                    der += T->T[1][((q * nb + b) * nc + c) * dim + d] * coefs[b];
+                EXPECT_NEAR(u_ref[(q * nc + c) * dim + d], der, 1e-12);
+            }
+        }
+    }
+
+    std::vector<Scalar> f0(n_q * nc), f1(n_q * nc * dim);
+    for (Int i = 0; i < n_q * nc; ++i)
+        f0[i] = std::cos(0.3 * i);
+    for (Int i = 0; i < n_q * nc * dim; ++i)
+        f1[i] = std::sin(0.2 * i);
+    std::vector<Scalar> elem_vec(nb, 1.);
+    tpb.integrate(f0.data(), f1.data(), elem_vec.data(), work.data());
+    for (Int b = 0; b < nb; ++b) {
+        Scalar val = 1.;
+        for (Int q = 0; q < n_q; ++q) {
+            for (Int c = 0; c < nc; ++c) {
+                val += T->T[0][(q * nb + b) * nc + c] * f0[q * nc + c];
+                for (Int d = 0; d < dim; ++d)
+                    val += T->T[1][((q * nb + b) * nc + c) * dim + d] * f1[(q * nc + c) * dim + d];
+            }
+        }
+        EXPECT_NEAR(elem_vec[b], val, 1e-12);
+    }
+
+    PETSC_CHECK(PetscFEDestroy(&fe));
+}
+
+} // namespace
+
+TEST(TensorProductBasisTest, quad)
+{
+    check_against_tabulation(2, 1, 1);
+    check_against_tabulation(2, 1, 2);
+    check_against_tabulation(2, 2, 3);
+}
+
+TEST(TensorProductBasisTest, hex)
+{
+    check_against_tabulation(3, 1, 1);
+    check_against_tabulation(3, 1, 2);
+    check_against_tabulation(3, 3, 2);
+}
+
+TEST(TensorProductBasisTest, simplex)
+{
+    PetscFE fe;
+    PETSC_CHECK(PetscFECreateLagrange(PETSC_COMM_SELF, 2, 1, PETSC_TRUE, 2, PETSC_DETERMINE, &fe));
+    TensorProductBasis tpb;
+    EXPECT_FALSE(tpb.create(fe));
+    EXPECT_FALSE(tpb.is_valid());
+    PETSC_CHECK(PetscFEDestroy(&fe));
+}
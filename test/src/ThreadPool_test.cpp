@@ -0,0 +1,80 @@
+#include "gmock/gmock.h"
+#include "godzilla/ThreadPool.h"
+#include "godzilla/Exception.h"
+#include <atomic>
+
+using namespace godzilla;
+
+TEST(ThreadPoolTest, no_workers)
+{
+    ThreadPool pool;
+    EXPECT_EQ(pool.get_num_threads(), 0);
+    std::vector<Int> slots(5, -1);
+    pool.parallel_for(5, [&](Int i) { slots[i] = get_thread_slot(); });
+    EXPECT_THAT(slots, testing::Each(0));
+}
+
+TEST(ThreadPoolTest, parallel_for)
+{
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.get_num_threads(), 3);
+    std::vector<Int> hits(100, 0);
+    std::vector<Int> slots(100, -1);
+    pool.parallel_for(100, [&](Int i) {
+        hits[i] += 1;
+        slots[i] = get_thread_slot();
+    });
+    EXPECT_THAT(hits, testing::Each(1));
+    EXPECT_THAT(slots, testing::Each(testing::AllOf(testing::Ge(1), testing::Le(3))));
+    EXPECT_EQ(get_thread_slot(), 0);
+}
+
+TEST(ThreadPoolTest, repeated_jobs)
+{
+    ThreadPool pool(2);
+    std::atomic<Int> sum(0);
+    for (Int j = 0; j < 10; ++j)
+        pool.parallel_for(10, [&](Int i) { sum += i; });
+    EXPECT_EQ(sum, 450);
+}
+
+TEST(ThreadPoolTest, resize)
+{
+    ThreadPool pool(1);
+    pool.resize(4);
+    EXPECT_EQ(pool.get_num_threads(), 4);
+    std::atomic<Int> cnt(0);
+    pool.parallel_for(20, [&](Int) { ++cnt; });
+    EXPECT_EQ(cnt, 20);
+    pool.resize(0);
+    EXPECT_EQ(pool.get_num_threads(), 0);
+}
+
+TEST(ThreadPoolTest, resize_after_jobs)
+{
+    ThreadPool pool(2);
+    std::atomic<Int> cnt(0);
+    for (Int j = 0; j < 3; ++j)
+        pool.parallel_for(10, [&](Int) { ++cnt; });
+    EXPECT_EQ(cnt, 30);
+
+    pool.resize(3);
+    for (Int j = 0; j < 3; ++j)
+        pool.parallel_for(10, [&](Int) { ++cnt; });
+    EXPECT_EQ(cnt, 60);
+}
+
+TEST(ThreadPoolTest, exception)
+{
+    ThreadPool pool(2);
+    EXPECT_THROW(pool.parallel_for(10,
+                                   [](Int i) {
+                                       if (i == 7)
+                                           throw Exception("error");
+                                   }),
+                 Exception);
+    // pool is still usable after a failed job
+    std::atomic<Int> cnt(0);
+    pool.parallel_for(4, [&](Int) { ++cnt; });
+    EXPECT_EQ(cnt, 4);
+}
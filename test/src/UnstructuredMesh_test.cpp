@@ -4,13 +4,18 @@
 #include "godzilla/Error.h"
 #include "godzilla/FileMesh.h"
 #include "godzilla/LineMesh.h"
+#include "godzilla/RectangleMesh.h"
 #include "godzilla/MeshFactory.h"
 #include "godzilla/UnstructuredMesh.h"
 #include "godzilla/Parameters.h"
 #include "godzilla/Formatters.h"
+#include "godzilla/Section.h"
+#include "godzilla/StarForest.h"
 #include "ExceptionTestMacros.h"
 #include "godzilla/Utils.h"
 #include "petscdmplex.h"
+#include <algorithm>
+#include <array>
 #include <filesystem>
 
 using namespace godzilla;
@@ -259,6 +264,38 @@ TEST(UnstructuredMeshTest, get_connectivity)
     EXPECT_EQ(vals[2], 4);
 }
 
+TEST(UnstructuredMeshTest, get_cell_connectivity)
+{
+    TestApp app;
+
+    auto params = app.make_parameters<TestUnstructuredMesh>();
+    params.set<String>("name", "obj");
+    auto mesh_qtr = MeshFactory::create<TestUnstructuredMesh>(params);
+    auto m = mesh_qtr.get();
+
+    const auto & conn = m->get_cell_connectivity();
+    EXPECT_EQ(conn.cells.first(), 0);
+    EXPECT_EQ(conn.cells.last(), 2);
+    EXPECT_THAT(conn.offsets, testing::ElementsAre(0, 2, 4));
+    EXPECT_THAT(conn.vertices, testing::ElementsAre(2, 3, 3, 4));
+    for (auto & cell : m->get_cell_range()) {
+        auto cell_conn = conn[cell];
+        auto expected = m->get_connectivity(cell);
+        ASSERT_EQ(cell_conn.size(), expected.size());
+        for (Int i = 0; i < cell_conn.size(); ++i)
+            EXPECT_EQ(cell_conn[i], expected[i]);
+    }
+
+    // the cache is rebuilt when the topology changes
+    m->construct_ghost_cells();
+    const auto & gconn = m->get_cell_connectivity();
+    EXPECT_EQ(gconn.cells.last(), 2);
+    EXPECT_THAT(gconn.vertices, testing::ElementsAre(4, 5, 5, 6));
+    EXPECT_EQ(gconn[1].size(), 2);
+    EXPECT_EQ(gconn[1][0], m->get_connectivity(1)[0]);
+    EXPECT_EQ(gconn[1][1], m->get_connectivity(1)[1]);
+}
+
 TEST(UnstructuredMeshTest, get_num_cell_nodes)
 {
     EXPECT_EQ(UnstructuredMesh::get_num_cell_nodes(PolytopeType::POINT), 1);
@@ -606,6 +643,14 @@ TEST(UnstructuredMesh, get_coordinates)
     EXPECT_DOUBLE_EQ(coord1[0], 0.5);
     EXPECT_DOUBLE_EQ(coord1[1], 0.);
     EXPECT_DOUBLE_EQ(coord1[2], 0.);
+
+    auto coords = m->get_vertex_coordinates();
+    EXPECT_EQ(coords.get_dim(), 3);
+    for (auto & vtx : m->get_vertex_range()) {
+        auto expected = m->get_vertex_coordinates(vtx);
+        for (Int d = 0; d < 3; ++d)
+            EXPECT_DOUBLE_EQ(coords[vtx][d], expected[d]);
+    }
 }
 
 TEST(UnstructuredMesh, get_cell_numbering)
@@ -753,3 +798,176 @@ TEST(UnstructuredMeshTest, create_submesh)
     EXPECT_THAT(facet_ids, testing::ElementsAre(5, 6));
     EXPECT_THAT(facet_types, testing::ElementsAre(PolytopeType::SEGMENT, PolytopeType::SEGMENT));
 }
+
+TEST(UnstructuredMeshTest, reorder)
+{
+    TestApp app;
+
+    for (auto ordering : { UnstructuredMesh::Ordering::RCM, UnstructuredMesh::Ordering::HILBERT }) {
+        auto params = app.make_parameters<RectangleMesh>();
+        params.set<Int>("nx", 5).set<Int>("ny", 4).set<bool>("simplex", true);
+        auto mesh = MeshFactory::create<RectangleMesh>(params);
+
+        auto n_cells = mesh->get_num_cells();
+        auto n_vertices = mesh->get_num_vertices();
+        auto face_sets = mesh->get_label("Face Sets");
+        auto ids_is = face_sets.get_value_index_set();
+        std::vector<Int> ids;
+        for (auto & id : ids_is.borrow_indices())
+            ids.push_back(id);
+        std::vector<Int> sizes;
+        for (auto & id : ids)
+            sizes.push_back(face_sets.get_stratum_size(id));
+
+        mesh->reorder(ordering);
+
+        EXPECT_EQ(mesh->get_num_cells(), n_cells);
+        EXPECT_EQ(mesh->get_num_vertices(), n_vertices);
+        face_sets = mesh->get_label("Face Sets");
+        for (std::size_t i = 0; i < ids.size(); ++i)
+            EXPECT_EQ(face_sets.get_stratum_size(ids[i]), sizes[i]);
+        Real vol = 0.;
+        for (auto & cell : mesh->get_cell_range())
+            vol += mesh->compute_cell_volume(cell);
+        EXPECT_NEAR(vol, 1., 1e-12);
+    }
+}
+
+namespace {
+
+/// Largest difference of the indices of two cells sharing a face
+Int
+dual_graph_bandwidth(const UnstructuredMesh & mesh)
+{
+    Int bw = 0;
+    for (auto & cell : mesh.get_cell_range())
+        for (auto & face : mesh.get_cone(cell))
+            for (auto & nbr : mesh.get_support(face))
+                bw = std::max(bw, std::abs(nbr - cell));
+    return bw;
+}
+
+std::vector<std::array<Real, 2>>
+cell_centroids(const UnstructuredMesh & mesh)
+{
+    std::vector<std::array<Real, 2>> centroids;
+    for (auto & cell : mesh.get_cell_range()) {
+        Real vol, centroid[3];
+        mesh.compute_cell_geometry(cell, &vol, centroid, nullptr);
+        centroids.push_back({ centroid[0], centroid[1] });
+    }
+    return centroids;
+}
+
+} // namespace
+
+TEST(UnstructuredMeshTest, reorder_permutes_cells)
+{
+    TestApp app;
+
+    for (auto ordering : { UnstructuredMesh::Ordering::RCM, UnstructuredMesh::Ordering::HILBERT }) {
+        // cells of a box mesh are numbered row by row, so neighbors in y are `nx` apart
+        auto params = app.make_parameters<RectangleMesh>();
+        params.set<Int>("nx", 8).set<Int>("ny", 3).set<bool>("simplex", false);
+        auto mesh = MeshFactory::create<RectangleMesh>(params);
+
+        auto bw = dual_graph_bandwidth(*mesh);
+        auto centroids = cell_centroids(*mesh);
+
+        mesh->reorder(ordering);
+
+        auto new_centroids = cell_centroids(*mesh);
+        ASSERT_EQ(new_centroids.size(), centroids.size());
+        EXPECT_NE(new_centroids, centroids);
+        // the same cells, only in a different order
+        std::sort(centroids.begin(), centroids.end());
+        std::sort(new_centroids.begin(), new_centroids.end());
+        for (std::size_t i = 0; i < centroids.size(); ++i)
+            for (Int d = 0; d < 2; ++d)
+                EXPECT_NEAR(new_centroids[i][d], centroids[i][d], 1e-12);
+
+        if (ordering == UnstructuredMesh::Ordering::RCM)
+            EXPECT_LT(dual_graph_bandwidth(*mesh), bw);
+    }
+}
+
+TEST(UnstructuredMeshTest, reorder_point_sf)
+{
+    TestApp app;
+    auto comm = app.get_comm();
+
+    for (auto ordering : { UnstructuredMesh::Ordering::RCM, UnstructuredMesh::Ordering::HILBERT }) {
+        auto params = app.make_parameters<RectangleMesh>();
+        params.set<Int>("nx", 6).set<Int>("ny", 5).set<bool>("simplex", false);
+        auto mesh = MeshFactory::create<RectangleMesh>(params);
+        mesh->distribute(1);
+        mesh->reorder(ordering);
+        // a serial mesh has no shared points
+        if (comm.size() == 1) {
+            EXPECT_FALSE(mesh->is_distributed());
+            continue;
+        }
+
+        // every shared point must be the same point (same depth and location) on the rank that
+        // owns it
+        auto chart = mesh->get_chart();
+        auto n_pts = chart.size();
+        std::vector<Int> depth(n_pts);
+        std::vector<Real> x(n_pts), y(n_pts);
+        for (auto & pt : chart) {
+            depth[pt] = mesh->get_point_depth(pt);
+            if (depth[pt] == 0) {
+                auto xyz = mesh->get_vertex_coordinates(pt);
+                x[pt] = xyz[0];
+                y[pt] = xyz[1];
+            }
+            else {
+                Real vol, centroid[3];
+                mesh->compute_cell_geometry(pt, &vol, centroid, nullptr);
+                x[pt] = centroid[0];
+                y[pt] = centroid[1];
+            }
+        }
+
+        auto sf = mesh->get_point_star_forest();
+        auto graph = sf.get_graph();
+        EXPECT_GT(graph.get_num_leaves(), 0);
+        for (Int i = 0; i < graph.get_num_leaves(); ++i) {
+            EXPECT_TRUE(chart.contains(graph.get_leaf(i)));
+            EXPECT_NE(graph.get_remote_leaf(i).rank, comm.rank());
+        }
+
+        auto remote_depth = depth;
+        auto remote_x = x;
+        auto remote_y = y;
+        sf.broadcast_begin(depth, remote_depth, mpi::op::replace<Int>());
+        sf.broadcast_end(depth, remote_depth, mpi::op::replace<Int>());
+        sf.broadcast_begin(x, remote_x, mpi::op::replace<Real>());
+        sf.broadcast_end(x, remote_x, mpi::op::replace<Real>());
+        sf.broadcast_begin(y, remote_y, mpi::op::replace<Real>());
+        sf.broadcast_end(y, remote_y, mpi::op::replace<Real>());
+        for (auto & pt : chart) {
+            EXPECT_EQ(remote_depth[pt], depth[pt]);
+            EXPECT_NEAR(remote_x[pt], x[pt], 1e-12);
+            EXPECT_NEAR(remote_y[pt], y[pt], 1e-12);
+        }
+    }
+}
+
+TEST(UnstructuredMeshTest, reorder_after_section)
+{
+    TestApp app;
+
+    auto params = app.make_parameters<RectangleMesh>();
+    params.set<Int>("nx", 2).set<Int>("ny", 2);
+    auto mesh = MeshFactory::create<RectangleMesh>(params);
+
+    Section section;
+    section.create(mesh->get_comm());
+    section.set_chart(mesh->get_chart());
+    section.set_up();
+    PETSC_CHECK(DMSetLocalSection(mesh->get_dm(), section));
+
+    EXPECT_DEATH(mesh->reorder(UnstructuredMesh::Ordering::RCM),
+                 "Mesh can only be reordered before any fields or sections are set up on it.");
+}